@@ -18,6 +18,7 @@ static int errno;
 #define strcasecmp(s1,s2) stricmp((s1), (s2))
 #else
 #include <strings.h>
+#include <poll.h>
 #endif
 
 #define DBDPG_TRUE (bool)1
@@ -117,6 +118,7 @@ DBISTATE_DECLARE;
  * That makes the code uncluttered and gives good flexibility.
  */
 #define TRACE_PQBACKENDPID         TRACE_XX "%sPQbackendPID\n",          THEADER_slow)
+#define TRACE_PQBINARYTUPLES       TRACE_XX "%sPQbinaryTuples\n",        THEADER_slow)
 #define TRACE_PQCANCEL             TRACE_XX "%sPQcancel\n",              THEADER_slow)
 #define TRACE_PQCLEAR              TRACE_XX "%sPQclear\n",               THEADER_slow)
 #define TRACE_PQCLOSEPREPARED      TRACE_XX "%sPQclosePrepared\n",       THEADER_slow)
@@ -128,10 +130,12 @@ DBISTATE_DECLARE;
 #define TRACE_PQCONSUMEINPUT       TRACE_XX "%sPQconsumeInput\n",        THEADER_slow)
 #define TRACE_PQDB                 TRACE_XX "%sPQdb\n",                  THEADER_slow)
 #define TRACE_PQENDCOPY            TRACE_XX "%sPQendcopy\n",             THEADER_slow)
+#define TRACE_PQENTERPIPELINEMODE  TRACE_XX "%sPQenterPipelineMode\n",   THEADER_slow)
 #define TRACE_PQERRORMESSAGE       TRACE_XX "%sPQerrorMessage\n",        THEADER_slow)
 #define TRACE_PQEXEC               TRACE_XX "%sPQexec\n",                THEADER_slow)
 #define TRACE_PQEXECPARAMS         TRACE_XX "%sPQexecParams\n",          THEADER_slow)
 #define TRACE_PQEXECPREPARED       TRACE_XX "%sPQexecPrepared\n",        THEADER_slow)
+#define TRACE_PQEXITPIPELINEMODE   TRACE_XX "%sPQexitPipelineMode\n",    THEADER_slow)
 #define TRACE_PQFINISH             TRACE_XX "%sPQfinish\n",              THEADER_slow)
 #define TRACE_PQFMOD               TRACE_XX "%sPQfmod\n",                THEADER_slow)
 #define TRACE_PQFNAME              TRACE_XX "%sPQfname\n",               THEADER_slow)
@@ -156,6 +160,8 @@ DBISTATE_DECLARE;
 #define TRACE_PQOPTIONS            TRACE_XX "%sPQoptions\n",             THEADER_slow)
 #define TRACE_PQPARAMETERSTATUS    TRACE_XX "%sPQparameterStatus\n",     THEADER_slow)
 #define TRACE_PQPASS               TRACE_XX "%sPQpass\n",                THEADER_slow)
+#define TRACE_PQPIPELINESTATUS     TRACE_XX "%sPQpipelineStatus\n",      THEADER_slow)
+#define TRACE_PQPIPELINESYNC       TRACE_XX "%sPQpipelineSync\n",        THEADER_slow)
 #define TRACE_PQPORT               TRACE_XX "%sPQport\n",                THEADER_slow)
 #define TRACE_PQPREPARE            TRACE_XX "%sPQprepare\n",             THEADER_slow)
 #define TRACE_PQPROTOCOLVERSION    TRACE_XX "%sPQprotocolVersion\n",     THEADER_slow)
@@ -171,8 +177,10 @@ DBISTATE_DECLARE;
 #define TRACE_PQSENDQUERYPARAMS    TRACE_XX "%sPQsendQueryParams\n",     THEADER_slow)
 #define TRACE_PQSENDQUERYPREPARED  TRACE_XX "%sPQsendQueryPrepared\n",   THEADER_slow)
 #define TRACE_PQSERVERVERSION      TRACE_XX "%sPQserverVersion\n",       THEADER_slow)
+#define TRACE_PQSETCHUNKEDROWSMODE TRACE_XX "%sPQsetChunkedRowsMode\n",  THEADER_slow)
 #define TRACE_PQSETERRORVERBOSITY  TRACE_XX "%sPQsetErrorVerbosity\n",   THEADER_slow)
 #define TRACE_PQSETNOTICEPROCESSOR TRACE_XX "%sPQsetNoticeProcessor\n",  THEADER_slow)
+#define TRACE_PQSETSINGLEROWMODE   TRACE_XX "%sPQsetSingleRowMode\n",    THEADER_slow)
 #define TRACE_PQSOCKET             TRACE_XX "%sPQsocket\n",              THEADER_slow)
 #define TRACE_PQSTATUS             TRACE_XX "%sPQstatus\n",              THEADER_slow)
 #define TRACE_PQTRACE              TRACE_XX "%sPQtrace\n",               THEADER_slow)
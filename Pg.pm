@@ -151,21 +151,32 @@ use 5.008001;
         # uncoverable branch false
         if (!$methods_are_installed) {
             DBD::Pg::db->install_method('pg_cancel');
+            DBD::Pg::db->install_method('pg_clear_metadata_cache');
             DBD::Pg::db->install_method('pg_continue_connect');
             DBD::Pg::db->install_method('pg_endcopy');
+            DBD::Pg::db->install_method('pg_enter_pipeline');
             DBD::Pg::db->install_method('pg_error_field');
+            DBD::Pg::db->install_method('pg_exit_pipeline');
             DBD::Pg::db->install_method('pg_getline');
             DBD::Pg::db->install_method('pg_getcopydata');
             DBD::Pg::db->install_method('pg_getcopydata_async');
+            DBD::Pg::db->install_method('pg_getcopydata_bulk');
             DBD::Pg::db->install_method('pg_notifies');
+            DBD::Pg::db->install_method('pg_notifies_all');
+            DBD::Pg::db->install_method('pg_wait_for_notify');
             DBD::Pg::db->install_method('pg_flush');
             DBD::Pg::db->install_method('pg_putcopydata');
             DBD::Pg::db->install_method('pg_putcopydata_async');
             DBD::Pg::db->install_method('pg_putcopyend');
             DBD::Pg::db->install_method('pg_putcopyend_async');
             DBD::Pg::db->install_method('pg_ping');
+            DBD::Pg::db->install_method('pg_pipeline_completed');
+            DBD::Pg::db->install_method('pg_pipeline_flush');
+            DBD::Pg::db->install_method('pg_pipeline_submit');
+            DBD::Pg::db->install_method('pg_pipeline_sync');
             DBD::Pg::db->install_method('pg_putline');
             DBD::Pg::db->install_method('pg_ready');
+            DBD::Pg::db->install_method('pg_register_types');
             DBD::Pg::db->install_method('pg_release');
             DBD::Pg::db->install_method('pg_result'); ## NOT duplicated below!
             DBD::Pg::db->install_method('pg_rollback_to');
@@ -180,6 +191,7 @@ use 5.008001;
             DBD::Pg::st->install_method('pg_ready');
             DBD::Pg::st->install_method('pg_canonical_ids');
             DBD::Pg::st->install_method('pg_canonical_names');
+            DBD::Pg::st->install_method('pg_fetch_columns');
 
             DBD::Pg::db->install_method('pg_lo_creat');
             DBD::Pg::db->install_method('pg_lo_open');
@@ -301,6 +313,14 @@ use 5.008001;
 
         return undef if ! defined $statement;
 
+        ## Arrange for last_insert_id to be answered by the INSERT itself
+        if (ref $attribs[0] eq 'HASH' and exists $attribs[0]{pg_returning_id}) {
+            my %attr = %{ $attribs[0] };
+            ($statement, $attr{pg_returning_id}) = _returning_id($dbh, $statement, $attr{pg_returning_id})
+                or return undef;
+            $attribs[0] = \%attr;
+        }
+
         # Create a 'blank' statement handle:
         my $sth = DBI::_new_sth($dbh, {
             'Statement' => $statement,
@@ -316,7 +336,7 @@ use 5.008001;
         my ($dbh, undef, $schema, $table, undef, $attr) = @_;
 
         ## Our ultimate goal is to get a sequence
-        my ($sth, $count, $SQL, $sequence);
+        my ($sth, $count, $sequence);
 
         ## Cache all of our table lookups? Default is yes
         my $cache = 1;
@@ -324,7 +344,6 @@ use 5.008001;
         ## Catalog and col (arguments 2 and 5) are not used
         $schema = '' if ! defined $schema;
         $table = '' if ! defined $table;
-        my $cachename = join("\0", 'lii', $schema, $table);
 
         if (defined $attr and length $attr) {
             ## If not a hash, assume it is a sequence name
@@ -344,106 +363,16 @@ use 5.008001;
             }
         }
 
-        if (! defined $sequence and exists $dbh->{private_dbdpg}{$cachename} and $cache) {
-            $sequence = $dbh->{private_dbdpg}{$cachename};
-        }
-        elsif (! defined $sequence) {
-            ## At this point, we must have a valid table name
-            if (! length $table) {
-                $dbh->set_err(1, 'last_insert_id needs at least a sequence or table name');
-                return undef;
-            }
-            my @args = ($table);
-            my $schemawhere;
-            if (length $schema) {
-                # if given a schema, use that
-                $schemawhere = 'n.nspname = ?';
-                push @args, $schema;
-            } else {
-                # otherwise it must be visible via the search path
-                $schemawhere = 'pg_catalog.pg_table_is_visible(c.oid)';
-            }
-            ## Is there a sequence associated with the table via a unique, indexed column,
-            ## either via ownership (e.g. serial, identity) or a manual default?
-            my $idcond = $dbh->{private_dbdpg}{version} >= 100000
-                ? q{a.attidentity <> ''} : q{false};
-            $SQL = sprintf(q{
-                SELECT i.indisprimary,
-                    COALESCE(
-                        -- this takes the table name as text, not regclass
-                        pg_catalog.pg_get_serial_sequence(
-                            -- and pre-8.3 doesn't have a cast from regclass to text,
-                            -- and pre-9.3 doesn't have format, so do it the long way
-                            quote_ident(n.nspname) || '.' || quote_ident(c.relname),
-                            a.attname),
-                        (SELECT replace(substring(pg_catalog.pg_get_expr(d.adbin, d.adrelid)
-                                            from $r$^nextval\('(.+)'::[\w\s]+\)$$r$),
-                                        -- unescape any single quotes from the default
-                                        $$''$$, $$'$$)
-                            FROM pg_catalog.pg_attrdef d
-                            WHERE a.atthasdef
-                                AND a.attrelid = d.adrelid
-                                AND a.attnum = d.adnum)
-                    ) AS seqname
-                FROM pg_class c
-                    JOIN pg_catalog.pg_namespace n ON (n.oid = c.relnamespace)
-                    -- LEFT JOIN so we can distinguish between table not found (zero rows)
-                    -- and no suitable column found (at least one all-NULL row)
-                    LEFT JOIN pg_catalog.pg_index i
-                        ON c.oid = i.indrelid AND i.indisunique
-                    LEFT JOIN pg_catalog.pg_attribute a
-                        ON i.indrelid = a.attrelid AND i.indkey[0]=a.attnum
-                        AND (a.atthasdef OR %s)
-                WHERE c.relname = ? AND %s
-            }, $idcond, $schemawhere);
-            $sth = $dbh->prepare_cached($SQL);
-            $count = $sth->execute(@args);
-            if (!defined $count or $count eq '0E0') {
-                $sth->finish();
-                my $message = qq{Could not find the table "$table"};
-                length $schema and $message .= qq{ in the schema "$schema"};
-                $dbh->set_err(1, $message);
-                return undef;
-            }
-            my $info = $sth->fetchall_arrayref();
-            ## We have at least one with a default value. See if we found any sequences
-            my @def = grep { defined $_->[1] } @$info;
-            if (!@def) {
-                ## This may be an inherited table, in which case we can use the parent's info
-                $SQL = 'SELECT inhparent::regclass FROM pg_inherits WHERE inhrelid = ?::regclass::oid';
-                my $isth = $dbh->prepare($SQL);
-                $count = $isth->execute($table);
-                if (!defined $count or $count eq '0E0') {
-                    $isth->finish();
-                    $dbh->set_err(1, qq{No suitable column found for last_insert_id of table "$table"\n});
-                    return undef;
-                }
-                my $parent = $isth->fetch->[0];
-                $args[0] = $parent;
-                $count = $sth->execute(@args);
-                if (1 == $count) {
-                    $info = $sth->fetchall_arrayref();
-                    @def = grep { defined $_->[1] } @$info;
-                }
-                if (!@def) {
-                    $sth->finish();
-                    $dbh->set_err(1, qq{No suitable column found for last_insert_id of table "$table"\n});
-                    return undef;
-                }
-                ## Fall through with inherited information
-            }
-            ## Tiebreaker goes to the primary keys
-            if (@def > 1) {
-                my @pri = grep { $_->[0] } @def;
-                if (1 != @pri) {
-                    $dbh->set_err(1, qq{No suitable column found for last_insert_id of table "$table"\n});
-                    return undef;
+        if (! defined $sequence) {
+            ## An INSERT prepared with pg_returning_id may have told us already
+            my $returning = DBD::Pg::db::_pg_returning_id($dbh);
+            if ($returning) {
+                my ($rschema, $rtable) = _insert_target($returning->[0]);
+                if (! length $table or ($rtable eq $table and (! length $schema or $rschema eq $schema))) {
+                    return $returning->[1];
                 }
-                @def = @pri;
             }
-            $sequence = $def[0]->[1];
-            ## Cache this information for subsequent calls
-            $dbh->{private_dbdpg}{$cachename} = $sequence;
+            ($sequence) = _lii_lookup($dbh, $schema, $table, $cache) or return undef;
         }
 
         $sth = $dbh->prepare_cached('SELECT pg_catalog.currval(?)');
@@ -453,6 +382,155 @@ use 5.008001;
 
     } ## end of last_insert_id
 
+    ## Find the sequence that last_insert_id reports on for a table, and the column using it
+    sub _lii_lookup {
+
+        my ($dbh, $schema, $table, $cache) = @_;
+
+        my ($sth, $count, $SQL);
+
+        my $cachename = join("\0", 'lii', $schema, $table);
+        if (exists $dbh->{private_dbdpg}{$cachename} and $cache) {
+            return @{ $dbh->{private_dbdpg}{$cachename} };
+        }
+
+        ## At this point, we must have a valid table name
+        if (! length $table) {
+            $dbh->set_err(1, 'last_insert_id needs at least a sequence or table name');
+            return;
+        }
+        my @args = ($table);
+        my $schemawhere;
+        if (length $schema) {
+            # if given a schema, use that
+            $schemawhere = 'n.nspname = ?';
+            push @args, $schema;
+        } else {
+            # otherwise it must be visible via the search path
+            $schemawhere = 'pg_catalog.pg_table_is_visible(c.oid)';
+        }
+        ## Is there a sequence associated with the table via a unique, indexed column,
+        ## either via ownership (e.g. serial, identity) or a manual default?
+        my $idcond = $dbh->{private_dbdpg}{version} >= 100000
+            ? q{a.attidentity <> ''} : q{false};
+        $SQL = sprintf(q{
+            SELECT i.indisprimary,
+                COALESCE(
+                    -- this takes the table name as text, not regclass
+                    pg_catalog.pg_get_serial_sequence(
+                        -- and pre-8.3 doesn't have a cast from regclass to text,
+                        -- and pre-9.3 doesn't have format, so do it the long way
+                        quote_ident(n.nspname) || '.' || quote_ident(c.relname),
+                        a.attname),
+                    (SELECT replace(substring(pg_catalog.pg_get_expr(d.adbin, d.adrelid)
+                                        from $r$^nextval\('(.+)'::[\w\s]+\)$$r$),
+                                    -- unescape any single quotes from the default
+                                    $$''$$, $$'$$)
+                        FROM pg_catalog.pg_attrdef d
+                        WHERE a.atthasdef
+                            AND a.attrelid = d.adrelid
+                            AND a.attnum = d.adnum)
+                ) AS seqname,
+                a.attname
+            FROM pg_class c
+                JOIN pg_catalog.pg_namespace n ON (n.oid = c.relnamespace)
+                -- LEFT JOIN so we can distinguish between table not found (zero rows)
+                -- and no suitable column found (at least one all-NULL row)
+                LEFT JOIN pg_catalog.pg_index i
+                    ON c.oid = i.indrelid AND i.indisunique
+                LEFT JOIN pg_catalog.pg_attribute a
+                    ON i.indrelid = a.attrelid AND i.indkey[0]=a.attnum
+                    AND (a.atthasdef OR %s)
+            WHERE c.relname = ? AND %s
+        }, $idcond, $schemawhere);
+        $sth = $dbh->prepare_cached($SQL);
+        $count = $sth->execute(@args);
+        if (!defined $count or $count eq '0E0') {
+            $sth->finish();
+            my $message = qq{Could not find the table "$table"};
+            length $schema and $message .= qq{ in the schema "$schema"};
+            $dbh->set_err(1, $message);
+            return;
+        }
+        my $info = $sth->fetchall_arrayref();
+        ## We have at least one with a default value. See if we found any sequences
+        my @def = grep { defined $_->[1] } @$info;
+        if (!@def) {
+            ## This may be an inherited table, in which case we can use the parent's info
+            $SQL = 'SELECT inhparent::regclass FROM pg_inherits WHERE inhrelid = ?::regclass::oid';
+            my $isth = $dbh->prepare($SQL);
+            $count = $isth->execute($table);
+            if (!defined $count or $count eq '0E0') {
+                $isth->finish();
+                $dbh->set_err(1, qq{No suitable column found for last_insert_id of table "$table"\n});
+                return;
+            }
+            my $parent = $isth->fetch->[0];
+            $args[0] = $parent;
+            $count = $sth->execute(@args);
+            if (1 == $count) {
+                $info = $sth->fetchall_arrayref();
+                @def = grep { defined $_->[1] } @$info;
+            }
+            if (!@def) {
+                $sth->finish();
+                $dbh->set_err(1, qq{No suitable column found for last_insert_id of table "$table"\n});
+                return;
+            }
+            ## Fall through with inherited information
+        }
+        ## Tiebreaker goes to the primary keys
+        if (@def > 1) {
+            my @pri = grep { $_->[0] } @def;
+            if (1 != @pri) {
+                $dbh->set_err(1, qq{No suitable column found for last_insert_id of table "$table"\n});
+                return;
+            }
+            @def = @pri;
+        }
+        my @found = @{ $def[0] }[1,2];
+        ## Cache this information for subsequent calls
+        $dbh->{private_dbdpg}{$cachename} = \@found;
+        return @found;
+
+    } ## end of _lii_lookup
+
+    ## Return the schema (empty if not given) and table that an INSERT statement writes to
+    sub _insert_target {
+        my $statement = shift;
+        my $ident = q{(?:"(?:[^"]|"")+"|[^\s"().,;]+)};
+        $statement =~ /^\s*INSERT\s+INTO\s+($ident)(?:\s*\.\s*($ident))?/i or return;
+        my @name = grep { defined } ($1, $2);
+        @name = map { /^"(.*)"\z/s ? do { (my $n = $1) =~ s/""/"/g; $n } : lc } @name;
+        return @name > 1 ? @name : ('', $name[0]);
+    }
+
+    ## Work out how an INSERT prepared with pg_returning_id reports its new key: from its
+    ## own RETURNING clause (1), or from one we add for the key column of its table (2)
+    sub _returning_id {
+        my ($dbh, $statement, $wanted) = @_;
+
+        return ($statement, 0) if ! $wanted;
+        my ($schema, $table) = _insert_target($statement) or return ($statement, 0);
+
+        ## Blank out comments, strings, and quoted identifiers, so that only
+        ## a real RETURNING counts, and we know where the statement really ends
+        (my $code = $statement) =~ s{
+            ( --[^\n]*
+            | /\*.*?\*/
+            | [Ee]'(?:[^'\\]|\\.|'')*'
+            | '(?:[^']|'')*'
+            | "(?:[^"]|"")*"
+            | \$((?:[A-Za-z_]\w*)?)\$.*?\$\2\$
+            )
+        }{' ' x length $1}gsex;
+        return ($statement, 1) if $code =~ /\bRETURNING\b/i;
+
+        my (undef, $column) = _lii_lookup($dbh, $schema, $table, 1) or return;
+        $code =~ /[\s;]*\z/;
+        return (substr($statement, 0, $-[0]) . ' RETURNING ' . $dbh->quote_identifier($column), 2);
+    }
+
     sub ping {
         my $dbh = shift;
         local $SIG{__WARN__} = sub {} if $dbh->FETCH('PrintError');
@@ -466,12 +544,39 @@ use 5.008001;
         return DBD::Pg::db::_ping($dbh);
     }
 
+    sub pg_clear_metadata_cache {
+        my $dbh = shift;
+        delete $dbh->{private_dbdpg}{metadata_cache};
+        DBD::Pg::db::_pg_clear_column_cache($dbh);
+        return;
+    }
+
+    sub pg_pipeline_submit {
+        my ($dbh, $jobs) = @_;
+
+        ## Each job is a statement handle followed by its bind values
+        $dbh->pg_enter_pipeline() or return undef;
+        for my $job (@$jobs) {
+            my ($sth, @bind) = @$job;
+            $sth->execute(@bind) or return undef;
+        }
+        return $dbh->pg_pipeline_flush();
+    }
+
     sub pg_type_info {
         my($dbh,$pg_type) = @_;
         return DBD::Pg::db::_pg_type_info($pg_type);
     }
 
     sub column_info {
+        my ($dbh, undef, $schema, $table) = @_;
+        if ($dbh->{pg_metadata_cache} and defined $table and length $table) {
+            return _metadata_cached($dbh, 'column_info', [[$schema, $table, 1]], \&_column_info, @_);
+        }
+        return _column_info(@_);
+    }
+
+    sub _column_info {
 
         # Columns expected in statement handle returned (Per DBI, must be in order):
         # TABLE_CAT, TABLE_SCHEM, TABLE_NAME, COLUMN_NAME, DATA_TYPE, TYPE_NAME,
@@ -646,7 +751,139 @@ EOSQL
         return $sth;
     }
 
+    ## Return the result of a catalog method from the pg_metadata_cache, as long as
+    ## nothing about the relations it depends on has changed. Otherwise, call the
+    ## method and remember what it returned.
+    sub _metadata_cached {
+        my ($dbh, $method, $tables, $build, @args) = @_;
+
+        ## Schema changes made by this handle do not always give the catalog
+        ## rows a new xmin (not within a single transaction), so also forget
+        ## everything whenever we have run a command that may change the schema
+        my $generation = DBD::Pg::db::_pg_metadata_generation($dbh);
+        my $seen = $dbh->{private_dbdpg}{metadata_generation};
+        if (! defined $seen or $seen != $generation) {
+            delete $dbh->{private_dbdpg}{metadata_cache};
+            $dbh->{private_dbdpg}{metadata_generation} = $generation;
+        }
+
+        my $fingerprint = _metadata_fingerprint($dbh, $tables, 'foreign_key_info' eq $method);
+        return $build->(@args) if ! defined $fingerprint;
+
+        my @key = ($method, $dbh->{FetchHashKeyName});
+        for my $arg (@args[1..$#args]) {
+            if (ref $arg eq 'HASH') {
+                push @key, join ',' => map { "$_=" . (defined $arg->{$_} ? $arg->{$_} : '') } sort keys %$arg;
+            }
+            else {
+                push @key, defined $arg ? "=$arg" : '';
+            }
+        }
+        my $key = join "\0" => @key;
+
+        my $cache = $dbh->{private_dbdpg}{metadata_cache} ||= {};
+        my $entry = $cache->{$key};
+        if (! $entry or $entry->{fingerprint} ne $fingerprint) {
+            my $sth = $build->(@args) or return undef;
+            $entry = {
+                fingerprint => $fingerprint,
+                names       => [ @{ $sth->{NAME} } ],
+                rows        => $sth->fetchall_arrayref(),
+            };
+
+            ## Make room by forgetting the least recently used results
+            delete $cache->{$key};
+            while (keys %$cache and keys %$cache >= $dbh->{pg_metadata_cache}) {
+                my $oldest;
+                for my $name (keys %$cache) {
+                    $oldest = $name if ! defined $oldest or $cache->{$name}{used} < $cache->{$oldest}{used};
+                }
+                delete $cache->{$oldest};
+            }
+            $cache->{$key} = $entry;
+        }
+        $entry->{used} = ++$dbh->{private_dbdpg}{metadata_clock};
+
+        ## DBD::Sponge consumes the rows it is given, so hand it a copy
+        return _prepare_from_data($method, [ map { [ @$_ ] } @{ $entry->{rows} } ], $entry->{names});
+    }
+
+    ## Describe, in a single query, everything a catalog method reads about the
+    ## named relations (or, for foreign keys, the relations linked to them)
+    sub _metadata_fingerprint {
+        my ($dbh, $tables, $linked) = @_;
+
+        my (@where, @args);
+        for my $t (@$tables) {
+            my ($schema, $table, $like) = @$t;
+            next if ! defined $table or ! length $table;
+            my $where = 'r.relname ' . (($like and $table =~ /[_%]/) ? 'LIKE ?' : '= ?');
+            push @args, $table;
+            if (defined $schema and length $schema) {
+                $where .= ' AND rn.nspname ' . (($like and $schema =~ /[_%]/) ? 'LIKE ?' : '= ?');
+                push @args, $schema;
+            }
+            push @where, "($where)";
+        }
+        my $where = join ' OR ' => @where;
+
+        my $relations = qq{SELECT r.oid FROM pg_catalog.pg_class r
+JOIN pg_catalog.pg_namespace rn ON (rn.oid = r.relnamespace)
+WHERE $where};
+        if ($linked) {
+            $relations .= qq{
+UNION SELECT o.conrelid FROM pg_catalog.pg_constraint o
+JOIN pg_catalog.pg_class r ON (r.oid = o.confrelid)
+JOIN pg_catalog.pg_namespace rn ON (rn.oid = r.relnamespace)
+WHERE o.contype = 'f' AND ($where)
+UNION SELECT o.confrelid FROM pg_catalog.pg_constraint o
+JOIN pg_catalog.pg_class r ON (r.oid = o.conrelid)
+JOIN pg_catalog.pg_namespace rn ON (rn.oid = r.relnamespace)
+WHERE o.contype = 'f' AND ($where)};
+            @args = (@args, @args, @args);
+        }
+
+        ## Enum values are shown by column_info
+        my $enums = $dbh->{pg_server_version} >= 80300
+            ? q{(SELECT pg_catalog.sum(e.xmin::text::bigint) || '/' || pg_catalog.count(*) FROM pg_catalog.pg_enum e
+     WHERE e.enumtypid IN (SELECT a.atttypid FROM pg_catalog.pg_attribute a WHERE a.attrelid = c.oid))}
+            : 'NULL';
+
+        ## Any change to a catalog row made by another transaction gives it a
+        ## new xmin, so the sums of xmin change whenever a column, default,
+        ## constraint, index, comment, or column type does
+        my $SQL = <<"EOSQL";
+SELECT c.oid, c.xmin, c.relfilenode, c.relpages, c.reltuples,
+  n.nspname, n.xmin, pg_catalog.pg_table_is_visible(c.oid),
+  (SELECT pg_catalog.sum(a.xmin::text::bigint) FROM pg_catalog.pg_attribute a WHERE a.attrelid = c.oid),
+  (SELECT pg_catalog.sum(d.xmin::text::bigint) FROM pg_catalog.pg_attrdef d WHERE d.adrelid = c.oid),
+  (SELECT pg_catalog.sum(o.xmin::text::bigint) FROM pg_catalog.pg_constraint o WHERE o.conrelid = c.oid OR o.confrelid = c.oid),
+  (SELECT pg_catalog.sum(i.xmin::text::bigint + x.xmin::text::bigint) || '/' || pg_catalog.sum(x.relpages) || '/' || pg_catalog.sum(x.reltuples)
+     FROM pg_catalog.pg_index i JOIN pg_catalog.pg_class x ON (x.oid = i.indexrelid) WHERE i.indrelid = c.oid),
+  (SELECT pg_catalog.sum(ds.xmin::text::bigint) || '/' || pg_catalog.count(*) FROM pg_catalog.pg_description ds
+     WHERE ds.objoid = c.oid AND ds.classoid = 'pg_catalog.pg_class'::pg_catalog.regclass),
+  (SELECT pg_catalog.sum(t.xmin::text::bigint) FROM pg_catalog.pg_type t
+     WHERE t.oid IN (SELECT a.atttypid FROM pg_catalog.pg_attribute a WHERE a.attrelid = c.oid)),
+  $enums
+FROM pg_catalog.pg_class c
+JOIN pg_catalog.pg_namespace n ON (n.oid = c.relnamespace)
+WHERE c.oid IN ($relations)
+ORDER BY c.oid
+EOSQL
+
+        my $rows = $dbh->selectall_arrayref($SQL, undef, @args) or return undef;
+        return join "\n" => map { join ':' => map { defined $_ ? $_ : '' } @$_ } @$rows;
+    }
+
     sub statistics_info {
+        my ($dbh, undef, $schema, $table) = @_;
+        if ($dbh->{pg_metadata_cache} and defined $table and length $table) {
+            return _metadata_cached($dbh, 'statistics_info', [[$schema, $table]], \&_statistics_info, @_);
+        }
+        return _statistics_info(@_);
+    }
+
+    sub _statistics_info {
 
         ## Gather statistics about a table and its columns
         ## See https://metacpan.org/pod/DBI#statistics_info
@@ -780,6 +1017,14 @@ EOSQL
     }
 
     sub primary_key_info {
+        my ($dbh, undef, $schema, $table) = @_;
+        if ($dbh->{pg_metadata_cache} and defined $table and length $table) {
+            return _metadata_cached($dbh, 'primary_key_info', [[$schema, $table]], \&_primary_key_info, @_);
+        }
+        return _primary_key_info(@_);
+    }
+
+    sub _primary_key_info {
 
         ## Return a statement handle with info on the columns of a primary key
         ## See https://metacpan.org/pod/DBI#primary_key_info
@@ -904,7 +1149,7 @@ EOSQL
 
         return _prepare_from_data('primary_key_info', $pkinfo, \@cols);
 
-    } ## end of primary_key_info
+    } ## end of _primary_key_info
 
     sub primary_key {
 
@@ -918,6 +1163,14 @@ EOSQL
     }
 
     sub foreign_key_info {
+        my ($dbh, undef, $pschema, $ptable, undef, $fschema, $ftable) = @_;
+        if ($dbh->{pg_metadata_cache} and ((defined $ptable and length $ptable) or (defined $ftable and length $ftable))) {
+            return _metadata_cached($dbh, 'foreign_key_info', [[$pschema, $ptable], [$fschema, $ftable]], \&_foreign_key_info, @_);
+        }
+        return _foreign_key_info(@_);
+    }
+
+    sub _foreign_key_info {
 
         my $dbh = shift;
 
@@ -1057,10 +1310,18 @@ EOSQL
 
         return _prepare_from_data('foreign_key_info', $fkinfo, \@cols);
 
-    } ## end of foreign_key_info
+    } ## end of _foreign_key_info
 
 
     sub table_info {
+        my ($dbh, undef, $schema, $table) = @_;
+        if ($dbh->{pg_metadata_cache} and defined $table and length $table) {
+            return _metadata_cached($dbh, 'table_info', [[$schema, $table, 1]], \&_table_info, @_);
+        }
+        return _table_info(@_);
+    }
+
+    sub _table_info {
 
         my $dbh = shift;
         my ($catalog, $schema, $table, $type) = @_;
@@ -1594,8 +1855,11 @@ EOSQL
     sub private_attribute_info {
         return {
                 pg_async_status                => undef,
+                pg_binary_results              => undef,
                 pg_bool_tf                     => undef,
+                pg_copy_buffer                 => undef,
                 pg_int8_as_string              => undef,
+                pg_metadata_cache              => undef,
                 pg_db                          => undef,
                 pg_default_port                => undef,
                 pg_enable_utf8                 => undef,
@@ -1609,6 +1873,7 @@ EOSQL
                 pg_options                     => undef,
                 pg_pass                        => undef,
                 pg_pid                         => undef,
+                pg_pipeline_status             => undef,
                 pg_placeholder_dollaronly      => undef,
                 pg_placeholder_nocolons        => undef,
                 pg_placeholder_escaped         => undef,
@@ -1620,8 +1885,10 @@ EOSQL
                 pg_skip_deallocate             => undef,
                 pg_socket                      => undef,
                 pg_standard_conforming_strings => undef,
+                pg_statement_cache             => undef,
                 pg_switch_prepared             => undef,
                 pg_user                        => undef,
+                pg_zero_copy                   => undef,
         };
     }
 }
@@ -1662,9 +1929,122 @@ EOSQL
 
     } ## end bind_param_array
 
+    sub execute_for_fetch {
+
+        ## Executes the statement once for every tuple returned by $fetch_tuple_sub
+        ## When possible, the tuples are sent in batches using pipeline mode,
+        ## so that we do not need to wait for the server after every one
+
+        my ($sth, $fetch_tuple_sub, $tuple_status) = @_;
+
+        my $dbh = $sth->{Database};
+
+        ## Fall back to the DBI version if pipeline mode cannot be used here
+        if ($dbh->{pg_lib_version} < 140000
+            or $dbh->{pg_pipeline_status}
+            or $dbh->{pg_async_status}
+            or $sth->{pg_async}
+            or $sth->{pg_direct}
+            or ! $sth->{pg_server_prepare}
+            or ! $sth->{NUM_OF_PARAMS}) {
+            return $sth->SUPER::execute_for_fetch($fetch_tuple_sub, $tuple_status);
+        }
+
+        ## Start with an empty status array
+        if ($tuple_status) {
+            @$tuple_status = ();
+        }
+        else {
+            $tuple_status = [];
+        }
+
+        ## Prepare the statement once up front, so that the server does not have
+        ## to parse and plan it again for every tuple sent through the pipeline
+        if (DBD::Pg::st::_pg_server_prepare($sth) < 0) {
+            return $sth->set_err($sth->err, $sth->errstr, $sth->state);
+        }
+
+        my $autocommit = $dbh->{AutoCommit};
+        my $batch_size = 1000;
+        my ($rows, $errors, $finished) = (0, 0, 0);
+        my $pipeline_error;
+
+        {
+            ## Errors are gathered into the status array rather than raised one at a time
+            local $dbh->{RaiseError} = 0;
+            local $dbh->{PrintError} = 0;
+            local $sth->{RaiseError} = 0;
+            local $sth->{PrintError} = 0;
+
+            while (! $finished) {
+
+                ## Queue up the next batch of tuples
+                if (! $dbh->pg_enter_pipeline()) {
+                    $pipeline_error = [$dbh->err, $dbh->errstr, $dbh->state];
+                    last;
+                }
+                my (@batch, @status, $failed);
+                while (@batch < $batch_size) {
+                    my $tuple = $fetch_tuple_sub->();
+                    if (! $tuple) {
+                        $finished = 1;
+                        last;
+                    }
+                    push @batch => [@$tuple];
+                    if (! $sth->execute(@$tuple)) {
+                        $failed = [$sth->err, $sth->errstr, $sth->state];
+                        last;
+                    }
+                }
+
+                ## Gather the results, then leave pipeline mode so we can recover from errors
+                my $ok = defined $dbh->pg_pipeline_sync(\@status);
+                $dbh->pg_exit_pipeline();
+
+                ## If a tuple could not even be queued, record its error and carry on with the next batch
+                if ($failed) {
+                    $ok = 0;
+                    push @status => $failed;
+                }
+
+                ## With AutoCommit on, a failure rolls back the whole batch, so run it again
+                ## one tuple at a time to find out which ones can succeed by themselves
+                if (! $ok and $autocommit) {
+                    @status = ();
+                    for my $tuple (@batch) {
+                        my $rv = $sth->execute(@$tuple);
+                        push @status => $rv ? $rv : [$sth->err, $sth->errstr, $sth->state];
+                    }
+                }
+
+                for my $rv (@status) {
+                    if (ref $rv) {
+                        $errors++;
+                    }
+                    elsif ($rows >= 0) {
+                        $rows = $rv >= 0 ? $rows + $rv : -1;
+                    }
+                }
+                push @$tuple_status => @status;
+            }
+        }
+
+        ## Now that RaiseError is back to what the caller wanted, report any failure
+        return $sth->set_err(@$pipeline_error) if $pipeline_error;
+
+        my $tuples = @$tuple_status;
+        return $sth->set_err($DBI::stderr, "executing $tuples generated $errors errors")
+            if $errors;
+
+        $tuples ||= '0E0';
+        return wantarray ? ($tuples, $rows) : $tuples;
+
+    } ## end execute_for_fetch
+
      sub private_attribute_info {
         return {
                 pg_async                  => undef,
+                pg_binary_results         => undef,
                 pg_bound                  => undef,
                 pg_current_row            => undef,
                 pg_direct                 => undef,
@@ -1678,6 +2058,7 @@ EOSQL
                 pg_segments               => undef,
                 pg_server_prepare         => undef,
                 pg_size                   => undef,
+                pg_stream_rows            => undef,
                 pg_switch_prepared        => undef,
                 pg_type                   => undef,
         };
@@ -1685,6 +2066,90 @@ EOSQL
 
 } ## end st section
 
+
+{
+    package DBD::Pg::Multi;
+
+    use strict;
+
+    sub new {
+        my ($class, @dbhs) = @_;
+        @dbhs = @{ $dbhs[0] } if 1 == @dbhs and 'ARRAY' eq ref $dbhs[0];
+        for my $dbh (@dbhs) {
+            die 'DBD::Pg::Multi->new needs DBD::Pg database handles'
+                if ! UNIVERSAL::isa($dbh, 'DBI::db') or 'Pg' ne $dbh->{Driver}{Name};
+        }
+        return bless { dbhs => \@dbhs, sths => [], done => [] }, $class;
+    }
+
+    sub execute {
+        my ($self, $statement, @bind) = @_;
+
+        ## Send the query to every database without waiting for any of them
+        my $sent = 0;
+        $self->{sths} = [];
+        for my $index (0..$#{ $self->{dbhs} }) {
+            my $dbh = $self->{dbhs}[$index];
+            local $dbh->{RaiseError} = 0;
+            local $dbh->{PrintError} = 0;
+            my $sth = $dbh->prepare($statement, {pg_async => DBD::Pg::PG_ASYNC()});
+            if ($sth and $sth->execute(@bind)) {
+                $self->{sths}[$index] = $sth;
+                $sent++;
+            }
+            else {
+                push @{ $self->{done} }, _error($index, $dbh, $sth);
+            }
+        }
+        return $sent;
+    }
+
+    sub results {
+        my ($self, $timeout) = @_;
+
+        ## Queries that could not be sent are reported right away
+        my @done = @{ $self->{done} };
+        $self->{done} = [];
+
+        my @running = grep { defined $self->{sths}[$_] } 0..$#{ $self->{sths} };
+        return @done if ! @running;
+
+        my $ready = DBD::Pg::db::_pg_multi_ready([ @{ $self->{dbhs} }[@running] ], @done ? 0 : $timeout);
+        for my $index (@running[@$ready]) {
+            my $dbh = $self->{dbhs}[$index];
+            my $sth = $self->{sths}[$index];
+            $self->{sths}[$index] = undef;
+            local $dbh->{RaiseError} = 0;
+            local $dbh->{PrintError} = 0;
+            my $rows = $sth->pg_result();
+            push @done, defined $rows
+                ? { index => $index, dbh => $dbh, sth => $sth, rows => $rows }
+                : _error($index, $dbh, $sth);
+        }
+        return @done;
+    }
+
+    sub pending {
+        my $self = shift;
+        return @{ $self->{done} } + grep { defined } @{ $self->{sths} };
+    }
+
+    sub all {
+        my $self = shift;
+        my @all;
+        push @all, $self->results() while $self->pending();
+        return sort { $a->{index} <=> $b->{index} } @all;
+    }
+
+    sub _error {
+        my ($index, $dbh, $sth) = @_;
+        my $h = $sth || $dbh;
+        return { index => $index, dbh => $dbh, sth => $sth,
+                 err => $h->err, errstr => $h->errstr, state => $h->state };
+    }
+
+} ## end multi section
+
 1;
 
 __END__
@@ -2526,6 +2991,16 @@ You can force DBD::Pg to send your query directly to the server by adding
 the L<pg_direct|/pg_direct (boolean)> attribute to your prepare call. This is not recommended,
 but is added just in case you need it.
 
+Normally, all the rows of a query are read into memory when L</execute> is called.
+For very large result sets, you can instead have the rows sent over in batches as you
+fetch them, by passing the L<pg_stream_rows|/pg_stream_rows (integer)> attribute:
+
+  $sth = $dbh->prepare('SELECT * FROM huge_table', {pg_stream_rows => 1000});
+  $sth->execute();
+  while (my $row = $sth->fetchrow_arrayref()) {
+    ...
+  }
+
 =head4 B<Placeholders>
 
 There are three types of placeholders that can be used in DBD::Pg. The first is
@@ -2716,6 +3191,26 @@ Alternatively, using C<RETURNING>:
     print "Last insert id was $newid\n";
   }
 
+Each call above costs a second round trip to the server. To avoid it, prepare the
+C<INSERT> with the C<pg_returning_id> attribute. If the statement has no C<RETURNING>
+clause, DBD::Pg adds one for the key column that last_insert_id would have used, and
+remembers the value it returns (from the last row, if several were inserted). If the
+statement already has a C<RETURNING> clause, the value of its first column is remembered
+instead, and the rows can still be fetched as usual. The next call to last_insert_id for
+that table, or with no table at all, then answers without asking the server:
+
+  $sth = $dbh->prepare('INSERT INTO lii2(baz) VALUES (?)', {pg_returning_id => 1});
+  for (qw(uno dos tres cuatro)) {
+    $sth->execute($_);
+    my $newid = $dbh->last_insert_id(undef,undef,"lii2",undef);
+    print "Last insert id was $newid\n";
+  }
+
+The remembered value is forgotten as soon as any other statement is run on the database
+handle, after which last_insert_id asks the server as before. Nothing is remembered for
+statements run with L</pg_async>, L</pg_stream_rows>, L</pg_binary_results>, or in
+L</Pipeline Mode>.
+
 =head3 B<commit>
 
   $rv = $dbh->commit;
@@ -2781,7 +3276,9 @@ suitable for passing into Postgres array columns.
 If the value contains backslashes, and the server is version 8.1 or higher,
 then the escaped string syntax will be used (which places a capital E before
 the first single quote). This syntax is always used when quoting bytea values
-on servers 8.1 and higher.
+on servers 8.1 and higher. On servers 9.0 and higher, bytea values are written in
+hex format (C<E'\\x...'>) whenever that is shorter than escaping each byte, which
+is the case for most binary data.
 
 The C<data_type> argument is optional and should be one of the type constants
 exported by DBD::Pg (such as PG_BYTEA). In addition to string, bytea, char, bool,
@@ -2844,6 +3341,60 @@ new notices will not be picked up while in the middle of a transaction. An examp
 Payloads will always be an empty string unless you are connecting to a Postgres
 server version 9.0 or higher.
 
+=head3 B<pg_notifies_all>
+
+  $ret = $dbh->pg_notifies_all($max, \%options);
+
+Like L</pg_notifies>, but returns every notification received so far in a single call,
+which is much faster when they arrive in large bursts. Returns a reference to an array
+holding one three-element array (name, PID, payload) per notification, in the order
+they were received, or C<undef> if the connection could not be read. The array is empty
+if there is nothing pending. If C<$max> is given and positive, at most that many
+notifications are returned; the rest are left for the next call.
+
+The optional hashref accepts two keys. When C<group> is true, a reference to a hash is
+returned instead, with one key per notification name, each holding an array of
+two-element arrays (PID and payload). When C<unique> is true, a notification with the
+same name and payload as one earlier in the same batch is dropped.
+
+  $dbh->do('LISTEN jobs');
+  $dbh->commit();
+  while (1) {
+      my $batch = $dbh->pg_notifies_all(10_000, { group => 1, unique => 1 });
+      for my $job (@{ $batch->{jobs} || [] }) {
+          my ($pid, $payload) = @$job;
+          ...
+      }
+      sleep(1);
+  }
+
+=head3 B<pg_wait_for_notify>
+
+  $ret = $dbh->pg_wait_for_notify($timeout, $max);
+
+Waits for notifications to arrive and returns them, so that a listener does not need
+its own C<select> loop around L</getfd> and L</pg_notifies>. If notifications are
+already pending they are returned at once; otherwise this sleeps on the connection's
+socket until something arrives or C<$timeout> seconds (which may be fractional) have
+passed. A timeout of C<0> only checks, and an undefined or negative timeout waits
+forever. The return value is the same as for L</pg_notifies_all>: a reference to an
+array of three-element arrays, which is empty if the time ran out, or C<undef> if the
+connection to the server was lost. If C<$max> is given and positive, at most that
+many notifications are returned.
+
+  $dbh->do('LISTEN jobs');
+  $dbh->commit();
+  while (1) {
+      my $batch = $dbh->pg_wait_for_notify(30) or die 'Lost the connection';
+      for my $notify (@$batch) {
+          my ($name, $pid, $payload) = @$notify;
+          ...
+      }
+  }
+
+Perl signal handlers are run while waiting, so an C<alarm> or a C<SIGINT> handler can
+still interrupt it.
+
 =head3 B<ping>
 
   $rv = $dbh->ping;
@@ -3202,6 +3753,34 @@ according to the following table:
 Returns a list of hash references holding information about one or more variants of $data_type.
 See the DBI documentation for more details.
 
+=head3 B<pg_register_types>
+
+  $count = $dbh->pg_register_types;
+
+Looks up the user-defined and extension types (such as enums, or the types added by
+C<CREATE EXTENSION hstore>) in the current database, and adds them to the types DBD::Pg
+knows about for this connection. Once registered, such a type can be given as the
+C<pg_type> of a placeholder, the L</pg_type> statement handle attribute reports its name,
+and arrays of it are returned as Perl arrays rather than strings. Values themselves are
+still treated as strings. Returns the number of newly registered types, or undef on error.
+Call it again after creating new types; types already registered are left alone.
+
+  $dbh->do(q{CREATE TYPE mood AS ENUM ('sad','ok','happy')});
+  $dbh->pg_register_types();
+  my $moods = $dbh->selectrow_array(q{SELECT '{sad,happy}'::mood[]});
+  ## $moods is now ['sad','happy']
+
+=head3 B<pg_clear_metadata_cache>
+
+  $dbh->pg_clear_metadata_cache;
+
+Forgets the column details that DBD::Pg remembers for the L</NULLABLE> attribute and the
+L</pg_canonical_names> method. These are looked up once per table column and then reused by
+every statement on this database handle. The cache is emptied automatically whenever this
+handle runs a C<CREATE>, C<ALTER>, C<DROP>, or C<ROLLBACK> command, but not when another
+connection changes the schema, so call this method if that happens. It also forgets all the
+results kept by L</pg_metadata_cache>.
+
 =head3 B<pg_server_trace>
 
   $dbh->pg_server_trace($filehandle);
@@ -3388,6 +3967,49 @@ possible to return the old behavior. The old behavior is useful when encoding
 the results of a call in JSON format and passing it to JavaScript for
 processing, where integer values have a precision of no more than 53 bits.
 
+=head3 B<pg_binary_results> (boolean)
+
+DBD::Pg specific attribute. Defaults to false. When true, new statement handles will ask
+the server to send results in binary format when possible, which avoids parsing each value
+from its text form and often reduces the amount of data sent. See the statement handle
+attribute of the same name for details.
+
+=head3 B<pg_zero_copy> (integer)
+
+DBD::Pg specific attribute. Defaults to 0, which disables it. When set to a positive
+number, text and bytea values at least that many bytes long are returned by the
+C<fetchrow_*> methods without being copied out of the result received from the server:
+the Perl value points directly at the data libpq already holds. This saves a copy (and
+the matching memory) when fetching large documents or binary objects.
+
+  $dbh->{pg_zero_copy} = 64 * 1024;
+  $sth = $dbh->prepare('SELECT data FROM files WHERE id = ?');
+  $sth->execute($id);
+  my $row = $sth->fetchrow_arrayref();
+  print {$fh} $row->[0];
+
+The saving applies to values used in place, as above. Values returned this way are
+read-only; copying one into another variable gives a normal, modifiable string. The
+result from the server is kept alive until every such value has been freed or
+overwritten, so holding on to a single large value keeps the whole result in memory.
+Columns bound with L</bind_col>, and values returned by L</pg_fetch_columns>, are
+always copied.
+
+=head3 B<pg_copy_buffer> (integer)
+
+DBD::Pg specific attribute. Defaults to 0. When set to a positive number, rows passed to
+L</pg_putcopydata> during a COPY FROM are held back and sent to the server in chunks of
+up to that many bytes, instead of one message per call. A value such as C<256 * 1024>
+greatly reduces the overhead of loading many short rows. Anything left over is sent by
+L</pg_putcopyend> (or L</pg_putcopyend_async>), so errors in the buffered data may not
+be reported until then. Rows sent with L</pg_putcopydata_async>, and the messages of a
+COPY BOTH (replication) stream, are never buffered.
+
+  $dbh->{pg_copy_buffer} = 256 * 1024;
+  $dbh->do("COPY mytable FROM STDIN");
+  $dbh->pg_putcopydata("$_\n") for @lines;
+  $dbh->pg_putcopyend();
+
 =head3 B<pg_skip_deallocate> (integer)
 
 DBD::Pg specific attribute. By default this is false, and causes prepared statements
@@ -3395,6 +4017,53 @@ created by us to be deallocated when no longer needed (i.e. when the handle is d
 By setting this to true, this deallocation is skipped entirely. This is useful when
 there is something else taking over responsibility for prepared statements.
 
+=head3 B<pg_statement_cache> (integer)
+
+DBD::Pg specific attribute. Defaults to 0, which disables the statement cache. When set
+to a positive number, DBD::Pg remembers up to that many recently prepared statements,
+keyed by their SQL text. Preparing the same statement again reuses the work of splitting
+it into placeholders, and once a server-side prepared statement has been created for it
+(see L</pg_switch_prepared>), that statement is handed from one statement handle to the
+next instead of being deallocated and prepared again. This makes code that calls
+C<prepare> (rather than C<prepare_cached>) inside a loop much cheaper.
+
+  $dbh->{pg_statement_cache} = 100;
+  for my $id (@ids) {
+      my $sth = $dbh->prepare('SELECT name FROM users WHERE id = ?');
+      $sth->execute($id);
+      ...
+  }
+
+Statements using L</pg_direct> or L</pg_async> are never cached, and a cached statement
+is only reused when it was prepared with the same placeholder types. The least recently
+used statements are deallocated when the cache is full. Because the server-side statements
+outlive the handles that created them, commands that remove prepared statements behind
+DBD::Pg's back, such as C<DEALLOCATE ALL> or C<DISCARD ALL>, should not be used while the
+cache is enabled. Setting this attribute to 0 empties the cache.
+
+=head3 B<pg_metadata_cache> (integer)
+
+DBD::Pg specific attribute. Defaults to 0, which disables the metadata cache. When set
+to a positive number, the results of up to that many recent calls to L</column_info>,
+L</primary_key_info>, L</foreign_key_info>, L</table_info>, and L</statistics_info>
+are remembered, keyed by their arguments. Only calls that name a table are cached.
+Calling the same method again first runs one small query that reads the catalog rows
+of the relations involved: their columns, defaults, constraints, indexes, comments,
+and the types (including enum values) of their columns. If none of these has changed since, the remembered result is returned without running
+the method's own, much larger, queries. This helps tools that look up the same tables
+over and over.
+
+  $dbh->{pg_metadata_cache} = 500;
+  my $columns = $dbh->column_info(undef, 'public', 'users', undef)->fetchall_arrayref({});
+
+Cached results are always returned as L<DBD::Sponge> statement handles. Running any
+C<CREATE>, C<ALTER>, C<DROP>, C<COMMENT>, or C<ROLLBACK> command through the handle
+forgets all cached results, as the catalog rows changed by the current transaction cannot
+be told apart from each other. Schema changes made by this handle in other ways, such as
+inside a function or a C<DO> block, may not be noticed; call L</pg_clear_metadata_cache>
+after making them. The least recently used results are
+forgotten when the cache is full, and L</pg_clear_metadata_cache> forgets all of them.
+
 =head3 B<pg_errorlevel> (integer)
 
 DBD::Pg specific attribute. Sets the amount of information returned by the server's
@@ -3492,6 +4161,13 @@ command. 0 indicates no asynchronous command is in progress, 1 indicates that
 an asynchronous command has started and -1 indicated that an asynchronous command
 has been cancelled.
 
+=head3 B<pg_pipeline_status> (integer, read-only)
+
+DBD::Pg specific attribute. Returns the L<pipeline mode|/Pipeline Mode> status of the connection,
+as given by libpq's PQpipelineStatus: 0 if not in pipeline mode, 1 if in pipeline mode,
+and 2 if in pipeline mode and an error has occurred since the last sync point. Always returns
+0 if DBD::Pg was compiled against a libpq older than version 14.
+
 =head3 B<pg_standard_conforming_strings> (boolean, read-only)
 
 DBD::Pg specific attribute. Returns true if the server is currently using
@@ -3611,6 +4287,14 @@ else afterwards. If the statement has already been prepared, and you switch the
 data type to something else, DBD::Pg will re-prepare the statement for you before
 doing the next execute.
 
+When a placeholder has been given one of the types boolean, smallint, integer, bigint, oid,
+real, double precision, uuid, timestamp, or timestamptz, DBD::Pg sends its value to the server in
+binary format whenever the value is in a plain form it can convert itself, which saves the
+server from parsing it. For example, numbers must have no surrounding spaces, and timestamps
+must look like C<2024-05-06 07:08:09.123456>. For timestamptz, a time zone offset such as C<+02>
+or C<Z> is needed, and for timestamp there must be none. Any other value is sent as text, just
+as before, and the server works out what it means.
+
 Examples:
 
   use DBI qw(:sql_types);
@@ -3739,6 +4423,16 @@ for more details.
 Used internally by the L</execute_array> method, and rarely used directly. See the
 DBI documentation for more details.
 
+When DBD::Pg has been compiled against libpq version 14 or higher, the tuples are sent to the
+server in batches of 1000 using L<pipeline mode|/Pipeline Mode>, rather than waiting for the
+server to answer each one in turn. This is done for any statement with placeholders that is
+not using L<pg_direct|/pg_direct (boolean)>, L<pg_async|/pg_async (integer)>, or
+C<pg_server_prepare> set to false, as long as the database handle is not already in pipeline
+mode. The statement is prepared on the server first, so it is parsed and planned only
+once. If one of the tuples fails while AutoCommit is on, the server rolls back the rest of its
+batch, so that batch is run again one tuple at a time, to make sure that every tuple that can
+succeed on its own is committed, just as if each had been executed separately.
+
 =head3 B<fetchrow_arrayref>
 
   $ary_ref = $sth->fetchrow_arrayref;
@@ -3804,6 +4498,30 @@ See the DBI documentation for a complete discussion.
 Returns a hashref containing all rows to be fetched from the statement handle. See the DBI documentation for
 a full discussion.
 
+=head3 B<pg_fetch_columns>
+
+  $columns = $sth->pg_fetch_columns();
+  $columns = $sth->pg_fetch_columns( $max_rows );
+
+DBD::Pg specific method. Returns a reference to an array containing one array reference per column,
+each holding the values of that column for all the remaining rows to be fetched from the statement
+handle. The values are the same as those returned by L</fetchrow_arrayref>, but the result is built
+one column at a time, which is much faster than L</fetchall_arrayref> when pulling a large number of
+rows into per-column lists.
+
+If C<$max_rows> is given, no more than that many rows are fetched, and the method can be called
+again to get the next batch. Once all rows have been fetched, the statement handle is finished, and
+any further calls return undef. This works well with L<pg_stream_rows|/pg_stream_rows (integer)>:
+
+  $sth = $dbh->prepare('SELECT id, price FROM sales', { pg_stream_rows => 10000 });
+  $sth->execute();
+  while (my $columns = $sth->pg_fetch_columns(10000)) {
+      my ($ids, $prices) = @$columns;
+      ...
+  }
+
+Note that the final batch may be empty.
+
 =head3 B<finish>
 
   $rv = $sth->finish;
@@ -3816,7 +4534,8 @@ when you have not fetched all the possible rows.
   $rv = $sth->rows;
 
 Returns the number of rows returned by the last query. In contrast to many other DBD modules,
-the number of rows is available immediately after calling C<< $sth->execute >>. Note that
+the number of rows is available immediately after calling C<< $sth->execute >> (unless
+L<pg_stream_rows|/pg_stream_rows (integer)> is being used). Note that
 the L</execute> method itself returns the number of rows itself, which means that this
 method is rarely needed.
 
@@ -3893,9 +4612,10 @@ DBD::Pg specific method. It returns array of original (or canonical) names
 F<Schema>.F<Table>.F<Column> format or undef if current column is not a
 simple reference.
 
-Note that this method is quite slow because it need additional information from
-server for every column that is simple reference. Consider to use L</pg_canonical_ids>
-instead.
+Note that this method needs additional information from the server for every column
+that is a simple reference. All such columns are looked up with a single query, and
+the answers are cached on the database handle (see L</pg_clear_metadata_cache>), but
+L</pg_canonical_ids> never needs to ask the server at all.
 
 =head3 B<last_insert_id>
 
@@ -3970,7 +4690,8 @@ This method returns undef if called before C<execute()>.
 
 Returns an arrayref of integer values for each column returned by the statement. The number
 indicates if the column is nullable or not. 0 = not nullable, 1 = nullable, 2 = unknown.
-This method returns undef if called before C<execute()>.
+This method returns undef if called before C<execute()>. The answers are looked up from the
+server with a single query and cached; see L</pg_clear_metadata_cache>.
 
 =head3 B<Database> (dbh, read-only)
 
@@ -4006,6 +4727,8 @@ method call failed.
 
 DBD::Pg specific attribute. Returns the number of the tuple (row) that was
 most recently fetched. Returns zero before and after fetching is performed.
+When using L<pg_stream_rows|/pg_stream_rows (integer)>, this counts from
+the start of the whole result, not the current batch.
 
 =head3 B<pg_numbound> (integer, read-only)
 
@@ -4102,6 +4825,46 @@ command. 0 indicates no asynchronous command is in progress, 1 indicates that
 an asynchronous command has started and -1 indicated that an asynchronous command
 has been cancelled.
 
+=head3 B<pg_binary_results> (boolean)
+
+DBD::Pg specific attribute. Defaults to the value of the database handle attribute of
+the same name. When true, the server is asked to send the results of this statement in binary
+format, which DBD::Pg decodes directly instead of parsing the text form of each value. The
+attribute can also be passed to L</prepare>:
+
+  $sth = $dbh->prepare('SELECT id, score FROM results WHERE run = ?', {pg_binary_results => 1});
+
+The first execution always uses text format, so that DBD::Pg can learn the column types.
+Later executions use binary format if every column is one of these types: boolean, smallint,
+integer, bigint, oid, real, double precision, bytea, text, varchar, char, name, json,
+timestamp (without time zone), uuid, or an array of boolean, smallint, integer, bigint,
+real, double precision, text, or varchar. Otherwise, text format is used as before.
+Arrays in binary format are decoded directly into Perl arrays, so they are only requested
+when L</pg_expand_array> is on.
+Values are returned exactly as they would be in text format, except that timestamps are
+always in ISO format, whatever the value of DateStyle. Because binary results cannot be
+requested with plain PQexec, statements with no placeholders are sent via PQexecParams,
+and thus cannot contain more than one command.
+
+=head3 B<pg_stream_rows> (integer)
+
+DBD::Pg specific attribute. Defaults to 0, which means that L</execute> reads
+all the rows of a result into memory before returning. When set to a positive
+number, only the first rows are read by L</execute>, and the rest are pulled from the
+server as they are fetched, which keeps memory use low for very large results. With
+libpq version 17 or higher, rows are sent over in batches of this size; with older
+versions they are sent one at a time (single-row mode, which needs libpq 9.2 or higher).
+The attribute can be given to L</prepare> or set on the statement handle before calling
+L</execute>.
+
+When streaming, L</execute> returns -1 as the number of rows is not yet known, and
+L</rows> returns the number of rows received so far. Until the last row has been
+fetched (or L</finish> is called), the database connection is busy: running any other
+statement or method on the same database handle will first throw away the remaining rows.
+If an error happens after the first rows have been sent, it is reported by the fetch
+method. This attribute is ignored for L<asynchronous|/Asynchronous Queries> queries
+and in L<pipeline mode|/Pipeline Mode>.
+
 =head3 B<RowsInCache>
 
 Not used by DBD::Pg
@@ -4372,12 +5135,205 @@ be used afterwards to complete the connection establishment process. If
 the attribute is present but its value is false, an ordinary
 synchronous connect will be done instead.
 
+=head3 Querying Multiple Databases
+
+The DBD::Pg::Multi class runs the same query on several database handles at once, for example
+on each shard of a sharded database. The query is sent asynchronously on every handle, and then
+a single poll() call waits on all of their sockets, so that each result can be handled as soon
+as it arrives, rather than waiting for the databases one after another.
+
+  my $multi = DBD::Pg::Multi->new(@shard_dbhs);
+  $multi->execute('SELECT count(*) FROM orders WHERE placed > ?', $since);
+  while ($multi->pending()) {
+    for my $res ($multi->results()) {
+      if (defined $res->{err}) {
+        warn "Shard $res->{index} failed: $res->{errstr}";
+        next;
+      }
+      $total += $res->{sth}->fetchall_arrayref()->[0][0];
+    }
+  }
+
+=over 4
+
+=item B<new>
+
+Creates a new DBD::Pg::Multi object from a list (or an arrayref) of connected database handles.
+
+=item B<execute>
+
+Prepares the given statement with L<pg_async|/Asynchronous Queries> on each database handle and executes
+it with the given bind values, without waiting for any of them. Returns the number of handles the query
+was sent to. Any handle that could not send the query is reported by the next call to C<results>.
+All results should be gathered before calling this method again, and none of the handles should
+already be running an asynchronous query.
+
+=item B<results>
+
+Waits until at least one of the queries has finished, for at most the number of seconds given as an
+argument (forever if no argument is given), and returns a list with a hashref for each finished query.
+It contains the C<index> of the database handle in the list given to C<new>, the C<dbh> itself, and
+the C<sth> that ran the query, from which the rows can be fetched as usual. If the query succeeded,
+C<rows> holds what L</pg_result> returned. If it failed, C<err>, C<errstr>, and C<state> hold the
+error for that database handle instead: an error on one handle never prevents the results of the
+others from being returned, and is not raised even if L<RaiseError|/RaiseError (boolean, inherited)>
+is on. Returns an empty list if the time ran out, or if nothing is left to gather.
+
+=item B<pending>
+
+Returns the number of database handles whose results have not yet been returned by C<results>.
+
+=item B<all>
+
+Waits for every query to finish, and returns the list of all the results, ordered by C<index>.
+
+  my @counts = map { $_->{sth}->fetchall_arrayref()->[0][0] }
+    grep { ! defined $_->{err} } $multi->all();
+
+=back
+
+=head2 Pipeline Mode
+
+Normally, every call to L</execute> waits for the server to answer before returning,
+which means one network round trip per statement. In pipeline mode, statements are
+sent to the server without waiting, and all of the results are gathered at once
+at a later sync point. This can greatly speed up applications that run many small
+statements, especially over high-latency connections. Pipeline mode requires DBD::Pg
+to have been compiled against libpq version 14 or higher.
+
+  $dbh->pg_enter_pipeline();
+  my $sth = $dbh->prepare('INSERT INTO sales(item, price) VALUES (?,?)');
+  for my $row (@rows) {
+    $sth->execute(@$row); ## Returns 0E0 right away
+  }
+  my $count = $dbh->pg_pipeline_sync();
+  $dbh->pg_exit_pipeline();
+
+While in pipeline mode, both L</execute> and L</do> return "0E0" as soon as the command
+has been queued. The statement is sent using the extended query protocol, so only a single
+SQL command is allowed per statement. Statements that have not yet been prepared on the
+server are sent with their parameters rather than being prepared first. Asynchronous
+queries cannot be used at the same time as pipeline mode, nor can the L</commit>, L</rollback>,
+or the L<COPY|/COPY support> methods: to end a transaction, either queue a COMMIT or ROLLBACK
+command, or leave pipeline mode first.
+
+Each sync point ends an implicit transaction on the server: if AutoCommit is on,
+all the commands sent since the previous sync point are committed together.
+If one of the commands fails, the server skips all the remaining commands
+up to the next sync point, and they are reported as failed as well.
+If AutoCommit is off, a transaction is started as usual with the first queued command,
+and is left open after the sync point.
+
+=head3 Pipeline Methods
+
+=over 4
+
+=item B<pg_enter_pipeline>
+
+This database handle method puts the connection into pipeline mode. It returns true on success.
+It is not possible to enter pipeline mode while an asynchronous query is running.
+
+  $dbh->pg_enter_pipeline();
+
+=item B<pg_pipeline_sync>
+
+This database handle method marks a sync point, and then waits for the results of all commands
+sent since the previous sync point. Each result is stored in the statement handle that sent it,
+so that the L</rows> method and all the fetch methods work as usual, although only the result of
+the last execution of each statement handle is kept. Returns the total number of rows affected
+or returned by all the statements (or "0E0" if none), or undef if any command failed, in which
+case the database handle error is set to that of the first failing command.
+
+An optional arrayref may be passed in, which will be filled with one entry for every call to
+execute since the previous sync point: the number of rows on success, or an arrayref of
+error code, error message, and SQLSTATE on failure (similar to the ArrayTupleStatus of
+L<DBI/execute_array>).
+
+  my @status;
+  if (! defined $dbh->pg_pipeline_sync(\@status)) {
+    for my $i (0..$#status) {
+      next if ! ref $status[$i];
+      print "Statement $i failed: $status[$i][1]\n";
+    }
+  }
+
+=item B<pg_pipeline_flush>
+
+This database handle method marks a sync point like L</pg_pipeline_sync>, but returns right
+away instead of waiting for the results. These are gathered later with L</pg_pipeline_completed>,
+so the application can carry on with other work while the server runs the commands.
+Returns the number of statements whose results have not yet been gathered (or "0E0" if none),
+or undef on error. The L</pg_pipeline_sync> method cannot be used again until all the flushed
+results have been gathered.
+
+=item B<pg_pipeline_submit>
+
+This database handle method takes an arrayref of jobs, each of which is an arrayref of a statement
+handle followed by its bind values. It enters pipeline mode if needed, executes every job, and then
+calls L</pg_pipeline_flush>, whose return value it returns. It returns undef if any job could
+not be sent.
+
+  my $sth = $dbh->prepare('SELECT * FROM orders WHERE customer = ?');
+  my $pending = $dbh->pg_pipeline_submit([ map { [$sth, $_] } @customers ]);
+
+=item B<pg_pipeline_completed>
+
+This database handle method gathers the results of flushed commands that the server has finished,
+without waiting for the rest. It returns an arrayref with one entry per finished statement, in the
+order they were executed, each an arrayref of the statement handle and the number of rows, or of the
+statement handle and an arrayref of error code, error message, and SQLSTATE if it failed. As with
+L</pg_pipeline_sync>, the result is stored in the statement handle, so its rows can be fetched
+as usual. As a statement handle only holds one result, gathering stops before a second result for
+the same statement handle: fetch the rows you need before calling this method again. Returns undef
+if the connection has failed.
+
+It returns an empty arrayref if nothing has finished yet, in which case the L</pg_socket> can be
+waited on before trying again. If a true argument is passed in, it instead waits until at least one
+statement has finished, or until there is nothing left to gather.
+
+  my $sth = $dbh->prepare('SELECT * FROM orders WHERE customer = ?');
+  my @customers = (1..100);
+  my $pending = $dbh->pg_pipeline_submit([ map { [$sth, $_] } @customers ]);
+  my $rin = '';
+  vec($rin, $dbh->{pg_socket}, 1) = 1;
+  while ($pending > 0) {
+    my $done = $dbh->pg_pipeline_completed();
+    if (! @$done) {
+      select(my $rout = $rin, undef, undef, undef);
+      next;
+    }
+    for my $entry (@$done) {
+      my ($sth, $rows) = @$entry;
+      die "Failed: $rows->[1]" if ref $rows;
+      process_orders($sth->fetchall_arrayref());
+      $pending--;
+    }
+  }
+  $dbh->pg_exit_pipeline();
+
+=item B<pg_exit_pipeline>
+
+This database handle method takes the connection out of pipeline mode. If any flushed commands
+have not been gathered, L</pg_pipeline_completed> is called until they have been. If any commands
+are still waiting for a sync point, L</pg_pipeline_sync> is called next. Returns true if all
+went well.
+
+=back
+
 =head2 Array support
 
 DBD::Pg allows arrays (as arrayrefs) to be passed in to both
 the L</quote> and the L</execute> methods. In both cases, the array is
 flattened into a string representing a Postgres array.
 
+An arrayref bound with L</bind_param> and a C<pg_type> of one of the numeric
+array types (C<PG_INT2ARRAY>, C<PG_INT4ARRAY>, C<PG_INT8ARRAY>, C<PG_FLOAT4ARRAY>,
+or C<PG_FLOAT8ARRAY>) is given that type, and if it is one-dimensional and every
+item is a number or undef, it is sent to the server in binary format whenever
+server-side prepares are in use. This is much faster for very large arrays:
+
+  $sth->bind_param(1, \@scores, { pg_type => PG_FLOAT8ARRAY });
+
 When fetching rows from a table that contains a column with an
 array type, the result will be passed back to your script as an arrayref.
 
@@ -4442,6 +5398,29 @@ ready to be delivered yet. When this happens, the variable has not been changed,
 and you will need to call the method again until you get a non-zero result.
 (Data is still always returned one data row at a time.)
 
+=head3 B<pg_getcopydata_bulk>
+
+  $ret = $dbh->pg_getcopydata_bulk($buffer, $min_bytes);
+
+A faster way to read the results of a COPY TO command, which appends many rows to
+C<$buffer> (a variable or a reference to one) in a single call instead of returning one
+row at a time. It waits on the server until at least C<$min_bytes> bytes (default 0,
+meaning at least one row) have been appended, then adds any further complete rows that
+have already arrived, without waiting. The number of bytes appended is returned, or -1
+once the COPY has finished, in which case the last rows (if any) have still been
+appended to the buffer. An error returns -2.
+
+The buffer is never shrunk, so emptying it between calls reuses the same memory:
+
+  $dbh->do('COPY mytable TO STDOUT');
+  my $buffer = '';
+  while (1) {
+      my $ret = $dbh->pg_getcopydata_bulk($buffer, 1024 * 1024);
+      print {$fh} $buffer;
+      $buffer = '';
+      last if $ret < 0;
+  }
+
 =head3 B<pg_putcopydata>
 
 Used to put data into a table after the server has been put into COPY IN mode
@@ -4465,6 +5444,18 @@ the COPY statement. Returns a 1 on successful input. Examples:
   $dbh->pg_putcopydata("Anchovies~6\n");
   $dbh->pg_putcopyend();
 
+The argument may also be a reference to an array of rows, which are all sent in a
+single call, gathered into large chunks rather than one message per row. Undefined
+elements are skipped. This is much faster for loading many short rows:
+
+  $dbh->do("COPY mytable FROM STDIN");
+  while (my @batch = get_rows(10_000)) {
+      $dbh->pg_putcopydata(\@batch);
+  }
+  $dbh->pg_putcopyend();
+
+See also L</pg_copy_buffer>, which gathers rows across separate calls.
+
 =head3 B<pg_putcopydata_async>
 
 Non-blocking version of pg_putcopydata for use by async libraries. When called, the
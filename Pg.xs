@@ -297,7 +297,7 @@ quote(dbh, to_quote_sv, type_sv=Nullsv)
                     if (!SvROK(type_sv) || SvTYPE(SvRV(type_sv)) != SVt_PVHV)
                         croak("Second argument to quote must be a hashref");
                     if ((svp = hv_fetchs((HV*)SvRV(type_sv),"pg_type", 0)) != NULL) {
-                        type_info = pg_type_data(SvIV(*svp));
+                        type_info = pg_db_type_data(imp_dbh, SvIV(*svp));
                     }
                     else if ((svp = hv_fetchs((HV*)SvRV(type_sv),"type", 0)) != NULL) {
                         type_info = sql_type_data(SvIV(*svp));
@@ -331,7 +331,9 @@ quote(dbh, to_quote_sv, type_sv=Nullsv)
                 
             to_quote = SvPV(to_quote_sv, len);
             /* Need good debugging here */
-            quoted = type_info->quote(aTHX_ to_quote, len, &retlen, imp_dbh->pg_server_version >= 80100 ? 1 : 0);
+            quoted = type_info->quote(aTHX_ to_quote, len, &retlen,
+                                     imp_dbh->pg_server_version >= 90000 ? PG_QUOTE_BYTEA_HEX
+                                     : imp_dbh->pg_server_version >= 80100 ? 1 : 0);
             RETVAL = newSVpvn_utf8(quoted, retlen, utf8);
             Safefree (quoted);
         }
@@ -460,6 +462,80 @@ pg_notifies(dbh)
         ST(0) = pg_db_pg_notifies(dbh, imp_dbh);
 
 
+void
+pg_notifies_all(dbh, max=Nullsv, attribs=Nullsv)
+    SV * dbh
+    SV * max
+    SV * attribs
+    CODE:
+        bool group = DBDPG_FALSE;
+        bool unique = DBDPG_FALSE;
+        D_imp_dbh(dbh);
+        if (attribs && SvROK(attribs) && SvTYPE(SvRV(attribs)) == SVt_PVHV) {
+            SV **svp;
+            if ((svp = hv_fetchs((HV*)SvRV(attribs),"group", 0)) != NULL)
+                group = SvTRUE(*svp) ? DBDPG_TRUE : DBDPG_FALSE;
+            if ((svp = hv_fetchs((HV*)SvRV(attribs),"unique", 0)) != NULL)
+                unique = SvTRUE(*svp) ? DBDPG_TRUE : DBDPG_FALSE;
+        }
+        ST(0) = pg_db_pg_notifies_all(dbh, imp_dbh, (max && SvOK(max)) ? (int)SvIV(max) : 0, group, unique);
+
+
+void
+pg_wait_for_notify(dbh, timeout=Nullsv, max=Nullsv)
+    SV * dbh
+    SV * timeout
+    SV * max
+    CODE:
+        D_imp_dbh(dbh);
+        ST(0) = pg_db_pg_wait_for_notify(dbh, imp_dbh, (timeout && SvOK(timeout)) ? SvNV(timeout) : -1.0,
+                                         (max && SvOK(max)) ? (int)SvIV(max) : 0);
+
+
+void
+pg_register_types(dbh)
+    SV * dbh
+    CODE:
+        int ret;
+        D_imp_dbh(dbh);
+        ret = pg_db_register_types(dbh, imp_dbh);
+        ST(0) = ret < 0 ? &PL_sv_undef : sv_2mortal(newSViv(ret));
+
+
+void
+_pg_multi_ready(handles, timeout=Nullsv)
+    SV * handles
+    SV * timeout
+    CODE:
+        if (!SvROK(handles) || SvTYPE(SvRV(handles)) != SVt_PVAV)
+            croak("First argument to _pg_multi_ready must be an arrayref");
+        ST(0) = pg_db_multi_ready((AV*)SvRV(handles), (timeout && SvOK(timeout)) ? SvNV(timeout) : -1.0);
+
+
+void
+_pg_returning_id(dbh)
+    SV * dbh
+    CODE:
+        D_imp_dbh(dbh);
+        ST(0) = pg_db_returning_id(imp_dbh);
+
+
+void
+_pg_metadata_generation(dbh)
+    SV * dbh
+    CODE:
+        D_imp_dbh(dbh);
+        ST(0) = sv_2mortal(newSViv((IV)imp_dbh->metadata_generation));
+
+
+void
+_pg_clear_column_cache(dbh)
+    SV * dbh
+    CODE:
+        D_imp_dbh(dbh);
+        pg_db_clear_metadata_cache(imp_dbh);
+
+
 void
 pg_savepoint(dbh,name)
     SV * dbh
@@ -780,6 +856,18 @@ pg_getcopydata_async(dbh, dataline)
     OUTPUT:
         RETVAL
 
+IV
+pg_getcopydata_bulk(dbh, buffer, min_bytes=Nullsv)
+    INPUT:
+        SV * dbh
+        SV * buffer
+        SV * min_bytes
+    CODE:
+        IV min = (min_bytes && SvOK(min_bytes)) ? SvIV(min_bytes) : 0;
+        RETVAL = pg_db_getcopydata_bulk(dbh, SvROK(buffer) ? SvRV(buffer) : buffer, min > 0 ? (STRLEN)min : 0);
+    OUTPUT:
+        RETVAL
+
 I32
 pg_putcopydata(dbh, dataline)
     INPUT:
@@ -925,6 +1013,64 @@ pg_cancel(dbh)
     D_imp_dbh(dbh);
     ST(0) = pg_db_cancel(dbh, imp_dbh) ? &PL_sv_yes : &PL_sv_no;
 
+void
+pg_enter_pipeline(dbh)
+    SV *dbh
+    CODE:
+    D_imp_dbh(dbh);
+    ST(0) = pg_db_enter_pipeline(dbh, imp_dbh) ? &PL_sv_yes : &PL_sv_no;
+
+void
+pg_pipeline_sync(dbh, tuple_status=Nullsv)
+    SV * dbh
+    SV * tuple_status
+    CODE:
+        long ret;
+        AV *status_av = NULL;
+        D_imp_dbh(dbh);
+        if (tuple_status && SvOK(tuple_status)) {
+            if (!SvROK(tuple_status) || SvTYPE(SvRV(tuple_status)) != SVt_PVAV)
+                croak("Argument to pg_pipeline_sync must be an arrayref");
+            status_av = (AV*)SvRV(tuple_status);
+            av_clear(status_av);
+        }
+        ret = pg_db_pipeline_sync(dbh, imp_dbh, status_av);
+        if (ret == 0)
+            XST_mPV(0, "0E0");
+        else if (ret < -1)
+            XST_mUNDEF(0);
+        else
+            XST_mIV(0, ret);
+
+void
+pg_pipeline_flush(dbh)
+    SV * dbh
+    CODE:
+        int ret;
+        D_imp_dbh(dbh);
+        ret = pg_db_pipeline_flush(dbh, imp_dbh);
+        if (ret == 0)
+            XST_mPV(0, "0E0");
+        else if (ret < -1)
+            XST_mUNDEF(0);
+        else
+            XST_mIV(0, ret);
+
+void
+pg_pipeline_completed(dbh, wait=Nullsv)
+    SV * dbh
+    SV * wait
+    CODE:
+    D_imp_dbh(dbh);
+    ST(0) = pg_db_pipeline_completed(dbh, imp_dbh, wait && SvTRUE(wait) ? DBDPG_TRUE : DBDPG_FALSE);
+
+void
+pg_exit_pipeline(dbh)
+    SV *dbh
+    CODE:
+    D_imp_dbh(dbh);
+    ST(0) = pg_db_exit_pipeline(dbh, imp_dbh) ? &PL_sv_yes : &PL_sv_no;
+
 
 # -- end of DBD::Pg::db
 
@@ -980,6 +1126,23 @@ pg_result(sth)
         else
             XST_mIV(0, ret);
 
+void
+_pg_server_prepare(sth)
+    SV * sth
+    CODE:
+        D_imp_sth(sth);
+        ST(0) = sv_2mortal(newSViv(pg_st_server_prepare(sth, imp_sth)));
+
+SV*
+pg_fetch_columns(sth, max_rows=Nullsv)
+    SV * sth
+    SV * max_rows
+    CODE:
+        D_imp_sth(sth);
+        RETVAL = pg_st_fetch_columns(sth, imp_sth, (max_rows && SvOK(max_rows)) ? (long)SvIV(max_rows) : -1);
+    OUTPUT:
+        RETVAL
+
 SV*
 pg_canonical_ids(sth)
     SV *sth
@@ -0,0 +1,335 @@
+#!/usr/bin/env perl
+
+## Benchmark the hot paths of DBD::Pg: fetching, executing, COPY, arrays, and quoting
+
+my $USAGE = "Usage: $0 [--rows N] [--iterations N] [--repeat N] [--only regex] [--json] [--dsn dsn]";
+
+## The usual way to run this is "make bench", which uses the same database
+## as "make test" (creating a throwaway cluster if needed). Options can be
+## passed in via BENCH_OPTS, for example:
+##
+## make bench BENCH_OPTS="--only fetch --rows 100000"
+##
+## Options:
+## --rows         Number of rows for the fetch, array, and COPY benchmarks (default 20000)
+## --iterations   Number of calls for the execute and quote benchmarks (default 5000)
+## --repeat       Run each benchmark this many times and report the fastest (default 3)
+## --only         Only run benchmarks whose name matches this regex
+## --json         Print one JSON object per line instead of tab-separated columns
+## --dsn          Connect to this DSN instead of the test database (also uses DBI_USER and DBI_PASS)
+##
+## Each result line has four columns: benchmark, variant, value, unit
+
+
+use 5.008001;
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch', 't';
+use DBI;
+use DBD::Pg qw/ :pg_types /;
+use Getopt::Long qw/ GetOptions /;
+use Time::HiRes qw/ gettimeofday tv_interval /;
+
+our $VERSION = 1.0;
+
+my %arg = (
+    rows       => 20000,
+    iterations => 5000,
+    repeat     => 3,
+    only       => '',
+);
+
+GetOptions
+ (
+   \%arg,
+   'rows=i',
+   'iterations=i',
+   'repeat=i',
+   'only=s',
+   'json',
+   'dsn=s',
+   'help',
+) or die "$USAGE\n";
+
+if ($arg{help}) {
+    print "$USAGE\n";
+    exit 0;
+}
+
+my $dbh;
+if ($arg{dsn}) {
+    $dbh = DBI->connect($arg{dsn}, $ENV{DBI_USER}, $ENV{DBI_PASS},
+                        {AutoCommit => 0, RaiseError => 1, PrintError => 0});
+}
+else {
+    require 'dbdpg_test_setup.pl'; ## no critic
+    my $error;
+    (undef, $error, $dbh) = connect_database();
+    $dbh or die "Could not connect to or create the test database: $error\n"
+        . "Set DBI_DSN (and DBI_USER and DBI_PASS), or PGINITDB to the initdb to use, or pass --dsn\n";
+}
+$dbh->{AutoCommit} = 0;
+$dbh->{RaiseError} = 1;
+$dbh->{PrintError} = 0;
+
+my $rows = $arg{rows};
+my $iterations = $arg{iterations};
+
+report_environment();
+
+bench_fetch()        if wanted('fetch');
+bench_fetch_method() if wanted('fetch_method');
+bench_execute()      if wanted('execute');
+bench_copy()         if wanted('copy');
+bench_arrays()       if wanted('array');
+bench_quote()        if wanted('quote');
+
+$dbh->rollback();
+$dbh->disconnect();
+
+exit;
+
+
+sub wanted {
+    my $name = shift;
+    return 1 if ! length $arg{only};
+    return $name =~ /$arg{only}/ ? 1 : 0;
+}
+
+
+sub measure {
+
+    ## Run the code the requested number of times, and return the fastest time in seconds
+    ## The optional setup code is run before each attempt, outside of the timing
+
+    my ($code, $setup) = @_;
+
+    my $best;
+    for (1..$arg{repeat}) {
+        $setup->() if $setup;
+        my $start = [gettimeofday];
+        $code->();
+        my $elapsed = tv_interval($start);
+        $best = $elapsed if ! defined $best or $elapsed < $best;
+    }
+    return $best || 1e-9;
+}
+
+
+sub report {
+
+    my ($name, $variant, $value, $unit) = @_;
+
+    $value = sprintf '%.2f', $value;
+    if ($arg{json}) {
+        print qq[{"benchmark":"$name","variant":"$variant","value":$value,"unit":"$unit"}\n];
+    }
+    else {
+        print join("\t", $name, $variant, $value, $unit), "\n";
+    }
+    return;
+}
+
+
+sub report_environment {
+
+    my %env = (
+        dbdpg   => $DBD::Pg::VERSION,
+        dbi     => $DBI::VERSION,
+        perl    => sprintf('%vd', $^V),
+        libpq   => $dbh->{pg_lib_version},
+        server  => $dbh->{pg_server_version},
+        rows    => $rows,
+        iterations => $iterations,
+        repeat  => $arg{repeat},
+    );
+
+    if ($arg{json}) {
+        print '{"environment":{', (join ',' => map { qq{"$_":"$env{$_}"} } sort keys %env), "}}\n";
+    }
+    else {
+        print '## ', (join ' ' => map { "$_=$env{$_}" } sort keys %env), "\n";
+        print join("\t", qw/ benchmark variant value unit /), "\n";
+    }
+    return;
+}
+
+
+sub bench_fetch {
+
+    ## Rows per second for each type, for a few row widths, in text and binary format
+
+    my %expr = (
+        int4        => 'g',
+        int8        => 'g::int8 * 1000000',
+        float8      => 'g::float8 / 7',
+        numeric     => 'g::numeric / 7',
+        bool        => '(g % 2 = 0)',
+        text        => q{repeat('x', 20) || g},
+        timestamptz => q{'2020-01-01'::timestamptz + g * interval '1 second'},
+        bytea       => q{decode(md5(g::text), 'hex')},
+    );
+    my @widths = (1, 10, 50);
+    my $maxwidth = $widths[-1];
+
+    for my $type (sort keys %expr) {
+        my $table = "dbdpg_bench_fetch_$type";
+        my $cols = join ',' => map { "$expr{$type} AS c$_" } 1..$maxwidth;
+        $dbh->do("CREATE TEMP TABLE $table AS SELECT $cols FROM generate_series(1,$rows) AS g");
+
+        for my $width (@widths) {
+            my $SQL = "SELECT " . (join ',' => map { "c$_" } 1..$width) . " FROM $table";
+            for my $format (qw/ text binary /) {
+                my $sth = $dbh->prepare($SQL, {pg_binary_results => $format eq 'binary' ? 1 : 0});
+                ## The first execute tells us the column types, which binary results need
+                $sth->execute();
+                $sth->finish();
+                my $time = measure(sub {
+                    $sth->execute();
+                    1 while $sth->fetchrow_arrayref();
+                });
+                report('fetch', "$type/$width/$format", $rows / $time, 'rows/s');
+            }
+        }
+        $dbh->do("DROP TABLE $table");
+    }
+    return;
+}
+
+
+sub bench_fetch_method {
+
+    ## Rows per second for each way of fetching the same ten integer columns
+
+    my $cols = join ',' => map { "g AS c$_" } 1..10;
+    $dbh->do("CREATE TEMP TABLE dbdpg_bench_method AS SELECT $cols FROM generate_series(1,$rows) AS g");
+    my $sth = $dbh->prepare('SELECT * FROM dbdpg_bench_method');
+
+    my %method = (
+        fetchrow_arrayref => sub { 1 while $sth->fetchrow_arrayref(); },
+        fetchrow_array    => sub { 1 while my @row = $sth->fetchrow_array(); },
+        fetchrow_hashref  => sub { 1 while $sth->fetchrow_hashref(); },
+        fetchall_arrayref => sub { $sth->fetchall_arrayref(); },
+        pg_fetch_columns  => sub { $sth->pg_fetch_columns(); },
+    );
+
+    for my $name (sort keys %method) {
+        my $time = measure(sub {
+            $sth->execute();
+            $method{$name}->();
+        });
+        report('fetch_method', $name, $rows / $time, 'rows/s');
+    }
+    $dbh->do('DROP TABLE dbdpg_bench_method');
+    return;
+}
+
+
+sub bench_execute {
+
+    ## Microseconds per execute for PQexec, PQexecParams, and PQexecPrepared
+
+    my %style = (
+        PQexec         => {pg_server_prepare => 0},
+        PQexecParams   => {pg_server_prepare => 1, pg_switch_prepared => 0},
+        PQexecPrepared => {pg_server_prepare => 1, pg_switch_prepared => 1},
+    );
+
+    for my $name (sort keys %style) {
+        my $sth = $dbh->prepare('SELECT ?::int4 + 1', $style{$name});
+        my $time = measure(sub {
+            for my $i (1..$iterations) {
+                $sth->execute($i);
+                $sth->fetchrow_arrayref();
+            }
+        });
+        report('execute', $name, 1e6 * $time / $iterations, 'us/call');
+    }
+    return;
+}
+
+
+sub bench_copy {
+
+    ## Rows and megabytes per second for COPY FROM STDIN and COPY TO STDOUT
+
+    $dbh->do('CREATE TEMP TABLE dbdpg_bench_copy (id int, name text, amount numeric, stamp timestamptz)');
+
+    my @lines = map { "$_\tname number $_\t$_.25\t2020-01-01 12:34:56+00\n" } 1..$rows;
+    my $bytes = 0;
+    $bytes += length $_ for @lines;
+
+    my $time = measure(sub {
+        $dbh->do('COPY dbdpg_bench_copy FROM STDIN');
+        $dbh->pg_putcopydata($_) for @lines;
+        $dbh->pg_putcopyend();
+    }, sub { $dbh->do('TRUNCATE TABLE dbdpg_bench_copy'); });
+    report('copy_in', 'rows', $rows / $time, 'rows/s');
+    report('copy_in', 'bytes', $bytes / $time / 1e6, 'MB/s');
+
+    $time = measure(sub {
+        my $line = '';
+        $dbh->do('COPY dbdpg_bench_copy TO STDOUT');
+        1 while $dbh->pg_getcopydata($line) >= 0;
+    });
+    report('copy_out', 'rows', $rows / $time, 'rows/s');
+    report('copy_out', 'bytes', $bytes / $time / 1e6, 'MB/s');
+
+    $dbh->do('DROP TABLE dbdpg_bench_copy');
+    return;
+}
+
+
+sub bench_arrays {
+
+    ## Elements per second when arrays are turned into Perl arrays on fetch
+
+    my $arows = int($rows / 10) || 1;
+
+    my %array = (
+        'int4[100]'    => [100, 'SELECT array_agg(g+i) FROM generate_series(1,100) AS i'],
+        'float8[100]'  => [100, 'SELECT array_agg((g+i)::float8 / 3) FROM generate_series(1,100) AS i'],
+        'text[20]'     => [20,  q{SELECT array_agg('item "' || (g+i) || '"') FROM generate_series(1,20) AS i}],
+        'int4[10][10]' => [100, 'SELECT array_agg(a) FROM (SELECT array_agg(g+i+j) AS a FROM generate_series(1,10) AS i, '
+                                . 'generate_series(1,10) AS j GROUP BY i) AS x'],
+    );
+
+    for my $name (sort keys %array) {
+        my ($elements, $sub) = @{ $array{$name} };
+        $dbh->do("CREATE TEMP TABLE dbdpg_bench_array AS SELECT ($sub) AS a FROM generate_series(1,$arows) AS g");
+        my $sth = $dbh->prepare('SELECT a FROM dbdpg_bench_array');
+        my $time = measure(sub {
+            $sth->execute();
+            1 while $sth->fetchrow_arrayref();
+        });
+        report('array_fetch', $name, $arows * $elements / $time, 'elements/s');
+        $dbh->do('DROP TABLE dbdpg_bench_array');
+    }
+    return;
+}
+
+
+sub bench_quote {
+
+    ## Calls per second for quote() on various kinds of input
+
+    my %input = (
+        plain     => ['Just a simple string with nothing special in it'],
+        escapes   => [q{It's got 'quotes' and \\backslashes\\ in it} x 3],
+        long      => ['x' x 10000],
+        bytea     => [join('' => map { chr } 0..255), {pg_type => PG_BYTEA}],
+        int4      => [123456, {pg_type => PG_INT4}],
+        array     => [[1..50]],
+    );
+
+    for my $name (sort keys %input) {
+        my ($value, $type) = @{ $input{$name} };
+        my $time = measure(sub {
+            for (1..$iterations) {
+                $dbh->quote($value, $type);
+            }
+        });
+        report('quote', $name, $iterations / $time, 'calls/s');
+    }
+    return;
+}
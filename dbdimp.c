@@ -83,16 +83,38 @@ do { \
   } \
 } while (0)
 
-/* For a statement handle's PGresult pointer, free it as needed */
+/*
+  For a statement handle's PGresult pointer, free it as needed.
+  If fetched values still point into it, it is freed once they are gone.
+*/
 #define CLEAR_STH_RESULT(mysth) \
 do { \
   if (mysth && mysth->result) { \
-    TRACE_PQCLEAR; \
-    PQclear(mysth->result); \
+    if (mysth->result_hold) { \
+      pg_st_result_unhold(mysth); \
+    } \
+    else { \
+      TRACE_PQCLEAR; \
+      PQclear(mysth->result); \
+    } \
     mysth->result = NULL; \
   } \
 } while (0)
 
+/* Read big-endian integers from a result sent in binary format */
+#define PG_BINARY_U16(p) ((uint16_t)(((uint16_t)(p)[0] << 8) | (uint16_t)(p)[1]))
+#define PG_BINARY_U32(p) (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#define PG_BINARY_U64(p) (((uint64_t)PG_BINARY_U32(p) << 32) | (uint64_t)PG_BINARY_U32((p)+4))
+
+/* Is this result one batch of rows from a streamed query? (see pg_stream_rows) */
+#if PGLIBVERSION >= 170000
+#define PG_STREAM_CHUNK(status) (PGRES_SINGLE_TUPLE == (status) || PGRES_TUPLES_CHUNK == (status))
+#elif PGLIBVERSION >= 90200
+#define PG_STREAM_CHUNK(status) (PGRES_SINGLE_TUPLE == (status))
+#else
+#define PG_STREAM_CHUNK(status) DBDPG_FALSE
+#endif
+
 enum {
     STH_ASYNC_AUTOERROR = -2,    /* PG_OLDQUERY_WAIT auto-retrieved an error result */
     STH_ASYNC_CANCELLED = -1,
@@ -124,6 +146,42 @@ static PGTransactionStatusType pg_db_txn_status (pTHX_ imp_dbh_t *imp_dbh);
 static int pg_db_start_txn (pTHX_ SV *dbh, imp_dbh_t *imp_dbh);
 static int handle_old_async(pTHX_ SV * handle, imp_dbh_t * imp_dbh, const int asyncflag);
 static void pg_db_detect_client_encoding_utf8(pTHX_ imp_dbh_t *imp_dbh);
+static void pg_db_pipeline_append(imp_dbh_t *imp_dbh, imp_sth_t *imp_sth);
+static void pg_db_pipeline_reset(pTHX_ imp_dbh_t *imp_dbh);
+static void pg_db_pipeline_store(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth, PGresult *result, ExecStatusType status);
+static int pg_db_pipeline_command(pTHX_ SV *h, imp_dbh_t *imp_dbh, const char *sql);
+static int pg_db_pipeline_start_txn(pTHX_ SV *h, imp_dbh_t *imp_dbh);
+static void pg_st_stream_start(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth);
+static ExecStatusType pg_st_stream_next(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth);
+static void pg_st_stream_discard(pTHX_ imp_dbh_t *imp_dbh);
+static bool pg_binary_decodable(int type_id);
+static void pg_st_result_unhold(imp_sth_t *imp_sth);
+static bool pg_st_zero_copy(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth, int column, SV *sv, char *value, int length, bool binary);
+static void pg_zero_copy_release(pTHX_ SV *sv);
+static bool pg_binary_to_sv(pTHX_ imp_dbh_t *imp_dbh, SV *sv, int type_id, const unsigned char *value, int len, int chopblanks);
+static int pg_binary_array_element(int type_id);
+static bool pg_binary_array_to_sv(pTHX_ imp_dbh_t *imp_dbh, SV *sv, int type_id, const unsigned char *value, int len);
+static void pg_st_type_info_setup(pTHX_ imp_sth_t *imp_sth, int num_fields);
+static int pg_st_decoder_flags(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth, bool binary);
+static void pg_st_decoder_setup(pTHX_ imp_sth_t *imp_sth, int num_fields, int flags);
+static bool pg_binary_encodable(int type_id);
+static int pg_binary_from_string(pTHX_ imp_dbh_t *imp_dbh, int type_id, const char *value, char *out);
+static int pg_binary_array_numeric(int type_id);
+static char * pg_binary_array_from_av(pTHX_ imp_dbh_t *imp_dbh, int type_id, AV *av, int *binlen);
+static void pg_st_array_text(pTHX_ ph_t *currph);
+static void pg_st_reprepare(pTHX_ SV *sth, imp_dbh_t *imp_dbh, imp_sth_t *imp_sth);
+static char * pg_st_cache_key(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth, const char *statement, STRLEN *keylen);
+static stmt_cache_t * pg_db_cache_find(pTHX_ imp_dbh_t *imp_dbh, const char *key, STRLEN keylen);
+static void pg_db_cache_trim(pTHX_ imp_dbh_t *imp_dbh);
+static void pg_db_cache_clear(pTHX_ imp_dbh_t *imp_dbh);
+static stmt_cache_t * pg_st_cache_store(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth);
+static void pg_st_cache_load(pTHX_ imp_sth_t *imp_sth, stmt_cache_t *entry);
+static void pg_db_copy_out_end(pTHX_ SV *dbh, imp_dbh_t *imp_dbh);
+static int pg_db_copy_flush(pTHX_ SV *dbh, imp_dbh_t *imp_dbh);
+static bool pg_st_cache_take(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth);
+static AV ** pg_st_column_info(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth, int fields);
+static void pg_db_returning_clear(pTHX_ imp_dbh_t *imp_dbh);
+static bool pg_st_cache_give(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth);
 
 static void ph_array_init(imp_sth_t *imp_sth)
 {
@@ -165,6 +223,7 @@ static void ph_array_destroy(imp_sth_t *imp_sth)
         Safefree(elem->fooname);
         Safefree(elem->value);
         Safefree(elem->quoted);
+        Safefree(elem->binarray);
     }
 
     Safefree(imp_sth->ph_array.array);
@@ -465,10 +524,37 @@ int dbd_db_login6 (SV * dbh, imp_dbh_t * imp_dbh, char * dbname, char * uid, cha
     imp_dbh->pg_errorlevel     = 1; /* Default */
     imp_dbh->async_status      = DBH_NO_ASYNC;
     imp_dbh->async_sth         = NULL;
+    imp_dbh->stream_sth        = NULL;
     imp_dbh->last_result       = NULL; /* NULL or the last PGresult returned by a database or statement handle */
     imp_dbh->result_shared     = DBDPG_FALSE;
     imp_dbh->pg_int8_as_string = DBDPG_FALSE;
+    imp_dbh->binary_results    = DBDPG_FALSE;
+    imp_dbh->zero_copy         = 0;
+    imp_dbh->copy_buffer_size  = 0;
+    imp_dbh->copy_buffer       = NULL;
+    imp_dbh->copy_buffer_length = 0;
+    imp_dbh->copy_buffer_alloc = 0;
     imp_dbh->skip_deallocate   = DBDPG_FALSE;
+    imp_dbh->in_pipeline       = DBDPG_FALSE;
+    imp_dbh->pipeline_count    = 0;
+    imp_dbh->pipeline_length   = 0;
+    imp_dbh->pipeline_sths     = NULL;
+    imp_dbh->pipeline_head     = 0;
+    imp_dbh->pipeline_flushed  = 0;
+    imp_dbh->pipeline_status   = -1;
+    imp_dbh->pipeline_rows     = 0;
+    imp_dbh->pipeline_error    = NULL;
+    imp_dbh->stmt_cache_size   = 0;
+    imp_dbh->stmt_cache_count  = 0;
+    imp_dbh->stmt_cache        = NULL;
+    imp_dbh->stmt_cache_head   = NULL;
+    imp_dbh->stmt_cache_tail   = NULL;
+    imp_dbh->registered_types  = NULL;
+    imp_dbh->column_cache      = NULL;
+    imp_dbh->metadata_cache_size = 0;
+    imp_dbh->metadata_generation = 0;
+    imp_dbh->returning_sql     = NULL;
+    imp_dbh->returning_value   = NULL;
 
     /* if not connecting asynchronously, do after connect init */
     imp_dbh->pg_protocol = -1;
@@ -645,6 +731,8 @@ static ExecStatusType _result(pTHX_ imp_dbh_t * imp_dbh, const char * sql)
 
     if (TSQL) TRC(DBILOGFP, "%s;\n\n", sql);
 
+    pg_st_stream_discard(aTHX_ imp_dbh);
+
     CLEAR_LAST_RESULT(imp_dbh);
 
     TRACE_PQEXEC;
@@ -709,6 +797,12 @@ static ExecStatusType _sqlstate(pTHX_ imp_dbh_t * imp_dbh, PGresult * result)
         case PGRES_COPY_OUT:
         case PGRES_COPY_IN:
         case PGRES_COPY_BOTH:
+#if PGLIBVERSION >= 90200
+        case PGRES_SINGLE_TUPLE:
+#endif
+#if PGLIBVERSION >= 170000
+        case PGRES_TUPLES_CHUNK:
+#endif
             sqlstate = "00000"; /* SUCCESSFUL COMPLETION */
             break;
         case PGRES_BAD_RESPONSE:
@@ -732,6 +826,23 @@ static ExecStatusType _sqlstate(pTHX_ imp_dbh_t * imp_dbh, PGresult * result)
     memcpy(imp_dbh->sqlstate, sqlstate, 5);
     imp_dbh->sqlstate[5] = '\0';
 
+    /*
+      Changing the schema, or undoing a change, makes the column cache stale,
+      as well as the catalog method results Pg.pm keeps for pg_metadata_cache
+    */
+    if (PGRES_COMMAND_OK == status
+        && ((NULL != imp_dbh->column_cache && HvUSEDKEYS(imp_dbh->column_cache))
+            || imp_dbh->metadata_cache_size > 0)) {
+        const char * tag;
+        TRACE_PQCMDSTATUS;
+        tag = PQcmdStatus(result);
+        if (strnEQ(tag, "ALTER", 5) || strnEQ(tag, "DROP", 4) || strnEQ(tag, "CREATE", 6)
+            || strnEQ(tag, "COMMENT", 7) || strnEQ(tag, "ROLLBACK", 8)) {
+            imp_dbh->metadata_generation++;
+            pg_db_clear_metadata_cache(imp_dbh);
+        }
+    }
+
     if (TRACE7_slow) TRC(DBILOGFP, "%s_sqlstate txn_status is %d\n",
                     THEADER_slow, pg_db_txn_status(aTHX_ imp_dbh));
 
@@ -758,6 +869,9 @@ int dbd_db_ping (SV * dbh)
         return -1;
     }
 
+    /* Any rows still streaming in are thrown away */
+    pg_st_stream_discard(aTHX_ imp_dbh);
+
     tstatus = pg_db_txn_status(aTHX_ imp_dbh);
     if (TRACE5_slow) TRC(DBILOGFP, "%sdbd_db_ping txn_status is %d\n", THEADER_slow, tstatus);
 
@@ -830,6 +944,13 @@ static int pg_db_rollback_commit (pTHX_ SV * dbh, imp_dbh_t * imp_dbh, int actio
         return 0;
     }
 
+    /* Synchronous commands cannot be run while in pipeline mode */
+    if (imp_dbh->in_pipeline) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Cannot commit or rollback while in pipeline mode");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_commit (error: pipeline mode)\n", THEADER_slow);
+        return 0;
+    }
+
     /* We only perform these actions if we need to. For newer servers, we
        ask it for the status directly and double-check things */
 
@@ -888,6 +1009,7 @@ static int pg_db_rollback_commit (pTHX_ SV * dbh, imp_dbh_t * imp_dbh, int actio
     /* We just did a rollback or a commit, so savepoints are not relevant, and we cannot be in a PGRES_COPY state */
     av_undef(imp_dbh->savepoints);
     imp_dbh->copystate=0;
+    imp_dbh->copy_buffer_length = 0;
 
     if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_commit (result: 1)\n", THEADER_slow);
     return 1;
@@ -924,8 +1046,8 @@ int dbd_db_disconnect (SV * dbh, imp_dbh_t * imp_dbh)
     DBIc_ACTIVE_off(imp_dbh);
 
     if (NULL != imp_dbh->conn) {
-        /* Attempt a rollback */
-        if (0 != dbd_db_rollback(dbh, imp_dbh) && TRACE5_slow)
+        /* Attempt a rollback (not possible in pipeline mode: the server will do it for us) */
+        if (!imp_dbh->in_pipeline && 0 != dbd_db_rollback(dbh, imp_dbh) && TRACE5_slow)
             TRC(DBILOGFP, "%sdbd_db_disconnect: AutoCommit=off -> rollback\n", THEADER_slow);
 
         TRACE_PQFINISH;
@@ -933,6 +1055,13 @@ int dbd_db_disconnect (SV * dbh, imp_dbh_t * imp_dbh)
         imp_dbh->conn = NULL;
     }
 
+    /* Anything still queued in the pipeline is gone with the connection */
+    imp_dbh->in_pipeline = DBDPG_FALSE;
+    pg_db_pipeline_reset(aTHX_ imp_dbh);
+
+    /* Likewise for the statements in the statement cache */
+    pg_db_cache_clear(aTHX_ imp_dbh);
+
     /* We don't free imp_dbh since a reference still exists    */
     /* The DESTROY method is the only one to 'free' memory.    */
     /* Note that statement objects may still exists for this dbh! */
@@ -965,6 +1094,29 @@ void dbd_db_destroy (SV * dbh, imp_dbh_t * imp_dbh)
     sv_free((SV *)imp_dbh->savepoints);
     Safefree(imp_dbh->sqlstate);
     imp_dbh->sqlstate = NULL;
+    Safefree(imp_dbh->pipeline_sths);
+    imp_dbh->pipeline_sths = NULL;
+    Safefree(imp_dbh->copy_buffer);
+    imp_dbh->copy_buffer = NULL;
+    if (NULL != imp_dbh->column_cache) {
+        SvREFCNT_dec((SV*)imp_dbh->column_cache);
+        imp_dbh->column_cache = NULL;
+    }
+    pg_db_returning_clear(aTHX_ imp_dbh);
+    pg_db_cache_clear(aTHX_ imp_dbh);
+
+    if (NULL != imp_dbh->registered_types) {
+        HE *he;
+        hv_iterinit(imp_dbh->registered_types);
+        while ((he = hv_iternext(imp_dbh->registered_types)) != NULL) {
+            sql_type_info_t *type_info = INT2PTR(sql_type_info_t *, SvIV(HeVAL(he)));
+            Safefree(type_info->type_name);
+            Safefree(type_info->arrayout);
+            Safefree(type_info);
+        }
+        SvREFCNT_dec((SV*)imp_dbh->registered_types);
+        imp_dbh->registered_types = NULL;
+    }
 
     DBIc_IMPSET_off(imp_dbh);
 
@@ -1051,12 +1203,14 @@ SV * dbd_db_FETCH_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv)
             return dbd_st_FETCH_attrib (dbh, imp_dbh->do_tmp_sth, keysv);
         break;
 
-    case 12: /* pg_INV_WRITE  pg_utf8_flag */
+    case 12: /* pg_INV_WRITE  pg_utf8_flag  pg_zero_copy */
 
         if (strEQ("pg_INV_WRITE", key))
             retsv = newSViv((IV) INV_WRITE );
         else if (strEQ("pg_utf8_flag", key))
             retsv = newSViv((IV)imp_dbh->pg_utf8_flag);
+        else if (strEQ("pg_zero_copy", key))
+            retsv = newSViv((IV)imp_dbh->zero_copy);
         break;
 
     case 13: /* pg_errorlevel */
@@ -1065,7 +1219,7 @@ SV * dbd_db_FETCH_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv)
             retsv = newSViv((IV)imp_dbh->pg_errorlevel);
         break;
 
-    case 14: /* pg_lib_version  pg_prepare_now  pg_enable_utf8 */
+    case 14: /* pg_lib_version  pg_prepare_now  pg_enable_utf8  pg_copy_buffer */
 
         if (strEQ("pg_lib_version", key))
             retsv = newSViv((IV) PGLIBVERSION );
@@ -1073,6 +1227,8 @@ SV * dbd_db_FETCH_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv)
             retsv = newSViv((IV)imp_dbh->prepare_now);
         else if (strEQ("pg_enable_utf8", key))
             retsv = newSViv((IV)imp_dbh->pg_enable_utf8);
+        else if (strEQ("pg_copy_buffer", key))
+            retsv = newSViv((IV)imp_dbh->copy_buffer_size);
         break;
 
     case 15: /* pg_default_port pg_async_status pg_expand_array */
@@ -1085,7 +1241,7 @@ SV * dbd_db_FETCH_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv)
             retsv = newSViv((IV)imp_dbh->expand_array);
         break;
 
-    case 17: /* pg_server_prepare  pg_server_version  pg_int8_as_string */
+    case 17: /* pg_server_prepare  pg_server_version  pg_int8_as_string  pg_binary_results  pg_metadata_cache */
 
         if (strEQ("pg_server_prepare", key))
             retsv = newSViv((IV)imp_dbh->server_prepare);
@@ -1094,14 +1250,28 @@ SV * dbd_db_FETCH_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv)
         else if (strEQ("pg_int8_as_string", key)) {
               retsv = newSViv((IV)imp_dbh->pg_int8_as_string);
         }
+        else if (strEQ("pg_binary_results", key))
+            retsv = newSViv((IV)imp_dbh->binary_results);
+        else if (strEQ("pg_metadata_cache", key))
+            retsv = newSViv((IV)imp_dbh->metadata_cache_size);
         break;
 
-    case 18: /* pg_switch_prepared  pg_skip_deallocate */
+    case 18: /* pg_switch_prepared  pg_skip_deallocate  pg_pipeline_status  pg_statement_cache */
 
         if (strEQ("pg_switch_prepared", key))
             retsv = newSViv((IV)imp_dbh->switch_prepared);
         else if (strEQ("pg_skip_deallocate", key))
             retsv = newSViv((IV)imp_dbh->skip_deallocate);
+        else if (strEQ("pg_statement_cache", key))
+            retsv = newSViv((IV)imp_dbh->stmt_cache_size);
+        else if (strEQ("pg_pipeline_status", key)) {
+#if PGLIBVERSION >= 140000
+            TRACE_PQPIPELINESTATUS;
+            retsv = newSViv((IV)(imp_dbh->conn ? PQpipelineStatus(imp_dbh->conn) : 0));
+#else
+            retsv = newSViv(0);
+#endif
+        }
         break;
 
     case 23: /* pg_placeholder_nocolons */
@@ -1187,6 +1357,16 @@ int dbd_db_STORE_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv, SV * valuesv
         }
         break;
 
+    case 12: /* pg_zero_copy */
+
+        if (strEQ("pg_zero_copy", key)) {
+            imp_dbh->zero_copy = SvOK(valuesv) ? (int)SvIV(valuesv) : 0;
+            if (imp_dbh->zero_copy < 0)
+                imp_dbh->zero_copy = 0;
+            retval = 1;
+        }
+        break;
+
     case 13: /* pg_errorlevel */
 
         if (strEQ("pg_errorlevel", key)) {
@@ -1203,12 +1383,18 @@ int dbd_db_STORE_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv, SV * valuesv
         }
         break;
 
-    case 14: /* pg_prepare_now  pg_enable_utf8 */
+    case 14: /* pg_prepare_now  pg_enable_utf8  pg_copy_buffer */
 
         if (strEQ("pg_prepare_now", key)) {
             imp_dbh->prepare_now = newval ? DBDPG_TRUE : DBDPG_FALSE;
             retval = 1;
         }
+        else if (strEQ("pg_copy_buffer", key)) {
+            imp_dbh->copy_buffer_size = SvOK(valuesv) ? (int)SvIV(valuesv) : 0;
+            if (imp_dbh->copy_buffer_size < 0)
+                imp_dbh->copy_buffer_size = 0;
+            retval = 1;
+        }
 
         /*
            We don't want to check the client_encoding every single time we talk to the database,
@@ -1251,7 +1437,7 @@ int dbd_db_STORE_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv, SV * valuesv
         }
         break;
 
-    case 17: /* pg_server_prepare  pg_int8_as_string */
+    case 17: /* pg_server_prepare  pg_int8_as_string  pg_binary_results  pg_metadata_cache */
 
         if (strEQ("pg_server_prepare", key)) {
             imp_dbh->server_prepare = newval ? DBDPG_TRUE : DBDPG_FALSE;
@@ -1261,9 +1447,19 @@ int dbd_db_STORE_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv, SV * valuesv
             imp_dbh->pg_int8_as_string = newval!=0 ? DBDPG_TRUE : DBDPG_FALSE;
             retval = 1;
         }
+        else if (strEQ("pg_binary_results", key)) {
+            imp_dbh->binary_results = newval ? DBDPG_TRUE : DBDPG_FALSE;
+            retval = 1;
+        }
+        else if (strEQ("pg_metadata_cache", key)) {
+            imp_dbh->metadata_cache_size = SvOK(valuesv) ? (int)SvIV(valuesv) : 0;
+            if (imp_dbh->metadata_cache_size < 0)
+                imp_dbh->metadata_cache_size = 0;
+            retval = 1;
+        }
         break;
 
-    case 18: /* pg_switch_prepared  pg_skip_deallocate */
+    case 18: /* pg_switch_prepared  pg_skip_deallocate  pg_statement_cache */
 
         if (strEQ("pg_switch_prepared", key)) {
             if (SvOK(valuesv)) {
@@ -1277,6 +1473,11 @@ int dbd_db_STORE_attrib (SV * dbh, imp_dbh_t * imp_dbh, SV * keysv, SV * valuesv
                 retval = 1;
             }
         }
+        else if (strEQ("pg_statement_cache", key)) {
+            imp_dbh->stmt_cache_size = SvOK(valuesv) && SvIV(valuesv) > 0 ? (int)SvIV(valuesv) : 0;
+            pg_db_cache_trim(aTHX_ imp_dbh);
+            retval = 1;
+        }
         break;
 
     case 22: /* pg_placeholder_escaped */
@@ -1404,6 +1605,7 @@ SV * dbd_st_FETCH_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv)
                 ph_t *currph = ph_array_element(imp_sth, p);
                 SV *phkey = pg_st_placeholder_key(imp_sth, currph, p);
                 SV *val;
+                pg_st_array_text(aTHX_ currph);
                 if (NULL == currph->value) {
                     val = newSV(0);
                     if (!hv_store_ent(pvhv, phkey, val, 0)) {
@@ -1438,12 +1640,16 @@ SV * dbd_st_FETCH_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv)
         }
         break;
 
-    case 14: /* pg_prepare_now pg_current_row */
+    case 14: /* pg_prepare_now pg_current_row pg_stream_rows */
 
         if (strEQ("pg_prepare_now", key))
             retsv = newSViv((IV)imp_sth->prepare_now);
         else if (strEQ("pg_current_row", key))
-            retsv = newSViv(imp_sth->cur_tuple);
+            retsv = newSViv(imp_sth->streamed && DBIc_ACTIVE(imp_sth)
+                            ? imp_sth->stream_total - imp_sth->rows + imp_sth->cur_tuple
+                            : imp_sth->cur_tuple);
+        else if (strEQ("pg_stream_rows", key))
+            retsv = newSViv((IV)imp_sth->stream_rows);
         break;
 
     case 15: /* pg_prepare_name pg_async_status */
@@ -1454,10 +1660,12 @@ SV * dbd_st_FETCH_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv)
             retsv = newSViv((IV)imp_sth->async_status);
         break;
 
-    case 17: /* pg_server_prepare */
+    case 17: /* pg_server_prepare pg_binary_results */
 
         if (strEQ("pg_server_prepare", key))
             retsv = newSViv((IV)imp_sth->server_prepare);
+        else if (strEQ("pg_binary_results", key))
+            retsv = newSViv((IV)imp_sth->binary_results);
         break;
 
     case 18: /* pg_switch_prepared */
@@ -1518,11 +1726,12 @@ SV * dbd_st_FETCH_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv)
         else if (strEQ("TYPE", key)) {
             /* Need to convert the Pg type to ANSI/SQL type. */
             sql_type_info_t * type_info;
+            D_imp_dbh_from_sth;
             AV *av = newAV();
             retsv = newRV_inc(sv_2mortal((SV*)av));
             while(--fields >= 0) {
                 TRACE_PQFTYPE;
-                type_info = pg_type_data((int)PQftype(imp_sth->result, fields));
+                type_info = pg_db_type_data(imp_dbh, (int)PQftype(imp_sth->result, fields));
                 (void)av_store(av, fields, newSViv( type_info ? type_info->type.sql : 0 ) );
             }
         }
@@ -1561,11 +1770,12 @@ SV * dbd_st_FETCH_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv)
         }
         else if (strEQ("pg_type", key)) {
             sql_type_info_t * type_info;
+            D_imp_dbh_from_sth;
             AV *av = newAV();
             retsv = newRV_inc(sv_2mortal((SV*)av));
             while(--fields >= 0) {
                 TRACE_PQFTYPE;
-                type_info = pg_type_data((int)PQftype(imp_sth->result,fields));
+                type_info = pg_db_type_data(imp_dbh, (int)PQftype(imp_sth->result,fields));
                 (void)av_store(av, fields, newSVpv(type_info ? type_info->type_name : "unknown", 0));
             }
         }
@@ -1575,47 +1785,19 @@ SV * dbd_st_FETCH_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv)
 
         if (strEQ("NULLABLE", key)) {
             AV *av = newAV();
-            PGresult *result;
-            int status;
+            AV **info;
             D_imp_dbh_from_sth;
-            int nullable; /* 0 = not nullable, 1 = nullable 2 = unknown */
-            int y;
-            Oid o;
             retsv = newRV_inc(sv_2mortal((SV*)av));
 
+            /* We need the connection, so any rows still streaming in are thrown away */
+            pg_st_stream_discard(aTHX_ imp_dbh);
+
+            /* 0 = not nullable, 1 = nullable 2 = unknown */
+            info = pg_st_column_info(aTHX_ imp_dbh, imp_sth, fields);
             while(--fields >= 0) {
-                nullable=2;
-                TRACE_PQFTABLE;
-                o = PQftable(imp_sth->result, fields);
-                TRACE_PQFTABLECOL;
-                y = PQftablecol(imp_sth->result, fields);
-                if (InvalidOid != o && y > 0) { /* We know what table and column this came from */
-                    char sqlstring[128];
-                    sprintf(sqlstring, "SELECT attnotnull FROM pg_catalog.pg_attribute WHERE attrelid=%u AND attnum=%d", o, y);
-                    TRACE_PQEXEC;
-                    result = PQexec(imp_dbh->conn, sqlstring);
-                    TRACE_PQRESULTSTATUS;
-                    status = PQresultStatus(result);
-                    if (PGRES_TUPLES_OK == status) {
-                        TRACE_PQNTUPLES;
-                        if (PQntuples(result)!=0) {
-                            TRACE_PQGETVALUE;
-                            switch (PQgetvalue(result,0,0)[0]) {
-                            case 't':
-                                nullable = 0;
-                                break;
-                            case 'f':
-                            default:
-                                nullable = 1;
-                                break;
-                            }
-                        }
-                    }
-                    TRACE_PQCLEAR;
-                    PQclear(result);
-                }
-                (void)av_store(av, fields, newSViv(nullable));
+                (void)av_store(av, fields, newSViv(info[fields] ? SvIV(*av_fetch(info[fields], 0, 0)) : 2));
             }
+            Safefree(info);
         }
         break;
 
@@ -1715,12 +1897,16 @@ int dbd_st_STORE_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv, SV * valuesv
         }
         break;
 
-    case 14: /* pg_prepare_now */
+    case 14: /* pg_prepare_now pg_stream_rows */
 
         if (strEQ("pg_prepare_now", key)) {
             imp_sth->prepare_now = strEQ(value,"0") ? DBDPG_FALSE : DBDPG_TRUE;
             retval = 1;
         }
+        else if (strEQ("pg_stream_rows", key)) {
+            imp_sth->stream_rows = SvOK(valuesv) && SvIV(valuesv) > 0 ? (int)SvIV(valuesv) : 0;
+            retval = 1;
+        }
         break;
 
     case 15: /* pg_prepare_name */
@@ -1734,12 +1920,16 @@ int dbd_st_STORE_attrib (SV * sth, imp_sth_t * imp_sth, SV * keysv, SV * valuesv
         }
         break;
 
-    case 17: /* pg_server_prepare */
+    case 17: /* pg_server_prepare pg_binary_results */
 
         if (strEQ("pg_server_prepare", key)) {
             imp_sth->server_prepare = SvTRUE(valuesv) ? DBDPG_TRUE : DBDPG_FALSE;
             retval = 1;
         }
+        else if (strEQ("pg_binary_results", key)) {
+            imp_sth->binary_results = SvTRUE(valuesv) ? DBDPG_TRUE : DBDPG_FALSE;
+            retval = 1;
+        }
         break;
 
     case 18: /* pg_switch_prepared */
@@ -1870,6 +2060,357 @@ SV * pg_db_pg_notifies (SV * dbh, imp_dbh_t * imp_dbh)
 } /* end of pg_db_pg_notifies */
 
 
+/* ================================================================== */
+/*
+  Drain every pending notification (or at most max of them) in one call.
+  Returns a reference to an array of [name, pid, payload] arrays, or when
+  grouping, to a hash of name => [[pid, payload], ...]. With unique, repeats
+  of a name and payload already seen in this batch are dropped.
+*/
+SV * pg_db_pg_notifies_all (SV * dbh, imp_dbh_t * imp_dbh, int max, bool group, bool unique)
+{
+    dTHX;
+    PGnotify ** notifies = NULL;
+    int         count = 0;
+    int         size = 0;
+    int         round;
+    int         x;
+    AV *        ret = NULL;
+    HV *        groups = NULL;
+    HV *        seen = NULL;
+    SV *        keysv = NULL;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_notifies_all (max: %d)\n", THEADER_slow, max);
+
+    /* Collect them all first, so the results can be sized once */
+    do {
+        TRACE_PQCONSUMEINPUT;
+        if (0 == PQconsumeInput(imp_dbh->conn)) {
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            for (x = 0; x < count; x++) {
+                TRACE_PQFREEMEM;
+                PQfreemem(notifies[x]);
+            }
+            Safefree(notifies);
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pg_notifies_all (error)\n", THEADER_slow);
+            return &PL_sv_undef;
+        }
+
+        for (round = 0; max <= 0 || count < max; round++) {
+            PGnotify * notify;
+            TRACE_PQNOTIFIES;
+            notify = PQnotifies(imp_dbh->conn);
+            if (!notify)
+                break;
+            if (count == size) {
+                size = size ? size * 2 : 64;
+                Renew(notifies, size, PGnotify *);
+            }
+            notifies[count++] = notify;
+        }
+        /* A burst may have filled the input buffer, so read again until it is quiet */
+    } while (round > 0 && (max <= 0 || count < max));
+
+    if (group) {
+        groups = newHV();
+    }
+    else {
+        ret = newAV();
+        if (count > 0)
+            av_extend(ret, count - 1);
+    }
+    if (unique) {
+        seen = newHV();
+        keysv = newSV(0);
+    }
+
+    for (x = 0; x < count; x++) {
+        PGnotify * notify = notifies[x];
+        SV *       namesv;
+        SV *       payloadsv;
+        AV *       entry;
+
+        if (unique) {
+            /* Names cannot contain a NUL, so it can separate the two */
+            sv_setpv(keysv, notify->relname);
+            sv_catpvn(keysv, "", 1);
+            sv_catpv(keysv, notify->extra);
+            if (hv_exists_ent(seen, keysv, 0)) {
+                TRACE_PQFREEMEM;
+                PQfreemem(notify);
+                continue;
+            }
+            (void)hv_store_ent(seen, keysv, newSV(0), 0);
+        }
+
+        namesv = newSVpv(notify->relname, 0);
+        payloadsv = newSVpv(notify->extra, 0);
+        if (imp_dbh->pg_utf8_flag) {
+            SvUTF8_on(namesv);
+            SvUTF8_on(payloadsv);
+        }
+
+        entry = newAV();
+        if (group) {
+            HE * he = hv_fetch_ent(groups, namesv, 1, 0);
+            SV * listsv = HeVAL(he);
+            if (!SvROK(listsv))
+                sv_setsv(listsv, sv_2mortal(newRV_noinc((SV*)newAV())));
+            av_extend(entry, 1);
+            av_push(entry, newSViv(notify->be_pid));
+            av_push(entry, payloadsv);
+            av_push((AV*)SvRV(listsv), newRV_noinc((SV*)entry));
+            SvREFCNT_dec(namesv);
+        }
+        else {
+            av_extend(entry, 2);
+            av_push(entry, namesv);
+            av_push(entry, newSViv(notify->be_pid));
+            av_push(entry, payloadsv);
+            av_push(ret, newRV_noinc((SV*)entry));
+        }
+
+        TRACE_PQFREEMEM;
+        PQfreemem(notify);
+    }
+
+    Safefree(notifies);
+    if (unique) {
+        SvREFCNT_dec((SV*)seen);
+        SvREFCNT_dec(keysv);
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pg_notifies_all (count: %d)\n", THEADER_slow, count);
+    return sv_2mortal(newRV_noinc(group ? (SV*)groups : (SV*)ret));
+
+} /* end of pg_db_pg_notifies_all */
+
+
+/* ================================================================== */
+/* The current time in seconds, with microseconds */
+static double pg_now (pTHX)
+{
+    struct timeval tv;
+
+    PerlProc_gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+
+} /* end of pg_now */
+
+
+/* ================================================================== */
+/*
+  Wait until any of count sockets is readable, for at most timeout seconds
+  (forever if negative). Returns as poll() does: above 0 if one is readable,
+  0 if timed out, and below 0 on error, with errno set.
+*/
+static int pg_wait_readable (const int *socks, int count, double timeout)
+{
+#ifdef WIN32
+    fd_set         readfds;
+    struct timeval tv;
+    int            maxsock = 0;
+    int            i;
+
+    FD_ZERO(&readfds);
+    for (i=0; i < count; i++) {
+        FD_SET(socks[i], &readfds);
+        if (socks[i] > maxsock)
+            maxsock = socks[i];
+    }
+    if (timeout >= 0) {
+        tv.tv_sec = (long)timeout;
+        tv.tv_usec = (long)((timeout - (double)tv.tv_sec) * 1000000.0);
+    }
+    return select(maxsock + 1, &readfds, NULL, NULL, timeout < 0 ? NULL : &tv);
+#else
+    struct pollfd  pfd;
+    struct pollfd *pfds = &pfd;
+    int            msec;
+    int            status;
+    int            i;
+
+    if (count > 1)
+        New(0, pfds, count, struct pollfd);
+    for (i=0; i < count; i++) {
+        pfds[i].fd = socks[i];
+        pfds[i].events = POLLIN;
+        pfds[i].revents = 0;
+    }
+    if (timeout < 0)
+        msec = -1;
+    else if (timeout >= (double)(INT_MAX / 1000))
+        msec = INT_MAX / 1000 * 1000; /* Caller loops until the real deadline */
+    else
+        msec = (int)(timeout * 1000.0 + 0.999); /* Round up so we never wake early */
+    status = poll(pfds, (nfds_t)count, msec);
+    if (pfds != &pfd) {
+        int save_errno = errno;
+        Safefree(pfds);
+        errno = save_errno;
+    }
+    return status;
+#endif
+
+} /* end of pg_wait_readable */
+
+
+/* ================================================================== */
+/*
+  Wait for notifications to arrive, for at most timeout seconds (forever if
+  negative, and just a quick check if 0), then drain them as pg_notifies_all
+  does. Returns a reference to an array of [name, pid, payload] arrays, which
+  is empty if the time ran out, or undef if the connection failed.
+*/
+SV * pg_db_pg_wait_for_notify (SV * dbh, imp_dbh_t * imp_dbh, double timeout, int max)
+{
+    dTHX;
+    double deadline = timeout > 0 ? pg_now(aTHX) + timeout : 0;
+    double remaining = timeout;
+    SV *   ret;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_wait_for_notify (timeout: %g)\n", THEADER_slow, timeout);
+
+    for (;;) {
+        int sock;
+        int status;
+
+        ret = pg_db_pg_notifies_all(dbh, imp_dbh, max, DBDPG_FALSE, DBDPG_FALSE);
+        if (!SvROK(ret) || AvFILLp((AV*)SvRV(ret)) >= 0)
+            break;
+
+        if (timeout > 0) {
+            remaining = deadline - pg_now(aTHX);
+            if (remaining <= 0)
+                break;
+        }
+        else if (0 == timeout) {
+            break;
+        }
+
+        TRACE_PQSOCKET;
+        sock = PQsocket(imp_dbh->conn);
+        if (sock < 0) {
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "The connection to the server was lost");
+            ret = &PL_sv_undef;
+            break;
+        }
+
+        /* A readable socket may only hold part of a message, so go around again either way */
+        status = pg_wait_readable(&sock, 1, remaining);
+        if (status < 0) {
+            if (EINTR == errno) {
+                PERL_ASYNC_CHECK(); /* Let any Perl signal handlers run */
+                continue;
+            }
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, Strerror(errno));
+            ret = &PL_sv_undef;
+            break;
+        }
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pg_wait_for_notify\n", THEADER_slow);
+    return ret;
+
+} /* end of pg_db_pg_wait_for_notify */
+
+
+/* ================================================================== */
+/*
+  Look up a type by oid: first among the types built into DBD::Pg,
+  then among those added to this connection by pg_register_types
+*/
+sql_type_info_t * pg_db_type_data (imp_dbh_t * imp_dbh, int type_id)
+{
+    sql_type_info_t *type_info = pg_type_data(type_id);
+
+    if (NULL == type_info && NULL != imp_dbh->registered_types) {
+        dTHX;
+        SV **svp = hv_fetch(imp_dbh->registered_types, (char *)&type_id, sizeof(int), 0);
+        if (NULL != svp)
+            type_info = INT2PTR(sql_type_info_t *, SvIV(*svp));
+    }
+
+    return type_info;
+
+} /* end of pg_db_type_data */
+
+
+/* ================================================================== */
+/*
+  Add the user-defined and extension types of the current database, so that
+  they can be bound by pg_type, and arrays of them are returned as arrays.
+  Returns the number of newly registered types.
+*/
+int pg_db_register_types (SV * dbh, imp_dbh_t * imp_dbh)
+{
+    dTHX;
+    ExecStatusType status;
+    int            rows;
+    int            added = 0;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_register_types\n", THEADER_slow);
+
+    /* Composite types are left out, as every table has one (and an array of them) */
+    status = _result(aTHX_ imp_dbh,
+                     "SELECT t.oid, t.typname, t.typoutput::text, COALESCE(e.typdelim, t.typdelim) "
+                     "FROM pg_catalog.pg_type t "
+                     "LEFT JOIN pg_catalog.pg_type e ON (e.oid = t.typelem AND t.typcategory = 'A') "
+                     "WHERE t.oid >= 16384 AND t.typtype IN ('b','e','r','m') "
+                     "AND COALESCE(e.typtype, 'b') <> 'c'");
+
+    if (PGRES_TUPLES_OK != status) {
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_register_types (error)\n", THEADER_slow);
+        return -2;
+    }
+
+    if (NULL == imp_dbh->registered_types)
+        imp_dbh->registered_types = newHV();
+
+    TRACE_PQNTUPLES;
+    rows = PQntuples(imp_dbh->last_result);
+    for (int i = 0; i < rows; i++) {
+        sql_type_info_t *type_info;
+        int              type_id;
+
+        TRACE_PQGETVALUE;
+        type_id = atoi(PQgetvalue(imp_dbh->last_result, i, 0));
+
+        /* Statement handles may be using existing entries, so those are never replaced */
+        if (NULL != pg_db_type_data(imp_dbh, type_id))
+            continue;
+
+        Newz(0, type_info, 1, sql_type_info_t); /* freed in dbd_db_destroy */
+        type_info->type_id         = type_id;
+        TRACE_PQGETVALUE;
+        type_info->type_name       = savepv(PQgetvalue(imp_dbh->last_result, i, 1));
+        TRACE_PQGETVALUE;
+        type_info->arrayout        = savepv(PQgetvalue(imp_dbh->last_result, i, 2));
+        TRACE_PQGETVALUE;
+        type_info->array_delimiter = *PQgetvalue(imp_dbh->last_result, i, 3);
+        type_info->bind_ok         = DBDPG_TRUE;
+        type_info->quote           = quote_string;
+        type_info->dequote         = dequote_string;
+        type_info->type.sql        = 0;
+        type_info->svtype          = 0;
+
+        if (TRACE5_slow)
+            TRC(DBILOGFP, "%sRegistered type %s (%d)\n", THEADER_slow, type_info->type_name, type_id);
+
+        (void)hv_store(imp_dbh->registered_types, (char *)&type_id, sizeof(int), newSViv(PTR2IV(type_info)), 0);
+        added++;
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_register_types (added: %d)\n", THEADER_slow, added);
+    return added;
+
+} /* end of pg_db_register_types */
+
+
 /* ================================================================== */
 int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * attribs)
 {
@@ -1878,6 +2419,7 @@ int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * at
     STRLEN mypos=0; /* Used to find and set firstword */
     SV **svp; /* To help parse the arguments */
     char *statement;
+    stmt_cache_t *entry; /* statement cache entry, if any */
 
     statement_sv = pg_rightgraded_sv(aTHX_ statement_sv, imp_dbh->pg_utf8_flag);
     statement = SvPV_nolen(statement_sv);
@@ -1897,9 +2439,13 @@ int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * at
     imp_sth->totalsize         = 0;
     imp_sth->async_flag        = 0;
     imp_sth->async_status      = STH_NO_ASYNC;
+    imp_sth->stream_rows       = 0;
+    imp_sth->stream_total      = 0;
+    imp_sth->streamed          = DBDPG_FALSE;
     imp_sth->prepare_name      = NULL;
     imp_sth->firstword         = NULL;
     imp_sth->result            = NULL;
+    imp_sth->result_hold       = NULL;
     imp_sth->type_info         = NULL;
     imp_sth->PQvals            = NULL;
     imp_sth->PQlens            = NULL;
@@ -1913,7 +2459,15 @@ int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * at
     imp_sth->has_current       = DBDPG_FALSE; /* Are any of the params DEFAULT? */
     imp_sth->use_inout         = DBDPG_FALSE; /* Are any of the placeholders using inout? */
     imp_sth->all_bound         = DBDPG_FALSE; /* Have all placeholders been bound? */
+    imp_sth->binary_ready      = DBDPG_FALSE; /* Not until we have seen the column types */
+    imp_sth->decoders          = NULL;
+    imp_sth->decoder_flags     = 0;
     imp_sth->number_iterations = 0;
+    imp_sth->cache_key         = NULL;
+    imp_sth->cache_keylen      = 0;
+    imp_sth->cache_oids        = NULL;
+    imp_sth->returning_id      = 0;
+    imp_sth->returning_sql     = NULL;
 
     /* Create the array of placeholders and array of segments */
     ph_array_init(imp_sth);
@@ -1925,6 +2479,7 @@ int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * at
     imp_sth->prepare_now      = imp_dbh->prepare_now;
     imp_sth->dollaronly       = imp_dbh->dollaronly;
     imp_sth->nocolons         = imp_dbh->nocolons;
+    imp_sth->binary_results   = imp_dbh->binary_results;
 
     /* Parse and set any attributes passed in */
     if (attribs) {
@@ -1945,6 +2500,18 @@ int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * at
         if ((svp = hv_fetchs((HV*)SvRV(attribs),"pg_async", 0)) != NULL) {
             imp_sth->async_flag = (int)SvIV(*svp);
         }
+        if ((svp = hv_fetchs((HV*)SvRV(attribs),"pg_stream_rows", 0)) != NULL) {
+            imp_sth->stream_rows = SvOK(*svp) && SvIV(*svp) > 0 ? (int)SvIV(*svp) : 0;
+        }
+        if ((svp = hv_fetchs((HV*)SvRV(attribs),"pg_binary_results", 0)) != NULL) {
+            imp_sth->binary_results = SvTRUE(*svp) ? DBDPG_TRUE : DBDPG_FALSE;
+        }
+        /* Pg.pm has already checked this is an INSERT, and added any RETURNING */
+        if ((svp = hv_fetchs((HV*)SvRV(attribs),"pg_returning_id", 0)) != NULL && SvOK(*svp)) {
+            imp_sth->returning_id = (int)SvIV(*svp);
+            if (imp_sth->returning_id)
+                imp_sth->returning_sql = newSVpv(statement, 0); /* freed in dbd_st_destroy */
+        }
     }
 
     /* Figure out the first word in the statement */
@@ -1978,8 +2545,17 @@ int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * at
     /* Tell DBI to call destroy when this handle ends */
     DBIc_IMPSET_on(imp_sth);
 
-    /* Break the statement into segments by placeholder */
-    pg_st_split_statement(aTHX_ imp_sth, statement);
+    /* Break the statement into segments by placeholder, unless the statement cache already has */
+    imp_sth->cache_key = pg_st_cache_key(aTHX_ imp_dbh, imp_sth, statement, &imp_sth->cache_keylen);
+    if (NULL != imp_sth->cache_key
+        && NULL != (entry = pg_db_cache_find(aTHX_ imp_dbh, imp_sth->cache_key, imp_sth->cache_keylen))) {
+        pg_st_cache_load(aTHX_ imp_sth, entry);
+    }
+    else {
+        pg_st_split_statement(aTHX_ imp_sth, statement);
+        if (NULL != imp_sth->cache_key)
+            (void)pg_st_cache_store(aTHX_ imp_dbh, imp_sth);
+    }
 
     /*
       We prepare it right away if:
@@ -2002,6 +2578,7 @@ int dbd_st_prepare_sv (SV * sth, imp_sth_t * imp_sth, SV * statement_sv, SV * at
         && !imp_sth->direct
         && imp_sth->server_prepare
         && imp_sth->prepare_now
+        && !imp_dbh->in_pipeline
         ) {
         if (TRACE5_slow) TRC(DBILOGFP, "%sRunning an immediate prepare\n", THEADER_slow);
 
@@ -2438,6 +3015,8 @@ static void pg_st_split_statement (pTHX_ imp_sth_t * imp_sth, char * statement)
                 newph.isinout    = DBDPG_FALSE;
                 newph.valuelen   = 0;
                 newph.quotedlen  = 0;
+                newph.binarray   = NULL;
+                newph.binarraylen = 0;
 
                 New(0, newph.fooname, phsectionsize+1, char); /* freed in dbd_st_destroy */
                 Copy(statement-phsectionsize, newph.fooname, phsectionsize, char);
@@ -2526,6 +3105,8 @@ static void pg_st_split_statement (pTHX_ imp_sth_t * imp_sth, char * statement)
             newph.isinout    = DBDPG_FALSE;
             newph.valuelen   = 0;
             newph.quotedlen  = 0;
+            newph.binarray   = NULL;
+            newph.binarraylen = 0;
 
             ph_array_append(imp_sth, &newph);
         }
@@ -2577,6 +3158,12 @@ static int pg_st_prepare_statement (pTHX_ SV * sth, imp_sth_t * imp_sth)
 
     if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_prepare_statement\n", THEADER_slow);
 
+    /* An earlier statement handle may have left this statement prepared already */
+    if (pg_st_cache_take(aTHX_ imp_dbh, imp_sth)) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_prepare_statement (statement cache)\n", THEADER_slow);
+        return 0;
+    }
+
     Safefree(imp_sth->prepare_name);
     Newx(imp_sth->prepare_name, MAX_PREPARE_NAME, char); /* freed in dbd_st_destroy */
 
@@ -2615,6 +3202,9 @@ static int pg_st_prepare_statement (pTHX_ SV * sth, imp_sth_t * imp_sth)
     if (TSQL)
         TRC(DBILOGFP, "PREPARE %s AS %s;\n\n", imp_sth->prepare_name, strbuf_get(statement));
 
+    /* Any rows still streaming in for another statement are in the way */
+    pg_st_stream_discard(aTHX_ imp_dbh);
+
     if (imp_sth->async_flag & PG_ASYNC) {
         TRACE_PQSENDPREPARE;
         send_prepare_status =
@@ -2653,6 +3243,12 @@ static int pg_st_prepare_statement (pTHX_ SV * sth, imp_sth_t * imp_sth)
     if (PGRES_COMMAND_OK == prepare_status) {
         imp_sth->prepared_by_us = DBDPG_TRUE; /* Done here so deallocate is not called spuriously */
         imp_dbh->prepare_number++;
+        /* Remember the types used, in case this statement ends up in the statement cache */
+        if (NULL != imp_sth->cache_key && imp_sth->numphs > 0) {
+            Renew(imp_sth->cache_oids, imp_sth->numphs, Oid); /* freed in dbd_st_destroy */
+            for (int p = 0; p < imp_sth->numphs; p++)
+                imp_sth->cache_oids[p] = imp_sth->PQoids ? imp_sth->PQoids[p] : 0;
+        }
         if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_prepare_statement\n", THEADER_slow);
         return 0;
     }
@@ -2667,73 +3263,509 @@ static int pg_st_prepare_statement (pTHX_ SV * sth, imp_sth_t * imp_sth)
 } /* end of pg_st_prepare_statement */
 
 
-
 /* ================================================================== */
-int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV sql_type, SV * attribs, int is_inout, IV maxlen)
+/*
+  Make sure a statement is prepared on the server before it is executed many
+  times in pipeline mode, where a synchronous prepare is not possible.
+  Returns 1 if it is prepared, 0 if it cannot be, or -2 on error.
+*/
+int pg_st_server_prepare (SV * sth, imp_sth_t * imp_sth)
 {
     dTHX;
     D_imp_dbh_from_sth;
-    char * name = Nullch;
-    STRLEN name_len;
-    ph_t * currph = NULL;
-    int    x, phnum;
-    SV **  svp;
-    bool   reprepare = DBDPG_FALSE;
-    bool   found;
-    int    pg_type = 0;
-    char * value_string = NULL;
-    bool   is_array = DBDPG_FALSE;
-
-    PERL_UNUSED_VAR(maxlen);
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_bind_ph (ph_name: %s)\n",
-                    THEADER_slow,
-                    neatsvpv(ph_name,0));
 
-    if (0==imp_sth->numphs)
-        croak("Statement has no placeholders to bind");
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_server_prepare\n", THEADER_slow);
 
-    /* Check the placeholder name and transform to a standard form */
-    if (SvGMAGICAL(ph_name)) {
-        (void)mg_get(ph_name);
-    }
-    name = SvPV(ph_name, name_len);
-    if (PLACEHOLDER_COLON == imp_sth->placeholder_type) {
-        if (':' != *name) {
-            croak("Placeholders must begin with ':' when using the \":foo\" style");
-        }
-    }
-    else {
-        for (x=0; *(name+x); x++) {
-            if (!isDIGIT(*(name+x)) && (x!=0 || '$'!=*(name+x))) {
-                croak("Placeholder should be in the format \"$1\"\n");
-            }
-        }
+    if (!imp_sth->is_dml
+        || imp_sth->has_default
+        || imp_sth->has_current
+        || imp_sth->direct
+        || !imp_sth->numphs
+        || !imp_sth->server_prepare
+        || imp_sth->async_flag & PG_ASYNC
+        || imp_dbh->in_pipeline
+        || DBH_NO_ASYNC != imp_dbh->async_status) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_server_prepare (not preparable)\n", THEADER_slow);
+        return 0;
     }
 
-    /* Find the placeholder in question */
-    if (PLACEHOLDER_COLON == imp_sth->placeholder_type) {
-        found = 0;
-        for (int p=0; p < ph_array_count(imp_sth); p++) {
-            currph = ph_array_element(imp_sth, p);
-            if (0==strcmp(currph->fooname, name)) {
-                found = 1;
-                break;
-            }
-        }
-        if (!found)
-            croak("Cannot bind unknown placeholder '%s'", name);
-    }
-    else { /* We have a number */
-        if ('$' == *name)
-            name++;
-        phnum = atoi(name);
-        if (phnum < 1 || phnum > imp_sth->numphs)
-            croak("Cannot bind unknown placeholder %d (%s)", phnum, neatsvpv(ph_name,0));
-        currph = ph_array_element(imp_sth, phnum - 1);
+    if (NULL == imp_sth->prepare_name && pg_st_prepare_statement(aTHX_ sth, imp_sth)!=0) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_server_prepare (error)\n", THEADER_slow);
+        return -2;
     }
 
-    /* Check the value */
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_server_prepare (%s)\n", THEADER_slow, imp_sth->prepare_name);
+    return 1;
+
+} /* end of pg_st_server_prepare */
+
+
+
+/*
+  The statement cache (pg_statement_cache) remembers how recently prepared
+  statements were split into segments and placeholders, and the name of one
+  server-side prepared statement for each. A statement handle checks the name
+  out of the cache when it needs it, and hands it back when it is destroyed,
+  so the statement is only prepared once per connection.
+*/
+
+/* ================================================================== */
+static char * pg_st_cache_key (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth, const char * statement, STRLEN * keylen)
+{
+    const char * scs;
+    char       * key;
+    STRLEN       len;
+
+    if (imp_dbh->stmt_cache_size < 1
+        || NULL == imp_dbh->conn
+        || !imp_sth->is_dml
+        || imp_sth->direct
+        || !imp_sth->server_prepare
+        || imp_sth->async_flag)
+        return NULL;
+
+    /* Everything that changes how the statement is split goes into the first character */
+    TRACE_PQPARAMETERSTATUS;
+    scs = PQparameterStatus(imp_dbh->conn, "standard_conforming_strings");
+
+    len = strlen(statement);
+    New(0, key, len+2, char); /* freed in dbd_st_destroy */
+    key[0] = (char)('A'
+                    + (imp_sth->dollaronly ? 1 : 0)
+                    + (imp_sth->nocolons ? 2 : 0)
+                    + (imp_dbh->ph_escaped ? 4 : 0)
+                    + (NULL != scs && 0==strncmp(scs,"on",2) ? 8 : 0));
+    Copy(statement, key+1, len+1, char);
+    *keylen = len+1;
+    return key;
+
+} /* end of pg_st_cache_key */
+
+
+/* ================================================================== */
+static stmt_cache_t * pg_db_cache_find (pTHX_ imp_dbh_t * imp_dbh, const char * key, STRLEN keylen)
+{
+    SV          **svp;
+    stmt_cache_t *entry;
+
+    if (NULL == imp_dbh->stmt_cache)
+        return NULL;
+
+    if ((svp = hv_fetch(imp_dbh->stmt_cache, key, (I32)keylen, 0)) == NULL)
+        return NULL;
+
+    entry = INT2PTR(stmt_cache_t *, SvIV(*svp));
+
+    /* Move to the front of the list, as the most recently used */
+    if (entry != imp_dbh->stmt_cache_head) {
+        entry->prev->next = entry->next;
+        if (entry->next)
+            entry->next->prev = entry->prev;
+        else
+            imp_dbh->stmt_cache_tail = entry->prev;
+        entry->prev = NULL;
+        entry->next = imp_dbh->stmt_cache_head;
+        imp_dbh->stmt_cache_head->prev = entry;
+        imp_dbh->stmt_cache_head = entry;
+    }
+
+    return entry;
+
+} /* end of pg_db_cache_find */
+
+
+/* ================================================================== */
+static void pg_db_cache_remove (pTHX_ imp_dbh_t * imp_dbh, stmt_cache_t * entry)
+{
+
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        imp_dbh->stmt_cache_head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        imp_dbh->stmt_cache_tail = entry->prev;
+
+    (void)hv_delete(imp_dbh->stmt_cache, entry->key, (I32)entry->keylen, G_DISCARD);
+    imp_dbh->stmt_cache_count--;
+
+    for (int s = 0; s < entry->segcount; s++)
+        Safefree(entry->segs[s].segment);
+    for (int p = 0; p < entry->phcount; p++)
+        Safefree(entry->foonames[p]);
+    Safefree(entry->segs);
+    Safefree(entry->foonames);
+    Safefree(entry->prepare_name);
+    Safefree(entry->oids);
+    Safefree(entry->key);
+    Safefree(entry);
+
+} /* end of pg_db_cache_remove */
+
+
+/* ================================================================== */
+/*
+  Deallocate a statement owned by the cache. Returns false if this cannot be
+  done right now, in which case the caller should try again later.
+*/
+static bool pg_db_cache_deallocate (pTHX_ imp_dbh_t * imp_dbh, const char * prepare_name)
+{
+    char                    tempsqlstate[6];
+    PGTransactionStatusType tstatus;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_cache_deallocate (%s)\n", THEADER_slow, prepare_name);
+
+    if (imp_dbh->skip_deallocate || NULL == imp_dbh->conn) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_cache_deallocate (skipped)\n", THEADER_slow);
+        return DBDPG_TRUE;
+    }
+
+    /* Never interfere with anything in progress on the connection */
+    tstatus = pg_db_txn_status(aTHX_ imp_dbh);
+    if (imp_dbh->in_pipeline
+        || imp_dbh->copystate
+        || imp_dbh->async_status
+        || NULL != imp_dbh->stream_sth
+        || (PQTRANS_IDLE != tstatus && PQTRANS_INTRANS != tstatus)) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_cache_deallocate (deferred)\n", THEADER_slow);
+        return DBDPG_FALSE;
+    }
+
+    /* The caller's SQLSTATE should not change because of housekeeping */
+    strncpy(tempsqlstate, imp_dbh->sqlstate, sizeof(tempsqlstate)-1);
+    tempsqlstate[sizeof(tempsqlstate)-1]='\0';
+
+#if PGLIBVERSION >= 170000
+    CLEAR_LAST_RESULT(imp_dbh);
+    TRACE_PQCLOSEPREPARED;
+    imp_dbh->last_result = PQclosePrepared(imp_dbh->conn, prepare_name);
+    imp_dbh->result_shared = DBDPG_FALSE;
+    (void)_sqlstate(aTHX_ imp_dbh, imp_dbh->last_result);
+#else
+    {
+        char * stmt;
+        New(0, stmt, strlen("DEALLOCATE ") + strlen(prepare_name) + 1, char); /* freed below */
+        sprintf(stmt, "DEALLOCATE %s", prepare_name);
+        (void)_result(aTHX_ imp_dbh, stmt);
+        Safefree(stmt);
+    }
+#endif
+
+    strncpy(imp_dbh->sqlstate, tempsqlstate, 6);
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_cache_deallocate\n", THEADER_slow);
+    return DBDPG_TRUE;
+
+} /* end of pg_db_cache_deallocate */
+
+
+/* ================================================================== */
+/* Evict the least recently used entries until the cache fits within pg_statement_cache */
+static void pg_db_cache_trim (pTHX_ imp_dbh_t * imp_dbh)
+{
+
+    while (imp_dbh->stmt_cache_count > imp_dbh->stmt_cache_size) {
+        stmt_cache_t *entry = imp_dbh->stmt_cache_tail;
+
+        if (TRACE5_slow)
+            TRC(DBILOGFP, "%sRemoving statement cache entry (%s)\n", THEADER_slow, entry->key+1);
+
+        if (NULL != entry->prepare_name
+            && !pg_db_cache_deallocate(aTHX_ imp_dbh, entry->prepare_name))
+            break;
+
+        pg_db_cache_remove(aTHX_ imp_dbh, entry);
+    }
+
+} /* end of pg_db_cache_trim */
+
+
+/* ================================================================== */
+/* Free the whole statement cache. The server-side statements are left alone. */
+static void pg_db_cache_clear (pTHX_ imp_dbh_t * imp_dbh)
+{
+
+    while (NULL != imp_dbh->stmt_cache_head)
+        pg_db_cache_remove(aTHX_ imp_dbh, imp_dbh->stmt_cache_head);
+
+    if (NULL != imp_dbh->stmt_cache) {
+        SvREFCNT_dec((SV*)imp_dbh->stmt_cache);
+        imp_dbh->stmt_cache = NULL;
+    }
+
+} /* end of pg_db_cache_clear */
+
+
+/* ================================================================== */
+/* Add a freshly split statement to the cache */
+static stmt_cache_t * pg_st_cache_store (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+{
+    stmt_cache_t *entry;
+
+    if (TRACE5_slow)
+        TRC(DBILOGFP, "%sAdding statement cache entry (%s)\n", THEADER_slow, imp_sth->cache_key+1);
+
+    Newz(0, entry, 1, stmt_cache_t); /* freed in pg_db_cache_remove */
+    entry->key = savepvn(imp_sth->cache_key, imp_sth->cache_keylen);
+    entry->keylen           = imp_sth->cache_keylen;
+    entry->placeholder_type = imp_sth->placeholder_type;
+    entry->numsegs          = imp_sth->numsegs;
+    entry->numphs           = imp_sth->numphs;
+    entry->totalsize        = imp_sth->totalsize;
+
+    entry->segcount = seg_array_count(imp_sth);
+    Newz(0, entry->segs, entry->segcount, seg_t);
+    for (int s = 0; s < entry->segcount; s++) {
+        seg_t *currseg = seg_array_element(imp_sth, s);
+        entry->segs[s].placeholder = currseg->placeholder;
+        entry->segs[s].segment = currseg->segment ? savepv(currseg->segment) : NULL;
+    }
+
+    entry->phcount = ph_array_count(imp_sth);
+    Newz(0, entry->foonames, entry->phcount, char *);
+    for (int p = 0; p < entry->phcount; p++) {
+        ph_t *currph = ph_array_element(imp_sth, p);
+        entry->foonames[p] = currph->fooname ? savepv(currph->fooname) : NULL;
+    }
+
+    if (NULL == imp_dbh->stmt_cache)
+        imp_dbh->stmt_cache = newHV();
+    (void)hv_store(imp_dbh->stmt_cache, entry->key, (I32)entry->keylen, newSViv(PTR2IV(entry)), 0);
+
+    entry->next = imp_dbh->stmt_cache_head;
+    if (imp_dbh->stmt_cache_head)
+        imp_dbh->stmt_cache_head->prev = entry;
+    else
+        imp_dbh->stmt_cache_tail = entry;
+    imp_dbh->stmt_cache_head = entry;
+    imp_dbh->stmt_cache_count++;
+
+    pg_db_cache_trim(aTHX_ imp_dbh);
+
+    return entry;
+
+} /* end of pg_st_cache_store */
+
+
+/* ================================================================== */
+/* Fill in the segments and placeholders of a new statement handle from the cache */
+static void pg_st_cache_load (pTHX_ imp_sth_t * imp_sth, stmt_cache_t * entry)
+{
+
+    if (TRACE5_slow)
+        TRC(DBILOGFP, "%sUsing statement cache entry (%s)\n", THEADER_slow, entry->key+1);
+
+    for (int s = 0; s < entry->segcount; s++) {
+        seg_t newseg;
+        newseg.placeholder = entry->segs[s].placeholder;
+        newseg.segment = entry->segs[s].segment ? savepv(entry->segs[s].segment) : NULL; /* freed in dbd_st_destroy */
+        seg_array_append(imp_sth, &newseg);
+    }
+
+    for (int p = 0; p < entry->phcount; p++) {
+        ph_t newph;
+
+        newph.bind_type  = NULL;
+        newph.value      = NULL;
+        newph.quoted     = NULL;
+        newph.fooname    = entry->foonames[p] ? savepv(entry->foonames[p]) : NULL; /* freed in dbd_st_destroy */
+        newph.inout      = NULL;
+        newph.referenced = DBDPG_FALSE;
+        newph.defaultval = DBDPG_TRUE;
+        newph.isdefault  = DBDPG_FALSE;
+        newph.iscurrent  = DBDPG_FALSE;
+        newph.isinout    = DBDPG_FALSE;
+        newph.valuelen   = 0;
+        newph.quotedlen  = 0;
+        newph.binarray   = NULL;
+        newph.binarraylen = 0;
+
+        ph_array_append(imp_sth, &newph);
+    }
+
+    imp_sth->placeholder_type = entry->placeholder_type;
+    imp_sth->numsegs          = entry->numsegs;
+    imp_sth->numphs           = entry->numphs;
+    imp_sth->totalsize        = entry->totalsize;
+
+    DBIc_NUM_PARAMS(imp_sth) = imp_sth->numphs;
+
+} /* end of pg_st_cache_load */
+
+
+/* ================================================================== */
+/*
+  Take the cached server-side statement for this statement handle, if there is
+  one and it was prepared with the parameter types this handle would use.
+*/
+static bool pg_st_cache_take (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+{
+    stmt_cache_t *entry;
+
+    if (NULL == imp_sth->cache_key || NULL == imp_dbh->stmt_cache)
+        return DBDPG_FALSE;
+
+    if ((entry = pg_db_cache_find(aTHX_ imp_dbh, imp_sth->cache_key, imp_sth->cache_keylen)) == NULL
+        || NULL == entry->prepare_name)
+        return DBDPG_FALSE;
+
+    for (int p = 0; p < imp_sth->numphs; p++) {
+        ph_t *currph = ph_array_element(imp_sth, p);
+        Oid   wanted = (currph->defaultval || NULL == currph->bind_type) ? 0 : (Oid)currph->bind_type->type_id;
+        if (wanted != entry->oids[p]) {
+            if (TRACE5_slow)
+                TRC(DBILOGFP, "%sStatement cache entry has different types, not using (%s)\n",
+                    THEADER_slow, entry->prepare_name);
+            return DBDPG_FALSE;
+        }
+    }
+
+    if (TRACE5_slow)
+        TRC(DBILOGFP, "%sTaking statement (%s) from the statement cache\n", THEADER_slow, entry->prepare_name);
+
+    Safefree(imp_sth->prepare_name);
+    Safefree(imp_sth->cache_oids);
+    imp_sth->prepare_name = entry->prepare_name;
+    imp_sth->cache_oids = entry->oids;
+    imp_sth->prepared_by_us = DBDPG_TRUE;
+    entry->prepare_name = NULL;
+    entry->oids = NULL;
+
+    return DBDPG_TRUE;
+
+} /* end of pg_st_cache_take */
+
+
+/* ================================================================== */
+/*
+  Hand this statement handle's server-side statement over to the cache.
+  Returns false if the cache did not want it, and it should be deallocated.
+*/
+static bool pg_st_cache_give (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+{
+    stmt_cache_t *entry;
+
+    if (NULL == imp_sth->cache_key
+        || NULL == imp_sth->prepare_name
+        || imp_dbh->stmt_cache_size < 1
+        || NULL == imp_dbh->conn
+        || (imp_sth->numphs > 0 && NULL == imp_sth->cache_oids))
+        return DBDPG_FALSE;
+
+    /* The entry may have been evicted while this handle was alive */
+    if ((entry = pg_db_cache_find(aTHX_ imp_dbh, imp_sth->cache_key, imp_sth->cache_keylen)) == NULL)
+        entry = pg_st_cache_store(aTHX_ imp_dbh, imp_sth);
+
+    /* Keep only one server-side statement per entry */
+    if (NULL != entry->prepare_name)
+        return DBDPG_FALSE;
+
+    if (TRACE5_slow)
+        TRC(DBILOGFP, "%sGiving statement (%s) to the statement cache\n", THEADER_slow, imp_sth->prepare_name);
+
+    entry->prepare_name = imp_sth->prepare_name;
+    entry->oids = imp_sth->cache_oids;
+    imp_sth->prepare_name = NULL;
+    imp_sth->cache_oids = NULL;
+    imp_sth->prepared_by_us = DBDPG_FALSE;
+
+    return DBDPG_TRUE;
+
+} /* end of pg_st_cache_give */
+
+
+
+/* ================================================================== */
+/* A placeholder type has changed, so the server-side statement must be prepared again */
+static void pg_st_reprepare (pTHX_ SV * sth, imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+{
+    if (TRACE5_slow)
+        TRC(DBILOGFP, "%sBinding has forced a re-prepare\n", THEADER_slow);
+    /* The statement cache may keep the old statement; deallocate sets the prepare_name to NULL */
+    if (!pg_st_cache_give(aTHX_ imp_dbh, imp_sth)
+        && pg_st_deallocate_statement(aTHX_ sth, imp_sth)!=0) {
+        /* Deallocation failed. Let's mark it and move on */
+        Safefree(imp_sth->prepare_name);
+        imp_sth->prepare_name = NULL;
+        if (TRACEWARN_slow)
+            TRC(DBILOGFP, "%sFailed to deallocate!\n", THEADER_slow);
+    }
+
+} /* end of pg_st_reprepare */
+
+
+/* ================================================================== */
+int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV sql_type, SV * attribs, int is_inout, IV maxlen)
+{
+    dTHX;
+    D_imp_dbh_from_sth;
+    char * name = Nullch;
+    STRLEN name_len;
+    ph_t * currph = NULL;
+    int    x, phnum;
+    SV **  svp;
+    bool   reprepare = DBDPG_FALSE;
+    bool   found;
+    int    pg_type = 0;
+    char * value_string = NULL;
+    bool   is_array = DBDPG_FALSE;
+
+    PERL_UNUSED_VAR(maxlen);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_bind_ph (ph_name: %s)\n",
+                    THEADER_slow,
+                    neatsvpv(ph_name,0));
+
+    if (0==imp_sth->numphs)
+        croak("Statement has no placeholders to bind");
+
+    /* Check the placeholder name and transform to a standard form */
+    if (SvGMAGICAL(ph_name)) {
+        (void)mg_get(ph_name);
+    }
+    name = SvPV(ph_name, name_len);
+    if (PLACEHOLDER_COLON == imp_sth->placeholder_type) {
+        if (':' != *name) {
+            croak("Placeholders must begin with ':' when using the \":foo\" style");
+        }
+    }
+    else {
+        for (x=0; *(name+x); x++) {
+            if (!isDIGIT(*(name+x)) && (x!=0 || '$'!=*(name+x))) {
+                croak("Placeholder should be in the format \"$1\"\n");
+            }
+        }
+    }
+
+    /* Find the placeholder in question */
+    if (PLACEHOLDER_COLON == imp_sth->placeholder_type) {
+        found = 0;
+        for (int p=0; p < ph_array_count(imp_sth); p++) {
+            currph = ph_array_element(imp_sth, p);
+            if (0==strcmp(currph->fooname, name)) {
+                found = 1;
+                break;
+            }
+        }
+        if (!found)
+            croak("Cannot bind unknown placeholder '%s'", name);
+    }
+    else { /* We have a number */
+        if ('$' == *name)
+            name++;
+        phnum = atoi(name);
+        if (phnum < 1 || phnum > imp_sth->numphs)
+            croak("Cannot bind unknown placeholder %d (%s)", phnum, neatsvpv(ph_name,0));
+        currph = ph_array_element(imp_sth, phnum - 1);
+    }
+
+    /* Any binary form of an array bound earlier is now stale */
+    Safefree(currph->binarray);
+    currph->binarray = NULL;
+    currph->binarraylen = 0;
+
+    /* Check the value */
     if (SvTYPE(newvalue) > SVt_PVLV) { /* hook for later array logic    */
         croak("Cannot bind a non-scalar value (%s)", neatsvpv(newvalue,0));
     }
@@ -2757,15 +3789,47 @@ int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV
             imp_sth->has_current = DBDPG_TRUE;
         }
         else if (SvTYPE(SvRV(newvalue)) == SVt_PVAV) {
-            SV * quotedval;
-            quotedval = pg_stringify_array(newvalue,",",imp_dbh->pg_server_version,imp_dbh->pg_utf8_flag);
-            currph->valuelen = sv_len(quotedval);
-            Renew(currph->value, currph->valuelen+1, char); /* freed in dbd_st_destroy */
-            Copy(SvUTF8(quotedval) ? SvPVutf8_nolen(quotedval) : SvPV_nolen(quotedval),
-                 currph->value, currph->valuelen+1, char);
-            currph->bind_type = pg_type_data(PG_CSTRINGARRAY);
-            sv_2mortal(quotedval);
+            Safefree(currph->value);
+            currph->value = NULL;
+            currph->valuelen = 0;
             is_array = DBDPG_TRUE;
+
+            /*
+              A numeric array bound with an explicit array pg_type keeps that type, and
+              is also encoded in binary format for PQexecParams/PQexecPrepared if possible.
+              Other arrays are sent as text of an unspecified type, as always.
+            */
+            if (attribs
+                && !SvAMAGIC(newvalue)
+                && (svp = hv_fetchs((HV*)SvRV(attribs),"pg_type", 0)) != NULL
+                && pg_binary_array_numeric((int)SvIV(*svp))) {
+                sql_type_info_t *array_type = pg_type_data((int)SvIV(*svp));
+                if (currph->defaultval || currph->bind_type != array_type) {
+                    if (currph->defaultval)
+                        imp_sth->numbound++;
+                    currph->defaultval = DBDPG_FALSE;
+                    currph->bind_type = array_type;
+                    if (imp_sth->prepared_by_us && NULL != imp_sth->prepare_name)
+                        reprepare = DBDPG_TRUE;
+                }
+                currph->binarray = pg_binary_array_from_av(aTHX_ imp_dbh, array_type->type_id,
+                                                           (AV*)SvRV(newvalue), &currph->binarraylen);
+                if (NULL != currph->binarray)
+                    imp_sth->has_binary = DBDPG_TRUE;
+            }
+            else if (currph->defaultval)
+                currph->bind_type = pg_type_data(PG_CSTRINGARRAY);
+
+            /* An array sent in binary only needs its text form if that is ever asked for */
+            if (NULL == currph->binarray) {
+                SV * quotedval;
+                quotedval = pg_stringify_array(newvalue,",",imp_dbh->pg_server_version,imp_dbh->pg_utf8_flag);
+                currph->valuelen = sv_len(quotedval);
+                New(0, currph->value, currph->valuelen+1, char); /* freed in dbd_st_destroy */
+                Copy(SvUTF8(quotedval) ? SvPVutf8_nolen(quotedval) : SvPV_nolen(quotedval),
+                     currph->value, currph->valuelen+1, char);
+                sv_2mortal(quotedval);
+            }
         }
         else if (!SvAMAGIC(newvalue)) {
             /*
@@ -2794,6 +3858,8 @@ int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV
             imp_sth->numbound++;
             currph->bind_type = pg_type_data(PG_UNKNOWN);
         }
+        if (reprepare)
+            pg_st_reprepare(aTHX_ sth, imp_dbh, imp_sth);
         if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_bind_ph (special)\n", THEADER_slow);
         return 1;
     }
@@ -2811,7 +3877,7 @@ int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV
         imp_sth->numbound++;
 
     if (pg_type) {
-        if ((currph->bind_type = pg_type_data(pg_type))) {
+        if ((currph->bind_type = pg_db_type_data(imp_dbh, pg_type))) {
             if (!currph->bind_type->bind_ok) { /* Re-evaluate with new prepare */
                 croak("Cannot bind %s, pg_type %s not supported by DBD::Pg",
                       name, currph->bind_type->type_name);
@@ -2846,8 +3912,8 @@ int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV
         /* Possible re-prepare, depending on whether the type name also changes */
         if (imp_sth->prepared_by_us && NULL != imp_sth->prepare_name)
             reprepare = DBDPG_TRUE;
-        /* Mark this statement as having binary if the type is bytea */
-        if (PG_BYTEA==currph->bind_type->type_id)
+        /* Mark this statement as having binary if the type is bytea, or one we can encode */
+        if (PG_BYTEA==currph->bind_type->type_id || pg_binary_encodable(currph->bind_type->type_id))
             imp_sth->has_binary = DBDPG_TRUE;
     }
 
@@ -2882,18 +3948,8 @@ int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV
         currph->valuelen = 0;
     }
 
-    if (reprepare) {
-        if (TRACE5_slow)
-            TRC(DBILOGFP, "%sBinding has forced a re-prepare\n", THEADER_slow);
-        /* Deallocate sets the prepare_name to NULL */
-        if (pg_st_deallocate_statement(aTHX_ sth, imp_sth)!=0) {
-            /* Deallocation failed. Let's mark it and move on */
-            Safefree(imp_sth->prepare_name);
-            imp_sth->prepare_name = NULL;
-            if (TRACEWARN_slow)
-                TRC(DBILOGFP, "%sFailed to deallocate!\n", THEADER_slow);
-        }
-    }
+    if (reprepare)
+        pg_st_reprepare(aTHX_ sth, imp_dbh, imp_sth);
 
     if (TRACE7_slow)
         TRC    (DBILOGFP,
@@ -2909,7 +3965,117 @@ int dbd_bind_ph (SV * sth, imp_sth_t * imp_sth, SV * ph_name, SV * newvalue, IV
 
 
 /* ================================================================== */
-SV * pg_stringify_array(SV *input, const char * array_delim, int server_version, bool utf8) {
+/*
+  Append the body of an array literal for pg_stringify_array to value:
+  everything after the first opening brace. Each element is stringified
+  exactly once and written straight into the buffer, which is grown as needed.
+*/
+static void pg_stringify_array_body(pTHX_ SV * value, AV * lastarr, int array_depth, int inner_arrays, int array_items,
+                                    const char * array_delim, int server_version, bool utf8)
+{
+
+    const STRLEN delim_len = strlen(array_delim);
+    char * out = SvEND(value);
+    AV *   currarr = lastarr;
+    SV *   svitem;
+    SV **  svp;
+    char * string;
+    STRLEN stringlength;
+    int    xy, yz;
+
+    /* Make room for len more bytes, plus the trailing NUL */
+#define PG_ARRAY_RESERVE(len)                                          \
+    STMT_START {                                                       \
+        const STRLEN cur_ = (STRLEN)(out - SvPVX(value));              \
+        if (SvLEN(value) - cur_ <= (len))                              \
+            out = SvGROW(value, (cur_ + (len)) * 2 + 16) + cur_;       \
+    } STMT_END
+
+#define PG_ARRAY_PUT(str, len)                \
+    STMT_START {                              \
+        PG_ARRAY_RESERVE(len);                \
+        Copy((str), out, (len), char);        \
+        out += (len);                         \
+    } STMT_END
+
+    for (xy=1; xy < array_depth; xy++) {
+        PG_ARRAY_PUT("{", 1);
+    }
+
+    for (xy=0; xy < inner_arrays || !array_depth; xy++) {
+        if (array_depth) {
+            svitem = *av_fetch(lastarr, xy, 0);
+            if (!SvROK(svitem))
+                croak ("Not a valid array!");
+            currarr = (AV*)SvRV(svitem);
+            if (SvTYPE(currarr) != SVt_PVAV)
+                croak("Arrays must contain only scalars and other arrays!");
+            if (1+av_len(currarr) != array_items)
+                croak("Invalid array - all arrays must be of equal size");
+            PG_ARRAY_PUT("{", 1);
+        }
+        for (yz=0; yz < array_items; yz++) {
+            if (NULL == (svp = av_fetch(currarr, yz, 0))) {
+                PG_ARRAY_PUT("NULL", 4);
+            }
+            else {
+                svitem = *svp;
+
+                if (SvROK(svitem))
+                    croak("Arrays must contain only scalars and other arrays");
+
+                if (!SvOK(svitem)) { /* Insert NULL if we can */
+                    /* Only version 8.2 and up can handle NULLs in arrays */
+                    if (server_version < 80200)
+                        croak("Cannot use NULLs in arrays until version 8.2");
+                    PG_ARRAY_PUT("NULL", 4); /* Beware of array_nulls config param! */
+                }
+                else {
+                    /* avoid up- or down-grading the caller's value */
+                    svitem = pg_rightgraded_sv(aTHX_ svitem, utf8);
+                    string = SvPV(svitem, stringlength);
+                    /* Escape backslashes and double-quotes: at worst, every byte doubles */
+                    PG_ARRAY_RESERVE(stringlength * 2 + 2);
+                    *out++ = '"';
+                    while (stringlength--) {
+                        if ('"' == *string || '\\' == *string)
+                            *out++ = '\\';
+                        *out++ = *string++;
+                    }
+                    *out++ = '"';
+                }
+            }
+
+            if (yz < array_items-1)
+                PG_ARRAY_PUT(array_delim, delim_len);
+        }
+
+        if (!array_items) {
+            PG_ARRAY_PUT("\"\"", 2);
+        }
+
+        PG_ARRAY_PUT("}", 1);
+        if (xy < inner_arrays-1)
+            PG_ARRAY_PUT(array_delim, delim_len);
+        if (!array_depth)
+            break;
+    }
+
+    for (xy=0; xy<array_depth; xy++) {
+        PG_ARRAY_PUT("}", 1);
+    }
+
+#undef PG_ARRAY_PUT
+#undef PG_ARRAY_RESERVE
+
+    SvCUR_set(value, (STRLEN)(out - SvPVX(value)));
+    *SvEND(value) = '\0';
+
+} /* end of pg_stringify_array_body */
+
+
+/* ================================================================== */
+SV * pg_stringify_array(SV *input, const char * array_delim, int server_version, bool utf8) {
 
     dTHX;
     AV * toparr;
@@ -2919,10 +4085,7 @@ SV * pg_stringify_array(SV *input, const char * array_delim, int server_version,
     int array_depth = 0;
     int array_items;
     int inner_arrays = 0;
-    int xy, yz;
     SV * svitem;
-    char * string;
-    STRLEN stringlength;
     SV * value;
 
     if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_stringify_array\n", THEADER_slow);
@@ -2980,91 +4143,117 @@ SV * pg_stringify_array(SV *input, const char * array_delim, int server_version,
     /* How many items are in each inner array? */
     array_items = array_depth ? (1+(int)av_len((AV*)SvRV(*av_fetch(lastarr,0,0)))) : 1+(int)av_len(lastarr);
 
-    for (xy=1; xy < array_depth; xy++) {
-        sv_catpv(value, "{");
-    }
+    /* Start with room for a few bytes per item, so that small items never need a regrow */
+    SvGROW(value, 16 + (STRLEN)(array_depth ? inner_arrays : 1) * (STRLEN)(array_items + 1) * 8);
+    pg_stringify_array_body(aTHX_ value, lastarr, array_depth, inner_arrays, array_items,
+                            array_delim, server_version, utf8);
 
-    for (xy=0; xy < inner_arrays || !array_depth; xy++) {
-        if (array_depth) {
-            svitem = *av_fetch(lastarr, xy, 0);
-            if (!SvROK(svitem))
-                croak ("Not a valid array!");
-            currarr = (AV*)SvRV(svitem);
-            if (SvTYPE(currarr) != SVt_PVAV)
-                croak("Arrays must contain only scalars and other arrays!");
-            if (1+av_len(currarr) != array_items)
-                croak("Invalid array - all arrays must be of equal size");
-            sv_catpv(value, "{");
-        }
-        for (yz=0; yz < array_items; yz++) {
-            if (! av_exists(currarr, yz)) {
-                sv_catpv(value, "NULL");
-            }
-            else {
-                svitem = *av_fetch(currarr, yz, 0);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_stringify_array (string: %s)\n", THEADER_slow, neatsvpv(value,0));
+    return value;
 
-                if (SvROK(svitem))
-                    croak("Arrays must contain only scalars and other arrays");
+} /* end of pg_stringify_array */
 
-                if (!SvOK(svitem)) { /* Insert NULL if we can */
-                    /* Only version 8.2 and up can handle NULLs in arrays */
-                    if (server_version < 80200)
-                        croak("Cannot use NULLs in arrays until version 8.2");
-                    sv_catpv(value, "NULL"); /* Beware of array_nulls config param! */
-                }
-                else {
-                    sv_catpv(value, "\"");
-                    /* avoid up- or down-grading the caller's value */
-                    svitem = pg_rightgraded_sv(aTHX_ svitem, utf8);
-                    string = SvPV(svitem, stringlength);
-                    while (stringlength--) {
-                        /* Escape backslashes and double-quotes. */
-                        if ('\"' == *string || '\\' == *string)
-                            sv_catpvn(value, "\\", 1);
-                        sv_catpvn(value, string, 1);
-                        string++;
-                    }
-                    sv_catpv(value, "\"");
-                }
-            }
+/* ================================================================== */
+/*
+  Postgres allows at most six dimensions (MAXDIM), so the stack of arrays
+  being built can live on the C stack
+*/
+#define PG_ARRAY_MAXDIM 6
+
+/* Append to an array that has usually been pre-sized with av_extend */
+#define PG_AV_PUSH(av, sv)                        \
+    STMT_START {                                  \
+        if (AvFILLp(av) < AvMAX(av))              \
+            AvARRAY(av)[++AvFILLp(av)] = (sv);    \
+        else                                      \
+            av_push((av), (sv));                  \
+    } STMT_END
+
+/* Integer array items: parse the digits directly, leaving anything unusual to Perl */
+static SV * pg_array_item_iv(pTHX_ const char * value, STRLEN len)
+{
+    const char * p = value;
+    const char * const end = value + len;
+    bool neg = DBDPG_FALSE;
+    UV   uv = 0;
 
-            if (yz < array_items-1)
-                sv_catpv(value, array_delim);
-        }
+    if (p < end && '-' == *p) {
+        neg = DBDPG_TRUE;
+        p++;
+    }
+    if (p == end || end - p > (IVSIZE >= 8 ? 18 : 9))
+        return newSViv(SvIV(sv_2mortal(newSVpvn(value, len))));
+    for (; p < end; p++) {
+        if (*p < '0' || *p > '9')
+            return newSViv(SvIV(sv_2mortal(newSVpvn(value, len))));
+        uv = uv * 10 + (UV)(*p - '0');
+    }
+    return newSViv(neg ? -(IV)uv : (IV)uv);
 
-        if (!array_items) {
-            sv_catpv(value, "\"\"");
-        }
+} /* end of pg_array_item_iv */
 
-        sv_catpv(value, "}");
-        if (xy < inner_arrays-1)
-            sv_catpv(value, array_delim);
-        if (!array_depth)
-            break;
+/*
+  Create the SV for a single array item. The value is not NUL-terminated:
+  the character after it is borrowed (and restored) when a terminated
+  string is needed.
+*/
+static SV * pg_array_item(pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * coltype, char * value, STRLEN len)
+{
+    SV * sv;
+    char save;
+
+    switch (coltype->svtype) {
+    case 1:
+        return pg_array_item_iv(aTHX_ value, len);
+    case 2:
+        save = value[len];
+        value[len] = '\0';
+        sv = newSVnv(Atof(value));
+        value[len] = save;
+        return sv;
+    case 3:
+        if (imp_dbh->pg_bool_tf)
+            return newSVpvn('t' == *value ? "t" : "f", 1);
+        return newSViv('t' == *value ? 1 : 0);
+    default:
+        break;
     }
 
-    for (xy=0; xy<array_depth; xy++) {
-        sv_catpv(value, "}");
+    /* Bytea gets special dequoting, and is never marked as utf8 */
+    if (PG_BYTEAARRAY == coltype->type_id) {
+        STRLEN rawlen = len; /* dequoting shrinks len, but the borrowed byte is still here */
+        save = value[rawlen];
+        value[rawlen] = '\0';
+        coltype->dequote(aTHX_ value, &len);
+        sv = newSVpvn(value, len);
+        value[rawlen] = save;
+        return sv;
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_stringify_array (string: %s)\n", THEADER_slow, neatsvpv(value,0));
-    return value;
+    sv = newSVpvn(value, len);
+    if (imp_dbh->pg_utf8_flag)
+        SvUTF8_on(sv);
+    return sv;
 
-} /* end of pg_stringify_array */
+} /* end of pg_array_item */
 
-/* ================================================================== */
+/*
+  Turn the text output of an array into a Perl array reference in a single pass.
+  Quoted items are unescaped in place (the unescaped form is never longer), so
+  no scratch buffer is needed. The input must therefore be writable, as the
+  value of a PGresult is.
+*/
 static SV * pg_destringify_array(pTHX_ imp_dbh_t *imp_dbh, char * input, sql_type_info_t * coltype)
 {
 
-    AV*    av;              /* The main array we are returning a reference to */
-    AV*    currentav;       /* The current array level */
-    AV*    topav;           /* Where each item starts at */
-    char*  string;
-    STRLEN section_size = 0;
-    bool   in_quote = 0;
-    bool   seen_quotes = 0;
-    int    opening_braces = 0;
-    int    closing_braces = 0;
+    AV*     av;                           /* The main array we are returning a reference to */
+    AV*     stack[PG_ARRAY_MAXDIM+1];     /* The array being built at each level */
+    SSize_t width[PG_ARRAY_MAXDIM+1];     /* Size of the first finished array at each level */
+    int     depth = 0;
+    int     x;
+    const char delim = coltype->array_delimiter;
+    char *  value;
+    STRLEN  len;
 
     if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_destringify_array (string: %s quotechar: %c)\n",
                     THEADER_slow, input, coltype->array_delimiter);
@@ -3086,2958 +4275,5656 @@ static SV * pg_destringify_array(pTHX_ imp_dbh_t *imp_dbh, char * input, sql_typ
     if ('{' != *(input++))
         croak("Tried to destringify a non-array!: %s", input);
 
-    /* Count how deep this array goes */
-    while ('{' == *input) {
-        opening_braces++;
-        input++;
-    }
-    input -= opening_braces;
+    av = stack[0] = newAV();
+    for (x = 0; x <= PG_ARRAY_MAXDIM; x++)
+        width[x] = -1;
 
-    New(0, string, strlen(input), char); /* Freed at end of this function */
-    string[0] = '\0';
+    /*
+      A one-dimensional array is sized from its delimiter count. Delimiters inside
+      quoted items make this an overestimate, which is harmless. Arrays are always
+      rectangular, so nested arrays are sized from the first of their siblings.
+    */
+    if ('{' != *input && '}' != *input) {
+        SSize_t items = 0;
+        for (value = input; '\0' != *value; value++) {
+            if (delim == *value)
+                items++;
+        }
+        av_extend(av, items);
+    }
 
-    av = currentav = topav = newAV();
+    while (depth >= 0 && '\0' != *input) {
 
-    while (*input != '\0') {
-        if (in_quote) {
-            if ('"' == *input) {
-                in_quote = 0;
-                /* String will be stored by following delimiter or brace */
-                input++;
-                continue;
-            }
-            if ('\\' == *input) { /* Eat backslashes */
-                input++;
+        if ('{' == *input) {
+            AV * newav;
+            if (depth >= PG_ARRAY_MAXDIM) {
+                SvREFCNT_dec((SV*)av);
+                croak("Array has too many dimensions: %s", input);
             }
-            string[section_size++] = *input++;
+            newav = newAV();
+            PG_AV_PUSH(stack[depth], newRV_noinc((SV*)newav));
+            stack[++depth] = newav;
+            if (width[depth] > 0)
+                av_extend(newav, width[depth] - 1);
+            input++;
             continue;
         }
-        else if ('{' == *input) {
-            AV * const newav = newAV();
-            av_push(currentav, newRV_noinc((SV*)newav));
-            currentav = newav;
-        }
-        else if (coltype->array_delimiter == *input) {
-        }
-        else if ('}' == *input) {
-        }
-        else if ('"' == *input) {
-            in_quote = seen_quotes = (bool)1;
-        }
-        else {
-            string[section_size++] = *input;
-        }
 
-        if ('}' == *input || (coltype->array_delimiter == *input && '}' != *(input-1))) {
-            string[section_size] = '\0';
-            if (0 == section_size && !seen_quotes) {
-                /* Just an empty array */
-            }
-            else if (4 == section_size && 0 == strncmp(string, "NULL", 4) && '"' != *(input-1)) {
-                av_push(currentav, newSV(0));
-            }
-            else {
-                if (1 == coltype->svtype)
-                    av_push(currentav, newSViv(SvIV(sv_2mortal(newSVpvn(string,section_size)))));
-                else if (2 == coltype->svtype)
-                    av_push(currentav, newSVnv(SvNV(sv_2mortal(newSVpvn(string,section_size)))));
-                else if (3 == coltype->svtype) {
-                    if (imp_dbh->pg_bool_tf) {
-                        av_push(currentav, newSVpv('t' == *string ? "t" : "f", 0));
-                    }
-                    else
-                        av_push(currentav, newSViv('t' == *string ? 1 : 0));
-                }
-                else {
-                    // Bytea gets special dequoting
-                    if (0 == strncmp(coltype->type_name, "_bytea", 6)) {
-                        coltype->dequote(aTHX_ string, &section_size);
-                    }
-
-                    SV *sv = newSVpvn(string, section_size);
-
-                    // Mark as utf8 if needed (but never bytea)
-                    if (0 != strncmp(coltype->type_name, "_bytea", 6)
-                        && imp_dbh->pg_utf8_flag)
-                        SvUTF8_on(sv);
-
-                    av_push(currentav, sv);
+        if ('}' == *input) {
+            if (width[depth] < 0)
+                width[depth] = AvFILLp(stack[depth]) + 1;
+            depth--;
+            input++;
+            continue;
+        }
 
-                }
-            }
-            section_size = 0;
+        if (delim == *input) {
+            input++;
+            continue;
         }
 
-        /* Handle all touching closing braces */
-        if ('}' == *input) {
-            if (closing_braces) {
-                while ('}' == *input) {
-                    input++;
-                }
-            }
-            else {
-                while ('}' == *input) {
-                    closing_braces++;
+        if ('"' == *input) {
+            /* Quoted item: unescape it in place, it may be empty or the word NULL */
+            char * out;
+            value = out = ++input;
+            while ('"' != *input && '\0' != *input) {
+                if ('\\' == *input && '\0' != input[1]) /* Eat backslashes */
                     input++;
-                }
-                /* Set the new topav if required */
-                if ('\0' != *input && opening_braces > closing_braces) {
-                    closing_braces = opening_braces - closing_braces;
-                    while (closing_braces--) {
-                        topav = (AV*)SvRV(AvARRAY(topav)[0]);
-                    }
-                }
+                *out++ = *input++;
             }
-            currentav = topav;
+            len = (STRLEN)(out - value);
+            if ('"' == *input)
+                input++;
+            PG_AV_PUSH(stack[depth], pg_array_item(aTHX_ imp_dbh, coltype, value, len));
+            continue;
         }
-        else {
+
+        /* Unquoted item: runs until the next delimiter or closing brace */
+        value = input;
+        while (delim != *input && '}' != *input && '\0' != *input)
             input++;
-        }
+        len = (STRLEN)(input - value);
+        if (4 == len && 0 == strncmp(value, "NULL", 4))
+            PG_AV_PUSH(stack[depth], newSV(0));
+        else
+            PG_AV_PUSH(stack[depth], pg_array_item(aTHX_ imp_dbh, coltype, value, len));
     }
-    Safefree(string);
 
     if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_destringify_array\n", THEADER_slow);
     return newRV_noinc((SV*)av);
 
 } /* end of pg_destringify_array */
 
-SV * pg_upgraded_sv(pTHX_ SV *input) {
-    U8 *p, *end;
-    STRLEN len;
-    /* SvPV() can change the value SvUTF8() (for overloaded values and tied values). */
-    p = (U8*)SvPV(input, len);
-    if(SvUTF8(input)) return input;
-    for(end = p + len; p != end; p++) {
-        if(*p & 0x80) {
-            SV *output = sv_mortalcopy(input);
-            sv_utf8_upgrade(output);
-            return output;
-        }
-    }
-    return input;
-}
 
-SV * pg_downgraded_sv(pTHX_ SV *input) {
-    U8 *p, *end;
-    STRLEN len;
-    /* SvPV() can change the value SvUTF8() (for overloaded values and tied values). */
-    p = (U8*)SvPV(input, len);
-    if(!SvUTF8(input)) return input;
-    for(end = p + len; p != end; p++) {
-        if(*p & 0x80) {
-            SV *output = sv_mortalcopy(input);
-            sv_utf8_downgrade(output, DBDPG_FALSE);
-            return output;
-        }
+/* ================================================================== */
+/*
+  Can we decode a value of this type sent in binary format?
+  Used to decide if a statement handle can ask for binary results.
+  Types we know nothing about (PG_UNKNOWN) have binary formats of their own,
+  so they are always fetched as text.
+*/
+static bool pg_binary_decodable(int type_id)
+{
+    switch (type_id) {
+    case PG_BOOL:
+    case PG_INT2:
+    case PG_INT4:
+#if IVSIZE >= 8
+    case PG_INT8:
+#endif
+    case PG_OID:
+    case PG_FLOAT4:
+    case PG_FLOAT8:
+    case PG_BYTEA:
+    case PG_TEXT:
+    case PG_VARCHAR:
+    case PG_BPCHAR:
+    case PG_NAME:
+    case PG_CHAR:
+    case PG_JSON:
+    case PG_TIMESTAMP:
+    case PG_UUID:
+        return DBDPG_TRUE;
+    default:
+        return pg_binary_array_element(type_id) ? DBDPG_TRUE : DBDPG_FALSE;
     }
-    return input;
-}
 
-SV * pg_rightgraded_sv(pTHX_ SV *input, bool utf8) {
-    return utf8 ? pg_upgraded_sv(aTHX_ input) : pg_downgraded_sv(aTHX_ input);
-}
+} /* end of pg_binary_decodable */
 
-static void pg_db_detect_client_encoding_utf8(pTHX_ imp_dbh_t *imp_dbh) {
-    char *clean_encoding;
-    long unsigned int i, j;
-    TRACE_PQPARAMETERSTATUS;
-    const char * const client_encoding =
-        PQparameterStatus(imp_dbh->conn, "client_encoding");
-    if (NULL != client_encoding) {
-        STRLEN len = strlen(client_encoding);
-        New(0, clean_encoding, len + 1, char);
-        for (i = 0, j = 0; i < len; i++) {
-            const char c = toLOWER(client_encoding[i]);
-            if (isALPHA(c) || isDIGIT(c))
-                clean_encoding[j++] = c;
-        }
-        clean_encoding[j] = '\0';
-        imp_dbh->client_encoding_utf8 =
-            (strnEQ(clean_encoding, "utf8", 4) || strnEQ(clean_encoding, "unicode", 8))
-            ? DBDPG_TRUE : DBDPG_FALSE;
-        Safefree(clean_encoding);
-    }
-    else {
-        imp_dbh->client_encoding_utf8 = DBDPG_FALSE;
-    }
-}
 
 /* ================================================================== */
-long pg_quickexec (SV * dbh, const char * sql, const int asyncflag)
+/*
+  The element type of an array type we can decode from binary format,
+  or 0 if we cannot
+*/
+static int pg_binary_array_element(int type_id)
 {
-    dTHX;
-    D_imp_dbh(dbh);
-    ExecStatusType          status = PGRES_FATAL_ERROR; /* Assume the worst */
-    PGTransactionStatusType txn_status;
-    long                    rows = 0;
+    switch (type_id) {
+    case PG_BOOLARRAY:    return PG_BOOL;
+    case PG_INT2ARRAY:    return PG_INT2;
+    case PG_INT4ARRAY:    return PG_INT4;
+#if IVSIZE >= 8
+    case PG_INT8ARRAY:    return PG_INT8;
+#endif
+    case PG_FLOAT4ARRAY:  return PG_FLOAT4;
+    case PG_FLOAT8ARRAY:  return PG_FLOAT8;
+    case PG_TEXTARRAY:    return PG_TEXT;
+    case PG_VARCHARARRAY: return PG_VARCHAR;
+    default:              return 0;
+    }
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_quickexec (query: %s async: %d async_status: %d)\n",
-            THEADER_slow, sql, asyncflag, imp_dbh->async_status);
+} /* end of pg_binary_array_element */
 
-    if (NULL == imp_dbh->conn) {
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Database handle has been disconnected");
-        return -2;
-    }
 
-    /* Abort if we are in the middle of a copy */
-    if (imp_dbh->copystate != 0) {
-        if (PGRES_COPY_IN == imp_dbh->copystate) {
-            croak("Must call pg_putcopyend before issuing more commands");
-        }
-        else {
-            croak("Must call pg_getcopydata until no more rows before issuing more commands");
-        }
-    }
+/* ================================================================== */
+/*
+  Convert a Julian day number to a year, month, and day
+  (same algorithm as j2date in the Postgres source)
+*/
+static void pg_binary_j2date(int jd, int *year, int *month, int *day)
+{
+    unsigned int julian;
+    unsigned int quad;
+    unsigned int extra;
+    int          y;
+
+    julian = (unsigned int)jd;
+    julian += 32044;
+    quad = julian / 146097;
+    extra = (julian - quad * 146097) * 4 + 3;
+    julian += 60 + quad * 3 + extra / 146097;
+    quad = julian / 1461;
+    julian -= quad * 1461;
+    y = (int)(julian * 4 / 1461);
+    julian = ((y != 0) ? ((julian + 305) % 365) : ((julian + 306) % 366)) + 123;
+    y += (int)quad * 4;
+    *year = y - 4800;
+    quad = julian * 2141 / 65536;
+    *day = (int)(julian - 7834 * quad / 256);
+    *month = (int)((quad + 10) % 12 + 1);
+
+} /* end of pg_binary_j2date */
 
-    /* If we are still waiting on an async, handle it */
-    switch (imp_dbh->async_status) {
-    case DBH_NO_ASYNC:
+
+/* ================================================================== */
+/*
+  Store a single value sent in binary format (network byte order) into an SV,
+  giving the same result as the text format would.
+  Returns false if the type or length is not one we can handle.
+*/
+static bool pg_binary_to_sv(pTHX_ imp_dbh_t * imp_dbh, SV * sv, int type_id, const unsigned char * value, int len, int chopblanks)
+{
+    switch (type_id) {
+
+    case PG_BOOL:
+        if (1 != len)
+            return DBDPG_FALSE;
+        if (imp_dbh->pg_bool_tf)
+            sv_setpvn(sv, *value ? "t" : "f", 1);
+        else
+            sv_setiv(sv, *value ? 1 : 0);
         break;
 
-    case DBH_ASYNC_CONNECT:
-    case DBH_ASYNC_CONNECT_POLL:
-        if (TRACE5_slow) TRC(DBILOGFP, "%snot yet connected\n", THEADER_slow);
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (async rows: %ld)\n", THEADER_slow, rows);
-        return -1;
+    case PG_INT2:
+        if (2 != len)
+            return DBDPG_FALSE;
+        sv_setiv(sv, (int16_t)PG_BINARY_U16(value));
+        break;
 
-    default:
-        if (TRACE5_slow) TRC(DBILOGFP, "%shandling old async\n", THEADER_slow);
-        rows = handle_old_async(aTHX_ dbh, imp_dbh, asyncflag);
-        if (rows) {
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (async rows: %ld)\n", THEADER_slow, rows);
-            return rows;
+    case PG_INT4:
+        if (4 != len)
+            return DBDPG_FALSE;
+        sv_setiv(sv, (int32_t)PG_BINARY_U32(value));
+        break;
+
+#if IVSIZE >= 8
+    case PG_INT8:
+        if (8 != len)
+            return DBDPG_FALSE;
+        if (imp_dbh->pg_int8_as_string)
+            sv_setpvf(sv, "%" IVdf, (IV)(int64_t)PG_BINARY_U64(value));
+        else
+            sv_setiv(sv, (IV)(int64_t)PG_BINARY_U64(value));
+        break;
+#endif
+
+    case PG_OID:
+        if (4 != len)
+            return DBDPG_FALSE;
+        sv_setuv(sv, (UV)PG_BINARY_U32(value));
+        break;
+
+    case PG_FLOAT4:
+        {
+            uint32_t bits;
+            float    f;
+            char     buf[32];
+            int      digits;
+            if (4 != len)
+                return DBDPG_FALSE;
+            bits = PG_BINARY_U32(value);
+            Copy(&bits, &f, 1, float);
+            /* Use the shortest decimal form, as the server does, so that 0.1 stays 0.1 */
+            for (digits = FLT_DIG; ; digits++) {
+                snprintf(buf, sizeof(buf), "%.*g", digits, (double)f);
+                if (digits >= 9 || (float)strtod(buf, NULL) == f)
+                    break;
+            }
+            sv_setnv(sv, strtod(buf, NULL));
         }
-    }
+        break;
 
-    /* If not autocommit, start a new transaction */
-    if (!imp_dbh->done_begin && !DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        status = _result(aTHX_ imp_dbh, "begin");
-        if (PGRES_COMMAND_OK != status) {
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: begin failed)\n", THEADER_slow);
-            return -2;
+    case PG_FLOAT8:
+        {
+            uint64_t bits;
+            double   d;
+            if (8 != len)
+                return DBDPG_FALSE;
+            bits = PG_BINARY_U64(value);
+            Copy(&bits, &d, 1, double);
+            sv_setnv(sv, (NV)d);
         }
-        imp_dbh->done_begin = DBDPG_TRUE;
-        /* If read-only mode, make it so */
-        if (imp_dbh->txn_read_only) {
-            status = _result(aTHX_ imp_dbh, "set transaction read only");
-            if (PGRES_COMMAND_OK != status) {
-                TRACE_PQERRORMESSAGE;
-                pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: set transaction read only failed)\n", THEADER_slow);
-                return -2;
-            }
+        break;
+
+    case PG_BPCHAR:
+        if (chopblanks) {
+            while (len && ' ' == value[len-1])
+                --len;
         }
-    }
+        sv_setpvn(sv, (const char *)value, (STRLEN)len);
+        break;
 
-    /*
-      We want txn mode if AutoCommit
-     */
+    case PG_BYTEA:
+    case PG_TEXT:
+    case PG_VARCHAR:
+    case PG_NAME:
+    case PG_CHAR:
+    case PG_JSON:
+        /* The binary format of these is the same as the text format, less any escaping */
+        sv_setpvn(sv, (const char *)value, (STRLEN)len);
+        break;
 
+    case PG_TIMESTAMP:
+        {
+            /* Microseconds since 2000-01-01, returned in ISO format */
+            int64_t ts, days, usecs;
+            int     year, month, day, hour, minute, second, fraction;
+            char    buf[64];
+            int     buflen;
+
+            if (8 != len)
+                return DBDPG_FALSE;
+            ts = (int64_t)PG_BINARY_U64(value);
+            if (INT64_MAX == ts) {
+                sv_setpvs(sv, "infinity");
+                break;
+            }
+            if (INT64_MIN == ts) {
+                sv_setpvs(sv, "-infinity");
+                break;
+            }
 
-    /* Asynchronous commands get kicked off and return undef */
-    if (asyncflag & PG_ASYNC) {
-        if (TRACE4_slow) TRC(DBILOGFP, "%sGoing asynchronous with do()\n", THEADER_slow);
-        TRACE_PQSENDQUERY;
-        if (! PQsendQuery(imp_dbh->conn, sql)) {
-            if (TRACE4_slow) TRC(DBILOGFP, "%sPQsendQuery failed\n", THEADER_slow);
-            _fatal_sqlstate(aTHX_ imp_dbh);
+            days = ts / INT64_C(86400000000);
+            usecs = ts % INT64_C(86400000000);
+            if (usecs < 0) {
+                usecs += INT64_C(86400000000);
+                days--;
+            }
+            pg_binary_j2date((int)(days + 2451545), &year, &month, &day); /* 2451545 is 2000-01-01 */
+
+            hour     = (int)(usecs / INT64_C(3600000000));
+            usecs   -= (int64_t)hour * INT64_C(3600000000);
+            minute   = (int)(usecs / 60000000);
+            usecs   -= (int64_t)minute * 60000000;
+            second   = (int)(usecs / 1000000);
+            fraction = (int)(usecs - (int64_t)second * 1000000);
+
+            buflen = snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d",
+                              year > 0 ? year : -(year - 1), month, day, hour, minute, second);
+            if (fraction) {
+                /* Trailing zeroes are not shown */
+                int digits = 6;
+                while (0 == fraction % 10) {
+                    fraction /= 10;
+                    digits--;
+                }
+                buflen += snprintf(buf + buflen, sizeof(buf) - buflen, ".%0*d", digits, fraction);
+            }
+            if (year <= 0)
+                buflen += snprintf(buf + buflen, sizeof(buf) - buflen, " BC");
+            sv_setpvn(sv, buf, (STRLEN)buflen);
+        }
+        break;
 
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: async do failed)\n", THEADER_slow);
-            return -2;
+    case PG_UUID:
+        {
+            static const char hexdigits[] = "0123456789abcdef";
+            char buf[36];
+            int  i, j = 0;
+
+            if (16 != len)
+                return DBDPG_FALSE;
+            for (i = 0; i < 16; i++) {
+                if (4 == i || 6 == i || 8 == i || 10 == i)
+                    buf[j++] = '-';
+                buf[j++] = hexdigits[value[i] >> 4];
+                buf[j++] = hexdigits[value[i] & 0x0f];
+            }
+            sv_setpvn(sv, buf, 36);
         }
-        imp_dbh->async_status = DBH_ASYNC;
-        imp_dbh->async_sth = NULL; /* Needed? */
+        break;
 
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (async)\n", THEADER_slow);
-        return 0;
+    default:
+        if (pg_binary_array_element(type_id))
+            return pg_binary_array_to_sv(aTHX_ imp_dbh, sv, type_id, value, len);
+        return DBDPG_FALSE;
     }
 
-    if (TSQL) TRC(DBILOGFP, "%s;\n\n", sql);
+    return DBDPG_TRUE;
 
-    CLEAR_LAST_RESULT(imp_dbh);
+} /* end of pg_binary_to_sv */
 
-    TRACE_PQEXEC;
-    imp_dbh->last_result = PQexec(imp_dbh->conn, sql);
-    imp_dbh->result_shared = DBDPG_FALSE;
 
-    status = _sqlstate(aTHX_ imp_dbh, imp_dbh->last_result);
+/* ================================================================== */
+/*
+  Fill one dimension of an array sent in binary format, recursing into the
+  next dimension until we reach the elements themselves. Each element is
+  a length (-1 for NULL) followed by the element in binary format.
+*/
+static bool pg_binary_array_fill(pTHX_ imp_dbh_t * imp_dbh, AV * av, const int * dims, int ndim, int element_type,
+                                 const unsigned char ** pos, const unsigned char * end)
+{
+    const bool utf8 = imp_dbh->pg_utf8_flag && (PG_TEXT == element_type || PG_VARCHAR == element_type);
+    int i;
 
-    imp_dbh->copystate = 0; /* Assume not in copy mode until told otherwise */
+    av_extend(av, dims[0] - 1);
 
-    if (TRACE4_slow) TRC(DBILOGFP, "%sGot a status of %d\n", THEADER_slow, status);
-    switch ((int)status) {
-    case PGRES_TUPLES_OK:
-        TRACE_PQNTUPLES;
-        rows = PQntuples(imp_dbh->last_result);
-        break;
-    case PGRES_COMMAND_OK:
-        /* non-select statement */
-        TRACE_PQCMDTUPLES;
-        rows = atol(PQcmdTuples(imp_dbh->last_result));
-        break;
-    case PGRES_COPY_OUT:
-    case PGRES_COPY_IN:
-    case PGRES_COPY_BOTH:
-        /* Copy Out/In data transfer in progress */
-        imp_dbh->copystate = status;
-        imp_dbh->copybinary = PQbinaryTuples(imp_dbh->last_result);
-        rows = -1;
-        break;
-    case PGRES_EMPTY_QUERY:
-    case PGRES_BAD_RESPONSE:
-    case PGRES_NONFATAL_ERROR:
-        rows = -2;
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-        break;
-    case PGRES_FATAL_ERROR:
-    default:
-        rows = -2;
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-        break;
-    }
+    for (i = 0; i < dims[0]; i++) {
+        SV *   item;
+        int    len;
 
-    if (NULL == imp_dbh->last_result) {
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (no result)\n", THEADER_slow);
-        return -2;
-    }
+        if (ndim > 1) {
+            AV * const subav = newAV();
+            av_push(av, newRV_noinc((SV*)subav));
+            if (!pg_binary_array_fill(aTHX_ imp_dbh, subav, dims + 1, ndim - 1, element_type, pos, end))
+                return DBDPG_FALSE;
+            continue;
+        }
 
-    TRACE_PQTRANSACTIONSTATUS;
-    txn_status = PQtransactionStatus(imp_dbh->conn);
+        if (end - *pos < 4)
+            return DBDPG_FALSE;
+        len = (int32_t)PG_BINARY_U32(*pos);
+        *pos += 4;
 
-    if (PQTRANS_IDLE == txn_status) {
-        imp_dbh->done_begin = DBDPG_FALSE;
-        imp_dbh->copystate=0;
-        /* If begin_work has been called, turn AutoCommit back on and BegunWork off */
-        if (DBIc_has(imp_dbh, DBIcf_BegunWork)!=0) {
-            DBIc_set(imp_dbh, DBIcf_AutoCommit, 1);
-            DBIc_set(imp_dbh, DBIcf_BegunWork, 0);
+        if (len < 0) {
+            av_push(av, newSV(0));
+            continue;
         }
+        if (end - *pos < len)
+            return DBDPG_FALSE;
+
+        item = newSV(0);
+        av_push(av, item);
+        if (!pg_binary_to_sv(aTHX_ imp_dbh, item, element_type, *pos, len, 0))
+            return DBDPG_FALSE;
+        if (utf8)
+            SvUTF8_on(item);
+        *pos += len;
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (rows: %ld, txn_status: %d)\n",
-                  THEADER_slow, rows, txn_status);
-    return rows;
+    return DBDPG_TRUE;
 
-} /* end of pg_quickexec */
+} /* end of pg_binary_array_fill */
 
 
 /* ================================================================== */
-/* Return value <= -2:error, >=0:ok row count, (-1=unknown count) */
-static int pq_send_prepared_query (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+/*
+  Store an array sent in binary format into an SV as an array reference,
+  giving the same result as pg_destringify_array would for the text format.
+  The header is the number of dimensions, a has-nulls flag, and the element
+  type, followed by the size and lower bound of each dimension.
+*/
+static bool pg_binary_array_to_sv(pTHX_ imp_dbh_t * imp_dbh, SV * sv, int type_id, const unsigned char * value, int len)
 {
-    TRACE_PQSENDQUERYPREPARED;
-    return PQsendQueryPrepared (imp_dbh->conn,
-                                imp_sth->prepare_name, imp_sth->numphs,
-                                imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts,
-                                0);
-}
+    const unsigned char * pos = value;
+    const unsigned char * const end = value + len;
+    int    dims[PG_ARRAY_MAXDIM];
+    int    ndim;
+    int    i;
+    double items = 1;
+    AV *   av;
+
+    if (len < 12)
+        return DBDPG_FALSE;
+    ndim = (int32_t)PG_BINARY_U32(pos);
+    if (ndim < 0 || ndim > PG_ARRAY_MAXDIM)
+        return DBDPG_FALSE;
+    if ((int)PG_BINARY_U32(pos + 8) != pg_binary_array_element(type_id))
+        return DBDPG_FALSE;
+    pos += 12;
 
-long dbd_st_execute (SV * sth, imp_sth_t * imp_sth)
-{
-    dTHX;
-    D_imp_dbh_from_sth;
-    int           status, p, s;
-    STRLEN        execsize;
-    strbuf_t     *statement = NULL;
-    long          ret;
-    PQExecType    pqtype;
+    if (end - pos < 8 * ndim)
+        return DBDPG_FALSE;
+    for (i = 0; i < ndim; i++) {
+        dims[i] = (int32_t)PG_BINARY_U32(pos); /* the lower bound that follows is not used */
+        if (dims[i] < 0)
+            return DBDPG_FALSE;
+        items *= dims[i];
+        pos += 8;
+    }
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_execute\n", THEADER_slow);
+    /* Every element takes at least four bytes, so do not trust sizes that say otherwise */
+    if (ndim && items * 4 > (double)(end - pos))
+        return DBDPG_FALSE;
 
-    if (NULL == imp_dbh->conn) {
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "Cannot call execute on a disconnected database handle");
-        return -2;
+    av = newAV();
+    /* An empty array has no dimensions at all */
+    if (ndim && !pg_binary_array_fill(aTHX_ imp_dbh, av, dims, ndim, pg_binary_array_element(type_id), &pos, end)) {
+        SvREFCNT_dec((SV*)av);
+        return DBDPG_FALSE;
     }
 
-    /* Abort if we are in the middle of a copy */
-    if (imp_dbh->copystate!=0)
-        croak("Must call pg_endcopy before issuing more commands");
+    sv_setsv(sv, sv_2mortal(newRV_noinc((SV*)av)));
+    return DBDPG_TRUE;
 
-    /* Ensure that all the placeholders have been bound */
-    if (!imp_sth->all_bound && imp_sth->numphs!=0) {
-        for (p=0; p < ph_array_count(imp_sth); p++) {
-            ph_t *currph = ph_array_element(imp_sth, p);
-            if (NULL == currph->bind_type) {
-                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "execute called with an unbound placeholder");
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: unbound placeholder)\n", THEADER_slow);
-                return -2;
-            }
-            if (currph->isinout) {
-                currph->valuelen = sv_len(currph->inout);
-                Renew(currph->value, currph->valuelen+1, char);
-                Copy(SvPV_nolen(currph->inout), currph->value, currph->valuelen+1, char);
-                currph->value[currph->valuelen] = '\0';
-            }
-        }
-        imp_sth->all_bound = DBDPG_TRUE;
+} /* end of pg_binary_array_to_sv */
+
+
+/* ================================================================== */
+/*
+  Can a placeholder of this type be sent to the server in binary format?
+  (bytea is always sent as binary, and is handled separately)
+*/
+static bool pg_binary_encodable(int type_id)
+{
+    switch (type_id) {
+    case PG_BOOL:
+    case PG_INT2:
+    case PG_INT4:
+    case PG_INT8:
+    case PG_OID:
+    case PG_FLOAT4:
+    case PG_FLOAT8:
+    case PG_UUID:
+    case PG_TIMESTAMP:
+    case PG_TIMESTAMPTZ:
+        return DBDPG_TRUE;
+    default:
+        return DBDPG_FALSE;
     }
 
-    /* Check for old async transactions */
-    switch (imp_dbh->async_status) {
-    case DBH_NO_ASYNC:
-        break;
+} /* end of pg_binary_encodable */
 
-    case DBH_ASYNC_CONNECT:
-    case DBH_ASYNC_CONNECT_POLL:
-        if (TRACE5_slow) TRC(DBILOGFP, "%snot yet connected\n", THEADER_slow);
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute\n", THEADER_slow);
-        return -2;
 
-    default:
-        if (imp_dbh->async_status && STH_ASYNC_PREPARE != imp_sth->async_status) {
-            if (TRACE7_slow) TRC(DBILOGFP, "%sAttempting to handle existing async transaction\n", THEADER_slow);
-            ret = handle_old_async(aTHX_ sth, imp_dbh, imp_sth->async_flag);
-            if (ret) {
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (async ret: %ld)\n", THEADER_slow, ret);
-                return ret;
-            }
-        }
+/* ================================================================== */
+/*
+  Convert a year, month, and day to a Julian day number
+  (same algorithm as date2j in the Postgres source)
+*/
+static int pg_binary_date2j(int year, int month, int day)
+{
+    int julian;
+    int century;
+
+    if (month > 2) {
+        month += 1;
+        year += 4800;
+    }
+    else {
+        month += 13;
+        year += 4799;
     }
 
-    /* If not autocommit, start a new transaction */
-    if (!imp_dbh->done_begin && !DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        status = _result(aTHX_ imp_dbh, "begin");
-        if (PGRES_COMMAND_OK != status) {
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: begin failed)\n", THEADER_slow);
-            return -2;
-        }
-        imp_dbh->done_begin = DBDPG_TRUE;
-        /* If read-only mode, make it so */
-        if (imp_dbh->txn_read_only) {
-            status = _result(aTHX_ imp_dbh, "set transaction read only");
-            if (PGRES_COMMAND_OK != status) {
-                TRACE_PQERRORMESSAGE;
-                pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: set transaction read only failed)\n", THEADER_slow);
-                return -2;
-            }
-        }
-    }
+    century = year / 100;
+    julian = year * 365 - 32167;
+    julian += year / 4 - century + century / 4;
+    julian += 7834 * month / 256 + day;
 
-    /*
-      Clear old result (if any), except if starting the
-      query asynchronously. Old async results will be
-      deleted implicitly the next time pg_db_result is
-      called.
-    */
-     if (!(imp_sth->async_flag & PG_ASYNC)) {
-         CLEAR_STH_RESULT(imp_sth);
-     }
+    return julian;
 
-    /*
-      Now, we need to build the statement to send to the backend
-      We are using one of PQexec, PQexecPrepared, or PQexecParams
-      Let's figure out which we are going to use and set pqtype
-    */
+} /* end of pg_binary_date2j */
 
-    if (TRACE4_slow) TRC(DBILOGFP,
-                    "%sPQexec* decision: dml=%d direct=%d server_prepare=%d numbound=%d numphs=%d default=%d current=%d\n",
-                    THEADER_slow,
-                    imp_sth->is_dml,
-                    imp_sth->direct,
-                    imp_sth->server_prepare,
-                    imp_sth->numbound,
-                    imp_sth->numphs,
-                    imp_sth->has_default,
-                    imp_sth->has_current);
 
-    /* Increment our count */
-    imp_sth->number_iterations++;
+/* ================================================================== */
+/*
+  Parse a timestamp in strict ISO format: YYYY-MM-DD HH:MM:SS[.ffffff]
+  followed by an optional time zone offset of Z, +HH, +HH:MM, or +HHMM.
+  Sets the number of microseconds since 2000-01-01, and whether an offset
+  was given. Returns false for anything else, which is then sent as text.
+*/
+static bool pg_binary_parse_timestamp(const char *value, int64_t *ts, bool *has_offset)
+{
+    static const int mdays[] = {31,28,31,30,31,30,31,31,30,31,30,31};
+    int     year, month, day, hour, minute, second;
+    int64_t usecs = 0;
+    int     offset = 0;
+    int     digits;
+    const char *p = value;
+
+#define PG_BINARY_DIGITS(var, n) \
+    for (var = 0, digits = 0; digits < (n); digits++, p++) { \
+        if (!isDIGIT(*p)) return DBDPG_FALSE; \
+        var = var * 10 + (*p - '0'); \
+    }
+
+    PG_BINARY_DIGITS(year, 4);
+    if ('-' != *p++) return DBDPG_FALSE;
+    PG_BINARY_DIGITS(month, 2);
+    if ('-' != *p++) return DBDPG_FALSE;
+    PG_BINARY_DIGITS(day, 2);
+    if (' ' != *p && 'T' != *p) return DBDPG_FALSE;
+    p++;
+    PG_BINARY_DIGITS(hour, 2);
+    if (':' != *p++) return DBDPG_FALSE;
+    PG_BINARY_DIGITS(minute, 2);
+    if (':' != *p++) return DBDPG_FALSE;
+    PG_BINARY_DIGITS(second, 2);
+
+    if ('.' == *p) {
+        int scale = 100000;
+        p++;
+        if (!isDIGIT(*p)) return DBDPG_FALSE;
+        for (digits = 0; isDIGIT(*p); digits++, p++) {
+            /* The server rounds anything past microseconds, so leave that to it */
+            if (digits >= 6) return DBDPG_FALSE;
+            usecs += (*p - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    *has_offset = DBDPG_FALSE;
+    if ('Z' == *p) {
+        *has_offset = DBDPG_TRUE;
+        p++;
+    }
+    else if ('+' == *p || '-' == *p) {
+        int sign = '-' == *p ? -1 : 1;
+        int oh, om = 0;
+        p++;
+        PG_BINARY_DIGITS(oh, 2);
+        if (':' == *p) {
+            p++;
+            PG_BINARY_DIGITS(om, 2);
+        }
+        else if (isDIGIT(*p)) {
+            PG_BINARY_DIGITS(om, 2);
+        }
+        if (oh > 15 || om > 59) return DBDPG_FALSE;
+        offset = sign * (oh * 3600 + om * 60);
+        *has_offset = DBDPG_TRUE;
+    }
+
+#undef PG_BINARY_DIGITS
+
+    if ('\0' != *p) return DBDPG_FALSE;
+
+    if (year < 1 || month < 1 || month > 12 || day < 1 || hour > 23 || minute > 59 || second > 59)
+        return DBDPG_FALSE;
+    if (day > mdays[month-1]
+        && !(2 == month && 29 == day && 0 == year % 4 && (0 != year % 100 || 0 == year % 400)))
+        return DBDPG_FALSE;
 
-    /* We use PQexec if:
-       1. The statement is *not* DML (e.g. is DDL, which cannot be prepared)
-       2. We have a DEFAULT parameter
-       3. We have a CURRENT parameter
-       4. pg_direct is true
-       5. There are no placeholders
-       6. pg_server_prepare is false
-    */
-    if (!imp_sth->is_dml
-        || imp_sth->has_default
-        || imp_sth->has_current
-        || imp_sth->direct
-        || !imp_sth->numphs
-        || !imp_sth->server_prepare
-        )
-        pqtype = PQTYPE_EXEC;
-    else if (STH_ASYNC_PREPARE == imp_sth->async_status ) {
-        pqtype = PQTYPE_PREPARED;
-    }
-    else if (0==imp_sth->switch_prepared || imp_sth->number_iterations < imp_sth->switch_prepared) {
-        pqtype = PQTYPE_PARAMS;
-    }
-    else {
-        pqtype = PQTYPE_PREPARED;
-    }
+    *ts = (int64_t)(pg_binary_date2j(year, month, day) - 2451545) * INT64_C(86400000000) /* 2451545 is 2000-01-01 */
+        + ((int64_t)hour * 3600 + minute * 60 + second - offset) * 1000000
+        + usecs;
 
-    /* We use the new server_side prepare style if:
-       1. The statement is DML (DDL is not preparable)
-       2. The attribute "pg_direct" is false
-       3. The attribute "pg_server_prepare" is true
-       4. There are no DEFAULT or CURRENT values
-    */
-    execsize = imp_sth->totalsize; /* Total of all segments */
+    return DBDPG_TRUE;
 
-    /* If using plain old PQexec, we need to quote each value ourselves */
-    if (PQTYPE_EXEC == pqtype) {
-        for (p=0; p < ph_array_count(imp_sth); p++) {
-            ph_t *currph = ph_array_element(imp_sth, p);
-            if (currph->isdefault) {
-                Renew(currph->quoted, 8, char); /* freed in dbd_st_destroy */
-                strncpy(currph->quoted, "DEFAULT", 8);
-                currph->quotedlen = 7;
-            }
-            else if (currph->iscurrent) {
-                Renew(currph->quoted, 18, char); /* freed in dbd_st_destroy */
-                strncpy(currph->quoted, "CURRENT_TIMESTAMP", 18);
-                currph->quotedlen = 17;
-            }
-            else if (NULL == currph->value) {
-                Renew(currph->quoted, 5, char); /* freed in dbd_st_destroy */
-                strncpy(currph->quoted, "NULL", 5);
-                currph->quotedlen = 4;
-            }
-            else {
-                if (currph->quoted) {
-                    Safefree(currph->quoted);
-                    currph->quoted = NULL;
-                }
-                currph->quoted = currph->bind_type->quote(
-                    aTHX_
-                    currph->value,
-                    currph->valuelen,
-                    &currph->quotedlen,
-                    imp_dbh->pg_server_version >= 80100 ? 1 : 0
-                                                          ); /* freed in dbd_st_destroy */
-            }
-        }
-    }
-    else { /* We are using a server that can handle PQexecParams/PQexecPrepared */
+} /* end of pg_binary_parse_timestamp */
 
-        /* Put all values into an array to pass to one of the above */
-        if (NULL == imp_sth->PQvals) {
-            Newz(0, imp_sth->PQvals, (size_t)imp_sth->numphs, const char *); /* freed in dbd_st_destroy */
-        }
-        for (p=0; p < ph_array_count(imp_sth); p++) {
-            ph_t *currph = ph_array_element(imp_sth, p);
-            imp_sth->PQvals[p] = currph->value;
-        }
 
-        /* Binary or regular? */
+/* ================================================================== */
+/*
+  Encode a placeholder value into the binary format (network byte order)
+  for its type. The output buffer must have room for at least 16 bytes.
+  Returns the length of the encoded value, or 0 if the value should
+  be sent as text instead (the server will then complain if it is invalid).
+*/
+static int pg_binary_from_string(pTHX_ imp_dbh_t * imp_dbh, int type_id, const char * value, char * out)
+{
+    unsigned char *bin = (unsigned char *)out;
+    char          *end;
+    int            i;
 
-        if (imp_sth->has_binary) {
-            if (NULL == imp_sth->PQlens) {
-                Newz(0, imp_sth->PQlens, (size_t)imp_sth->numphs, int); /* freed in dbd_st_destroy */
-                Newz(0, imp_sth->PQfmts, (size_t)imp_sth->numphs, int); /* freed in dbd_st_destroy */
-            }
-            for (p=0; p < ph_array_count(imp_sth); p++) {
-                ph_t *currph = ph_array_element(imp_sth, p);
-                if (PG_BYTEA==currph->bind_type->type_id) {
-                    imp_sth->PQlens[p] = (int)currph->valuelen;
-                    imp_sth->PQfmts[p] = 1;
-                }
-                else {
-                    imp_sth->PQlens[p] = 0;
-                    imp_sth->PQfmts[p] = 0;
-                }
-            }
-        }
-    }
+#define PG_BINARY_PUT32(b, v) \
+    do { (b)[0] = (unsigned char)((v) >> 24); (b)[1] = (unsigned char)((v) >> 16); \
+         (b)[2] = (unsigned char)((v) >> 8);  (b)[3] = (unsigned char)(v); } while (0)
 
-    /* Run one of PQexec (or PQsendQuery), PQexecParams (or PQsendQueryParams), PQexecPrepared (or PQsendQueryPrepared) */
+    if ('\0' == *value)
+        return 0;
 
-    if (PQTYPE_EXEC == pqtype) { /* PQexec or PQsendQuery */
+    switch (type_id) {
 
-        if (TRACE4_slow) TRC(DBILOGFP, "%s%s\n",
-                             THEADER_slow,
-                             imp_sth->async_flag & PG_ASYNC ? "PQsendQuery" : "PQexec");
+    case PG_BOOL:
+        if (strEQ(value, "1") || strEQ(value, "t") || 0 == strcasecmp(value, "true"))
+            bin[0] = 1;
+        else if (strEQ(value, "0") || strEQ(value, "f") || 0 == strcasecmp(value, "false"))
+            bin[0] = 0;
+        else
+            return 0;
+        return 1;
 
-        /* Go through and quote each value, then turn into a giant statement */
-        for (s=0; s < seg_array_count(imp_sth); s++) {
-            seg_t *currseg = seg_array_element(imp_sth, s);
-            if (currseg->placeholder!=0) {
-                execsize += ph_array_element(imp_sth, currseg->placeholder-1)->quotedlen;
+    case PG_INT2:
+    case PG_INT4:
+    case PG_INT8:
+    case PG_OID:
+        {
+            long long num;
+            errno = 0;
+            num = strtoll(value, &end, 10);
+            if (errno || '\0' != *end)
+                return 0;
+            if (PG_INT2 == type_id) {
+                if (num < -32768 || num > 32767)
+                    return 0;
+                bin[0] = (unsigned char)((uint16_t)num >> 8);
+                bin[1] = (unsigned char)num;
+                return 2;
+            }
+            if (PG_INT4 == type_id) {
+                if (num < INT32_MIN || num > INT32_MAX)
+                    return 0;
+                PG_BINARY_PUT32(bin, (uint32_t)num);
+                return 4;
             }
+            if (PG_OID == type_id) {
+                if (num < 0 || num > UINT32_MAX)
+                    return 0;
+                PG_BINARY_PUT32(bin, (uint32_t)num);
+                return 4;
+            }
+            PG_BINARY_PUT32(bin, (uint32_t)((uint64_t)num >> 32));
+            PG_BINARY_PUT32(bin+4, (uint32_t)num);
+            return 8;
         }
 
-        statement = strbuf_create(execsize + 1);
-
-        for (s=0; s < seg_array_count(imp_sth); s++) {
-            seg_t *currseg = seg_array_element(imp_sth, s);
-            if (currseg->segment != NULL)
-                strbuf_append_text(statement, currseg->segment);
-            if (currseg->placeholder!=0)
-                strbuf_append_text(statement, ph_array_element(imp_sth, currseg->placeholder-1)->quoted);
+    case PG_FLOAT4:
+        {
+            float    f;
+            uint32_t bits;
+            errno = 0;
+            f = strtof(value, &end);
+            if (errno || '\0' != *end || isSPACE(*value))
+                return 0;
+            Copy(&f, &bits, 1, uint32_t);
+            PG_BINARY_PUT32(bin, bits);
+            return 4;
+        }
+
+    case PG_FLOAT8:
+        {
+            double   d;
+            uint64_t bits;
+            errno = 0;
+            d = strtod(value, &end);
+            if (errno || '\0' != *end || isSPACE(*value))
+                return 0;
+            Copy(&d, &bits, 1, uint64_t);
+            PG_BINARY_PUT32(bin, (uint32_t)(bits >> 32));
+            PG_BINARY_PUT32(bin+4, (uint32_t)bits);
+            return 8;
+        }
+
+    case PG_UUID:
+        {
+            /* 32 hex digits, optionally with hyphens in the usual places */
+            const char *p = value;
+            for (i = 0; i < 16; i++) {
+                int hi, lo;
+                if ('-' == *p && (4 == i || 6 == i || 8 == i || 10 == i))
+                    p++;
+                if (!isXDIGIT(p[0]) || !isXDIGIT(p[1]))
+                    return 0;
+                hi = isDIGIT(p[0]) ? p[0] - '0' : toLOWER(p[0]) - 'a' + 10;
+                lo = isDIGIT(p[1]) ? p[1] - '0' : toLOWER(p[1]) - 'a' + 10;
+                bin[i] = (unsigned char)(hi << 4 | lo);
+                p += 2;
+            }
+            if ('\0' != *p)
+                return 0;
+            return 16;
         }
 
-        if (TRACE5_slow) TRC(DBILOGFP, "%sRunning %s with (%s)\n",
-                             THEADER_slow,
-                             imp_sth->async_flag & PG_ASYNC ? "PQsendQuery" : "PQexec",
-                             strbuf_get(statement));
-
-        if (TSQL)
-            TRC(DBILOGFP, "%s;\n\n", strbuf_get(statement));
+    case PG_TIMESTAMP:
+    case PG_TIMESTAMPTZ:
+        {
+            int64_t     ts;
+            bool        has_offset;
+            const char *intdates;
 
-        if (imp_sth->async_flag & PG_ASYNC) {
-            TRACE_PQSENDQUERY;
-            if (!PQsendQuery(imp_dbh->conn, strbuf_get(statement))) {
-                strbuf_destroy(statement);
-                _fatal_sqlstate(aTHX_ imp_dbh);
-                TRACE_PQERRORMESSAGE;
-                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: PQsendQuery failed)\n", THEADER_slow);
-                return -2;
-            }
+            if (!pg_binary_parse_timestamp(value, &ts, &has_offset))
+                return 0;
+            /*
+              Without an offset, a timestamptz depends on the session time zone,
+              and a timestamp ignores any offset given, so leave those to the server
+            */
+            if (has_offset != (PG_TIMESTAMPTZ == type_id))
+                return 0;
+            /* Very old servers may store timestamps as floating point */
+            TRACE_PQPARAMETERSTATUS;
+            intdates = PQparameterStatus(imp_dbh->conn, "integer_datetimes");
+            if (NULL == intdates || !strEQ(intdates, "on"))
+                return 0;
+            PG_BINARY_PUT32(bin, (uint32_t)((uint64_t)ts >> 32));
+            PG_BINARY_PUT32(bin+4, (uint32_t)ts);
+            return 8;
         }
-        else {
 
-            CLEAR_LAST_RESULT(imp_dbh);
+    default:
+        return 0;
+    }
 
-            CLEAR_STH_RESULT(imp_sth);
+#undef PG_BINARY_PUT32
 
-            TRACE_PQEXEC;
-            imp_dbh->last_result = imp_sth->result = PQexec(imp_dbh->conn, strbuf_get(statement));
-            imp_dbh->result_shared = DBDPG_TRUE;
-        }
+} /* end of pg_binary_from_string */
 
-        strbuf_destroy(statement);
 
+/* ================================================================== */
+/*
+  The element type of a numeric array type that can be sent to the server
+  in binary format, or 0 if it cannot
+*/
+static int pg_binary_array_numeric(int type_id)
+{
+    switch (type_id) {
+    case PG_INT2ARRAY:   return PG_INT2;
+    case PG_INT4ARRAY:   return PG_INT4;
+    case PG_INT8ARRAY:   return PG_INT8;
+    case PG_FLOAT4ARRAY: return PG_FLOAT4;
+    case PG_FLOAT8ARRAY: return PG_FLOAT8;
+    default:             return 0;
     }
-    else if (PQTYPE_PARAMS == pqtype) { /* PQexecParams or PQsendQueryParams */
 
-        if (TRACE4_slow) TRC(DBILOGFP, "%s%s\n",
-                             THEADER_slow,
-                             imp_sth->async_flag & PG_ASYNC ? "PQsendQueryParams" : "PQexecParams");
+} /* end of pg_binary_array_numeric */
 
 
-        statement = strbuf_create(1024);
+/* ================================================================== */
+/*
+  Encode a one-dimensional array of numbers into the binary array format:
+  the number of dimensions, a has-nulls flag, the element type, the size and
+  lower bound of the dimension, and then each element as a length (-1 for NULL)
+  followed by the element itself. Integers are written directly, anything else
+  goes through pg_binary_from_string. Returns a newly allocated buffer, or NULL
+  if the array should be sent as text instead.
+*/
+static char * pg_binary_array_from_av(pTHX_ imp_dbh_t * imp_dbh, int type_id, AV * av, int * binlen)
+{
+    const int      element_type = pg_binary_array_numeric(type_id);
+    const SSize_t  items = av_len(av) + 1;
+    int            width;
+    IV             min, max;
+    bool           hasnull = DBDPG_FALSE;
+    unsigned char *bin;
+    unsigned char *pos;
+    SSize_t        i;
+
+#define PG_BINARY_PUT32(b, v) \
+    do { (b)[0] = (unsigned char)((v) >> 24); (b)[1] = (unsigned char)((v) >> 16); \
+         (b)[2] = (unsigned char)((v) >> 8);  (b)[3] = (unsigned char)(v); } while (0)
+
+    switch (element_type) {
+    case PG_INT2:   width = 2; min = -32768;    max = 32767;     break;
+    case PG_INT4:   width = 4; min = INT32_MIN; max = INT32_MAX; break;
+    case PG_INT8:   width = 8; min = IV_MIN;    max = IV_MAX;    break;
+    case PG_FLOAT4: width = 4; min = 0;         max = -1;        break;
+    case PG_FLOAT8: width = 8; min = 0;         max = -1;        break;
+    default:
+        return NULL;
+    }
 
-        for (s=0; s < seg_array_count(imp_sth); s++) {
-            seg_t *currseg = seg_array_element(imp_sth, s);
-            if (currseg->segment != NULL)
-                strbuf_append_text(statement, currseg->segment);
-            if (currseg->placeholder!=0)
-                strbuf_append_dollar_placeholder(statement, currseg->placeholder);
-        }
+    /* Empty arrays have no dimensions, and are just as easy to send as text */
+    if (items < 1 || items > (INT_MAX - 20) / (4 + width))
+        return NULL;
 
-        /* Populate PQoids */
-        if (NULL == imp_sth->PQoids) {
-            Newz(0, imp_sth->PQoids, (size_t)imp_sth->numphs, Oid); /* freed in dbd_st_destroy */
-        }
-        for (p=0; p < ph_array_count(imp_sth); p++) {
-            ph_t *currph = ph_array_element(imp_sth, p);
-            imp_sth->PQoids[p] = (currph->defaultval) ? 0 : (Oid)currph->bind_type->type_id;
+    New(0, bin, 20 + items * (4 + width), unsigned char); /* freed in dbd_st_destroy or the next bind */
+    pos = bin + 20;
+
+    for (i = 0; i < items; i++) {
+        SV ** svp = av_fetch(av, i, 0);
+        SV *  sv = NULL == svp ? NULL : *svp;
+        int   len;
+
+        if (NULL == sv || !SvOK(sv)) {
+            PG_BINARY_PUT32(pos, (uint32_t)-1);
+            pos += 4;
+            hasnull = DBDPG_TRUE;
+            continue;
         }
+        if (SvROK(sv)) /* Not one-dimensional */
+            goto text;
 
-        if (TRACE7_slow) {
-            for (p=0; p < ph_array_count(imp_sth); p++) {
-                ph_t *currph = ph_array_element(imp_sth, p);
-                TRC(DBILOGFP, "%sPQexecParams item #%d\n", THEADER_slow, (int)p);
-                TRC(DBILOGFP, "%s-> Type: (%d)\n", THEADER_slow, imp_sth->PQoids[p]);
-                TRC(DBILOGFP, "%s-> Value: (%s)\n", THEADER_slow, imp_sth->PQvals[p]);
-                TRC(DBILOGFP, "%s-> Length: (%d)\n", THEADER_slow, imp_sth->PQlens ? imp_sth->PQlens[p] : 0);
-                TRC(DBILOGFP, "%s-> Format: (%d)\n", THEADER_slow, imp_sth->PQfmts ? imp_sth->PQfmts[p] : 0);
+        /* Integers that Perl already has as integers need no parsing */
+        if (min <= max && SvIOK(sv) && !SvIsUV(sv) && SvIVX(sv) >= min && SvIVX(sv) <= max) {
+            const IV iv = SvIVX(sv);
+            PG_BINARY_PUT32(pos, (uint32_t)width);
+            if (2 == width) {
+                pos[4] = (unsigned char)((uint16_t)iv >> 8);
+                pos[5] = (unsigned char)iv;
+            }
+            else if (4 == width) {
+                PG_BINARY_PUT32(pos+4, (uint32_t)iv);
+            }
+            else {
+                PG_BINARY_PUT32(pos+4, (uint32_t)((uint64_t)iv >> 32));
+                PG_BINARY_PUT32(pos+8, (uint32_t)iv);
             }
+            pos += 4 + width;
+            continue;
         }
 
-        if (TSQL) {
-            TRC(DBILOGFP, "EXECUTE %s (\n", strbuf_get(statement));
-            for (p=0; p < ph_array_count(imp_sth); p++) {
-                TRC(DBILOGFP, "$%d: %s\n", p+1, imp_sth->PQvals[p]);
-            }
-            TRC(DBILOGFP, ");\n\n");
+        /* Everything else is encoded from its string form, just as a single value would be */
+        {
+            char out[17];
+            len = pg_binary_from_string(aTHX_ imp_dbh, element_type, SvPV_nolen(sv), out);
+            if (len != width)
+                goto text;
+            PG_BINARY_PUT32(pos, (uint32_t)len);
+            Copy(out, pos + 4, len, char);
+            pos += 4 + len;
         }
+    }
 
-        if (TRACE5_slow) TRC(DBILOGFP, "%sRunning %s with (%s)\n",
-                             THEADER_slow,
-                             imp_sth->async_flag & PG_ASYNC ? "PQsendQueryParams" : "PQexecParams",
-                             strbuf_get(statement));
+    PG_BINARY_PUT32(bin, 1);                     /* dimensions */
+    PG_BINARY_PUT32(bin+4, hasnull ? 1 : 0);     /* has nulls */
+    PG_BINARY_PUT32(bin+8, (uint32_t)element_type);
+    PG_BINARY_PUT32(bin+12, (uint32_t)items);    /* size of the dimension */
+    PG_BINARY_PUT32(bin+16, 1);                  /* lower bound */
+    *binlen = (int)(pos - bin);
+    return (char *)bin;
 
-        if (imp_sth->async_flag & PG_ASYNC) {
-            TRACE_PQSENDQUERYPARAMS;
-            if (!PQsendQueryParams
-                (imp_dbh->conn, strbuf_get(statement), imp_sth->numphs,
-                 imp_sth->PQoids, imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, 0)) {
-                Safefree(statement);
-                _fatal_sqlstate(aTHX_ imp_dbh);
-                TRACE_PQERRORMESSAGE;
-                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: PQsendQueryParams failed)\n", THEADER_slow);
-                return -2;
+  text:
+    Safefree(bin);
+    return NULL;
+
+#undef PG_BINARY_PUT32
+
+} /* end of pg_binary_array_from_av */
+
+
+/* ================================================================== */
+/*
+  Build the text form of an array that was bound in binary format by
+  pg_binary_array_from_av, for when it has to be sent as text after all,
+  or is asked for by ParamValues. Does nothing for any other placeholder.
+*/
+static void pg_st_array_text(pTHX_ ph_t * currph)
+{
+    const unsigned char * pos;
+    int    element_type;
+    int    items;
+    int    i;
+    SV *   text;
+
+    if (NULL != currph->value || NULL == currph->binarray)
+        return;
+
+    pos = (const unsigned char *)currph->binarray;
+    element_type = (int)PG_BINARY_U32(pos + 8);
+    items = (int32_t)PG_BINARY_U32(pos + 12);
+    pos += 20;
+
+    text = sv_2mortal(newSVpvs("{"));
+    for (i = 0; i < items; i++) {
+        const int len = (int32_t)PG_BINARY_U32(pos);
+        pos += 4;
+        if (i)
+            sv_catpvs(text, ",");
+        if (len < 0) {
+            sv_catpvs(text, "NULL");
+            continue;
+        }
+        switch (element_type) {
+        case PG_INT2:
+            sv_catpvf(text, "%d", (int)(int16_t)PG_BINARY_U16(pos));
+            break;
+        case PG_INT4:
+            sv_catpvf(text, "%ld", (long)(int32_t)PG_BINARY_U32(pos));
+            break;
+#if IVSIZE >= 8
+        case PG_INT8:
+            sv_catpvf(text, "%" IVdf, (IV)(int64_t)PG_BINARY_U64(pos));
+            break;
+#endif
+        default:
+            {
+                /* Enough digits to give back exactly the same float */
+                double d;
+                char   buf[32];
+                if (PG_FLOAT4 == element_type) {
+                    uint32_t bits = PG_BINARY_U32(pos);
+                    float    f;
+                    Copy(&bits, &f, 1, float);
+                    d = (double)f;
+                }
+                else {
+                    uint64_t bits = PG_BINARY_U64(pos);
+                    Copy(&bits, &d, 1, double);
+                }
+                if (d != d)
+                    strcpy(buf, "NaN");
+                else if (d > DBL_MAX)
+                    strcpy(buf, "Infinity");
+                else if (d < -DBL_MAX)
+                    strcpy(buf, "-Infinity");
+                else
+                    snprintf(buf, sizeof(buf), "%.*g", PG_FLOAT4 == element_type ? 9 : 17, d);
+                sv_catpv(text, buf);
             }
+            break;
         }
-        else {
+        pos += len;
+    }
+    sv_catpvs(text, "}");
 
-            CLEAR_LAST_RESULT(imp_dbh);
+    currph->valuelen = SvCUR(text);
+    New(0, currph->value, currph->valuelen+1, char); /* freed in dbd_st_destroy */
+    Copy(SvPVX(text), currph->value, currph->valuelen+1, char);
 
-            CLEAR_STH_RESULT(imp_sth);
+} /* end of pg_st_array_text */
 
-            TRACE_PQEXECPARAMS;
-            imp_dbh->last_result = imp_sth->result = PQexecParams
-                (
-                 imp_dbh->conn, strbuf_get(statement), imp_sth->numphs,
-                 imp_sth->PQoids, imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, 0
-                 );
-            imp_dbh->result_shared = DBDPG_TRUE;
+SV * pg_upgraded_sv(pTHX_ SV *input) {
+    U8 *p, *end;
+    STRLEN len;
+    /* SvPV() can change the value SvUTF8() (for overloaded values and tied values). */
+    p = (U8*)SvPV(input, len);
+    if(SvUTF8(input)) return input;
+    for(end = p + len; p != end; p++) {
+        if(*p & 0x80) {
+            SV *output = sv_mortalcopy(input);
+            sv_utf8_upgrade(output);
+            return output;
         }
+    }
+    return input;
+}
 
-        strbuf_destroy(statement);
+SV * pg_downgraded_sv(pTHX_ SV *input) {
+    U8 *p, *end;
+    STRLEN len;
+    /* SvPV() can change the value SvUTF8() (for overloaded values and tied values). */
+    p = (U8*)SvPV(input, len);
+    if(!SvUTF8(input)) return input;
+    for(end = p + len; p != end; p++) {
+        if(*p & 0x80) {
+            SV *output = sv_mortalcopy(input);
+            sv_utf8_downgrade(output, DBDPG_FALSE);
+            return output;
+        }
+    }
+    return input;
+}
+
+SV * pg_rightgraded_sv(pTHX_ SV *input, bool utf8) {
+    return utf8 ? pg_upgraded_sv(aTHX_ input) : pg_downgraded_sv(aTHX_ input);
+}
 
+static void pg_db_detect_client_encoding_utf8(pTHX_ imp_dbh_t *imp_dbh) {
+    char *clean_encoding;
+    long unsigned int i, j;
+    TRACE_PQPARAMETERSTATUS;
+    const char * const client_encoding =
+        PQparameterStatus(imp_dbh->conn, "client_encoding");
+    if (NULL != client_encoding) {
+        STRLEN len = strlen(client_encoding);
+        New(0, clean_encoding, len + 1, char);
+        for (i = 0, j = 0; i < len; i++) {
+            const char c = toLOWER(client_encoding[i]);
+            if (isALPHA(c) || isDIGIT(c))
+                clean_encoding[j++] = c;
+        }
+        clean_encoding[j] = '\0';
+        imp_dbh->client_encoding_utf8 =
+            (strnEQ(clean_encoding, "utf8", 4) || strnEQ(clean_encoding, "unicode", 8))
+            ? DBDPG_TRUE : DBDPG_FALSE;
+        Safefree(clean_encoding);
     }
-    else if (PQTYPE_PREPARED == pqtype) { /* PQexecPrepared or PQsendQueryPrepared */
+    else {
+        imp_dbh->client_encoding_utf8 = DBDPG_FALSE;
+    }
+}
 
-        if (TRACE4_slow) TRC(DBILOGFP, "%s%s\n",
-                             THEADER_slow,
-                             imp_sth->async_flag & PG_ASYNC ? "PQsendQueryPrepared" : "PQexecPrepared");
+/* ================================================================== */
+long pg_quickexec (SV * dbh, const char * sql, const int asyncflag)
+{
+    dTHX;
+    D_imp_dbh(dbh);
+    ExecStatusType          status = PGRES_FATAL_ERROR; /* Assume the worst */
+    PGTransactionStatusType txn_status;
+    long                    rows = 0;
 
-        /* Prepare if it has not already been prepared (or it needs repreparing) */
-        if (NULL == imp_sth->prepare_name) {
-            if (imp_sth->prepared_by_us) {
-                if (TRACE5_slow) TRC(DBILOGFP, "%sRe-preparing statement\n", THEADER_slow);
-            }
-            if (pg_st_prepare_statement(aTHX_ sth, imp_sth)!=0) {
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error)\n", THEADER_slow);
-                return -2;
-            }
-        } else if (STH_ASYNC_PREPARE == imp_sth->async_status) {
-            if (TRACE5_slow) TRC(DBILOGFP, "%swaiting for async preprare to complete (%s)\n",
-                                 THEADER_slow, imp_sth->prepare_name);
-        } else {
-            if (TRACE5_slow) TRC(DBILOGFP, "%sUsing previously prepared statement (%s)\n",
-                            THEADER_slow, imp_sth->prepare_name);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_quickexec (query: %s async: %d async_status: %d)\n",
+            THEADER_slow, sql, asyncflag, imp_dbh->async_status);
+
+    if (NULL == imp_dbh->conn) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Database handle has been disconnected");
+        return -2;
+    }
+
+    /* Abort if we are in the middle of a copy */
+    if (imp_dbh->copystate != 0) {
+        if (PGRES_COPY_IN == imp_dbh->copystate) {
+            croak("Must call pg_putcopyend before issuing more commands");
+        }
+        else {
+            croak("Must call pg_getcopydata until no more rows before issuing more commands");
         }
+    }
 
-        if (STH_ASYNC_PREPARE != imp_sth->async_status) {
-            if (TRACE7_slow) {
-                for (p=0; p < ph_array_count(imp_sth); p++) {
-                    TRC(DBILOGFP, "%sPQexecPrepared item #%d\n", THEADER_slow, p);
-                    TRC(DBILOGFP, "%s-> Value: (%s)\n",
-                        THEADER_slow, (imp_sth->PQfmts && imp_sth->PQfmts[p]==1) ? "(binary, not shown)"
-                                    : imp_sth->PQvals[p]);
-                    TRC(DBILOGFP, "%s-> Length: (%d)\n", THEADER_slow, imp_sth->PQlens ? imp_sth->PQlens[p] : 0);
-                    TRC(DBILOGFP, "%s-> Format: (%d)\n", THEADER_slow, imp_sth->PQfmts ? imp_sth->PQfmts[p] : 0);
-                }
-            }
+    /* Any rows still streaming in for a statement handle are thrown away */
+    pg_st_stream_discard(aTHX_ imp_dbh);
 
-            if (TRACE5_slow) TRC(DBILOGFP, "%sRunning %s with (%s)\n", THEADER_slow,
-                                 imp_sth->async_flag & PG_ASYNC ? "PQsendQueryPrepared" : "PQexecPrepared",
-                                 imp_sth->prepare_name);
+    /* Once something else has run, last_insert_id must ask the server again */
+    pg_db_returning_clear(aTHX_ imp_dbh);
 
-            if (TSQL) {
-                TRC(DBILOGFP, "EXECUTE %s (\n", imp_sth->prepare_name);
-                for (p=0; p < ph_array_count(imp_sth); p++) {
-                    TRC(DBILOGFP, "$%d: %s\n", p+1, imp_sth->PQvals[p]);
-                }
-                TRC(DBILOGFP, ");\n\n");
-            }
+    /* In pipeline mode, the command is queued and the result gathered by pg_db_pipeline_sync */
+    if (imp_dbh->in_pipeline) {
+        if (asyncflag & PG_ASYNC) {
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Cannot use pg_async while in pipeline mode");
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: async in pipeline)\n", THEADER_slow);
+            return -2;
+        }
+        if (0 != pg_db_pipeline_start_txn(aTHX_ dbh, imp_dbh)
+            || 0 != pg_db_pipeline_command(aTHX_ dbh, imp_dbh, sql)) {
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: pipeline)\n", THEADER_slow);
+            return -2;
+        }
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (pipelined)\n", THEADER_slow);
+        return 0;
+    }
 
-            if (imp_sth->async_flag & PG_ASYNC) {
-                TRACE_PQSENDQUERYPREPARED;
-                if (!PQsendQueryPrepared
-                    (imp_dbh->conn, imp_sth->prepare_name, imp_sth->numphs,
-                     imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, 0)) {
-                    _fatal_sqlstate(aTHX_ imp_dbh);
-                    TRACE_PQERRORMESSAGE;
-                    pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-                    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: PQsendQueryPrepared failed)\n", THEADER_slow);
-                    return -2;
-                }
-            }
-            else {
+    /* If we are still waiting on an async, handle it */
+    switch (imp_dbh->async_status) {
+    case DBH_NO_ASYNC:
+        break;
 
-                CLEAR_LAST_RESULT(imp_dbh);
+    case DBH_ASYNC_CONNECT:
+    case DBH_ASYNC_CONNECT_POLL:
+        if (TRACE5_slow) TRC(DBILOGFP, "%snot yet connected\n", THEADER_slow);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (async rows: %ld)\n", THEADER_slow, rows);
+        return -1;
 
-                CLEAR_STH_RESULT(imp_sth);
+    default:
+        if (TRACE5_slow) TRC(DBILOGFP, "%shandling old async\n", THEADER_slow);
+        rows = handle_old_async(aTHX_ dbh, imp_dbh, asyncflag);
+        if (rows) {
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (async rows: %ld)\n", THEADER_slow, rows);
+            return rows;
+        }
+    }
 
-                TRACE_PQEXECPREPARED;
-                imp_dbh->last_result = imp_sth->result = PQexecPrepared
-                    (
-                     imp_dbh->conn, imp_sth->prepare_name, imp_sth->numphs,
-                     imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, 0
-                     );
-                imp_dbh->result_shared = DBDPG_TRUE;
+    /* If not autocommit, start a new transaction */
+    if (!imp_dbh->done_begin && !DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        status = _result(aTHX_ imp_dbh, "begin");
+        if (PGRES_COMMAND_OK != status) {
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: begin failed)\n", THEADER_slow);
+            return -2;
+        }
+        imp_dbh->done_begin = DBDPG_TRUE;
+        /* If read-only mode, make it so */
+        if (imp_dbh->txn_read_only) {
+            status = _result(aTHX_ imp_dbh, "set transaction read only");
+            if (PGRES_COMMAND_OK != status) {
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: set transaction read only failed)\n", THEADER_slow);
+                return -2;
             }
         }
-    } /* end new-style prepare */
+    }
 
-    /* Some form of PQexec* or PQsend* has been run at this point */
+    /*
+      We want txn mode if AutoCommit
+     */
 
-    /* If running asynchronously, we don't stick around for the result */
-    if (imp_sth->async_flag & PG_ASYNC) {
-        if (TRACEWARN_slow) TRC(DBILOGFP, "%sEarly return for async query\n", THEADER_slow);
-        if (!imp_sth->async_status) imp_sth->async_status = STH_ASYNC;
-        imp_dbh->async_sth = imp_sth;
+
+    /* Asynchronous commands get kicked off and return undef */
+    if (asyncflag & PG_ASYNC) {
+        if (TRACE4_slow) TRC(DBILOGFP, "%sGoing asynchronous with do()\n", THEADER_slow);
+        TRACE_PQSENDQUERY;
+        if (! PQsendQuery(imp_dbh->conn, sql)) {
+            if (TRACE4_slow) TRC(DBILOGFP, "%sPQsendQuery failed\n", THEADER_slow);
+            _fatal_sqlstate(aTHX_ imp_dbh);
+
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (error: async do failed)\n", THEADER_slow);
+            return -2;
+        }
         imp_dbh->async_status = DBH_ASYNC;
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (async)\n", THEADER_slow);
+        imp_dbh->async_sth = NULL; /* Needed? */
+
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (async)\n", THEADER_slow);
         return 0;
     }
 
-    status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
+    if (TSQL) TRC(DBILOGFP, "%s;\n\n", sql);
+
+    CLEAR_LAST_RESULT(imp_dbh);
+
+    TRACE_PQEXEC;
+    imp_dbh->last_result = PQexec(imp_dbh->conn, sql);
+    imp_dbh->result_shared = DBDPG_FALSE;
+
+    status = _sqlstate(aTHX_ imp_dbh, imp_dbh->last_result);
+
+    imp_dbh->copystate = 0; /* Assume not in copy mode until told otherwise */
+
+    if (TRACE4_slow) TRC(DBILOGFP, "%sGot a status of %d\n", THEADER_slow, status);
+    switch ((int)status) {
+    case PGRES_TUPLES_OK:
+        TRACE_PQNTUPLES;
+        rows = PQntuples(imp_dbh->last_result);
+        break;
+    case PGRES_COMMAND_OK:
+        /* non-select statement */
+        TRACE_PQCMDTUPLES;
+        rows = atol(PQcmdTuples(imp_dbh->last_result));
+        break;
+    case PGRES_COPY_OUT:
+    case PGRES_COPY_IN:
+    case PGRES_COPY_BOTH:
+        /* Copy Out/In data transfer in progress */
+        imp_dbh->copystate = status;
+        imp_dbh->copybinary = PQbinaryTuples(imp_dbh->last_result);
+        imp_dbh->copy_buffer_length = 0;
+        rows = -1;
+        break;
+    case PGRES_EMPTY_QUERY:
+    case PGRES_BAD_RESPONSE:
+    case PGRES_NONFATAL_ERROR:
+        rows = -2;
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+        break;
+    case PGRES_FATAL_ERROR:
+    default:
+        rows = -2;
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+        break;
+    }
+
+    if (NULL == imp_dbh->last_result) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (no result)\n", THEADER_slow);
+        return -2;
+    }
+
+    TRACE_PQTRANSACTIONSTATUS;
+    txn_status = PQtransactionStatus(imp_dbh->conn);
+
+    if (PQTRANS_IDLE == txn_status) {
+        imp_dbh->done_begin = DBDPG_FALSE;
+        imp_dbh->copystate=0;
+        /* If begin_work has been called, turn AutoCommit back on and BegunWork off */
+        if (DBIc_has(imp_dbh, DBIcf_BegunWork)!=0) {
+            DBIc_set(imp_dbh, DBIcf_AutoCommit, 1);
+            DBIc_set(imp_dbh, DBIcf_BegunWork, 0);
+        }
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_quickexec (rows: %ld, txn_status: %d)\n",
+                  THEADER_slow, rows, txn_status);
+    return rows;
+
+} /* end of pg_quickexec */
+
+
+/* ================================================================== */
+/* Return value <= -2:error, >=0:ok row count, (-1=unknown count) */
+static int pq_send_prepared_query (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+{
+    TRACE_PQSENDQUERYPREPARED;
+    return PQsendQueryPrepared (imp_dbh->conn,
+                                imp_sth->prepare_name, imp_sth->numphs,
+                                imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts,
+                                0);
+}
+
+long dbd_st_execute (SV * sth, imp_sth_t * imp_sth)
+{
+    dTHX;
+    D_imp_dbh_from_sth;
+    int           status, p, s;
+    STRLEN        execsize;
+    strbuf_t     *statement = NULL;
+    long          ret;
+    PQExecType    pqtype;
+    bool          stream;
+    int           resultformat;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_execute\n", THEADER_slow);
+
+    if (NULL == imp_dbh->conn) {
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "Cannot call execute on a disconnected database handle");
+        return -2;
+    }
+
+    /* Abort if we are in the middle of a copy */
+    if (imp_dbh->copystate!=0)
+        croak("Must call pg_endcopy before issuing more commands");
+
+    /* Any rows still streaming in (from this or another statement handle) are thrown away */
+    pg_st_stream_discard(aTHX_ imp_dbh);
+
+    /* Once something else has run, last_insert_id must ask the server again */
+    pg_db_returning_clear(aTHX_ imp_dbh);
+
+    /* Ensure that all the placeholders have been bound */
+    if (!imp_sth->all_bound && imp_sth->numphs!=0) {
+        for (p=0; p < ph_array_count(imp_sth); p++) {
+            ph_t *currph = ph_array_element(imp_sth, p);
+            if (NULL == currph->bind_type) {
+                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "execute called with an unbound placeholder");
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: unbound placeholder)\n", THEADER_slow);
+                return -2;
+            }
+            if (currph->isinout) {
+                Safefree(currph->binarray);
+                currph->binarray = NULL;
+                currph->binarraylen = 0;
+                currph->valuelen = sv_len(currph->inout);
+                Renew(currph->value, currph->valuelen+1, char);
+                Copy(SvPV_nolen(currph->inout), currph->value, currph->valuelen+1, char);
+                currph->value[currph->valuelen] = '\0';
+            }
+        }
+        imp_sth->all_bound = DBDPG_TRUE;
+    }
+
+    /* Pipeline mode cannot be mixed with asynchronous queries */
+    if (imp_dbh->in_pipeline && (imp_sth->async_flag & PG_ASYNC)) {
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "Cannot use pg_async while in pipeline mode");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: async in pipeline)\n", THEADER_slow);
+        return -2;
+    }
+
+    /* Streaming rows is only possible for plain synchronous queries */
+#if PGLIBVERSION >= 90200
+    stream = imp_sth->stream_rows > 0 && !(imp_sth->async_flag & PG_ASYNC) && !imp_dbh->in_pipeline;
+#else
+    stream = DBDPG_FALSE;
+#endif
+    imp_sth->streamed = DBDPG_FALSE;
+
+    /* Check for old async transactions */
+    switch (imp_dbh->async_status) {
+    case DBH_NO_ASYNC:
+        break;
+
+    case DBH_ASYNC_CONNECT:
+    case DBH_ASYNC_CONNECT_POLL:
+        if (TRACE5_slow) TRC(DBILOGFP, "%snot yet connected\n", THEADER_slow);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute\n", THEADER_slow);
+        return -2;
+
+    default:
+        if (imp_dbh->async_status && STH_ASYNC_PREPARE != imp_sth->async_status) {
+            if (TRACE7_slow) TRC(DBILOGFP, "%sAttempting to handle existing async transaction\n", THEADER_slow);
+            ret = handle_old_async(aTHX_ sth, imp_dbh, imp_sth->async_flag);
+            if (ret) {
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (async ret: %ld)\n", THEADER_slow, ret);
+                return ret;
+            }
+        }
+    }
+
+    /* If not autocommit, start a new transaction */
+    if (imp_dbh->in_pipeline) {
+        if (0 != pg_db_pipeline_start_txn(aTHX_ sth, imp_dbh)) {
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: begin failed)\n", THEADER_slow);
+            return -2;
+        }
+    }
+    else if (!imp_dbh->done_begin && !DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        status = _result(aTHX_ imp_dbh, "begin");
+        if (PGRES_COMMAND_OK != status) {
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: begin failed)\n", THEADER_slow);
+            return -2;
+        }
+        imp_dbh->done_begin = DBDPG_TRUE;
+        /* If read-only mode, make it so */
+        if (imp_dbh->txn_read_only) {
+            status = _result(aTHX_ imp_dbh, "set transaction read only");
+            if (PGRES_COMMAND_OK != status) {
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: set transaction read only failed)\n", THEADER_slow);
+                return -2;
+            }
+        }
+    }
+
+    /*
+      Clear old result (if any), except if starting the
+      query asynchronously or in pipeline mode. Old results
+      will be deleted implicitly the next time pg_db_result
+      or pg_db_pipeline_sync is called.
+    */
+     if (!(imp_sth->async_flag & PG_ASYNC) && !imp_dbh->in_pipeline) {
+         CLEAR_STH_RESULT(imp_sth);
+     }
+
+    /*
+      Now, we need to build the statement to send to the backend
+      We are using one of PQexec, PQexecPrepared, or PQexecParams
+      Let's figure out which we are going to use and set pqtype
+    */
+
+    if (TRACE4_slow) TRC(DBILOGFP,
+                    "%sPQexec* decision: dml=%d direct=%d server_prepare=%d numbound=%d numphs=%d default=%d current=%d\n",
+                    THEADER_slow,
+                    imp_sth->is_dml,
+                    imp_sth->direct,
+                    imp_sth->server_prepare,
+                    imp_sth->numbound,
+                    imp_sth->numphs,
+                    imp_sth->has_default,
+                    imp_sth->has_current);
+
+    /* Increment our count */
+    imp_sth->number_iterations++;
+
+    /* We use PQexec if:
+       1. The statement is *not* DML (e.g. is DDL, which cannot be prepared)
+       2. We have a DEFAULT parameter
+       3. We have a CURRENT parameter
+       4. pg_direct is true
+       5. There are no placeholders
+       6. pg_server_prepare is false
+    */
+    if (!imp_sth->is_dml
+        || imp_sth->has_default
+        || imp_sth->has_current
+        || imp_sth->direct
+        || !imp_sth->numphs
+        || !imp_sth->server_prepare
+        )
+        pqtype = PQTYPE_EXEC;
+    else if (STH_ASYNC_PREPARE == imp_sth->async_status ) {
+        pqtype = PQTYPE_PREPARED;
+    }
+    else if (0==imp_sth->switch_prepared || imp_sth->number_iterations < imp_sth->switch_prepared) {
+        pqtype = PQTYPE_PARAMS;
+    }
+    else {
+        pqtype = PQTYPE_PREPARED;
+    }
+
+    /*
+      Ask for binary results once we know that every column can be decoded from them.
+      Arrays in binary format can only be returned expanded, so pg_expand_array must be on.
+    */
+    resultformat = imp_sth->binary_results && imp_sth->binary_ready
+        && (imp_dbh->expand_array || !imp_sth->binary_arrays) ? 1 : 0;
+
+    /* Binary results need PQexecParams, even when there are no placeholders */
+    if (resultformat
+        && PQTYPE_EXEC == pqtype
+        && imp_sth->is_dml
+        && !imp_sth->numphs
+        && !imp_sth->direct
+        && imp_sth->server_prepare
+        )
+        pqtype = PQTYPE_PARAMS;
+
+    /* A synchronous prepare is not possible in pipeline mode, but one done beforehand is used */
+    if (imp_dbh->in_pipeline && PQTYPE_PREPARED == pqtype && NULL == imp_sth->prepare_name)
+        pqtype = PQTYPE_PARAMS;
+    else if (imp_dbh->in_pipeline && PQTYPE_PARAMS == pqtype && NULL != imp_sth->prepare_name
+             && imp_sth->is_dml && imp_sth->numphs)
+        pqtype = PQTYPE_PREPARED;
+
+    /* No need to wait for switch_prepared if an earlier statement handle left this statement prepared */
+    if (PQTYPE_PARAMS == pqtype && NULL == imp_sth->prepare_name && pg_st_cache_take(aTHX_ imp_dbh, imp_sth))
+        pqtype = PQTYPE_PREPARED;
+
+    /* We use the new server_side prepare style if:
+       1. The statement is DML (DDL is not preparable)
+       2. The attribute "pg_direct" is false
+       3. The attribute "pg_server_prepare" is true
+       4. There are no DEFAULT or CURRENT values
+    */
+    execsize = imp_sth->totalsize; /* Total of all segments */
+
+    /* If using plain old PQexec, we need to quote each value ourselves */
+    if (PQTYPE_EXEC == pqtype) {
+        for (p=0; p < ph_array_count(imp_sth); p++) {
+            ph_t *currph = ph_array_element(imp_sth, p);
+            pg_st_array_text(aTHX_ currph);
+            if (currph->isdefault) {
+                Renew(currph->quoted, 8, char); /* freed in dbd_st_destroy */
+                strncpy(currph->quoted, "DEFAULT", 8);
+                currph->quotedlen = 7;
+            }
+            else if (currph->iscurrent) {
+                Renew(currph->quoted, 18, char); /* freed in dbd_st_destroy */
+                strncpy(currph->quoted, "CURRENT_TIMESTAMP", 18);
+                currph->quotedlen = 17;
+            }
+            else if (NULL == currph->value) {
+                Renew(currph->quoted, 5, char); /* freed in dbd_st_destroy */
+                strncpy(currph->quoted, "NULL", 5);
+                currph->quotedlen = 4;
+            }
+            else {
+                if (currph->quoted) {
+                    Safefree(currph->quoted);
+                    currph->quoted = NULL;
+                }
+                currph->quoted = currph->bind_type->quote(
+                    aTHX_
+                    currph->value,
+                    currph->valuelen,
+                    &currph->quotedlen,
+                    imp_dbh->pg_server_version >= 90000 ? PG_QUOTE_BYTEA_HEX
+                    : imp_dbh->pg_server_version >= 80100 ? 1 : 0
+                                                          ); /* freed in dbd_st_destroy */
+            }
+        }
+    }
+    else { /* We are using a server that can handle PQexecParams/PQexecPrepared */
+
+        /* Put all values into an array to pass to one of the above */
+        if (NULL == imp_sth->PQvals) {
+            Newz(0, imp_sth->PQvals, (size_t)imp_sth->numphs, const char *); /* freed in dbd_st_destroy */
+        }
+        for (p=0; p < ph_array_count(imp_sth); p++) {
+            ph_t *currph = ph_array_element(imp_sth, p);
+            imp_sth->PQvals[p] = currph->value;
+        }
+
+        /* Binary or regular? */
+
+        if (imp_sth->has_binary) {
+            /*
+              Other than bytea, we can only send binary if the server knows the exact type
+              of the parameter, which is not the case if someone else prepared the statement
+            */
+            bool encode = PQTYPE_PARAMS == pqtype || NULL == imp_sth->prepare_name || imp_sth->prepared_by_us;
+            int  binlen;
+
+            if (NULL == imp_sth->PQlens) {
+                Newz(0, imp_sth->PQlens, (size_t)imp_sth->numphs, int); /* freed in dbd_st_destroy */
+                Newz(0, imp_sth->PQfmts, (size_t)imp_sth->numphs, int); /* freed in dbd_st_destroy */
+            }
+            for (p=0; p < ph_array_count(imp_sth); p++) {
+                ph_t *currph = ph_array_element(imp_sth, p);
+                if (PG_BYTEA==currph->bind_type->type_id) {
+                    imp_sth->PQlens[p] = (int)currph->valuelen;
+                    imp_sth->PQfmts[p] = 1;
+                }
+                else if (encode && NULL != currph->binarray) {
+                    imp_sth->PQvals[p] = currph->binarray;
+                    imp_sth->PQlens[p] = currph->binarraylen;
+                    imp_sth->PQfmts[p] = 1;
+                }
+                else if (NULL != currph->binarray) {
+                    pg_st_array_text(aTHX_ currph);
+                    imp_sth->PQvals[p] = currph->value;
+                    imp_sth->PQlens[p] = 0;
+                    imp_sth->PQfmts[p] = 0;
+                }
+                else if (encode
+                         && !currph->defaultval
+                         && NULL != currph->value
+                         && (binlen = pg_binary_from_string(aTHX_ imp_dbh, currph->bind_type->type_id,
+                                                            currph->value, currph->binvalue)) > 0) {
+                    imp_sth->PQvals[p] = currph->binvalue;
+                    imp_sth->PQlens[p] = binlen;
+                    imp_sth->PQfmts[p] = 1;
+                }
+                else {
+                    imp_sth->PQlens[p] = 0;
+                    imp_sth->PQfmts[p] = 0;
+                }
+            }
+        }
+    }
+
+    /* Run one of PQexec (or PQsendQuery), PQexecParams (or PQsendQueryParams), PQexecPrepared (or PQsendQueryPrepared) */
+
+    if (PQTYPE_EXEC == pqtype) { /* PQexec or PQsendQuery */
+
+        if (TRACE4_slow) TRC(DBILOGFP, "%s%s\n",
+                             THEADER_slow,
+                             imp_sth->async_flag & PG_ASYNC ? "PQsendQuery" : "PQexec");
+
+        /* Go through and quote each value, then turn into a giant statement */
+        for (s=0; s < seg_array_count(imp_sth); s++) {
+            seg_t *currseg = seg_array_element(imp_sth, s);
+            if (currseg->placeholder!=0) {
+                execsize += ph_array_element(imp_sth, currseg->placeholder-1)->quotedlen;
+            }
+        }
+
+        statement = strbuf_create(execsize + 1);
+
+        for (s=0; s < seg_array_count(imp_sth); s++) {
+            seg_t *currseg = seg_array_element(imp_sth, s);
+            if (currseg->segment != NULL)
+                strbuf_append_text(statement, currseg->segment);
+            if (currseg->placeholder!=0)
+                strbuf_append_text(statement, ph_array_element(imp_sth, currseg->placeholder-1)->quoted);
+        }
+
+        if (TRACE5_slow) TRC(DBILOGFP, "%sRunning %s with (%s)\n",
+                             THEADER_slow,
+                             imp_sth->async_flag & PG_ASYNC ? "PQsendQuery" : "PQexec",
+                             strbuf_get(statement));
+
+        if (TSQL)
+            TRC(DBILOGFP, "%s;\n\n", strbuf_get(statement));
+
+        if (imp_dbh->in_pipeline) {
+            /* PQsendQuery is not allowed in pipeline mode */
+            TRACE_PQSENDQUERYPARAMS;
+            if (!PQsendQueryParams(imp_dbh->conn, strbuf_get(statement), 0, NULL, NULL, NULL, NULL, 0)) {
+                strbuf_destroy(statement);
+                _fatal_sqlstate(aTHX_ imp_dbh);
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: PQsendQueryParams failed)\n", THEADER_slow);
+                return -2;
+            }
+        }
+        else if (imp_sth->async_flag & PG_ASYNC || stream) {
+            TRACE_PQSENDQUERY;
+            if (!PQsendQuery(imp_dbh->conn, strbuf_get(statement))) {
+                strbuf_destroy(statement);
+                _fatal_sqlstate(aTHX_ imp_dbh);
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: PQsendQuery failed)\n", THEADER_slow);
+                return -2;
+            }
+        }
+        else {
+
+            CLEAR_LAST_RESULT(imp_dbh);
+
+            CLEAR_STH_RESULT(imp_sth);
+
+            TRACE_PQEXEC;
+            imp_dbh->last_result = imp_sth->result = PQexec(imp_dbh->conn, strbuf_get(statement));
+            imp_dbh->result_shared = DBDPG_TRUE;
+        }
+
+        strbuf_destroy(statement);
+
+    }
+    else if (PQTYPE_PARAMS == pqtype) { /* PQexecParams or PQsendQueryParams */
+
+        if (TRACE4_slow) TRC(DBILOGFP, "%s%s\n",
+                             THEADER_slow,
+                             imp_sth->async_flag & PG_ASYNC ? "PQsendQueryParams" : "PQexecParams");
+
+
+        statement = strbuf_create(1024);
+
+        for (s=0; s < seg_array_count(imp_sth); s++) {
+            seg_t *currseg = seg_array_element(imp_sth, s);
+            if (currseg->segment != NULL)
+                strbuf_append_text(statement, currseg->segment);
+            if (currseg->placeholder!=0)
+                strbuf_append_dollar_placeholder(statement, currseg->placeholder);
+        }
+
+        /* Populate PQoids */
+        if (NULL == imp_sth->PQoids) {
+            Newz(0, imp_sth->PQoids, (size_t)imp_sth->numphs, Oid); /* freed in dbd_st_destroy */
+        }
+        for (p=0; p < ph_array_count(imp_sth); p++) {
+            ph_t *currph = ph_array_element(imp_sth, p);
+            imp_sth->PQoids[p] = (currph->defaultval) ? 0 : (Oid)currph->bind_type->type_id;
+        }
+
+        if (TRACE7_slow) {
+            for (p=0; p < ph_array_count(imp_sth); p++) {
+                ph_t *currph = ph_array_element(imp_sth, p);
+                TRC(DBILOGFP, "%sPQexecParams item #%d\n", THEADER_slow, (int)p);
+                TRC(DBILOGFP, "%s-> Type: (%d)\n", THEADER_slow, imp_sth->PQoids[p]);
+                TRC(DBILOGFP, "%s-> Value: (%s)\n",
+                    THEADER_slow, (imp_sth->PQfmts && imp_sth->PQfmts[p]==1) ? "(binary, not shown)"
+                                : imp_sth->PQvals[p]);
+                TRC(DBILOGFP, "%s-> Length: (%d)\n", THEADER_slow, imp_sth->PQlens ? imp_sth->PQlens[p] : 0);
+                TRC(DBILOGFP, "%s-> Format: (%d)\n", THEADER_slow, imp_sth->PQfmts ? imp_sth->PQfmts[p] : 0);
+            }
+        }
+
+        if (TSQL) {
+            TRC(DBILOGFP, "EXECUTE %s (\n", strbuf_get(statement));
+            for (p=0; p < ph_array_count(imp_sth); p++) {
+                TRC(DBILOGFP, "$%d: %s\n", p+1, ph_array_element(imp_sth, p)->value);
+            }
+            TRC(DBILOGFP, ");\n\n");
+        }
+
+        if (TRACE5_slow) TRC(DBILOGFP, "%sRunning %s with (%s)\n",
+                             THEADER_slow,
+                             imp_sth->async_flag & PG_ASYNC ? "PQsendQueryParams" : "PQexecParams",
+                             strbuf_get(statement));
+
+        if (imp_sth->async_flag & PG_ASYNC || imp_dbh->in_pipeline || stream) {
+            TRACE_PQSENDQUERYPARAMS;
+            if (!PQsendQueryParams
+                (imp_dbh->conn, strbuf_get(statement), imp_sth->numphs,
+                 imp_sth->PQoids, imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, resultformat)) {
+                Safefree(statement);
+                _fatal_sqlstate(aTHX_ imp_dbh);
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: PQsendQueryParams failed)\n", THEADER_slow);
+                return -2;
+            }
+        }
+        else {
+
+            CLEAR_LAST_RESULT(imp_dbh);
+
+            CLEAR_STH_RESULT(imp_sth);
+
+            TRACE_PQEXECPARAMS;
+            imp_dbh->last_result = imp_sth->result = PQexecParams
+                (
+                 imp_dbh->conn, strbuf_get(statement), imp_sth->numphs,
+                 imp_sth->PQoids, imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, resultformat
+                 );
+            imp_dbh->result_shared = DBDPG_TRUE;
+        }
+
+        strbuf_destroy(statement);
+
+    }
+    else if (PQTYPE_PREPARED == pqtype) { /* PQexecPrepared or PQsendQueryPrepared */
+
+        if (TRACE4_slow) TRC(DBILOGFP, "%s%s\n",
+                             THEADER_slow,
+                             imp_sth->async_flag & PG_ASYNC ? "PQsendQueryPrepared" : "PQexecPrepared");
+
+        /* Prepare if it has not already been prepared (or it needs repreparing) */
+        if (NULL == imp_sth->prepare_name) {
+            if (imp_sth->prepared_by_us) {
+                if (TRACE5_slow) TRC(DBILOGFP, "%sRe-preparing statement\n", THEADER_slow);
+            }
+            if (pg_st_prepare_statement(aTHX_ sth, imp_sth)!=0) {
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error)\n", THEADER_slow);
+                return -2;
+            }
+        } else if (STH_ASYNC_PREPARE == imp_sth->async_status) {
+            if (TRACE5_slow) TRC(DBILOGFP, "%swaiting for async preprare to complete (%s)\n",
+                                 THEADER_slow, imp_sth->prepare_name);
+        } else {
+            if (TRACE5_slow) TRC(DBILOGFP, "%sUsing previously prepared statement (%s)\n",
+                            THEADER_slow, imp_sth->prepare_name);
+        }
+
+        if (STH_ASYNC_PREPARE != imp_sth->async_status) {
+            if (TRACE7_slow) {
+                for (p=0; p < ph_array_count(imp_sth); p++) {
+                    TRC(DBILOGFP, "%sPQexecPrepared item #%d\n", THEADER_slow, p);
+                    TRC(DBILOGFP, "%s-> Value: (%s)\n",
+                        THEADER_slow, (imp_sth->PQfmts && imp_sth->PQfmts[p]==1) ? "(binary, not shown)"
+                                    : imp_sth->PQvals[p]);
+                    TRC(DBILOGFP, "%s-> Length: (%d)\n", THEADER_slow, imp_sth->PQlens ? imp_sth->PQlens[p] : 0);
+                    TRC(DBILOGFP, "%s-> Format: (%d)\n", THEADER_slow, imp_sth->PQfmts ? imp_sth->PQfmts[p] : 0);
+                }
+            }
+
+            if (TRACE5_slow) TRC(DBILOGFP, "%sRunning %s with (%s)\n", THEADER_slow,
+                                 imp_sth->async_flag & PG_ASYNC ? "PQsendQueryPrepared" : "PQexecPrepared",
+                                 imp_sth->prepare_name);
+
+            if (TSQL) {
+                TRC(DBILOGFP, "EXECUTE %s (\n", imp_sth->prepare_name);
+                for (p=0; p < ph_array_count(imp_sth); p++) {
+                    TRC(DBILOGFP, "$%d: %s\n", p+1, ph_array_element(imp_sth, p)->value);
+                }
+                TRC(DBILOGFP, ");\n\n");
+            }
+
+            if (imp_sth->async_flag & PG_ASYNC || imp_dbh->in_pipeline || stream) {
+                TRACE_PQSENDQUERYPREPARED;
+                if (!PQsendQueryPrepared
+                    (imp_dbh->conn, imp_sth->prepare_name, imp_sth->numphs,
+                     imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, resultformat)) {
+                    _fatal_sqlstate(aTHX_ imp_dbh);
+                    TRACE_PQERRORMESSAGE;
+                    pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: PQsendQueryPrepared failed)\n", THEADER_slow);
+                    return -2;
+                }
+            }
+            else {
+
+                CLEAR_LAST_RESULT(imp_dbh);
+
+                CLEAR_STH_RESULT(imp_sth);
+
+                TRACE_PQEXECPREPARED;
+                imp_dbh->last_result = imp_sth->result = PQexecPrepared
+                    (
+                     imp_dbh->conn, imp_sth->prepare_name, imp_sth->numphs,
+                     imp_sth->PQvals, imp_sth->PQlens, imp_sth->PQfmts, resultformat
+                     );
+                imp_dbh->result_shared = DBDPG_TRUE;
+            }
+        }
+    } /* end new-style prepare */
+
+    /* Some form of PQexec* or PQsend* has been run at this point */
+
+    /* In pipeline mode, the result is gathered later by pg_db_pipeline_sync */
+    if (imp_dbh->in_pipeline) {
+        pg_db_pipeline_append(imp_dbh, imp_sth);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (pipelined)\n", THEADER_slow);
+        return 0;
+    }
+
+    /* If running asynchronously, we don't stick around for the result */
+    if (imp_sth->async_flag & PG_ASYNC) {
+        if (TRACEWARN_slow) TRC(DBILOGFP, "%sEarly return for async query\n", THEADER_slow);
+        if (!imp_sth->async_status) imp_sth->async_status = STH_ASYNC;
+        imp_dbh->async_sth = imp_sth;
+        imp_dbh->async_status = DBH_ASYNC;
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (async)\n", THEADER_slow);
+        return 0;
+    }
+
+    /* If streaming, wait only for the first batch of rows; dbd_st_fetch gets the rest */
+    if (stream) {
+        pg_st_stream_start(aTHX_ imp_dbh, imp_sth);
+        status = pg_st_stream_next(aTHX_ imp_dbh, imp_sth);
+        if (PG_STREAM_CHUNK(status)) {
+            imp_dbh->copystate = 0;
+            imp_sth->streamed = DBDPG_TRUE;
+            TRACE_PQNFIELDS;
+            DBIc_NUM_FIELDS(imp_sth) = PQnfields(imp_sth->result);
+            DBIc_ACTIVE_on(imp_sth);
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (streaming, first batch: %ld)\n",
+                               THEADER_slow, imp_sth->rows);
+            return -1; /* Number of rows is not known yet */
+        }
+        /* Otherwise the complete result has arrived, so carry on as normal */
+    }
+
+    status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
+
+    imp_dbh->copystate = 0; /* Assume not in copy mode until told otherwise */
+
+    if (PGRES_TUPLES_OK == status) {
+        imp_sth->cur_tuple = 0;
+        TRACE_PQNFIELDS;
+        int num_fields = PQnfields(imp_sth->result);
+        DBIc_NUM_FIELDS(imp_sth) = num_fields;
+        TRACE_PQNTUPLES;
+        ret = PQntuples(imp_sth->result);
+        /* Remember the key of the last row inserted, so last_insert_id need not ask for it */
+        TRACE_PQBINARYTUPLES;
+        if (imp_sth->returning_id && ret > 0 && !PQbinaryTuples(imp_sth->result)) {
+            TRACE_PQGETISNULL;
+            if (PQgetisnull(imp_sth->result, (int)ret-1, 0))
+                imp_dbh->returning_value = newSV(0);
+            else {
+                TRACE_PQGETVALUE;
+                TRACE_PQGETLENGTH;
+                imp_dbh->returning_value = newSVpvn(PQgetvalue(imp_sth->result, (int)ret-1, 0),
+                                                    (STRLEN)PQgetlength(imp_sth->result, (int)ret-1, 0));
+                if (imp_dbh->pg_utf8_flag)
+                    SvUTF8_on(imp_dbh->returning_value);
+            }
+            imp_dbh->returning_sql = SvREFCNT_inc(imp_sth->returning_sql);
+        }
+        /* Nobody will fetch the rows of a RETURNING that Pg.pm added */
+        if (2 != imp_sth->returning_id)
+            DBIc_ACTIVE_on(imp_sth);
+        if (TRACE5_slow) TRC(DBILOGFP,
+                        "%sStatus was PGRES_TUPLES_OK, fields=%d, tuples=%ld\n",
+                        THEADER_slow, num_fields, ret);
+    }
+    else if (PGRES_COMMAND_OK == status) {
+        /* non-select statement */
+        bool gotrows = DBDPG_FALSE;
+
+        if (TRACE5_slow)
+            TRC(DBILOGFP, "%sStatus was PGRES_COMMAND_OK\n", THEADER_slow);
+
+        if (imp_sth->result) {
+            TRACE_PQCMDTUPLES;
+            ret = atol(PQcmdTuples(imp_sth->result));
+            gotrows = ret;
+            imp_sth->rows = ret;
+        }
+        if (!gotrows) {
+            /* No rows affected, but check for change of state */
+            TRACE_PQTRANSACTIONSTATUS;
+            if (PQTRANS_IDLE == PQtransactionStatus(imp_dbh->conn)) {
+                imp_dbh->done_begin = DBDPG_FALSE;
+                /* If begin_work has been called, turn AutoCommit back on and BegunWork off */
+                if (DBIc_has(imp_dbh, DBIcf_BegunWork)!=0) {
+                    DBIc_set(imp_dbh, DBIcf_AutoCommit, 1);
+                    DBIc_set(imp_dbh, DBIcf_BegunWork, 0);
+                }
+            }
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (OK, no rows)\n", THEADER_slow);
+            return 0;
+        }
+    }
+    else if (PGRES_COPY_OUT == status || PGRES_COPY_IN == status || PGRES_COPY_BOTH == status) {
+        if (TRACE5_slow)
+            TRC(DBILOGFP, "%sStatus was PGRES_COPY_%s\n",
+                THEADER_slow, PGRES_COPY_OUT == status ? "OUT" : PGRES_COPY_IN == status ? "IN" : "BOTH");
+        /* Copy Out/In data transfer in progress */
+        imp_dbh->copystate = status;
+        imp_dbh->copybinary = PQbinaryTuples(imp_sth->result);
+        imp_dbh->copy_buffer_length = 0;
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (COPY)\n", THEADER_slow);
+        return -1;
+    }
+    else {
+        if (TRACE5_slow) TRC(DBILOGFP, "%sInvalid status returned (%d)\n", THEADER_slow, status);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: bad status)\n", THEADER_slow);
+        return -2;
+    }
+
+    /* store the number of affected rows */
+
+    imp_sth->rows = ret;
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (rows: %ld)\n", THEADER_slow, ret);
+    return ret;
+
+} /* end of dbd_st_execute */
+
+
+/* ================================================================== */
+/*
+  Look up the type of every column in the current result, the first time
+  rows are fetched from a statement handle
+*/
+static void pg_st_type_info_setup (pTHX_ imp_sth_t * imp_sth, int num_fields)
+{
+    D_imp_dbh_from_sth;
+    int i;
+
+    Newz(0, imp_sth->type_info, (size_t)num_fields, sql_type_info_t*); /* freed in dbd_st_destroy */
+    for (i = 0; i < num_fields; ++i) {
+        TRACE_PQFTYPE;
+        imp_sth->type_info[i] = pg_db_type_data(imp_dbh, (int)PQftype(imp_sth->result, i));
+        if (imp_sth->type_info[i] == NULL) {
+            if (TRACEWARN_slow) {
+                TRACE_PQFTYPE;
+                TRC(DBILOGFP, "%sUnknown type returned by Postgres: %d. Setting to UNKNOWN\n",
+                    THEADER_slow, PQftype(imp_sth->result, i));
+            }
+            imp_sth->type_info[i] = pg_type_data(PG_UNKNOWN);
+        }
+    }
+    /* Later executions can ask for binary results if we know how to decode every column */
+    if (imp_sth->binary_results) {
+        imp_sth->binary_ready = DBDPG_TRUE;
+        imp_sth->binary_arrays = DBDPG_FALSE;
+        for (i = 0; i < num_fields; ++i) {
+            if (!pg_binary_decodable(imp_sth->type_info[i]->type_id)) {
+                imp_sth->binary_ready = DBDPG_FALSE;
+                break;
+            }
+            if (pg_binary_array_element(imp_sth->type_info[i]->type_id))
+                imp_sth->binary_arrays = DBDPG_TRUE;
+        }
+        if (TRACE5_slow) TRC(DBILOGFP, "%sBinary results are %spossible for this statement\n",
+                             THEADER_slow, imp_sth->binary_ready ? "" : "not ");
+    }
+
+} /* end of pg_st_type_info_setup */
+
+
+/* ================================================================== */
+/*
+  The decoders below store a single non-NULL value from a result into an SV,
+  converting it to a Perlish value according to the column type. One is
+  chosen for each column by pg_st_decoder_setup, so that the handle settings
+  are only looked at once instead of for every value. They return false if
+  a binary value cannot be decoded.
+*/
+
+/* Which handle settings the decoders were chosen for */
+#define PG_DECODE_READY       0x01
+#define PG_DECODE_BINARY      0x02
+#define PG_DECODE_CHOPBLANKS  0x04
+#define PG_DECODE_BOOL_TF     0x08
+#define PG_DECODE_INT8_STRING 0x10
+#define PG_DECODE_UTF8        0x20
+#define PG_DECODE_ARRAYS      0x40
+
+/* Everything is marked as UTF-8 (when the client_encoding is UTF8) except bytea */
+static void pg_decode_utf8 (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv)
+{
+    if (imp_dbh->pg_utf8_flag) {
+        if (PG_BYTEA == type_info->type_id) {
+            SvUTF8_off(sv);
+        }
+        /*
+          Don't try to upgrade references (e.g. arrays).
+          pg_destringify_array() upgrades the items as appropriate.
+        */
+        else if (!SvROK(sv)) {
+            SvUTF8_on(sv);
+            SvSETMAGIC(sv);
+        }
+    }
+}
+
+/* Text values that need no dequoting; the length from libpq is used as is */
+static bool pg_decode_string (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    PERL_UNUSED_ARG(imp_dbh);
+    PERL_UNUSED_ARG(type_info);
+    sv_setpvn(sv, value, (STRLEN)length);
+    return DBDPG_TRUE;
+}
+
+static bool pg_decode_string_utf8 (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    PERL_UNUSED_ARG(imp_dbh);
+    PERL_UNUSED_ARG(type_info);
+    sv_setpvn(sv, value, (STRLEN)length);
+    SvUTF8_on(sv);
+    SvSETMAGIC(sv);
+    return DBDPG_TRUE;
+}
+
+/* Text values with their own dequote function, such as bytea */
+static bool pg_decode_dequote (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    STRLEN value_len;
+    PERL_UNUSED_ARG(length);
+    type_info->dequote(aTHX_ value, &value_len); /* dequote in place */
+    sv_setpvn(sv, value, value_len);
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+/* Bytea in hex format is decoded straight into the SV, leaving the result untouched */
+static bool pg_decode_bytea (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    char * dest;
+
+    if (length < 2 || '\\' != value[0] || 'x' != value[1])
+        return pg_decode_dequote(aTHX_ imp_dbh, type_info, sv, value, length);
+
+    sv_setpvs(sv, "");
+    dest = SvGROW(sv, (STRLEN)(length - 2) / 2 + 1);
+    SvCUR_set(sv, decode_bytea_hex(value + 2, (STRLEN)(length - 2), dest));
+    *SvEND(sv) = '\0';
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+/* Blank-padded character values with ChopBlanks on */
+static bool pg_decode_bpchar_chop (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    while (length && ' ' == value[length-1])
+        --length;
+    sv_setpvn(sv, value, (STRLEN)length);
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+static bool pg_decode_bool (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    PERL_UNUSED_ARG(length);
+    sv_setiv(sv, 't' == *value ? 1 : 0);
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+/* Booleans with pg_bool_tf on */
+static bool pg_decode_bool_tf (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    PERL_UNUSED_ARG(length);
+    sv_setpvn(sv, 't' == *value ? "t" : "f", 1);
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+static bool pg_decode_integer (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    PERL_UNUSED_ARG(length);
+    sv_setiv(sv, atol(value));
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+static bool pg_decode_float (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    PERL_UNUSED_ARG(length);
+    sv_setnv(sv, strtod(value, NULL));
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+static bool pg_decode_array (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    PERL_UNUSED_ARG(length);
+    sv_setsv(sv, sv_2mortal(pg_destringify_array(aTHX_ imp_dbh, value, type_info)));
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+static bool pg_decode_binary (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    if (!pg_binary_to_sv(aTHX_ imp_dbh, sv, type_info->type_id, (unsigned char *)value, length, 0))
+        return DBDPG_FALSE;
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+static bool pg_decode_binary_chop (pTHX_ imp_dbh_t * imp_dbh, sql_type_info_t * type_info, SV * sv, char * value, int length)
+{
+    if (!pg_binary_to_sv(aTHX_ imp_dbh, sv, type_info->type_id, (unsigned char *)value, length, 1))
+        return DBDPG_FALSE;
+    pg_decode_utf8(aTHX_ imp_dbh, type_info, sv);
+    return DBDPG_TRUE;
+}
+
+
+/* ================================================================== */
+/* Gather the handle settings that affect how result values are decoded */
+static int pg_st_decoder_flags (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth, bool binary)
+{
+    return PG_DECODE_READY
+        | (binary ? PG_DECODE_BINARY : 0)
+        | (DBIc_has(imp_sth, DBIcf_ChopBlanks) ? PG_DECODE_CHOPBLANKS : 0)
+        | (imp_dbh->pg_bool_tf ? PG_DECODE_BOOL_TF : 0)
+        | (imp_dbh->pg_int8_as_string ? PG_DECODE_INT8_STRING : 0)
+        | (imp_dbh->pg_utf8_flag ? PG_DECODE_UTF8 : 0)
+        | (imp_dbh->expand_array ? PG_DECODE_ARRAYS : 0);
+
+} /* end of pg_st_decoder_flags */
+
+
+/* ================================================================== */
+/*
+  Choose a decoder for every column in the current result. This is redone
+  whenever one of the settings in flags changes.
+*/
+static void pg_st_decoder_setup (pTHX_ imp_sth_t * imp_sth, int num_fields, int flags)
+{
+    int i;
+
+    if (TRACE5_slow) TRC(DBILOGFP, "%sChoosing column decoders (flags: %d)\n", THEADER_slow, flags);
+
+    if (NULL == imp_sth->decoders)
+        Newz(0, imp_sth->decoders, (size_t)num_fields, pg_decoder_t); /* freed in dbd_st_destroy */
+
+    for (i = 0; i < num_fields; ++i) {
+        sql_type_info_t *type_info = imp_sth->type_info[i];
+        pg_decoder_t     decoder;
+
+        if (flags & PG_DECODE_BINARY) {
+            decoder = (flags & PG_DECODE_CHOPBLANKS) ? pg_decode_binary_chop : pg_decode_binary;
+        }
+        else if ((flags & PG_DECODE_ARRAYS) && 0 == strncmp(type_info->arrayout, "array", 5)) {
+            decoder = pg_decode_array;
+        }
+        else {
+            switch (type_info->type_id) {
+            case PG_BOOL:
+                decoder = (flags & PG_DECODE_BOOL_TF) ? pg_decode_bool_tf : pg_decode_bool;
+                break;
+#if IVSIZE >= 8 && LONGSIZE >= 8
+            case PG_INT8:
+                decoder = (flags & PG_DECODE_INT8_STRING) ? NULL : pg_decode_integer;
+                break;
+#endif
+            case PG_INT2:
+            case PG_INT4:
+                decoder = pg_decode_integer;
+                break;
+            case PG_FLOAT4:
+            case PG_FLOAT8:
+                decoder = pg_decode_float;
+                break;
+            case PG_BPCHAR:
+                decoder = (flags & PG_DECODE_CHOPBLANKS) ? pg_decode_bpchar_chop : NULL;
+                break;
+            case PG_BYTEA:
+                decoder = pg_decode_bytea;
+                break;
+            default:
+                decoder = NULL;
+            }
+
+            /* Everything else is a string */
+            if (NULL == decoder) {
+                if (type_info->dequote != dequote_string
+                    && type_info->dequote != dequote_char
+                    && type_info->dequote != null_dequote)
+                    decoder = pg_decode_dequote;
+                else if (!(flags & PG_DECODE_UTF8))
+                    decoder = pg_decode_string;
+                else
+                    decoder = pg_decode_string_utf8;
+            }
+        }
+
+        imp_sth->decoders[i] = decoder;
+    }
+
+    imp_sth->decoder_flags = flags;
+
+} /* end of pg_st_decoder_setup */
+
+
+/* ================================================================== */
+/*
+  Zero-copy values (see pg_zero_copy) are read-only strings whose buffer is
+  inside a PGresult. Each one carries this magic, which keeps the result alive
+  through a pg_result_hold_t until the value is freed or overwritten.
+  A new thread gets copies of these values that share the buffer, so the
+  count may be changed from more than one thread.
+*/
+static void pg_result_release (pTHX_ pg_result_hold_t * hold)
+{
+    int refcount;
+
+    OP_REFCNT_LOCK;
+    refcount = --hold->refcount;
+    OP_REFCNT_UNLOCK;
+    if (refcount > 0)
+        return;
+    TRACE_PQCLEAR;
+    PQclear(hold->result);
+    Safefree(hold);
+
+} /* end of pg_result_release */
+
+static int pg_zero_copy_free (pTHX_ SV * sv, MAGIC * mg)
+{
+    /* The buffer belongs to the result, so Perl must never use or free it */
+    SvPV_set(sv, NULL);
+    SvCUR_set(sv, 0);
+    SvLEN_set(sv, 0);
+    SvOK_off(sv);
+    pg_result_release(aTHX_ (pg_result_hold_t *)mg->mg_ptr);
+    return 0;
+
+} /* end of pg_zero_copy_free */
+
+/* A cloned value points at the same buffer, so it needs its own claim on the result */
+static int pg_zero_copy_dup (pTHX_ MAGIC * mg, CLONE_PARAMS * param)
+{
+    pg_result_hold_t * hold = (pg_result_hold_t *)mg->mg_ptr;
+
+    PERL_UNUSED_ARG(param);
+    OP_REFCNT_LOCK;
+    hold->refcount++;
+    OP_REFCNT_UNLOCK;
+    return 0;
+
+} /* end of pg_zero_copy_dup */
+
+static MGVTBL pg_zero_copy_vtbl = { NULL, NULL, NULL, NULL, pg_zero_copy_free, NULL, pg_zero_copy_dup };
+
+/* Turn a zero-copy value back into a plain, empty scalar */
+static void pg_zero_copy_release (pTHX_ SV * sv)
+{
+    MAGIC * mg;
+
+    if (SvTYPE(sv) < SVt_PVMG)
+        return;
+    for (mg = SvMAGIC(sv); mg; mg = mg->mg_moremagic) {
+        if (PERL_MAGIC_ext == mg->mg_type && &pg_zero_copy_vtbl == mg->mg_virtual) {
+            SvREADONLY_off(sv);
+            sv_unmagic(sv, PERL_MAGIC_ext);
+            return;
+        }
+    }
+
+} /* end of pg_zero_copy_release */
+
+
+/* ================================================================== */
+/* The statement handle no longer needs its result, but fetched values may */
+static void pg_st_result_unhold (imp_sth_t * imp_sth)
+{
+    dTHX;
+    imp_dbh_t * imp_dbh = (imp_dbh_t *)DBIc_PARENT_COM(imp_sth);
+
+    /* The database handle must not free it either, nor look at it again */
+    if (imp_dbh->last_result == imp_sth->result) {
+        imp_dbh->last_result = NULL;
+        imp_dbh->result_shared = DBDPG_FALSE;
+    }
+    pg_result_release(aTHX_ imp_sth->result_hold);
+    imp_sth->result_hold = NULL;
+
+} /* end of pg_st_result_unhold */
+
+
+/* ================================================================== */
+/*
+  Point an SV straight at a value inside the current result instead of copying it.
+  Only done for values that need no conversion: strings, and bytea, which is
+  decoded in place first. Returns false if the column does not qualify, in which
+  case the value is decoded as usual.
+*/
+static bool pg_st_zero_copy (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth, int column, SV * sv,
+                             char * value, int length, bool binary)
+{
+    sql_type_info_t * type_info = imp_sth->type_info[column];
+    pg_decoder_t      decoder = imp_sth->decoders[column];
+    STRLEN            len = (STRLEN)length;
+    bool              utf8;
+    MAGIC *           mg;
+
+    if (binary) {
+        switch (type_info->type_id) {
+        case PG_BYTEA:
+        case PG_TEXT:
+        case PG_VARCHAR:
+        case PG_NAME:
+        case PG_JSON:
+            break;
+        default:
+            return DBDPG_FALSE;
+        }
+        utf8 = imp_dbh->pg_utf8_flag && PG_BYTEA != type_info->type_id;
+    }
+    else if (pg_decode_string == decoder || pg_decode_string_utf8 == decoder) {
+        utf8 = pg_decode_string_utf8 == decoder;
+    }
+    else if (pg_decode_bytea == decoder) {
+        type_info->dequote(aTHX_ value, &len); /* dequote in place */
+        utf8 = DBDPG_FALSE;
+    }
+    else {
+        return DBDPG_FALSE;
+    }
+
+    if (NULL == imp_sth->result_hold) {
+        New(0, imp_sth->result_hold, 1, pg_result_hold_t); /* freed by pg_result_release */
+        imp_sth->result_hold->result = imp_sth->result;
+        imp_sth->result_hold->refcount = 1;
+    }
+    OP_REFCNT_LOCK;
+    imp_sth->result_hold->refcount++;
+    OP_REFCNT_UNLOCK;
+
+    /* Drop whatever the SV held before, then lend it the result's buffer */
+    if (SvTYPE(sv) < SVt_PV)
+        sv_upgrade(sv, SVt_PV);
+    sv_force_normal_flags(sv, SV_COW_DROP_PV);
+    SvPV_free(sv);
+    SvPV_set(sv, value);
+    SvCUR_set(sv, len);
+    SvLEN_set(sv, 0);
+    SvPOK_only(sv);
+    if (utf8)
+        SvUTF8_on(sv);
+    mg = sv_magicext(sv, NULL, PERL_MAGIC_ext, &pg_zero_copy_vtbl, (const char *)imp_sth->result_hold, 0);
+    mg->mg_flags |= MGf_DUP;
+    SvREADONLY_on(sv);
+
+    return DBDPG_TRUE;
+
+} /* end of pg_st_zero_copy */
+
+
+/* ================================================================== */
+AV * dbd_st_fetch (SV * sth, imp_sth_t * imp_sth)
+{
+    dTHX;
+    D_imp_dbh_from_sth;
+    int               num_fields;
+    int               i;
+    int               flags;
+    bool              binary;
+    AV *              av;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_fetch\n", THEADER_slow);
+
+    /* Check that execute() was executed successfully */
+    if ( !DBIc_ACTIVE(imp_sth) ) {
+        pg_error(aTHX_ sth, PGRES_NONFATAL_ERROR, "no statement executing\n");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch (error: no statement)\n", THEADER_slow);
+        return Nullav;
+    }
+
+    /* When streaming, get the next batch once we have used up the current one */
+    if (imp_sth->cur_tuple == imp_sth->rows && imp_dbh->stream_sth == imp_sth) {
+        ExecStatusType status = pg_st_stream_next(aTHX_ imp_dbh, imp_sth);
+        if (PGRES_TUPLES_OK != status && !PG_STREAM_CHUNK(status)) {
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
+            imp_sth->cur_tuple = 0;
+            DBIc_ACTIVE_off(imp_sth);
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch (error: streaming failed)\n", THEADER_slow);
+            return Nullav;
+        }
+    }
+
+    TRACE_PQNTUPLES;
+
+    if (imp_sth->cur_tuple == imp_sth->rows) {
+        if (TRACE5_slow)
+            TRC(DBILOGFP, "%sFetched the last tuple (%d)\n", THEADER_slow, imp_sth->cur_tuple);
+        imp_sth->cur_tuple = 0;
+        DBIc_ACTIVE_off(imp_sth);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch (last tuple)\n", THEADER_slow);
+        return Nullav; /* we reached the last tuple */
+    }
+
+    av = DBIc_DBISTATE(imp_sth)->get_fbav(imp_sth);
+    num_fields = AvFILL(av)+1;
+
+    /* Set up the type_info array if we have not seen it yet */
+    if (NULL == imp_sth->type_info)
+        pg_st_type_info_setup(aTHX_ imp_sth, num_fields);
+
+    TRACE_PQBINARYTUPLES;
+    binary = PQbinaryTuples(imp_sth->result) ? DBDPG_TRUE : DBDPG_FALSE;
+
+    /* Pick new column decoders if any relevant setting has changed */
+    flags = pg_st_decoder_flags(aTHX_ imp_dbh, imp_sth, binary);
+    if (flags != imp_sth->decoder_flags)
+        pg_st_decoder_setup(aTHX_ imp_sth, num_fields, flags);
+
+    for (i = 0; i < num_fields; ++i) {
+        sql_type_info_t * type_info;
+        SV *sv;
+
+        if (TRACE5_slow)
+            TRC(DBILOGFP, "%sFetching field #%d\n", THEADER_slow, i);
+
+        sv = AvARRAY(av)[i];
+
+        /* A value from an earlier row may still point into a result */
+        if (SvREADONLY(sv))
+            pg_zero_copy_release(aTHX_ sv);
+
+        TRACE_PQGETISNULL;
+        if (PQgetisnull(imp_sth->result, imp_sth->cur_tuple, i)!=0) {
+            SvROK(sv) ? (void)sv_unref(sv) : (void)SvOK_off(sv);
+        }
+        else {
+            char * value;
+            int    length;
+            TRACE_PQGETVALUE;
+            value = PQgetvalue(imp_sth->result, imp_sth->cur_tuple, i);
+
+            type_info = imp_sth->type_info[i];
+
+            TRACE_PQGETLENGTH;
+            length = PQgetlength(imp_sth->result, imp_sth->cur_tuple, i);
+
+            /*
+              A column given to bind_col is the caller's own variable, which
+              must stay writable, so it always gets a copy
+            */
+            if (imp_dbh->zero_copy && length >= imp_dbh->zero_copy && 1 == SvREFCNT(sv)
+                && pg_st_zero_copy(aTHX_ imp_dbh, imp_sth, i, sv, value, length, binary)) {
+                continue;
+            }
+
+            if (!imp_sth->decoders[i](aTHX_ imp_dbh, type_info, sv, value, length)) {
+                pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "Cannot decode a binary value of this column type");
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch (error: binary type %d)\n",
+                                   THEADER_slow, type_info->type_id);
+                return Nullav;
+            }
+        }
+    }
+
+    imp_sth->cur_tuple += 1;
+
+    /* Experimental inout support */
+    if (imp_sth->use_inout) {
+        for (int p=0; p < ph_array_count(imp_sth); p++) {
+            ph_t *currph = ph_array_element(imp_sth, p);
+            if (currph->isinout)
+                sv_copypv(currph->inout, AvARRAY(av)[p]);
+        }
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch\n", THEADER_slow);
+    return av;
+
+} /* end of dbd_st_fetch */
+
+
+/* ================================================================== */
+/*
+  Put the connection into single-row mode (or chunked-rows mode, for
+  libpq 17 and up) right after a query has been sent for a statement
+  handle using pg_stream_rows
+*/
+static void pg_st_stream_start (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+{
+    int mode_set = 0;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_stream_start (rows: %d)\n", THEADER_slow, imp_sth->stream_rows);
+
+#if PGLIBVERSION >= 170000
+    if (imp_sth->stream_rows > 1) {
+        TRACE_PQSETCHUNKEDROWSMODE;
+        mode_set = PQsetChunkedRowsMode(imp_dbh->conn, imp_sth->stream_rows);
+    }
+#endif
+#if PGLIBVERSION >= 90200
+    if (!mode_set) {
+        TRACE_PQSETSINGLEROWMODE;
+        mode_set = PQsetSingleRowMode(imp_dbh->conn);
+    }
+#endif
+
+    /* If neither worked, the whole result arrives at once, which is fine */
+    if (!mode_set && TRACEWARN_slow)
+        TRC(DBILOGFP, "%sCould not set single-row mode, fetching all rows at once\n", THEADER_slow);
+
+    imp_sth->stream_total = 0;
+    imp_dbh->stream_sth = imp_sth;
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_stream_start\n", THEADER_slow);
+
+} /* end of pg_st_stream_start */
+
+
+/* ================================================================== */
+/*
+  Get the next batch of rows for a streaming statement handle.
+  Once the final result arrives, the connection is made ready for
+  the next command. Returns the status of the new result.
+*/
+static ExecStatusType pg_st_stream_next (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth)
+{
+    ExecStatusType status;
+    PGresult *     result;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_stream_next\n", THEADER_slow);
+
+    CLEAR_LAST_RESULT(imp_dbh);
+
+    CLEAR_STH_RESULT(imp_sth);
+
+    TRACE_PQGETRESULT;
+    imp_dbh->last_result = imp_sth->result = PQgetResult(imp_dbh->conn);
+    imp_dbh->result_shared = DBDPG_TRUE;
+
+    status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
+
+    if (PG_STREAM_CHUNK(status) || PGRES_TUPLES_OK == status) {
+        TRACE_PQNTUPLES;
+        imp_sth->rows = PQntuples(imp_sth->result);
+        imp_sth->stream_total += imp_sth->rows;
+        imp_sth->cur_tuple = 0;
+    }
+
+    if (!PG_STREAM_CHUNK(status)) {
+        /* This was the last result: gather up anything else so the connection is free */
+        imp_dbh->stream_sth = NULL;
+        if (NULL != imp_sth->result
+            && PGRES_COPY_OUT != status && PGRES_COPY_IN != status && PGRES_COPY_BOTH != status) {
+            TRACE_PQGETRESULT;
+            while (NULL != (result = PQgetResult(imp_dbh->conn))) {
+                TRACE_PQCLEAR;
+                PQclear(result);
+            }
+        }
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_stream_next (status: %d rows: %ld)\n",
+                       THEADER_slow, status, imp_sth->rows);
+    return status;
+
+} /* end of pg_st_stream_next */
+
+
+/* ================================================================== */
+/*
+  Throw away any rows still due for a streaming statement handle,
+  so that the connection can be used for something else
+*/
+static void pg_st_stream_discard (pTHX_ imp_dbh_t * imp_dbh)
+{
+    imp_sth_t * imp_sth = imp_dbh->stream_sth;
+    PGresult *  result;
+
+    if (NULL == imp_sth)
+        return;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_stream_discard\n", THEADER_slow);
+
+    imp_dbh->stream_sth = NULL;
+
+    TRACE_PQGETRESULT;
+    while (NULL != (result = PQgetResult(imp_dbh->conn))) {
+        TRACE_PQCLEAR;
+        PQclear(result);
+    }
+
+    imp_sth->cur_tuple = 0;
+    DBIc_ACTIVE_off(imp_sth);
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_stream_discard\n", THEADER_slow);
+
+} /* end of pg_st_stream_discard */
+
+
+/* ================================================================== */
+/*
+  Fetch up to max_rows rows (or every remaining row, if max_rows is negative)
+  column by column, and return a reference to an array of arrays: one per column.
+  Returns undef once the statement handle has no more rows to give.
+*/
+SV * pg_st_fetch_columns (SV * sth, imp_sth_t * imp_sth, long max_rows)
+{
+    dTHX;
+    D_imp_dbh_from_sth;
+    AV *   columns;
+    int    num_fields;
+    int    i;
+    long   fetched = 0;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_fetch_columns (max_rows: %ld)\n", THEADER_slow, max_rows);
+
+    if (!DBIc_ACTIVE(imp_sth)) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_fetch_columns (not active)\n", THEADER_slow);
+        return &PL_sv_undef;
+    }
+
+    num_fields = DBIc_NUM_FIELDS(imp_sth);
+
+    columns = newAV();
+    av_extend(columns, num_fields);
+    for (i = 0; i < num_fields; ++i)
+        av_store(columns, i, newRV_noinc((SV *)newAV()));
+
+    while (max_rows < 0 || fetched < max_rows) {
+        bool binary;
+        int  flags;
+        long count;
+        int  start;
+
+        /* When streaming, get the next batch once we have used up the current one */
+        if (imp_sth->cur_tuple == imp_sth->rows && imp_dbh->stream_sth == imp_sth) {
+            ExecStatusType status = pg_st_stream_next(aTHX_ imp_dbh, imp_sth);
+            if (PGRES_TUPLES_OK != status && !PG_STREAM_CHUNK(status)) {
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
+                imp_sth->cur_tuple = 0;
+                DBIc_ACTIVE_off(imp_sth);
+                SvREFCNT_dec((SV *)columns);
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_fetch_columns (error: streaming failed)\n", THEADER_slow);
+                return &PL_sv_undef;
+            }
+        }
+
+        if (imp_sth->cur_tuple == imp_sth->rows)
+            break;
+
+        if (NULL == imp_sth->type_info)
+            pg_st_type_info_setup(aTHX_ imp_sth, num_fields);
+
+        TRACE_PQBINARYTUPLES;
+        binary = PQbinaryTuples(imp_sth->result) ? DBDPG_TRUE : DBDPG_FALSE;
+
+        flags = pg_st_decoder_flags(aTHX_ imp_dbh, imp_sth, binary);
+        if (flags != imp_sth->decoder_flags)
+            pg_st_decoder_setup(aTHX_ imp_sth, num_fields, flags);
+
+        start = imp_sth->cur_tuple;
+        count = imp_sth->rows - start;
+        if (max_rows >= 0 && count > max_rows - fetched)
+            count = max_rows - fetched;
+
+        if (TRACE5_slow) TRC(DBILOGFP, "%sFetching %ld rows starting at row %d\n", THEADER_slow, count, start);
+
+        /* Walk one column at a time, so each column array only needs to grow once */
+        for (i = 0; i < num_fields; ++i) {
+            AV *              column = (AV *)SvRV(AvARRAY(columns)[i]);
+            sql_type_info_t * type_info = imp_sth->type_info[i];
+            pg_decoder_t      decoder = imp_sth->decoders[i];
+            int               row;
+
+            av_extend(column, fetched + count - 1);
+
+            for (row = start; row < start + count; ++row) {
+                SV *sv = newSV(0);
+                av_store(column, fetched + row - start, sv);
+
+                TRACE_PQGETISNULL;
+                if (PQgetisnull(imp_sth->result, row, i)!=0)
+                    continue;
+
+                TRACE_PQGETVALUE;
+                TRACE_PQGETLENGTH;
+                if (!decoder(aTHX_ imp_dbh, type_info, sv, PQgetvalue(imp_sth->result, row, i),
+                             PQgetlength(imp_sth->result, row, i))) {
+                    pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "Cannot decode a binary value of this column type");
+                    SvREFCNT_dec((SV *)columns);
+                    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_fetch_columns (error: binary type %d)\n",
+                                       THEADER_slow, type_info->type_id);
+                    return &PL_sv_undef;
+                }
+            }
+        }
+
+        imp_sth->cur_tuple += count;
+        fetched += count;
+    }
+
+    /* Once everything has been fetched, the statement handle is finished */
+    if (imp_sth->cur_tuple == imp_sth->rows && imp_dbh->stream_sth != imp_sth) {
+        imp_sth->cur_tuple = 0;
+        DBIc_ACTIVE_off(imp_sth);
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_fetch_columns (rows: %ld)\n", THEADER_slow, fetched);
+    return newRV_noinc((SV *)columns);
+
+} /* end of pg_st_fetch_columns */
+
+
+/* ================================================================== */
+/*
+   Pop off savepoints to the specified savepoint name
+*/
+static void pg_db_free_savepoints_to (pTHX_ imp_dbh_t * imp_dbh, const char *savepoint)
+{
+    I32 i;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_free_savepoints_to\n", THEADER_slow);
+
+    for (i = av_len(imp_dbh->savepoints); i >= 0; i--) {
+        SV * const elem = av_pop(imp_dbh->savepoints);
+        if (strEQ(SvPV_nolen(elem), savepoint)) {
+            sv_2mortal(elem);
+            break;
+        }
+        sv_2mortal(elem);
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_free_savepoints_to\n", THEADER_slow);
+}
+
+
+/* ================================================================== */
+long dbd_st_rows (SV * sth, imp_sth_t * imp_sth)
+{
+    dTHX;
+
+    PERL_UNUSED_VAR(sth);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_rows\n", THEADER_slow);
+
+    /* When streaming, this is the number of rows received so far */
+    if (imp_sth->streamed)
+        return imp_sth->stream_total;
+
+    return imp_sth->rows;
+
+} /* end of dbd_st_rows */
+
+
+/* ================================================================== */
+int dbd_st_finish (SV * sth, imp_sth_t * imp_sth)
+{
+    dTHX;
+    D_imp_dbh_from_sth;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbdpg_finish (async: %d)\n",
+                    THEADER_slow, imp_dbh->async_status);
+
+    /* Only handle async cleanup if THIS statement owns the async query */
+    if (imp_dbh->async_status && imp_dbh->async_sth == imp_sth) {
+        handle_old_async(aTHX_ sth, imp_dbh, PG_OLDQUERY_WAIT);
+    }
+
+    imp_sth->async_status = STH_NO_ASYNC;
+    if (imp_dbh->async_sth == imp_sth) {
+        imp_dbh->async_sth = NULL;
+        imp_dbh->async_status = DBH_NO_ASYNC;
+    }
+
+    /* Throw away any rows not yet streamed in */
+    if (imp_dbh->stream_sth == imp_sth) {
+        pg_st_stream_discard(aTHX_ imp_dbh);
+    }
+
+    DBIc_ACTIVE_off(imp_sth);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_finish\n", THEADER_slow);
+    return 1;
+
+} /* end of dbd_st_finish */
+
+
+/* ================================================================== */
+static int pg_st_deallocate_statement (pTHX_ SV * sth, imp_sth_t * imp_sth)
+{
+    D_imp_dbh_from_sth;
+    char                    tempsqlstate[6];
+    int                     status;
+    PGTransactionStatusType tstatus;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_deallocate_statement\n", THEADER_slow);
+
+    if (imp_dbh->skip_deallocate) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (skipped)\n", THEADER_slow);
+        return 0;
+    }
+
+    if (NULL == imp_dbh->conn || NULL == imp_sth->prepare_name) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (0)\n", THEADER_slow);
+        return 0;
+    }
+
+    /* In pipeline mode, the deallocation is queued like any other command */
+    if (imp_dbh->in_pipeline) {
+        char * stmt;
+        New(0, stmt, strlen("DEALLOCATE ") + strlen(imp_sth->prepare_name) + 1, char); /* freed below */
+        sprintf(stmt, "DEALLOCATE %s", imp_sth->prepare_name);
+        status = pg_db_pipeline_command(aTHX_ sth, imp_dbh, stmt);
+        Safefree(stmt);
+        if (status != 0) {
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (error: pipeline)\n", THEADER_slow);
+            return 2;
+        }
+        Safefree(imp_sth->prepare_name);
+        imp_sth->prepare_name = NULL;
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (pipelined)\n", THEADER_slow);
+        return 0;
+    }
+
+    tempsqlstate[0] = '\0';
+
+    /* What is our status? */
+    tstatus = pg_db_txn_status(aTHX_ imp_dbh);
+    if (TRACE5_slow)
+        TRC(DBILOGFP, "%stxn_status is %d\n", THEADER_slow, tstatus);
+
+    /* If we are in a failed transaction, rollback before deallocating */
+    if (PQTRANS_INERROR == tstatus) {
+        if (TRACE4_slow)
+            TRC(DBILOGFP, "%sIssuing rollback before deallocate\n", THEADER_slow);
+        {
+            /* If a savepoint has been set, rollback to the last savepoint instead of the entire transaction */
+            I32    alen = av_len(imp_dbh->savepoints);
+            if (alen > -1) {
+                char    *cmd;
+                SV * const sp = *av_fetch(imp_dbh->savepoints, alen, 0);
+                New(0, cmd, SvLEN(sp) + 13, char); /* Freed below */
+                if (TRACE4_slow)
+                    TRC(DBILOGFP, "%sRolling back to savepoint %s\n", THEADER_slow, SvPV_nolen(sp));
+                sprintf(cmd, "rollback to %s", SvPV_nolen(sp));
+                strncpy(tempsqlstate, imp_dbh->sqlstate, sizeof(tempsqlstate)-1);
+                tempsqlstate[sizeof(tempsqlstate)-1]='\0';
+                status = _result(aTHX_ imp_dbh, cmd);
+                Safefree(cmd);
+            }
+            else {
+                status = _result(aTHX_ imp_dbh, "ROLLBACK");
+                imp_dbh->done_begin = DBDPG_FALSE;
+            }
+        }
+        if (PGRES_COMMAND_OK != status) {
+            /* This is not fatal, it just means we cannot deallocate */
+            if (TRACEWARN_slow) TRC(DBILOGFP, "%sRollback failed, so no deallocate\n", THEADER_slow);
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (cannot deallocate)\n", THEADER_slow);
+            return 1;
+        }
+    }
+
+#if PGLIBVERSION >= 170000
+
+    if (TRACE5_slow)
+        TRC(DBILOGFP, "%sUsing PQclosePrepared: %s\n", THEADER_slow, imp_sth->prepare_name);
+
+    CLEAR_LAST_RESULT(imp_dbh);
+
+    CLEAR_STH_RESULT(imp_sth);
+
+    TRACE_PQCLOSEPREPARED;
+    imp_dbh->last_result = imp_sth->result = PQclosePrepared(imp_dbh->conn, imp_sth->prepare_name);
+    imp_dbh->result_shared = DBDPG_TRUE;
+
+    status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
+#else
+    {
+        char *                  stmt;
+        New(0, stmt, strlen("DEALLOCATE ") + strlen(imp_sth->prepare_name) + 1, char); /* freed below */
+
+        sprintf(stmt, "DEALLOCATE %s", imp_sth->prepare_name);
+
+        if (TRACE5_slow)
+            TRC(DBILOGFP, "%sDeallocating (%s)\n", THEADER_slow, imp_sth->prepare_name);
+
+        status = _result(aTHX_ imp_dbh, stmt);
+        Safefree(stmt);
+    }
+#endif
+
+    if (PGRES_COMMAND_OK != status) {
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (error: status not OK)\n", THEADER_slow);
+        return 2;
+    }
+
+    Safefree(imp_sth->prepare_name);
+    imp_sth->prepare_name = NULL;
+    if (tempsqlstate[0]) {
+        strncpy(imp_dbh->sqlstate, tempsqlstate, 6);
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement\n", THEADER_slow);
+    return 0;
+
+} /* end of pg_st_deallocate_statement */
+
+
+/* ================================================================== */
+void dbd_st_destroy (SV * sth, imp_sth_t * imp_sth)
+{
+    dTHX;
+    D_imp_dbh_from_sth;
+
+    imp_dbh->do_tmp_sth = NULL;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_destroy\n", THEADER_slow);
+
+    if (0 == seg_array_count(imp_sth)) /* Already been destroyed! */
+        croak("dbd_st_destroy called twice!");
+
+    /* If the AutoInactiveDestroy flag has been set, we go no further */
+    if ((DBIc_AIADESTROY(imp_dbh)) && ((U32)PerlProc_getpid() != (size_t)imp_dbh->pid_number)) {
+        if (TRACE4_slow) {
+            TRC(DBILOGFP, "%sskipping sth destroy due to AutoInactiveDestroy\n", THEADER_slow);
+        }
+        DBIc_IMPSET_off(imp_sth); /* let DBI know we've done it */
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_destroy (AutoInactiveDestroy set)\n", THEADER_slow);
+        return;
+    }
+
+    /* If the InactiveDestroy flag has been set, we go no further */
+    if (DBIc_IADESTROY(imp_dbh)) {
+        if (TRACE4_slow) {
+            TRC(DBILOGFP, "%sskipping sth destroy due to InactiveDestroy\n", THEADER_slow);
+        }
+        DBIc_IMPSET_off(imp_sth); /* let DBI know we've done it */
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_destroy (InactiveDestroy set)\n", THEADER_slow);
+        return;
+    }
+
+    /* Only handle async cleanup if THIS statement owns the async query */
+    if (imp_dbh->async_status && imp_dbh->async_sth == imp_sth) {
+        handle_old_async(aTHX_ sth, imp_dbh, PG_OLDQUERY_WAIT);
+    }
+
+    /* Throw away any rows not yet streamed in, so the connection can be used again */
+    if (imp_dbh->stream_sth == imp_sth) {
+        pg_st_stream_discard(aTHX_ imp_dbh);
+    }
+
+    /* Deallocate only if we named this statement ourselves and we still have a good connection */
+    /* On rare occasions, dbd_db_destroy is called first and we can no longer rely on imp_dbh */
+    /* If the statement cache takes the statement over, there is nothing to deallocate */
+    if (imp_sth->prepared_by_us && DBIc_ACTIVE(imp_dbh)) {
+        if (!pg_st_cache_give(aTHX_ imp_dbh, imp_sth)
+            && pg_st_deallocate_statement(aTHX_ sth, imp_sth)!=0) {
+            if (TRACEWARN_slow)
+                TRC(DBILOGFP, "%sCould not deallocate\n", THEADER_slow);
+        }
+    }
+
+    Safefree(imp_sth->prepare_name);
+    Safefree(imp_sth->cache_key);
+    Safefree(imp_sth->cache_oids);
+    Safefree(imp_sth->type_info);
+    Safefree(imp_sth->decoders);
+    Safefree(imp_sth->firstword);
+    if (NULL != imp_sth->returning_sql)
+        SvREFCNT_dec(imp_sth->returning_sql);
+    Safefree(imp_sth->PQvals);
+    Safefree(imp_sth->PQlens);
+    Safefree(imp_sth->PQfmts);
+    Safefree(imp_sth->PQoids);
+
+    /*
+      If our result is the same as the last_result, we will not free it, but will
+       cede control over it so that the parent dbh can clear it later.
+       We do this in case $dbh->pg_error_field() is called
+    */
+    if (imp_sth->result == imp_dbh->last_result && NULL == imp_sth->result_hold) {
+        imp_dbh->result_shared = DBDPG_FALSE;
+    }
+    else {
+        CLEAR_STH_RESULT(imp_sth);
+    }
+
+    /* Regardless of the above, we want to not use this anymore */
+    imp_sth->result = NULL;
+
+    /* Free all the segments */
+    seg_array_destroy(imp_sth);
+
+    /* Free all the placeholders */
+    ph_array_destroy(imp_sth);
+
+    if (NULL != imp_dbh->async_sth && imp_dbh->async_sth == imp_sth)
+        imp_dbh->async_sth = NULL;
+
+    /* Results still due in the pipeline for this statement will be thrown away */
+    {
+        int i;
+        for (i=0; i < imp_dbh->pipeline_count; i++) {
+            if (imp_dbh->pipeline_sths[i] == imp_sth)
+                imp_dbh->pipeline_sths[i] = NULL;
+        }
+    }
+
+    DBIc_IMPSET_off(imp_sth); /* let DBI know we've done it */
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_destroy\n", THEADER_slow);
+
+} /* end of dbd_st_destroy */
+
+
+/* ================================================================== */
+int pg_db_putline (SV * dbh, SV * svbuf)
+{
+    dTHX;
+    D_imp_dbh(dbh);
+    const char * buffer;
+    STRLEN len;
+    int copystatus;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putline\n", THEADER_slow);
+
+    /* We must be in COPY IN state */
+    if (PGRES_COPY_IN != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
+        croak("pg_putline can only be called directly after issuing a COPY FROM command\n");
+
+    if (!svbuf || !SvOK(svbuf))
+        croak("pg_putline can only be called with a defined value\n");
+
+    buffer = SvPV(svbuf,len);
+
+    /* Rows buffered by pg_putcopydata must go first */
+    if (pg_db_copy_flush(aTHX_ dbh, imp_dbh) < 0) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putline (error: flush)\n", THEADER_slow);
+        return 0;
+    }
+
+    TRACE_PQPUTCOPYDATA;
+    copystatus = PQputCopyData(imp_dbh->conn, buffer, (int)strlen(buffer));
+    if (-1 == copystatus) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putline (error: copystatus not -1)\n", THEADER_slow);
+        return 0;
+    }
+    else if (1 != copystatus) {
+        croak("PQputCopyData gave a value of %d\n", copystatus);
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putline\n", THEADER_slow);
+    return 0;
+
+} /* end of pg_db_putline */
+
+
+/* ================================================================== */
+int pg_db_getline (SV * dbh, SV * svbuf)
+{
+    dTHX;
+    D_imp_dbh(dbh);
+    int    copystatus;
+    char * tempbuf;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_getline\n", THEADER_slow);
+
+    tempbuf = NULL;
+
+    /* We must be in COPY OUT state */
+    if (PGRES_COPY_OUT != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
+        croak("pg_getline can only be called directly after issuing a COPY TO command\n");
+
+    TRACE_PQGETCOPYDATA;
+    copystatus = PQgetCopyData(imp_dbh->conn, &tempbuf, 0);
+
+    if (-1 == copystatus) {
+        sv_setpvn(svbuf, "", 0);
+        imp_dbh->copystate=0;
+        TRACE_PQENDCOPY;
+        PQendcopy(imp_dbh->conn); /* Can't hurt */
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getline (-1)\n", THEADER_slow);
+        return -1;
+    }
+    else if (copystatus < 1) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+    }
+    else {
+        sv_setpvn(svbuf, tempbuf, copystatus);
+        TRACE_PQFREEMEM;
+        PQfreemem(tempbuf);
+    }
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getline (0)\n", THEADER_slow);
+    return 0;
+
+} /* end of pg_db_getline */
+
+
+/* ================================================================== */
+int pg_db_getcopydata (SV * dbh, SV * dataline, int async)
+{
+    dTHX;
+    D_imp_dbh(dbh);
+    int    copystatus;
+    char * tempbuf;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_getcopydata\n", THEADER_slow);
+
+    /* We must be in COPY OUT state */
+    if (PGRES_COPY_OUT != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
+        croak("pg_getcopydata can only be called directly after issuing a COPY TO command\n");
+
+    /* The arg to pg_db_getcopydata must be a writeable var */
+    if (SvREADONLY(dataline))
+        croak("pg_getcopydata: argument must be a writeable scalar");
+
+    tempbuf = NULL;
+
+    TRACE_PQGETCOPYDATA;
+    copystatus = PQgetCopyData(imp_dbh->conn, &tempbuf, async);
+
+    if (copystatus > 0) {
+        sv_setpvn(dataline, tempbuf, copystatus);
+        if (imp_dbh->pg_utf8_flag && !imp_dbh->copybinary)
+            SvUTF8_on(dataline);
+        else
+            SvUTF8_off(dataline);
+        TRACE_PQFREEMEM;
+        PQfreemem(tempbuf);
+    }
+    else if (0 == copystatus) { /* async and still in progress: consume and return */
+        TRACE_PQCONSUMEINPUT;
+        if (!PQconsumeInput(imp_dbh->conn)) {
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getcopydata (error: async in progress)\n", THEADER_slow);
+            return -2;
+        }
+    }
+    else if (-1 == copystatus) {
+        sv_setpv(dataline, "");
+        pg_db_copy_out_end(aTHX_ dbh, imp_dbh);
+    }
+    else {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+    }
+
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getcopydata\n", THEADER_slow);
+    return copystatus;
 
-    imp_dbh->copystate = 0; /* Assume not in copy mode until told otherwise */
+} /* end of pg_db_getcopydata */
 
-    if (PGRES_TUPLES_OK == status) {
-        imp_sth->cur_tuple = 0;
-        TRACE_PQNFIELDS;
-        int num_fields = PQnfields(imp_sth->result);
-        DBIc_NUM_FIELDS(imp_sth) = num_fields;
-        DBIc_ACTIVE_on(imp_sth);
-        TRACE_PQNTUPLES;
-        ret = PQntuples(imp_sth->result);
-        if (TRACE5_slow) TRC(DBILOGFP,
-                        "%sStatus was PGRES_TUPLES_OK, fields=%d, tuples=%ld\n",
-                        THEADER_slow, num_fields, ret);
+
+/* ================================================================== */
+/* The server has sent the last COPY OUT row: collect the final status */
+static void pg_db_copy_out_end (pTHX_ SV * dbh, imp_dbh_t * imp_dbh)
+{
+    PGresult * result;
+    ExecStatusType status;
+
+    imp_dbh->copystate=0;
+    TRACE_PQGETRESULT;
+    result = PQgetResult(imp_dbh->conn);
+    status = _sqlstate(aTHX_ imp_dbh, result);
+    while (result != NULL) {
+        TRACE_PQCLEAR;
+        PQclear(result);
+        TRACE_PQGETRESULT;
+        result = PQgetResult(imp_dbh->conn);
+    }
+    if (PGRES_COMMAND_OK != status) {
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
     }
-    else if (PGRES_COMMAND_OK == status) {
-        /* non-select statement */
-        bool gotrows = DBDPG_FALSE;
 
-        if (TRACE5_slow)
-            TRC(DBILOGFP, "%sStatus was PGRES_COMMAND_OK\n", THEADER_slow);
+} /* end of pg_db_copy_out_end */
 
-        if (imp_sth->result) {
-            TRACE_PQCMDTUPLES;
-            ret = atol(PQcmdTuples(imp_sth->result));
-            gotrows = ret;
-            imp_sth->rows = ret;
-        }
-        if (!gotrows) {
-            /* No rows affected, but check for change of state */
-            TRACE_PQTRANSACTIONSTATUS;
-            if (PQTRANS_IDLE == PQtransactionStatus(imp_dbh->conn)) {
-                imp_dbh->done_begin = DBDPG_FALSE;
-                /* If begin_work has been called, turn AutoCommit back on and BegunWork off */
-                if (DBIc_has(imp_dbh, DBIcf_BegunWork)!=0) {
-                    DBIc_set(imp_dbh, DBIcf_AutoCommit, 1);
-                    DBIc_set(imp_dbh, DBIcf_BegunWork, 0);
-                }
+
+/* ================================================================== */
+/*
+  Append as many COPY OUT rows as are available to buffer, waiting for more
+  until at least min_bytes have been added. The buffer's allocation is kept
+  and grown geometrically, so a caller that empties it between calls (with
+  $buf = '') reuses the same memory throughout. Returns the number of bytes
+  added, -1 once the COPY has finished (any last rows are still appended),
+  or -2 on error.
+*/
+IV pg_db_getcopydata_bulk (SV * dbh, SV * buffer, STRLEN min_bytes)
+{
+    dTHX;
+    D_imp_dbh(dbh);
+    bool   utf8;
+    STRLEN start;
+    STRLEN len;
+    int    copystatus;
+    char * tempbuf;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_getcopydata_bulk (min: %lu)\n", THEADER_slow, (unsigned long)min_bytes);
+
+    /* We must be in COPY OUT state */
+    if (PGRES_COPY_OUT != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
+        croak("pg_getcopydata_bulk can only be called directly after issuing a COPY TO command\n");
+
+    if (SvREADONLY(buffer))
+        croak("pg_getcopydata_bulk: argument must be a writeable scalar");
+
+    /* Make sure the existing contents can be appended to as-is */
+    utf8 = imp_dbh->pg_utf8_flag && !imp_dbh->copybinary;
+    if (!SvOK(buffer))
+        sv_setpvs(buffer, "");
+    (void)SvPV_force(buffer, start);
+    if (0 == start) {
+        if (utf8)
+            SvUTF8_on(buffer);
+        else
+            SvUTF8_off(buffer);
+    }
+    else if (utf8 && !SvUTF8(buffer))
+        sv_utf8_upgrade(buffer);
+    else if (!utf8 && SvUTF8(buffer))
+        sv_utf8_downgrade(buffer, FALSE);
+    start = len = SvCUR(buffer);
+    if (SvLEN(buffer) < len + min_bytes + 1)
+        SvGROW(buffer, len + min_bytes + 1);
+
+    for (;;) {
+        /* Only wait on the server until we have as much as was asked for */
+        const bool async = (len - start >= min_bytes && len > start);
+
+        tempbuf = NULL;
+        TRACE_PQGETCOPYDATA;
+        copystatus = PQgetCopyData(imp_dbh->conn, &tempbuf, async ? 1 : 0);
+
+        if (copystatus > 0) {
+            if (SvLEN(buffer) < len + (STRLEN)copystatus + 1) {
+                STRLEN newlen = SvLEN(buffer) * 2;
+                if (newlen < len + (STRLEN)copystatus + 1)
+                    newlen = len + (STRLEN)copystatus + 1;
+                SvGROW(buffer, newlen);
             }
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (OK, no rows)\n", THEADER_slow);
-            return 0;
+            Copy(tempbuf, SvPVX(buffer) + len, copystatus, char);
+            len += (STRLEN)copystatus;
+            TRACE_PQFREEMEM;
+            PQfreemem(tempbuf);
+        }
+        else if (0 == copystatus) { /* Nothing more is buffered yet */
+            break;
+        }
+        else if (-1 == copystatus) {
+            pg_db_copy_out_end(aTHX_ dbh, imp_dbh);
+            break;
+        }
+        else {
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            break;
         }
-    }
-    else if (PGRES_COPY_OUT == status || PGRES_COPY_IN == status || PGRES_COPY_BOTH == status) {
-        if (TRACE5_slow)
-            TRC(DBILOGFP, "%sStatus was PGRES_COPY_%s\n",
-                THEADER_slow, PGRES_COPY_OUT == status ? "OUT" : PGRES_COPY_IN == status ? "IN" : "BOTH");
-        /* Copy Out/In data transfer in progress */
-        imp_dbh->copystate = status;
-        imp_dbh->copybinary = PQbinaryTuples(imp_sth->result);
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (COPY)\n", THEADER_slow);
-        return -1;
-    }
-    else {
-        if (TRACE5_slow) TRC(DBILOGFP, "%sInvalid status returned (%d)\n", THEADER_slow, status);
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (error: bad status)\n", THEADER_slow);
-        return -2;
     }
 
-    /* store the number of affected rows */
+    SvCUR_set(buffer, len);
+    *SvEND(buffer) = '\0';
+    SvPOK_only_UTF8(buffer);
+    SvSETMAGIC(buffer);
 
-    imp_sth->rows = ret;
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getcopydata_bulk (status: %d, bytes: %lu)\n",
+                       THEADER_slow, copystatus, (unsigned long)(len - start));
+    return copystatus < 0 ? copystatus : (IV)(len - start);
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_execute (rows: %ld)\n", THEADER_slow, ret);
-    return ret;
+} /* end of pg_db_getcopydata_bulk */
 
-} /* end of dbd_st_execute */
 
+/* Size of the chunks that an array of COPY IN rows is sent in, when there is no pg_copy_buffer */
+#define PG_COPY_CHUNK 65536
 
 /* ================================================================== */
-AV * dbd_st_fetch (SV * sth, imp_sth_t * imp_sth)
+/*
+  Give any COPY IN rows held back by pg_putcopydata to libpq.
+  Returns 1 on success, 0 if a non-blocking connection is full, and -1 on error.
+*/
+static int pg_db_copy_flush (pTHX_ SV * dbh, imp_dbh_t * imp_dbh)
 {
-    dTHX;
-    D_imp_dbh_from_sth;
-    int               num_fields;
-    int               i;
-    int               chopblanks;
-    AV *              av;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_fetch\n", THEADER_slow);
+    int copystatus;
 
-    /* Check that execute() was executed successfully */
-    if ( !DBIc_ACTIVE(imp_sth) ) {
-        pg_error(aTHX_ sth, PGRES_NONFATAL_ERROR, "no statement executing\n");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch (error: no statement)\n", THEADER_slow);
-        return Nullav;
-    }
+    if (0 == imp_dbh->copy_buffer_length)
+        return 1;
 
-    TRACE_PQNTUPLES;
+    if (TRACE5_slow) TRC(DBILOGFP, "%sSending %d bytes of buffered COPY data\n", THEADER_slow, imp_dbh->copy_buffer_length);
 
-    if (imp_sth->cur_tuple == imp_sth->rows) {
-        if (TRACE5_slow)
-            TRC(DBILOGFP, "%sFetched the last tuple (%d)\n", THEADER_slow, imp_sth->cur_tuple);
-        imp_sth->cur_tuple = 0;
-        DBIc_ACTIVE_off(imp_sth);
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch (last tuple)\n", THEADER_slow);
-        return Nullav; /* we reached the last tuple */
+    TRACE_PQPUTCOPYDATA;
+    copystatus = PQputCopyData(imp_dbh->conn, imp_dbh->copy_buffer, imp_dbh->copy_buffer_length);
+    if (0 == copystatus)
+        return 0;
+    imp_dbh->copy_buffer_length = 0;
+    if (1 != copystatus) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        return -1;
     }
+    return 1;
 
-    av = DBIc_DBISTATE(imp_sth)->get_fbav(imp_sth);
-    num_fields = AvFILL(av)+1;
+} /* end of pg_db_copy_flush */
 
-    chopblanks = (int)DBIc_has(imp_sth, DBIcf_ChopBlanks);
 
-    /* Set up the type_info array if we have not seen it yet */
-    if (NULL == imp_sth->type_info) {
-        Newz(0, imp_sth->type_info, (size_t)num_fields, sql_type_info_t*); /* freed in dbd_st_destroy */
-        for (i = 0; i < num_fields; ++i) {
-            TRACE_PQFTYPE;
-            imp_sth->type_info[i] = pg_type_data((int)PQftype(imp_sth->result, i));
-            if (imp_sth->type_info[i] == NULL) {
-                if (TRACEWARN_slow) {
-                    TRACE_PQFTYPE;
-                    TRC(DBILOGFP, "%sUnknown type returned by Postgres: %d. Setting to UNKNOWN\n",
-                        THEADER_slow, PQftype(imp_sth->result, i));
-                }
-                imp_sth->type_info[i] = pg_type_data(PG_UNKNOWN);
+/* ================================================================== */
+/*
+  Add one row to the COPY IN buffer, sending it on whenever it would grow past
+  chunk bytes. Rows that are that big by themselves are sent as they are.
+  Only used on blocking connections. Returns 1 on success and -1 on error.
+*/
+static int pg_db_copy_queue (pTHX_ SV * dbh, imp_dbh_t * imp_dbh, const char * data, STRLEN len, int chunk)
+{
+    if ((STRLEN)imp_dbh->copy_buffer_length + len > (STRLEN)chunk) {
+        if (pg_db_copy_flush(aTHX_ dbh, imp_dbh) < 0)
+            return -1;
+        if (len >= (STRLEN)chunk) {
+            TRACE_PQPUTCOPYDATA;
+            if (1 != PQputCopyData(imp_dbh->conn, data, (int)len)) {
+                _fatal_sqlstate(aTHX_ imp_dbh);
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                return -1;
             }
+            return 1;
         }
     }
 
-    for (i = 0; i < num_fields; ++i) {
-        sql_type_info_t * type_info;
-        SV *sv;
+    if (imp_dbh->copy_buffer_alloc < chunk) {
+        Renew(imp_dbh->copy_buffer, chunk, char); /* freed in dbd_db_destroy */
+        imp_dbh->copy_buffer_alloc = chunk;
+    }
+    Copy(data, imp_dbh->copy_buffer + imp_dbh->copy_buffer_length, len, char);
+    imp_dbh->copy_buffer_length += (int)len;
+    return 1;
 
-        if (TRACE5_slow)
-            TRC(DBILOGFP, "%sFetching field #%d\n", THEADER_slow, i);
+} /* end of pg_db_copy_queue */
 
-        sv = AvARRAY(av)[i];
 
-        TRACE_PQGETISNULL;
-        if (PQgetisnull(imp_sth->result, imp_sth->cur_tuple, i)!=0) {
-            SvROK(sv) ? (void)sv_unref(sv) : (void)SvOK_off(sv);
-        }
-        else {
-            char * value;
-            TRACE_PQGETVALUE;
-            value = PQgetvalue(imp_sth->result, imp_sth->cur_tuple, i);
+/* ================================================================== */
+int pg_db_putcopydata (SV * dbh, SV * dataline, int async)
+{
+    dTHX;
+    D_imp_dbh(dbh);
+    int copystatus;
+    const char *copydata;
+    STRLEN copylen;
+    AV *rows = NULL;
 
-            type_info = imp_sth->type_info[i];
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putcopydata (async: %d)\n", THEADER_slow, async);
 
-            if (type_info
-                && 0 == strncmp(type_info->arrayout, "array", 5)
-                && imp_dbh->expand_array) {
-                sv_setsv(sv, sv_2mortal(pg_destringify_array(aTHX_ imp_dbh, value, type_info)));
-            }
-            else {
-                if (type_info) {
-                    STRLEN value_len;
-                    type_info->dequote(aTHX_ value, &value_len); /* dequote in place */
-                    /* For certain types, we can cast to non-string Perlish values */
-                    switch (type_info->type_id) {
-                    case PG_BOOL:
-                        if (imp_dbh->pg_bool_tf) {
-                            *value = ('1' == *value) ? 't' : 'f';
-                            sv_setpvn(sv, value, value_len);
-                        }
-                        else
-                            sv_setiv(sv, '1' == *value ? 1 : 0);
-                        break;
-#if IVSIZE >= 8 && LONGSIZE >= 8
-                    case PG_INT8:
-                        if (imp_dbh->pg_int8_as_string) {
-                            sv_setpvn(sv, value, value_len);
-                            break;
-                        }
-#endif
-                    /* fallthrough */
-                    case PG_INT2:
-                    case PG_INT4:
-                        sv_setiv(sv, atol(value));
-                        break;
-                    case PG_FLOAT4:
-                    case PG_FLOAT8:
-                        sv_setnv(sv, strtod(value, NULL));
-                        break;
-                    default:
-                        sv_setpvn(sv, value, value_len);
-                    }
-                }
-                else {
-                    sv_setpv(sv, value);
-                }
+    /* We must be in COPY IN state */
+    if (PGRES_COPY_IN != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
+        croak("pg_putcopydata can only be called directly after issuing a COPY FROM command\n");
 
-                if (type_info && (PG_BPCHAR == type_info->type_id) && chopblanks) {
-                    char *p = SvEND(sv);
-                    STRLEN len = SvCUR(sv);
-                    while(len && ' ' == *--p)
-                        --len;
-                    if (len != SvCUR(sv)) {
-                        SvCUR_set(sv, len);
-                        *SvEND(sv) = '\0';
-                    }
-                }
-            }
-            if (imp_dbh->pg_utf8_flag) {
-                /*
-                  The only exception to our rule about setting utf8 (when the client_encoding
-                  is set to UTF8) is bytea.
-                */
-                if (type_info && PG_BYTEA == type_info->type_id) {
-                    SvUTF8_off(sv);
-                }
-                /*
-                  Don't try to upgrade references (e.g. arrays).
-                  pg_destringify_array() upgrades the items as appropriate.
-                */
-                else if (!SvROK(sv)) {
-                    SvUTF8_on(sv);
-                    SvSETMAGIC(sv);
-                }
-            }
+    /* Enable non-blocking mode for async callers (safe during COPY: no other ops allowed) */
+    if (async && !imp_dbh->copy_nonblocking) {
+        TRACE_PQSETNONBLOCKING;
+        if (PQsetnonblocking(imp_dbh->conn, 1) != 0) {
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (error: setnonblocking)\n", THEADER_slow);
+            return -1;
         }
+        imp_dbh->copy_nonblocking = 1;
     }
 
-    imp_sth->cur_tuple += 1;
+    if (SvROK(dataline) && SVt_PVAV == SvTYPE(SvRV(dataline)) && !SvOBJECT(SvRV(dataline))) {
+        if (imp_dbh->copy_nonblocking)
+            croak("An array of rows cannot be sent once pg_putcopydata_async has been used\n");
+        rows = (AV*)SvRV(dataline);
+    }
 
-    /* Experimental inout support */
-    if (imp_sth->use_inout) {
-        for (int p=0; p < ph_array_count(imp_sth); p++) {
-            ph_t *currph = ph_array_element(imp_sth, p);
-            if (currph->isinout)
-                sv_copypv(currph->inout, AvARRAY(av)[p]);
+    /*
+      Rows are gathered into large chunks when asked for, and always when several
+      are given at once. That is not possible for COPY BOTH, where each call is a
+      separate replication message, or once async calls have made the connection
+      non-blocking.
+    */
+    if (!async && !imp_dbh->copy_nonblocking && PGRES_COPY_IN == imp_dbh->copystate
+        && (imp_dbh->copy_buffer_size > 0 || NULL != rows)) {
+        const int chunk = imp_dbh->copy_buffer_size > 0 ? imp_dbh->copy_buffer_size : PG_COPY_CHUNK;
+        int status = 1;
+        if (NULL == rows) {
+            if (imp_dbh->pg_utf8_flag && !imp_dbh->copybinary)
+                copydata = SvPVutf8(dataline, copylen);
+            else
+                copydata = SvPVbyte(dataline, copylen);
+            status = pg_db_copy_queue(aTHX_ dbh, imp_dbh, copydata, copylen, chunk);
+        }
+        else {
+            const SSize_t last = av_len(rows);
+            SSize_t x;
+            for (x = 0; x <= last && status > 0; x++) {
+                SV ** svp = av_fetch(rows, x, 0);
+                if (NULL == svp || !SvOK(*svp))
+                    continue;
+                if (imp_dbh->pg_utf8_flag && !imp_dbh->copybinary)
+                    copydata = SvPVutf8(*svp, copylen);
+                else
+                    copydata = SvPVbyte(*svp, copylen);
+                status = pg_db_copy_queue(aTHX_ dbh, imp_dbh, copydata, copylen, chunk);
+            }
         }
+        /* Without a buffer of its own, the caller expects everything to be sent now */
+        if (status > 0 && 0 == imp_dbh->copy_buffer_size)
+            status = pg_db_copy_flush(aTHX_ dbh, imp_dbh);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (buffered: %d)\n", THEADER_slow, imp_dbh->copy_buffer_length);
+        return status;
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_fetch\n", THEADER_slow);
-    return av;
-
-} /* end of dbd_st_fetch */
-
+    /* Anything buffered by earlier calls must go first */
+    if (imp_dbh->copy_buffer_length) {
+        copystatus = pg_db_copy_flush(aTHX_ dbh, imp_dbh);
+        if (copystatus <= 0) {
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (flush: %d)\n", THEADER_slow, copystatus);
+            return copystatus;
+        }
+    }
 
-/* ================================================================== */
-/*
-   Pop off savepoints to the specified savepoint name
-*/
-static void pg_db_free_savepoints_to (pTHX_ imp_dbh_t * imp_dbh, const char *savepoint)
-{
-    I32 i;
+    if (NULL != rows) { /* COPY BOTH: one message per row */
+        const SSize_t last = av_len(rows);
+        SSize_t x;
+        copystatus = 1;
+        for (x = 0; x <= last; x++) {
+            SV ** svp = av_fetch(rows, x, 0);
+            if (NULL == svp || !SvOK(*svp))
+                continue;
+            if (imp_dbh->pg_utf8_flag && !imp_dbh->copybinary)
+                copydata = SvPVutf8(*svp, copylen);
+            else
+                copydata = SvPVbyte(*svp, copylen);
+            TRACE_PQPUTCOPYDATA;
+            copystatus = PQputCopyData(imp_dbh->conn, copydata, copylen);
+            if (1 != copystatus)
+                break;
+        }
+    }
+    else {
+        if (imp_dbh->pg_utf8_flag && !imp_dbh->copybinary)
+            copydata = SvPVutf8(dataline, copylen);
+        else
+            copydata = SvPVbyte(dataline, copylen);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_free_savepoints_to\n", THEADER_slow);
+        TRACE_PQPUTCOPYDATA;
+        copystatus = PQputCopyData(imp_dbh->conn, copydata, copylen);
+    }
 
-    for (i = av_len(imp_dbh->savepoints); i >= 0; i--) {
-        SV * const elem = av_pop(imp_dbh->savepoints);
-        if (strEQ(SvPV_nolen(elem), savepoint)) {
-            sv_2mortal(elem);
-            break;
+    if (1 == copystatus) {
+        /* For COPY_BOTH (logical replication), flush immediately as before */
+        if (PGRES_COPY_BOTH == imp_dbh->copystate) {
+            TRACE_PQFLUSH;
+            if (PQflush(imp_dbh->conn)) {
+                _fatal_sqlstate(aTHX_ imp_dbh);
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (error: flush)\n", THEADER_slow);
+                return -1;
+            }
         }
-        sv_2mortal(elem);
+        /* For async mode, caller is responsible for calling pg_flush */
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (1)\n", THEADER_slow);
+        return 1;
+    }
+    else if (0 == copystatus) {
+        /* Non-blocking mode: output buffer full, caller should wait for write-ready */
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (buffer full)\n", THEADER_slow);
+        return 0;
+    }
+    else {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (error)\n", THEADER_slow);
+        return -1;
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_free_savepoints_to\n", THEADER_slow);
-}
+} /* end of pg_db_putcopydata */
 
 
 /* ================================================================== */
-long dbd_st_rows (SV * sth, imp_sth_t * imp_sth)
+int pg_db_putcopyend (SV * dbh)
 {
-    dTHX;
-
-    PERL_UNUSED_VAR(sth);
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_rows\n", THEADER_slow);
-
-    return imp_sth->rows;
-
-} /* end of dbd_st_rows */
 
+    /* If in COPY_IN or COPY_BOTH mode, terminate the COPYing */
+    /* Returns 1 on success, otherwise 0 (plus a probably warning/error) */
 
-/* ================================================================== */
-int dbd_st_finish (SV * sth, imp_sth_t * imp_sth)
-{
     dTHX;
-    D_imp_dbh_from_sth;
+    D_imp_dbh(dbh);
+    int copystatus;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbdpg_finish (async: %d)\n",
-                    THEADER_slow, imp_dbh->async_status);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putcopyend\n", THEADER_slow);
 
-    /* Only handle async cleanup if THIS statement owns the async query */
-    if (imp_dbh->async_status && imp_dbh->async_sth == imp_sth) {
-        handle_old_async(aTHX_ sth, imp_dbh, PG_OLDQUERY_WAIT);
+    if (0 == imp_dbh->copystate) {
+        warn("pg_putcopyend cannot be called until a COPY is issued");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (warning: copystate is 0)\n", THEADER_slow);
+        return 0;
     }
 
-    imp_sth->async_status = STH_NO_ASYNC;
-    if (imp_dbh->async_sth == imp_sth) {
-        imp_dbh->async_sth = NULL;
-        imp_dbh->async_status = DBH_NO_ASYNC;
+    if (PGRES_COPY_OUT == imp_dbh->copystate) {
+        warn("PQputcopyend does not need to be called when using PGgetcopydata");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (warning: copy state is OUT)\n", THEADER_slow);
+        return 0;
     }
 
-    DBIc_ACTIVE_off(imp_sth);
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_finish\n", THEADER_slow);
-    return 1;
-
-} /* end of dbd_st_finish */
-
+    /* Must be PGRES_COPY_IN or PGRES_COPY_BOTH at this point */
 
-/* ================================================================== */
-static int pg_st_deallocate_statement (pTHX_ SV * sth, imp_sth_t * imp_sth)
-{
-    D_imp_dbh_from_sth;
-    char                    tempsqlstate[6];
-    int                     status;
-    PGTransactionStatusType tstatus;
+    if (pg_db_copy_flush(aTHX_ dbh, imp_dbh) < 0) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (error: flush)\n", THEADER_slow);
+        return 0;
+    }
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_st_deallocate_statement\n", THEADER_slow);
+    TRACE_PQPUTCOPYEND;
+    copystatus = PQputCopyEnd(imp_dbh->conn, NULL);
 
-    if (imp_dbh->skip_deallocate) {
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (skipped)\n", THEADER_slow);
+    if (1 == copystatus) {
+        PGresult * result;
+        ExecStatusType status;
+        imp_dbh->copystate = 0;
+        TRACE_PQGETRESULT;
+        result = PQgetResult(imp_dbh->conn);
+        status = _sqlstate(aTHX_ imp_dbh, result);
+        while (result != NULL) {
+            TRACE_PQCLEAR;
+            PQclear(result);
+            TRACE_PQGETRESULT;
+            result = PQgetResult(imp_dbh->conn);
+        }
+        if (PGRES_COMMAND_OK != status) {
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (error: status not OK)\n", THEADER_slow);
+            return 0;
+        }
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (1)\n", THEADER_slow);
+        return 1;
+    }
+    else if (0 == copystatus) { /* non-blocking mode only */
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (0)\n", THEADER_slow);
         return 0;
     }
-
-    if (NULL == imp_dbh->conn || NULL == imp_sth->prepare_name) {
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (0)\n", THEADER_slow);
+    else {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (error: copystatus unknown)\n", THEADER_slow);
         return 0;
     }
 
-    tempsqlstate[0] = '\0';
+} /* end of pg_db_putcopyend */
 
-    /* What is our status? */
-    tstatus = pg_db_txn_status(aTHX_ imp_dbh);
-    if (TRACE5_slow)
-        TRC(DBILOGFP, "%stxn_status is %d\n", THEADER_slow, tstatus);
 
-    /* If we are in a failed transaction, rollback before deallocating */
-    if (PQTRANS_INERROR == tstatus) {
-        if (TRACE4_slow)
-            TRC(DBILOGFP, "%sIssuing rollback before deallocate\n", THEADER_slow);
-        {
-            /* If a savepoint has been set, rollback to the last savepoint instead of the entire transaction */
-            I32    alen = av_len(imp_dbh->savepoints);
-            if (alen > -1) {
-                char    *cmd;
-                SV * const sp = *av_fetch(imp_dbh->savepoints, alen, 0);
-                New(0, cmd, SvLEN(sp) + 13, char); /* Freed below */
-                if (TRACE4_slow)
-                    TRC(DBILOGFP, "%sRolling back to savepoint %s\n", THEADER_slow, SvPV_nolen(sp));
-                sprintf(cmd, "rollback to %s", SvPV_nolen(sp));
-                strncpy(tempsqlstate, imp_dbh->sqlstate, sizeof(tempsqlstate)-1);
-                tempsqlstate[sizeof(tempsqlstate)-1]='\0';
-                status = _result(aTHX_ imp_dbh, cmd);
-                Safefree(cmd);
-            }
-            else {
-                status = _result(aTHX_ imp_dbh, "ROLLBACK");
-                imp_dbh->done_begin = DBDPG_FALSE;
-            }
-        }
-        if (PGRES_COMMAND_OK != status) {
-            /* This is not fatal, it just means we cannot deallocate */
-            if (TRACEWARN_slow) TRC(DBILOGFP, "%sRollback failed, so no deallocate\n", THEADER_slow);
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (cannot deallocate)\n", THEADER_slow);
-            return 1;
-        }
-    }
+/* ================================================================== */
+/*
+   Non-blocking version of pg_db_putcopyend.
+   Sends the COPY end marker and attempts to collect the server result
+   without blocking. Restores blocking mode on completion (or error).
 
-#if PGLIBVERSION >= 170000
+   This function is designed to be called repeatedly in a poll loop:
+   - First call: sends PQputCopyEnd, attempts flush and result check
+   - Subsequent calls (when returning 0): polls for the server result
 
-    if (TRACE5_slow)
-        TRC(DBILOGFP, "%sUsing PQclosePrepared: %s\n", THEADER_slow, imp_sth->prepare_name);
+   Returns:
+    1 = COPY completed successfully, connection is back in normal mode
+    0 = not ready yet (caller should poll socket and call again)
+   -1 = error
+*/
+int pg_db_putcopyend_async (SV * dbh)
+{
+    dTHX;
+    D_imp_dbh(dbh);
 
-    CLEAR_LAST_RESULT(imp_dbh);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putcopyend_async (copystate: %d)\n",
+                         THEADER_slow, imp_dbh->copystate);
 
-    CLEAR_STH_RESULT(imp_sth);
+    switch (imp_dbh->copystate) {
 
-    TRACE_PQCLOSEPREPARED;
-    imp_dbh->last_result = imp_sth->result = PQclosePrepared(imp_dbh->conn, imp_sth->prepare_name);
-    imp_dbh->result_shared = DBDPG_TRUE;
+        /*
+          copystate == -1 means we already sent PQputCopyEnd on a prior call
+          and are waiting for the server result. Skip straight to result polling.
+        */
+    case -1:
+        break;
 
-    status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
-#else
-    {
-        char *                  stmt;
-        New(0, stmt, strlen("DEALLOCATE ") + strlen(imp_sth->prepare_name) + 1, char); /* freed below */
+    case 0:
+        warn("pg_putcopyend_async cannot be called until a COPY is issued");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (warning: copystate is 0)\n", THEADER_slow);
+        return -1;
 
-        sprintf(stmt, "DEALLOCATE %s", imp_sth->prepare_name);
+    case PGRES_COPY_OUT:
+        warn("pg_putcopyend_async does not need to be called when using pg_getcopydata");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (warning: copy state is OUT)\n", THEADER_slow);
+        return -1;
 
-        if (TRACE5_slow)
-            TRC(DBILOGFP, "%sDeallocating (%s)\n", THEADER_slow, imp_sth->prepare_name);
+    case PGRES_COPY_IN:
+    case PGRES_COPY_BOTH:
 
-        status = _result(aTHX_ imp_dbh, stmt);
-        Safefree(stmt);
-    }
-#endif
+        /* Rows buffered by pg_putcopydata must go first */
+        switch (pg_db_copy_flush(aTHX_ dbh, imp_dbh)) {
+        case 0:
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (buffer full)\n", THEADER_slow);
+            return 0;
+        case -1:
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: flush)\n", THEADER_slow);
+            return -1;
+        }
 
-    if (PGRES_COMMAND_OK != status) {
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ sth, status, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement (error: status not OK)\n", THEADER_slow);
-        return 2;
-    }
+        TRACE_PQPUTCOPYEND;
+        int copystatus = PQputCopyEnd(imp_dbh->conn, NULL);
 
-    Safefree(imp_sth->prepare_name);
-    imp_sth->prepare_name = NULL;
-    if (tempsqlstate[0]) {
-        strncpy(imp_dbh->sqlstate, tempsqlstate, 6);
-    }
+        if (0 == copystatus) {
+            /* Non-blocking mode: buffer full, caller should poll for write-ready */
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (buffer full)\n", THEADER_slow);
+            return 0;
+        }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_st_deallocate_statement\n", THEADER_slow);
-    return 0;
+        if (1 != copystatus) {
+            imp_dbh->copystate = 0;
+            if (imp_dbh->copy_nonblocking) {
+                TRACE_PQSETNONBLOCKING;
+                PQsetnonblocking(imp_dbh->conn, 0);
+                imp_dbh->copy_nonblocking = 0;
+            }
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error)\n", THEADER_slow);
+            return -1;
+        }
+
+        /* Mark that PQputCopyEnd has been successfully sent, awaiting result */
+        imp_dbh->copystate = -1;
+
+        /* Flush the end marker to the server */
+        TRACE_PQFLUSH;
+        int flushstatus = PQflush(imp_dbh->conn);
 
-} /* end of pg_st_deallocate_statement */
+        if (-1 == flushstatus) {
+            imp_dbh->copystate = 0;
+            if (imp_dbh->copy_nonblocking) {
+                TRACE_PQSETNONBLOCKING;
+                PQsetnonblocking(imp_dbh->conn, 0);
+                imp_dbh->copy_nonblocking = 0;
+            }
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: flush)\n", THEADER_slow);
+            return -1;
+        }
 
+        if (1 == flushstatus) {
+            /* Data pending in output buffer, caller should poll and retry */
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (flush pending)\n", THEADER_slow);
+            return 0;
+        }
 
-/* ================================================================== */
-void dbd_st_destroy (SV * sth, imp_sth_t * imp_sth)
-{
-    dTHX;
-    D_imp_dbh_from_sth;
+        /* flushstatus == 0: exit switch and do result polling */
+        break;
 
-    imp_dbh->do_tmp_sth = NULL;
+    default:
+        /* Should never be reached */
+        imp_dbh->copystate = 0;
+        if (imp_dbh->copy_nonblocking) {
+            TRACE_PQSETNONBLOCKING;
+            PQsetnonblocking(imp_dbh->conn, 0);
+            imp_dbh->copy_nonblocking = 0;
+        }
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (invalid copystate)\n", THEADER_slow);
+        return -1;
+    }
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_destroy\n", THEADER_slow);
+    /* result polling: check if the server result is ready (non-blocking) */
+    {
+        PGresult * result;
+        ExecStatusType status = PGRES_FATAL_ERROR;
 
-    if (0 == seg_array_count(imp_sth)) /* Already been destroyed! */
-        croak("dbd_st_destroy called twice!");
+        TRACE_PQCONSUMEINPUT;
+        if (0 == PQconsumeInput(imp_dbh->conn)) {
+            imp_dbh->copystate = 0;
+            if (imp_dbh->copy_nonblocking) {
+                TRACE_PQSETNONBLOCKING;
+                PQsetnonblocking(imp_dbh->conn, 0);
+                imp_dbh->copy_nonblocking = 0;
+            }
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: consumeInput)\n", THEADER_slow);
+            return -1;
+        }
 
-    /* If the AutoInactiveDestroy flag has been set, we go no further */
-    if ((DBIc_AIADESTROY(imp_dbh)) && ((U32)PerlProc_getpid() != (size_t)imp_dbh->pid_number)) {
-        if (TRACE4_slow) {
-            TRC(DBILOGFP, "%sskipping sth destroy due to AutoInactiveDestroy\n", THEADER_slow);
+        TRACE_PQISBUSY;
+        if (PQisBusy(imp_dbh->conn)) {
+            /* Server hasn't replied yet, caller should poll for read-ready */
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (result pending)\n", THEADER_slow);
+            return 0;
         }
-        DBIc_IMPSET_off(imp_sth); /* let DBI know we've done it */
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_destroy (AutoInactiveDestroy set)\n", THEADER_slow);
-        return;
-    }
 
-    /* If the InactiveDestroy flag has been set, we go no further */
-    if (DBIc_IADESTROY(imp_dbh)) {
-        if (TRACE4_slow) {
-            TRC(DBILOGFP, "%sskipping sth destroy due to InactiveDestroy\n", THEADER_slow);
+        /* Result is ready. Restore blocking mode and drain results. */
+        if (imp_dbh->copy_nonblocking) {
+            TRACE_PQSETNONBLOCKING;
+            if (-1 == PQsetnonblocking(imp_dbh->conn, 0)) {
+                imp_dbh->copystate = 0;
+                /* Technically, copy_nonblocking is still true, as PQsetnonblocking failed */
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: setnonblocking)\n", THEADER_slow);
+                return -1;
+            }
+            imp_dbh->copy_nonblocking = 0;
         }
-        DBIc_IMPSET_off(imp_sth); /* let DBI know we've done it */
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_destroy (InactiveDestroy set)\n", THEADER_slow);
-        return;
-    }
 
-    /* Only handle async cleanup if THIS statement owns the async query */
-    if (imp_dbh->async_status && imp_dbh->async_sth == imp_sth) {
-        handle_old_async(aTHX_ sth, imp_dbh, PG_OLDQUERY_WAIT);
-    }
+        imp_dbh->copystate = 0;
+        TRACE_PQGETRESULT;
+        result = PQgetResult(imp_dbh->conn);
+        if (result) {
+            status = _sqlstate(aTHX_ imp_dbh, result);
+            TRACE_PQCLEAR;
+            PQclear(result);
+        }
+        while ((result = PQgetResult(imp_dbh->conn)) != NULL) { // ok to not trace
+            PQclear(result);                                    // ok to not trace
+        }
 
-    /* Deallocate only if we named this statement ourselves and we still have a good connection */
-    /* On rare occasions, dbd_db_destroy is called first and we can no longer rely on imp_dbh */
-    if (imp_sth->prepared_by_us && DBIc_ACTIVE(imp_dbh)) {
-        if (pg_st_deallocate_statement(aTHX_ sth, imp_sth)!=0) {
-            if (TRACEWARN_slow)
-                TRC(DBILOGFP, "%sCould not deallocate\n", THEADER_slow);
+        if (PGRES_COMMAND_OK != status) {
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: status not OK)\n", THEADER_slow);
+            return -1;
         }
+
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (1)\n", THEADER_slow);
+        return 1;
     }
 
-    Safefree(imp_sth->prepare_name);
-    Safefree(imp_sth->type_info);
-    Safefree(imp_sth->firstword);
-    Safefree(imp_sth->PQvals);
-    Safefree(imp_sth->PQlens);
-    Safefree(imp_sth->PQfmts);
-    Safefree(imp_sth->PQoids);
+} /* end of pg_db_putcopyend_async */
 
-    /*
-      If our result is the same as the last_result, we will not free it, but will
-       cede control over it so that the parent dbh can clear it later.
-       We do this in case $dbh->pg_error_field() is called
-    */
-    if (imp_sth->result == imp_dbh->last_result) {
-        imp_dbh->result_shared = DBDPG_FALSE;
-    }
-    else {
-        CLEAR_STH_RESULT(imp_sth);
-    }
 
-    /* Regardless of the above, we want to not use this anymore */
-    imp_sth->result = NULL;
+/* ================================================================== */
+/*
+   Flush the libpq output buffer. Used during non-blocking COPY operations.
 
-    /* Free all the segments */
-    seg_array_destroy(imp_sth);
+   Returns:
+    0 = all data flushed successfully
+    1 = data still pending (caller should poll for write-ready and call again)
+   -1 = error
+*/
+int pg_db_flush (SV * dbh)
+{
+    dTHX;
+    D_imp_dbh(dbh);
+    int flush_status;
 
-    /* Free all the placeholders */
-    ph_array_destroy(imp_sth);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_flush\n", THEADER_slow);
 
-    if (NULL != imp_dbh->async_sth && imp_dbh->async_sth == imp_sth)
-        imp_dbh->async_sth = NULL;
+    TRACE_PQFLUSH;
+    flush_status = PQflush(imp_dbh->conn);
 
-    DBIc_IMPSET_off(imp_sth); /* let DBI know we've done it */
+    if (-1 == flush_status) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_flush (error)\n", THEADER_slow);
+        return -1;
+    }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_destroy\n", THEADER_slow);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_flush (%d)\n", THEADER_slow, flush_status);
+    return flush_status;
 
-} /* end of dbd_st_destroy */
+} /* end of pg_db_flush */
 
 
 /* ================================================================== */
-int pg_db_putline (SV * dbh, SV * svbuf)
+SV * pg_db_error_field (SV *dbh, char * fieldname)
 {
     dTHX;
     D_imp_dbh(dbh);
-    const char * buffer;
-    STRLEN len;
-    int copystatus;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putline\n", THEADER_slow);
-
-    /* We must be in COPY IN state */
-    if (PGRES_COPY_IN != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
-        croak("pg_putline can only be called directly after issuing a COPY FROM command\n");
+    int fieldcode = 0;
+    char ucname[42];
+    int i;
 
-    if (!svbuf || !SvOK(svbuf))
-        croak("pg_putline can only be called with a defined value\n");
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_error_field (fieldname=%s)\n", THEADER_slow, fieldname);
 
-    buffer = SvPV(svbuf,len);
+    for (i = 0; i < (int)sizeof(ucname) - 1 && fieldname[i]; i++)
+        ucname[i] = toupper((unsigned char)fieldname[i]);
+    ucname[i] = '\0';
 
-    TRACE_PQPUTCOPYDATA;
-    copystatus = PQputCopyData(imp_dbh->conn, buffer, (int)strlen(buffer));
-    if (-1 == copystatus) {
-        _fatal_sqlstate(aTHX_ imp_dbh);
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putline (error: copystatus not -1)\n", THEADER_slow);
-        return 0;
+    /* These allow partial matches, which is why 'severity_nonlocalized'  needs to go first */
+    if ( 0 == strncmp(ucname, "PG_DIAG_SEVERITY_NONLOCALIZED", 25) ||
+         0 == strncmp(ucname, "SEVERITY_NONLOCAL", 17)) {
+        fieldcode = PG_DIAG_SEVERITY_NONLOCALIZED; // i.e. 'V'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_SEVERITY", 16) ||
+              0 == strncmp(ucname, "SEVERITY", 8)) {
+        fieldcode = PG_DIAG_SEVERITY; // i.e. 'S'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_MESSAGE_PRIMARY", 20) ||
+              0 == strncmp(ucname, "MESSAGE_PRIMARY", 13) ||
+              0 == strncmp(ucname, "PRIMARY", 4)) {
+        fieldcode = PG_DIAG_MESSAGE_PRIMARY; // i.e. 'M'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_MESSAGE_DETAIL", 22) ||
+              0 == strncmp(ucname, "MESSAGE_DETAIL", 14) ||
+              0 == strncmp(ucname, "DETAIL", 6)) {
+        fieldcode = PG_DIAG_MESSAGE_DETAIL; // i.e. 'D'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_MESSAGE_HINT", 20) ||
+              0 == strncmp(ucname, "MESSAGE_HINT", 12) ||
+              0 == strncmp(ucname, "HINT", 4)) {
+        fieldcode = PG_DIAG_MESSAGE_HINT; // i.e. 'H'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_STATEMENT_POSITION", 21) ||
+              0 == strncmp(ucname, "STATEMENT_POSITION", 13)) {
+        fieldcode = PG_DIAG_STATEMENT_POSITION; // i.e. 'P'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_INTERNAL_POSITION", 20) ||
+              0 == strncmp(ucname, "INTERNAL_POSITION", 12)) {
+        fieldcode = PG_DIAG_INTERNAL_POSITION; // i.e. 'p'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_INTERNAL_QUERY", 22) ||
+              0 == strncmp(ucname, "INTERNAL_QUERY", 14)) {
+        fieldcode = PG_DIAG_INTERNAL_QUERY; // i.e. 'q'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_CONTEXT", 15) ||
+              0 == strncmp(ucname, "CONTEXT", 7)) {
+        fieldcode = PG_DIAG_CONTEXT; // i.e. 'W'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_SCHEMA_NAME", 14) ||
+              0 == strncmp(ucname, "SCHEMA", 5)) {
+        fieldcode = PG_DIAG_SCHEMA_NAME; // i.e. 's'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_TABLE_NAME", 13) ||
+              0 == strncmp(ucname, "TABLE", 5)) {
+        fieldcode = PG_DIAG_TABLE_NAME; // i.e. 't'
     }
-    else if (1 != copystatus) {
-        croak("PQputCopyData gave a value of %d\n", copystatus);
+    else if ( 0 == strncmp(ucname, "PG_DIAG_COLUMN_NAME", 11) ||
+              0 == strncmp(ucname, "COLUMN", 3)) {
+        fieldcode = PG_DIAG_COLUMN_NAME; // i.e. 'c'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_DATATYPE_NAME", 16) ||
+              0 == strncmp(ucname, "DATATYPE", 8) ||
+              0 == strncmp(ucname, "TYPE", 4)) {
+        fieldcode = PG_DIAG_DATATYPE_NAME; // i.e. 'd'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_CONSTRAINT_NAME", 18) ||
+              0 == strncmp(ucname, "CONSTRAINT", 10)) {
+        fieldcode = PG_DIAG_CONSTRAINT_NAME; // i.e. 'n'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_SOURCE_FILE", 19) ||
+              0 == strncmp(ucname, "SOURCE_FILE", 11)) {
+        fieldcode = PG_DIAG_SOURCE_FILE; // i.e. 'F'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_SOURCE_LINE", 19) ||
+              0 == strncmp(ucname, "SOURCE_LINE", 11)) {
+        fieldcode = PG_DIAG_SOURCE_LINE; // i.e. 'L'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_SOURCE_FUNCTION", 19) ||
+              0 == strncmp(ucname, "SOURCE_FUNCTION", 11)) {
+        fieldcode = PG_DIAG_SOURCE_FUNCTION; // i.e. 'R'
+    }
+    else if ( 0 == strncmp(ucname, "PG_DIAG_SQLSTATE", 16) ||
+              0 == strncmp(ucname, "SQLSTATE", 8) ||
+              0 == strncmp(ucname, "STATE", 5)) {
+        fieldcode = PG_DIAG_SQLSTATE; // i.e. 'C'
+    }
+    else {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Invalid error field");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_error_field (error: invalid field)\n", THEADER_slow);
+        return &PL_sv_undef;
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putline\n", THEADER_slow);
-    return 0;
-
-} /* end of pg_db_putline */
-
-
-/* ================================================================== */
-int pg_db_getline (SV * dbh, SV * svbuf)
-{
-    dTHX;
-    D_imp_dbh(dbh);
-    int    copystatus;
-    char * tempbuf;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_getline\n", THEADER_slow);
-
-    tempbuf = NULL;
-
-    /* We must be in COPY OUT state */
-    if (PGRES_COPY_OUT != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
-        croak("pg_getline can only be called directly after issuing a COPY TO command\n");
-
-    TRACE_PQGETCOPYDATA;
-    copystatus = PQgetCopyData(imp_dbh->conn, &tempbuf, 0);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_error_field (fieldcode: %d)\n", THEADER_slow, fieldcode);
 
-    if (-1 == copystatus) {
-        sv_setpvn(svbuf, "", 0);
-        imp_dbh->copystate=0;
-        TRACE_PQENDCOPY;
-        PQendcopy(imp_dbh->conn); /* Can't hurt */
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getline (-1)\n", THEADER_slow);
-        return -1;
-    }
-    else if (copystatus < 1) {
-        _fatal_sqlstate(aTHX_ imp_dbh);
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+    TRACE_PQRESULTERRORFIELD;
+    char *pq_err_field = PQresultErrorField(imp_dbh->last_result, fieldcode);
+    if (NULL == pq_err_field) {
+        return &PL_sv_undef;
     }
     else {
-        sv_setpvn(svbuf, tempbuf, copystatus);
-        TRACE_PQFREEMEM;
-        PQfreemem(tempbuf);
+        SV *sv_err_field = newSVpv(pq_err_field, 0);
+        if (imp_dbh->pg_utf8_flag)
+            SvUTF8_on(sv_err_field);
+        return sv_2mortal(sv_err_field);
     }
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getline (0)\n", THEADER_slow);
-    return 0;
 
-} /* end of pg_db_getline */
+} /* end of pg_db_error_field */
 
 
 /* ================================================================== */
-int pg_db_getcopydata (SV * dbh, SV * dataline, int async)
+int pg_db_endcopy (SV * dbh)
 {
     dTHX;
     D_imp_dbh(dbh);
-    int    copystatus;
-    char * tempbuf;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_getcopydata\n", THEADER_slow);
-
-    /* We must be in COPY OUT state */
-    if (PGRES_COPY_OUT != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
-        croak("pg_getcopydata can only be called directly after issuing a COPY TO command\n");
-
-    /* The arg to pg_db_getcopydata must be a writeable var */
-    if (SvREADONLY(dataline))
-        croak("pg_getcopydata: argument must be a writeable scalar");
+    int            copystatus;
+    PGresult *     result;
+    ExecStatusType status;
 
-    tempbuf = NULL;
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_endcopy\n", THEADER_slow);
 
-    TRACE_PQGETCOPYDATA;
-    copystatus = PQgetCopyData(imp_dbh->conn, &tempbuf, async);
+    if (0==imp_dbh->copystate)
+        croak("pg_endcopy cannot be called until a COPY is issued");
 
-    if (copystatus > 0) {
-        sv_setpvn(dataline, tempbuf, copystatus);
-        if (imp_dbh->pg_utf8_flag && !imp_dbh->copybinary)
-            SvUTF8_on(dataline);
-        else
-            SvUTF8_off(dataline);
-        TRACE_PQFREEMEM;
-        PQfreemem(tempbuf);
-    }
-    else if (0 == copystatus) { /* async and still in progress: consume and return */
-        TRACE_PQCONSUMEINPUT;
-        if (!PQconsumeInput(imp_dbh->conn)) {
+    if (PGRES_COPY_IN == imp_dbh->copystate) {
+        if (pg_db_copy_flush(aTHX_ dbh, imp_dbh) < 0) {
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_endcopy (error: flush)\n", THEADER_slow);
+            return 1;
+        }
+        TRACE_PQPUTCOPYEND;
+        copystatus = PQputCopyEnd(imp_dbh->conn, NULL);
+        if (-1 == copystatus) {
             _fatal_sqlstate(aTHX_ imp_dbh);
             TRACE_PQERRORMESSAGE;
             pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getcopydata (error: async in progress)\n", THEADER_slow);
-            return -2;
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_endcopy (error)\n", THEADER_slow);
+            return 1;
         }
-    }
-    else if (-1 == copystatus) {
-        PGresult * result;
-        ExecStatusType status;
-        sv_setpv(dataline, "");
-        imp_dbh->copystate=0;
+        else if (1 != copystatus)
+            croak("PQputCopyEnd returned a value of %d\n", copystatus);
+        /* Get the final result of the copy */
         TRACE_PQGETRESULT;
         result = PQgetResult(imp_dbh->conn);
         status = _sqlstate(aTHX_ imp_dbh, result);
-        while (result != NULL) {
-            TRACE_PQCLEAR;
-            PQclear(result);
-            TRACE_PQGETRESULT;
-            result = PQgetResult(imp_dbh->conn);
-        }
+        TRACE_PQCLEAR;
+        PQclear(result);
         if (PGRES_COMMAND_OK != status) {
             TRACE_PQERRORMESSAGE;
             pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_endcopy (error: status not OK)\n", THEADER_slow);
+            return 1;
         }
+        copystatus = 0;
     }
     else {
-        _fatal_sqlstate(aTHX_ imp_dbh);
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        TRACE_PQENDCOPY;
+        copystatus = PQendcopy(imp_dbh->conn);
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_getcopydata\n", THEADER_slow);
+    imp_dbh->copystate = 0;
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_endcopy\n", THEADER_slow);
     return copystatus;
 
-} /* end of pg_db_getcopydata */
+} /* end of pg_db_endcopy */
 
 
 /* ================================================================== */
-int pg_db_putcopydata (SV * dbh, SV * dataline, int async)
+void pg_db_pg_server_trace (SV * dbh, FILE * fh)
 {
     dTHX;
     D_imp_dbh(dbh);
-    int copystatus;
-    const char *copydata;
-    STRLEN copylen;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putcopydata (async: %d)\n", THEADER_slow, async);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_server_trace\n", THEADER_slow);
 
-    /* We must be in COPY IN state */
-    if (PGRES_COPY_IN != imp_dbh->copystate && PGRES_COPY_BOTH != imp_dbh->copystate)
-        croak("pg_putcopydata can only be called directly after issuing a COPY FROM command\n");
+    TRACE_PQTRACE;
+    PQtrace(imp_dbh->conn, fh);
 
-    /* Enable non-blocking mode for async callers (safe during COPY: no other ops allowed) */
-    if (async && !imp_dbh->copy_nonblocking) {
-        TRACE_PQSETNONBLOCKING;
-        if (PQsetnonblocking(imp_dbh->conn, 1) != 0) {
-            _fatal_sqlstate(aTHX_ imp_dbh);
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (error: setnonblocking)\n", THEADER_slow);
-            return -1;
-        }
-        imp_dbh->copy_nonblocking = 1;
-    }
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pg_server_trace\n", THEADER_slow);
 
-    if (imp_dbh->pg_utf8_flag && !imp_dbh->copybinary)
-        copydata = SvPVutf8(dataline, copylen);
-    else
-        copydata = SvPVbyte(dataline, copylen);
+} /* end of pg_db_pg_server_trace */
 
-    TRACE_PQPUTCOPYDATA;
-    copystatus = PQputCopyData(imp_dbh->conn, copydata, copylen);
 
-    if (1 == copystatus) {
-        /* For COPY_BOTH (logical replication), flush immediately as before */
-        if (PGRES_COPY_BOTH == imp_dbh->copystate) {
-            TRACE_PQFLUSH;
-            if (PQflush(imp_dbh->conn)) {
-                _fatal_sqlstate(aTHX_ imp_dbh);
-                TRACE_PQERRORMESSAGE;
-                pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (error: flush)\n", THEADER_slow);
-                return -1;
-            }
-        }
-        /* For async mode, caller is responsible for calling pg_flush */
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (1)\n", THEADER_slow);
-        return 1;
-    }
-    else if (0 == copystatus) {
-        /* Non-blocking mode: output buffer full, caller should wait for write-ready */
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (buffer full)\n", THEADER_slow);
-        return 0;
-    }
-    else {
-        _fatal_sqlstate(aTHX_ imp_dbh);
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopydata (error)\n", THEADER_slow);
-        return -1;
-    }
+/* ================================================================== */
+void pg_db_pg_server_untrace (SV * dbh)
+{
+    dTHX;
+    D_imp_dbh(dbh);
 
-} /* end of pg_db_putcopydata */
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_server_untrace\n", THEADER_slow);
 
+    TRACE_PQUNTRACE;
+    PQuntrace(imp_dbh->conn);
 
-/* ================================================================== */
-int pg_db_putcopyend (SV * dbh)
-{
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pg_server_untrace\n", THEADER_slow);
 
-    /* If in COPY_IN or COPY_BOTH mode, terminate the COPYing */
-    /* Returns 1 on success, otherwise 0 (plus a probably warning/error) */
+} /* end of pg_db_pg_server_untrace */
 
-    dTHX;
-    D_imp_dbh(dbh);
-    int copystatus;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putcopyend\n", THEADER_slow);
+/* ================================================================== */
+int pg_db_savepoint (SV * dbh, imp_dbh_t * imp_dbh, char * savepoint)
+{
+    dTHX;
+    int    status;
+    char * action;
 
-    if (0 == imp_dbh->copystate) {
-        warn("pg_putcopyend cannot be called until a COPY is issued");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (warning: copystate is 0)\n", THEADER_slow);
-        return 0;
-    }
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_savepoint (name: %s)\n", THEADER_slow, savepoint);
 
-    if (PGRES_COPY_OUT == imp_dbh->copystate) {
-        warn("PQputcopyend does not need to be called when using PGgetcopydata");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (warning: copy state is OUT)\n", THEADER_slow);
+    /* no action if AutoCommit = on or the connection is invalid */
+    if ((NULL == imp_dbh->conn) || (DBIc_has(imp_dbh, DBIcf_AutoCommit))) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint (0)\n", THEADER_slow);
         return 0;
     }
 
-    /* Must be PGRES_COPY_IN or PGRES_COPY_BOTH at this point */
-
-    TRACE_PQPUTCOPYEND;
-    copystatus = PQputCopyEnd(imp_dbh->conn, NULL);
-
-    if (1 == copystatus) {
-        PGresult * result;
-        ExecStatusType status;
-        imp_dbh->copystate = 0;
-        TRACE_PQGETRESULT;
-        result = PQgetResult(imp_dbh->conn);
-        status = _sqlstate(aTHX_ imp_dbh, result);
-        while (result != NULL) {
-            TRACE_PQCLEAR;
-            PQclear(result);
-            TRACE_PQGETRESULT;
-            result = PQgetResult(imp_dbh->conn);
-        }
+    /* Start a new transaction if this is the first command */
+    if (!imp_dbh->done_begin) {
+        status = _result(aTHX_ imp_dbh, "begin");
         if (PGRES_COMMAND_OK != status) {
             TRACE_PQERRORMESSAGE;
             pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (error: status not OK)\n", THEADER_slow);
-            return 0;
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint (error: status not OK for begin)\n", THEADER_slow);
+            return -2;
         }
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (1)\n", THEADER_slow);
-        return 1;
-    }
-    else if (0 == copystatus) { /* non-blocking mode only */
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (0)\n", THEADER_slow);
-        return 0;
+        imp_dbh->done_begin = DBDPG_TRUE;
     }
-    else {
-        _fatal_sqlstate(aTHX_ imp_dbh);
+
+    New(0, action, strlen(savepoint) + 11, char); /* freed below */
+    sprintf(action, "savepoint %s", savepoint);
+    status = _result(aTHX_ imp_dbh, action);
+    Safefree(action);
+
+    if (PGRES_COMMAND_OK != status) {
         TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend (error: copystatus unknown)\n", THEADER_slow);
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint (error: status not OK for savepoint)\n", THEADER_slow);
         return 0;
     }
 
-} /* end of pg_db_putcopyend */
-
+    av_push(imp_dbh->savepoints, newSVpv(savepoint,0));
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint\n", THEADER_slow);
+    return 1;
 
-/* ================================================================== */
-/*
-   Non-blocking version of pg_db_putcopyend.
-   Sends the COPY end marker and attempts to collect the server result
-   without blocking. Restores blocking mode on completion (or error).
+} /* end of pg_db_savepoint */
 
-   This function is designed to be called repeatedly in a poll loop:
-   - First call: sends PQputCopyEnd, attempts flush and result check
-   - Subsequent calls (when returning 0): polls for the server result
 
-   Returns:
-    1 = COPY completed successfully, connection is back in normal mode
-    0 = not ready yet (caller should poll socket and call again)
-   -1 = error
-*/
-int pg_db_putcopyend_async (SV * dbh)
+/* ================================================================== */
+int pg_db_rollback_to (SV * dbh, imp_dbh_t * imp_dbh, const char *savepoint)
 {
     dTHX;
-    D_imp_dbh(dbh);
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_putcopyend_async (copystate: %d)\n",
-                         THEADER_slow, imp_dbh->copystate);
-
-    switch (imp_dbh->copystate) {
-
-        /*
-          copystate == -1 means we already sent PQputCopyEnd on a prior call
-          and are waiting for the server result. Skip straight to result polling.
-        */
-    case -1:
-        break;
+    int    status;
+    char * action;
 
-    case 0:
-        warn("pg_putcopyend_async cannot be called until a COPY is issued");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (warning: copystate is 0)\n", THEADER_slow);
-        return -1;
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_rollback_to (name: %s)\n", THEADER_slow, savepoint);
 
-    case PGRES_COPY_OUT:
-        warn("pg_putcopyend_async does not need to be called when using pg_getcopydata");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (warning: copy state is OUT)\n", THEADER_slow);
-        return -1;
+    /* no action if AutoCommit = on or the connection is invalid */
+    if ((NULL == imp_dbh->conn) || (DBIc_has(imp_dbh, DBIcf_AutoCommit))) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_to (0)\n", THEADER_slow);
+        return 0;
+    }
 
-    case PGRES_COPY_IN:
-    case PGRES_COPY_BOTH:
+    New(0, action, strlen(savepoint) + 13, char);
+    sprintf(action, "rollback to %s", savepoint);
+    status = _result(aTHX_ imp_dbh, action);
+    Safefree(action);
 
-        TRACE_PQPUTCOPYEND;
-        int copystatus = PQputCopyEnd(imp_dbh->conn, NULL);
+    if (PGRES_COMMAND_OK != status) {
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_to (error: status not OK for rollback)\n", THEADER_slow);
+        return 0;
+    }
 
-        if (0 == copystatus) {
-            /* Non-blocking mode: buffer full, caller should poll for write-ready */
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (buffer full)\n", THEADER_slow);
-            return 0;
-        }
+    pg_db_free_savepoints_to(aTHX_ imp_dbh, savepoint);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_to\n", THEADER_slow);
+    return 1;
 
-        if (1 != copystatus) {
-            imp_dbh->copystate = 0;
-            if (imp_dbh->copy_nonblocking) {
-                TRACE_PQSETNONBLOCKING;
-                PQsetnonblocking(imp_dbh->conn, 0);
-                imp_dbh->copy_nonblocking = 0;
-            }
-            _fatal_sqlstate(aTHX_ imp_dbh);
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error)\n", THEADER_slow);
-            return -1;
-        }
+} /* end of pg_db_rollback_to */
 
-        /* Mark that PQputCopyEnd has been successfully sent, awaiting result */
-        imp_dbh->copystate = -1;
 
-        /* Flush the end marker to the server */
-        TRACE_PQFLUSH;
-        int flushstatus = PQflush(imp_dbh->conn);
+/* ================================================================== */
+int pg_db_release (SV * dbh, imp_dbh_t * imp_dbh, char * savepoint)
+{
+    dTHX;
+    int    status;
+    char * action;
 
-        if (-1 == flushstatus) {
-            imp_dbh->copystate = 0;
-            if (imp_dbh->copy_nonblocking) {
-                TRACE_PQSETNONBLOCKING;
-                PQsetnonblocking(imp_dbh->conn, 0);
-                imp_dbh->copy_nonblocking = 0;
-            }
-            _fatal_sqlstate(aTHX_ imp_dbh);
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: flush)\n", THEADER_slow);
-            return -1;
-        }
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_release (name: %s)\n", THEADER_slow, savepoint);
 
-        if (1 == flushstatus) {
-            /* Data pending in output buffer, caller should poll and retry */
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (flush pending)\n", THEADER_slow);
-            return 0;
-        }
+    /* no action if AutoCommit = on or the connection is invalid */
+    if ((NULL == imp_dbh->conn) || (DBIc_has(imp_dbh, DBIcf_AutoCommit))) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_release (0)\n", THEADER_slow);
+        return 0;
+    }
 
-        /* flushstatus == 0: exit switch and do result polling */
-        break;
+    New(0, action, strlen(savepoint) + 9, char);
+    sprintf(action, "release %s", savepoint);
+    status = _result(aTHX_ imp_dbh, action);
+    Safefree(action);
 
-    default:
-        /* Should never be reached */
-        imp_dbh->copystate = 0;
-        if (imp_dbh->copy_nonblocking) {
-            TRACE_PQSETNONBLOCKING;
-            PQsetnonblocking(imp_dbh->conn, 0);
-            imp_dbh->copy_nonblocking = 0;
-        }
-        _fatal_sqlstate(aTHX_ imp_dbh);
+    if (PGRES_COMMAND_OK != status) {
         TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (invalid copystate)\n", THEADER_slow);
-        return -1;
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_release (error: status not OK for release)\n", THEADER_slow);
+        return 0;
     }
 
-    /* result polling: check if the server result is ready (non-blocking) */
-    {
-        PGresult * result;
-        ExecStatusType status = PGRES_FATAL_ERROR;
+    pg_db_free_savepoints_to(aTHX_ imp_dbh, savepoint);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_release\n", THEADER_slow);
+    return 1;
 
-        TRACE_PQCONSUMEINPUT;
-        if (0 == PQconsumeInput(imp_dbh->conn)) {
-            imp_dbh->copystate = 0;
-            if (imp_dbh->copy_nonblocking) {
-                TRACE_PQSETNONBLOCKING;
-                PQsetnonblocking(imp_dbh->conn, 0);
-                imp_dbh->copy_nonblocking = 0;
-            }
-            _fatal_sqlstate(aTHX_ imp_dbh);
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: consumeInput)\n", THEADER_slow);
-            return -1;
-        }
+} /* end of pg_db_release */
 
-        TRACE_PQISBUSY;
-        if (PQisBusy(imp_dbh->conn)) {
-            /* Server hasn't replied yet, caller should poll for read-ready */
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (result pending)\n", THEADER_slow);
-            return 0;
-        }
 
-        /* Result is ready. Restore blocking mode and drain results. */
-        if (imp_dbh->copy_nonblocking) {
-            TRACE_PQSETNONBLOCKING;
-            if (-1 == PQsetnonblocking(imp_dbh->conn, 0)) {
-                imp_dbh->copystate = 0;
-                /* Technically, copy_nonblocking is still true, as PQsetnonblocking failed */
-                TRACE_PQERRORMESSAGE;
-                pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-                if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: setnonblocking)\n", THEADER_slow);
-                return -1;
-            }
-            imp_dbh->copy_nonblocking = 0;
-        }
+/* ================================================================== */
+/*
+   For lo_* functions. Used to ensure we are in a transaction
+*/
+static int pg_db_start_txn (pTHX_ SV * dbh, imp_dbh_t * imp_dbh)
+{
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_start_txn\n", THEADER_slow);
 
-        imp_dbh->copystate = 0;
-        TRACE_PQGETRESULT;
-        result = PQgetResult(imp_dbh->conn);
-        if (result) {
-            status = _sqlstate(aTHX_ imp_dbh, result);
-            TRACE_PQCLEAR;
-            PQclear(result);
-        }
-        while ((result = PQgetResult(imp_dbh->conn)) != NULL) { // ok to not trace
-            PQclear(result);                                    // ok to not trace
-        }
+    /* The lo_* calls that follow cannot share the connection with a stream */
+    pg_st_stream_discard(aTHX_ imp_dbh);
 
+    /* If not autocommit, start a new transaction */
+    if (!imp_dbh->done_begin) {
+        int status = _result(aTHX_ imp_dbh, "begin");
         if (PGRES_COMMAND_OK != status) {
             TRACE_PQERRORMESSAGE;
             pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (error: status not OK)\n", THEADER_slow);
-            return -1;
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_start_txn (error: status not OK for begin)\n", THEADER_slow);
+            return 0;
         }
-
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_putcopyend_async (1)\n", THEADER_slow);
-        return 1;
+        imp_dbh->done_begin = DBDPG_TRUE;
     }
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_start_txn\n", THEADER_slow);
 
-} /* end of pg_db_putcopyend_async */
+    return 1;
+
+} /* end of pg_db_start_txn */
 
 
 /* ================================================================== */
 /*
-   Flush the libpq output buffer. Used during non-blocking COPY operations.
-
-   Returns:
-    0 = all data flushed successfully
-    1 = data still pending (caller should poll for write-ready and call again)
-   -1 = error
+   For lo_import and lo_export functions. Used to commit or rollback a
+   transaction, but only if AutoCommit is on.
 */
-int pg_db_flush (SV * dbh)
+static int pg_db_end_txn (pTHX_ SV * dbh, imp_dbh_t * imp_dbh, int commit)
 {
-    dTHX;
-    D_imp_dbh(dbh);
-    int flush_status;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_flush\n", THEADER_slow);
+    int status;
 
-    TRACE_PQFLUSH;
-    flush_status = PQflush(imp_dbh->conn);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_end_txn with %s\n",
+                    THEADER_slow, commit ? "commit" : "rollback");
 
-    if (-1 == flush_status) {
-        _fatal_sqlstate(aTHX_ imp_dbh);
+    status = _result(aTHX_ imp_dbh, commit ? "commit" : "rollback");
+    imp_dbh->done_begin = DBDPG_FALSE;
+    if (PGRES_COMMAND_OK != status) {
         TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_flush (error)\n", THEADER_slow);
-        return -1;
+        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_end_txn (error: status not OK for %s)\n",
+                      THEADER_slow, commit ? "commit" : "rollback");
+        return 0;
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_flush (%d)\n", THEADER_slow, flush_status);
-    return flush_status;
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_end_txn\n", THEADER_slow);
 
-} /* end of pg_db_flush */
+    return 1;
+
+} /* end of pg_db_end_txn */
 
+/* Large object functions */
 
 /* ================================================================== */
-SV * pg_db_error_field (SV *dbh, char * fieldname)
+unsigned int pg_db_lo_creat (SV * dbh, int mode)
 {
+
     dTHX;
     D_imp_dbh(dbh);
-    int fieldcode = 0;
-    char ucname[42];
-    int i;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_error_field (fieldname=%s)\n", THEADER_slow, fieldname);
 
-    for (i = 0; i < (int)sizeof(ucname) - 1 && fieldname[i]; i++)
-        ucname[i] = toupper((unsigned char)fieldname[i]);
-    ucname[i] = '\0';
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_lo_creat (mode: %d)\n", THEADER_slow, mode);
 
-    /* These allow partial matches, which is why 'severity_nonlocalized'  needs to go first */
-    if ( 0 == strncmp(ucname, "PG_DIAG_SEVERITY_NONLOCALIZED", 25) ||
-         0 == strncmp(ucname, "SEVERITY_NONLOCAL", 17)) {
-        fieldcode = PG_DIAG_SEVERITY_NONLOCALIZED; // i.e. 'V'
-    }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_SEVERITY", 16) ||
-              0 == strncmp(ucname, "SEVERITY", 8)) {
-        fieldcode = PG_DIAG_SEVERITY; // i.e. 'S'
-    }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_MESSAGE_PRIMARY", 20) ||
-              0 == strncmp(ucname, "MESSAGE_PRIMARY", 13) ||
-              0 == strncmp(ucname, "PRIMARY", 4)) {
-        fieldcode = PG_DIAG_MESSAGE_PRIMARY; // i.e. 'M'
-    }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_MESSAGE_DETAIL", 22) ||
-              0 == strncmp(ucname, "MESSAGE_DETAIL", 14) ||
-              0 == strncmp(ucname, "DETAIL", 6)) {
-        fieldcode = PG_DIAG_MESSAGE_DETAIL; // i.e. 'D'
-    }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_MESSAGE_HINT", 20) ||
-              0 == strncmp(ucname, "MESSAGE_HINT", 12) ||
-              0 == strncmp(ucname, "HINT", 4)) {
-        fieldcode = PG_DIAG_MESSAGE_HINT; // i.e. 'H'
-    }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_STATEMENT_POSITION", 21) ||
-              0 == strncmp(ucname, "STATEMENT_POSITION", 13)) {
-        fieldcode = PG_DIAG_STATEMENT_POSITION; // i.e. 'P'
-    }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_INTERNAL_POSITION", 20) ||
-              0 == strncmp(ucname, "INTERNAL_POSITION", 12)) {
-        fieldcode = PG_DIAG_INTERNAL_POSITION; // i.e. 'p'
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_creat when AutoCommit is on");
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_INTERNAL_QUERY", 22) ||
-              0 == strncmp(ucname, "INTERNAL_QUERY", 14)) {
-        fieldcode = PG_DIAG_INTERNAL_QUERY; // i.e. 'q'
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh)) {
+        return 0; /* No other option, because lo_creat returns an Oid */
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_CONTEXT", 15) ||
-              0 == strncmp(ucname, "CONTEXT", 7)) {
-        fieldcode = PG_DIAG_CONTEXT; // i.e. 'W'
+
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_creat\n", THEADER_slow);
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_SCHEMA_NAME", 14) ||
-              0 == strncmp(ucname, "SCHEMA", 5)) {
-        fieldcode = PG_DIAG_SCHEMA_NAME; // i.e. 's'
+
+    return lo_creat(imp_dbh->conn, mode); /* 0 on error */
+
+}
+
+/* ================================================================== */
+int pg_db_lo_open (SV * dbh, unsigned int lobjId, int mode)
+{
+
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_lo_open (mode: %d objectid: %u)\n",
+                    THEADER_slow, mode, lobjId);
+
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_open when AutoCommit is on");
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_TABLE_NAME", 13) ||
-              0 == strncmp(ucname, "TABLE", 5)) {
-        fieldcode = PG_DIAG_TABLE_NAME; // i.e. 't'
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -2;
+
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_open\n", THEADER_slow);
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_COLUMN_NAME", 11) ||
-              0 == strncmp(ucname, "COLUMN", 3)) {
-        fieldcode = PG_DIAG_COLUMN_NAME; // i.e. 'c'
+
+    return lo_open(imp_dbh->conn, lobjId, mode); /* -1 on error */
+
+}
+
+/* ================================================================== */
+int pg_db_lo_close (SV * dbh, int fd)
+{
+
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_close (fd: %d)\n", THEADER_slow, fd);
+
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_close when AutoCommit is on");
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_DATATYPE_NAME", 16) ||
-              0 == strncmp(ucname, "DATATYPE", 8) ||
-              0 == strncmp(ucname, "TYPE", 4)) {
-        fieldcode = PG_DIAG_DATATYPE_NAME; // i.e. 'd'
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -1;
+
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_close\n", THEADER_slow);
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_CONSTRAINT_NAME", 18) ||
-              0 == strncmp(ucname, "CONSTRAINT", 10)) {
-        fieldcode = PG_DIAG_CONSTRAINT_NAME; // i.e. 'n'
+
+    return lo_close(imp_dbh->conn, fd); /* <0 on error, 0 if ok */
+
+}
+
+/* ================================================================== */
+int pg_db_lo_read (SV * dbh, int fd, char * buf, size_t len)
+{
+
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_read (fd: %d length: %" UVuf ")\n",
+                    THEADER_slow, fd, (UV)len);
+
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_read when AutoCommit is on");
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_SOURCE_FILE", 19) ||
-              0 == strncmp(ucname, "SOURCE_FILE", 11)) {
-        fieldcode = PG_DIAG_SOURCE_FILE; // i.e. 'F'
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -1;
+
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_read\n", THEADER_slow);
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_SOURCE_LINE", 19) ||
-              0 == strncmp(ucname, "SOURCE_LINE", 11)) {
-        fieldcode = PG_DIAG_SOURCE_LINE; // i.e. 'L'
+
+    return lo_read(imp_dbh->conn, fd, buf, len); /* bytes read, <0 on error */
+
+}
+
+/* ================================================================== */
+int pg_db_lo_write (SV * dbh, int fd, char * buf, size_t len)
+{
+
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_write (fd: %d length: %" UVuf ")\n",
+                    THEADER_slow, fd, (UV)len);
+
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_write when AutoCommit is on");
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_SOURCE_FUNCTION", 19) ||
-              0 == strncmp(ucname, "SOURCE_FUNCTION", 11)) {
-        fieldcode = PG_DIAG_SOURCE_FUNCTION; // i.e. 'R'
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -1;
+
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_write\n", THEADER_slow);
     }
-    else if ( 0 == strncmp(ucname, "PG_DIAG_SQLSTATE", 16) ||
-              0 == strncmp(ucname, "SQLSTATE", 8) ||
-              0 == strncmp(ucname, "STATE", 5)) {
-        fieldcode = PG_DIAG_SQLSTATE; // i.e. 'C'
+
+    return lo_write(imp_dbh->conn, fd, buf, len); /* bytes written, <0 on error */
+
+}
+
+/* ================================================================== */
+IV pg_db_lo_lseek (SV * dbh, int fd, IV offset, int whence)
+{
+
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_lseek (fd: %d offset: %" IVdf " whence: %d)\n",
+                    THEADER_slow, fd, offset, whence);
+
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_lseek when AutoCommit is on");
     }
-    else {
-        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Invalid error field");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_error_field (error: invalid field)\n", THEADER_slow);
-        return &PL_sv_undef;
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -1;
+
+#ifdef HAS64BITLO
+    if (imp_dbh->pg_server_version >= 90300) {
+        if (TLIBPQ_slow)
+            TRC(DBILOGFP, "%slo_lseek64\n", THEADER_slow);
+
+        return lo_lseek64(imp_dbh->conn, fd, offset, whence); /* new position, -1 on error */
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_error_field (fieldcode: %d)\n", THEADER_slow, fieldcode);
+    if (offset < INT_MIN || offset > INT_MAX)
+        croak("lo_lseek offset out of range of integer");
+#endif
 
-    TRACE_PQRESULTERRORFIELD;
-    char *pq_err_field = PQresultErrorField(imp_dbh->last_result, fieldcode);
-    if (NULL == pq_err_field) {
-        return &PL_sv_undef;
+    if (TLIBPQ_slow)
+        TRC(DBILOGFP, "%slo_lseek\n", THEADER_slow);
+
+    return lo_lseek(imp_dbh->conn, fd, offset, whence); /* new position, -1 on error */
+
+}
+
+
+/* ================================================================== */
+IV pg_db_lo_tell (SV * dbh, int fd)
+{
+
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_tell (fd: %d)\n", THEADER_slow, fd);
+
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_tell when AutoCommit is on");
     }
-    else {
-        SV *sv_err_field = newSVpv(pq_err_field, 0);
-        if (imp_dbh->pg_utf8_flag)
-            SvUTF8_on(sv_err_field);
-        return sv_2mortal(sv_err_field);
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -1;
+
+#ifdef HAS64BITLO
+    if (TLIBPQ_slow)
+        TRC(DBILOGFP, "%slo_tell64\n", THEADER_slow);
+
+    if (imp_dbh->pg_server_version >= 90300)
+        return lo_tell64(imp_dbh->conn, fd); /* current position, <0 on error */
+#endif
+
+    if (TLIBPQ_slow)
+        TRC(DBILOGFP, "%slo_tell\n", THEADER_slow);
+
+    return lo_tell(imp_dbh->conn, fd); /* current position, <0 on error */
+
+}
+
+/* ================================================================== */
+int pg_db_lo_truncate (SV * dbh, int fd, IV len)
+{
+
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_truncate (fd: %d length: %" IVdf ")\n",
+                         THEADER_slow, fd, len);
+
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_truncate when AutoCommit is on");
     }
 
-} /* end of pg_db_error_field */
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -1;
+
+#ifdef HAS64BITLO
+    if (TLIBPQ_slow)
+        TRC(DBILOGFP, "%slo_truncate64\n", THEADER_slow);
+
+    if (imp_dbh->pg_server_version >= 90300)
+        return lo_truncate64(imp_dbh->conn, fd, len); /* 0 success, <0 on error */
+
+    if (len < INT_MIN || len > INT_MAX)
+        croak("lo_truncate len out of range of integer");
+#endif
+
+    if (TLIBPQ_slow)
+        TRC(DBILOGFP, "%slo_truncate\n", THEADER_slow);
+    return lo_truncate(imp_dbh->conn, fd, len); /* 0 success, <0 on error */
 
+}
 
 /* ================================================================== */
-int pg_db_endcopy (SV * dbh)
+int pg_db_lo_unlink (SV * dbh, unsigned int lobjId)
 {
+
     dTHX;
     D_imp_dbh(dbh);
-    int            copystatus;
-    PGresult *     result;
-    ExecStatusType status;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_endcopy\n", THEADER_slow);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_unlink (objectid: %u)\n", THEADER_slow, lobjId);
 
-    if (0==imp_dbh->copystate)
-        croak("pg_endcopy cannot be called until a COPY is issued");
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        croak("Cannot call pg_lo_unlink when AutoCommit is on");
+    }
 
-    if (PGRES_COPY_IN == imp_dbh->copystate) {
-        TRACE_PQPUTCOPYEND;
-        copystatus = PQputCopyEnd(imp_dbh->conn, NULL);
-        if (-1 == copystatus) {
-            _fatal_sqlstate(aTHX_ imp_dbh);
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_endcopy (error)\n", THEADER_slow);
-            return 1;
-        }
-        else if (1 != copystatus)
-            croak("PQputCopyEnd returned a value of %d\n", copystatus);
-        /* Get the final result of the copy */
-        TRACE_PQGETRESULT;
-        result = PQgetResult(imp_dbh->conn);
-        status = _sqlstate(aTHX_ imp_dbh, result);
-        TRACE_PQCLEAR;
-        PQclear(result);
-        if (PGRES_COMMAND_OK != status) {
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_endcopy (error: status not OK)\n", THEADER_slow);
-            return 1;
-        }
-        copystatus = 0;
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -1;
+
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_unlink\n", THEADER_slow);
     }
-    else {
-        TRACE_PQENDCOPY;
-        copystatus = PQendcopy(imp_dbh->conn);
+
+    return lo_unlink(imp_dbh->conn, lobjId); /* 1 on success, -1 on failure */
+
+}
+
+/* ================================================================== */
+unsigned int pg_db_lo_import (SV * dbh, char * filename)
+{
+
+    Oid loid;
+    dTHX;
+    D_imp_dbh(dbh);
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_import (filename: %s)\n", THEADER_slow, filename);
+
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return 0; /* No other option, because lo_import returns an Oid */
+
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_import\n", THEADER_slow);
     }
+    loid = lo_import(imp_dbh->conn, filename); /* 0 on error */
 
-    imp_dbh->copystate = 0;
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_endcopy\n", THEADER_slow);
-    return copystatus;
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        if (!pg_db_end_txn(aTHX_ dbh, imp_dbh, 0==loid ? 0 : 1))
+            return 0;
+    }
 
-} /* end of pg_db_endcopy */
+    return loid;
 
+}
 
 /* ================================================================== */
-void pg_db_pg_server_trace (SV * dbh, FILE * fh)
+unsigned int pg_db_lo_import_with_oid (SV * dbh, char * filename, unsigned int lobjId)
 {
+
+    Oid loid;
     dTHX;
     D_imp_dbh(dbh);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_server_trace\n", THEADER_slow);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_import_with_oid (filename: %s, oid: %u)\n",
+                    THEADER_slow, filename, lobjId);
 
-    TRACE_PQTRACE;
-    PQtrace(imp_dbh->conn, fh);
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return 0; /* No other option, because lo_import* returns an Oid */
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pg_server_trace\n", THEADER_slow);
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_import_with_oid\n", THEADER_slow);
+    }
+    loid = lo_import_with_oid(imp_dbh->conn, filename, lobjId); /* 0 on error */
 
-} /* end of pg_db_pg_server_trace */
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        if (!pg_db_end_txn(aTHX_ dbh, imp_dbh, 0==loid ? 0 : 1))
+            return 0;
+    }
+
+    return loid;
 
+}
 
 /* ================================================================== */
-void pg_db_pg_server_untrace (SV * dbh)
+int pg_db_lo_export (SV * dbh, unsigned int lobjId, char * filename)
 {
+
+    int result;
     dTHX;
     D_imp_dbh(dbh);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_server_untrace\n", THEADER_slow);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_export (objectid: %u filename: %s)\n",
+                    THEADER_slow, lobjId, filename);
 
-    TRACE_PQUNTRACE;
-    PQuntrace(imp_dbh->conn);
+    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+        return -2;
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pg_server_untrace\n", THEADER_slow);
+    if (TLIBPQ_slow) {
+        TRC(DBILOGFP, "%slo_export\n", THEADER_slow);
+    }
+    result = lo_export(imp_dbh->conn, lobjId, filename); /* 1 on success, -1 on failure */
+    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
+        if (!pg_db_end_txn(aTHX_ dbh, imp_dbh, result==-1 ? 0 : 1))
+            return -1;
+    }
 
-} /* end of pg_db_pg_server_untrace */
+    return result;
+}
 
 
 /* ================================================================== */
-int pg_db_savepoint (SV * dbh, imp_dbh_t * imp_dbh, char * savepoint)
+int dbd_st_blob_read (SV * sth, imp_sth_t * imp_sth, int lobjId, long offset, long len, SV * destrv, long destoffset)
 {
     dTHX;
-    int    status;
-    char * action;
+    D_imp_dbh_from_sth;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_savepoint (name: %s)\n", THEADER_slow, savepoint);
+    int    ret, lobj_fd, nbytes;
+    STRLEN nread;
+    SV *   bufsv;
+    char * tmp;
 
-    /* no action if AutoCommit = on or the connection is invalid */
-    if ((NULL == imp_dbh->conn) || (DBIc_has(imp_dbh, DBIcf_AutoCommit))) {
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint (0)\n", THEADER_slow);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_blob_read (objectid: %d offset: %ld length: %ld)\n",
+                    THEADER_slow, lobjId, offset, len);
+
+    /* safety checks */
+    if (lobjId <= 0) {
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: lobjId <= 0");
+        return 0;
+    }
+    if (offset < 0) {
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: offset < 0");
+        return 0;
+    }
+    if (len < 0) {
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: len < 0");
+        return 0;
+    }
+    if (! SvROK(destrv)) {
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: destrv not a reference");
+        return 0;
+    }
+    if (destoffset < 0) {
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: destoffset < 0");
         return 0;
     }
 
-    /* Start a new transaction if this is the first command */
-    if (!imp_dbh->done_begin) {
-        status = _result(aTHX_ imp_dbh, "begin");
-        if (PGRES_COMMAND_OK != status) {
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint (error: status not OK for begin)\n", THEADER_slow);
-            return -2;
-        }
-        imp_dbh->done_begin = DBDPG_TRUE;
+    /* dereference destination and ensure it's writable string */
+    bufsv = SvRV(destrv);
+    if (0==destoffset) {
+        sv_setpvn(bufsv, "", 0);
     }
 
-    New(0, action, strlen(savepoint) + 11, char); /* freed below */
-    sprintf(action, "savepoint %s", savepoint);
-    status = _result(aTHX_ imp_dbh, action);
-    Safefree(action);
+    pg_st_stream_discard(aTHX_ imp_dbh);
 
-    if (PGRES_COMMAND_OK != status) {
+    /* open large object */
+    lobj_fd = lo_open(imp_dbh->conn, (unsigned)lobjId, INV_READ);
+    if (lobj_fd < 0) {
         TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint (error: status not OK for savepoint)\n", THEADER_slow);
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (error: open failed)\n", THEADER_slow);
         return 0;
     }
 
-    av_push(imp_dbh->savepoints, newSVpv(savepoint,0));
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_savepoint\n", THEADER_slow);
-    return 1;
-
-} /* end of pg_db_savepoint */
-
-
-/* ================================================================== */
-int pg_db_rollback_to (SV * dbh, imp_dbh_t * imp_dbh, const char *savepoint)
-{
-    dTHX;
-    int    status;
-    char * action;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_rollback_to (name: %s)\n", THEADER_slow, savepoint);
+    /* seek on large object */
+    if (offset > 0) {
+        ret = lo_lseek(imp_dbh->conn, lobj_fd, (int)offset, SEEK_SET);
+        if (ret < 0) {
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (error: bad seek)\n", THEADER_slow);
+            return 0;
+        }
+    }
 
-    /* no action if AutoCommit = on or the connection is invalid */
-    if ((NULL == imp_dbh->conn) || (DBIc_has(imp_dbh, DBIcf_AutoCommit))) {
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_to (0)\n", THEADER_slow);
-        return 0;
+    /* read from large object */
+    nread = 0;
+    SvGROW(bufsv, (STRLEN)(destoffset + nread + BUFSIZ + 1));
+    tmp = (SvPVX(bufsv)) + destoffset + nread;
+    while ((nbytes = lo_read(imp_dbh->conn, lobj_fd, tmp, BUFSIZ)) > 0) {
+        nread += nbytes;
+        /* break if user wants only a specified chunk */
+        if (len > 0 && nread > (STRLEN)len) {
+            nread = (STRLEN)len;
+            break;
+        }
+        SvGROW(bufsv, (STRLEN)(destoffset + nread + BUFSIZ + 1));
+        tmp = (SvPVX(bufsv)) + destoffset + nread;
     }
 
-    New(0, action, strlen(savepoint) + 13, char);
-    sprintf(action, "rollback to %s", savepoint);
-    status = _result(aTHX_ imp_dbh, action);
-    Safefree(action);
+    /* terminate string */
+    SvCUR_set(bufsv, (STRLEN)(destoffset + nread));
+    *SvEND(bufsv) = '\0';
 
-    if (PGRES_COMMAND_OK != status) {
+    /* close large object */
+    ret = lo_close(imp_dbh->conn, lobj_fd);
+    if (ret < 0) {
         TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_to (error: status not OK for rollback)\n", THEADER_slow);
+        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (error: close failed)\n", THEADER_slow);
         return 0;
     }
 
-    pg_db_free_savepoints_to(aTHX_ imp_dbh, savepoint);
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_rollback_to\n", THEADER_slow);
-    return 1;
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (bytes: %d)\n", THEADER_slow, (int)nread);
+    return (int)nread;
 
-} /* end of pg_db_rollback_to */
+} /* end of dbd_st_blob_read */
 
 
 /* ================================================================== */
-int pg_db_release (SV * dbh, imp_dbh_t * imp_dbh, char * savepoint)
+/*
+   Return the result of an asynchronous query, waiting if needed
+*/
+long pg_db_result (SV *h, imp_dbh_t *imp_dbh)
 {
     dTHX;
-    int    status;
-    char * action;
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_release (name: %s)\n", THEADER_slow, savepoint);
-
-    /* no action if AutoCommit = on or the connection is invalid */
-    if ((NULL == imp_dbh->conn) || (DBIc_has(imp_dbh, DBIcf_AutoCommit))) {
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_release (0)\n", THEADER_slow);
-        return 0;
-    }
+    PGresult *result;
+    ExecStatusType status;
+    long rows = 0;
+    /* Determine if we were called from a statement handle or database handle */
+    /* The Pg.xs passes sth/dbh as h, but imp_dbh is always the database handle */
+    D_imp_xxh(h);
+    imp_sth_t *imp_sth = NULL;
 
-    New(0, action, strlen(savepoint) + 9, char);
-    sprintf(action, "release %s", savepoint);
-    status = _result(aTHX_ imp_dbh, action);
-    Safefree(action);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_result\n", THEADER_slow);
 
-    if (PGRES_COMMAND_OK != status) {
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_release (error: status not OK for release)\n", THEADER_slow);
-        return 0;
+    if (DBIt_ST == DBIc_TYPE(imp_xxh)) {
+        imp_sth = (imp_sth_t*)imp_xxh;
     }
 
-    pg_db_free_savepoints_to(aTHX_ imp_dbh, savepoint);
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_release\n", THEADER_slow);
-    return 1;
+    /* Handle auto-retrieved results from PG_OLDQUERY_WAIT */
+    if (imp_sth && STH_ASYNC_AUTORETRIEVED == imp_sth->async_status) {
+        if (NULL == imp_sth->result) {
+            pg_error(aTHX_ h, PGRES_FATAL_ERROR, "Auto-retrieved results already consumed");
+            return -2;
+        }
 
-} /* end of pg_db_release */
+        status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
 
+        if (PGRES_TUPLES_OK == status || PGRES_COMMAND_OK == status) {
+            rows = imp_sth->rows;
+        }
+        else {
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ h, status, PQerrorMessage(imp_dbh->conn));
+            rows = -2;
+        }
+        imp_sth->async_status = STH_NO_ASYNC;
 
-/* ================================================================== */
-/*
-   For lo_* functions. Used to ensure we are in a transaction
-*/
-static int pg_db_start_txn (pTHX_ SV * dbh, imp_dbh_t * imp_dbh)
-{
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_start_txn\n", THEADER_slow);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (auto-retrieved, %ld rows)\n", THEADER_slow, rows);
+        return rows;
+    }
 
-    /* If not autocommit, start a new transaction */
-    if (!imp_dbh->done_begin) {
-        int status = _result(aTHX_ imp_dbh, "begin");
-        if (PGRES_COMMAND_OK != status) {
+    /* Handle auto-retrieved error results from PG_OLDQUERY_WAIT */
+    if (imp_sth && STH_ASYNC_AUTOERROR == imp_sth->async_status) {
+        if (NULL == imp_sth->result) {
             TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_start_txn (error: status not OK for begin)\n", THEADER_slow);
-            return 0;
+            pg_error(aTHX_ h, PGRES_FATAL_ERROR, "Auto-retrieved error already reported");
+            return -2;
         }
-        imp_dbh->done_begin = DBDPG_TRUE;
+
+        status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
+
+        TRACE_PQRESULTERRORMESSAGE;
+        pg_error(aTHX_ h, status, PQresultErrorMessage(imp_sth->result));
+        imp_sth->async_status = STH_NO_ASYNC;
+
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (auto-retrieved error)\n", THEADER_slow);
+        return -2;
     }
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_start_txn\n", THEADER_slow);
 
-    return 1;
+    /* No auto-retrieved results: check that an async query is actually running */
+    if (DBH_ASYNC != imp_dbh->async_status) {
+        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "No asynchronous query is running\n");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (error: no async)\n", THEADER_slow);
+        return -2;
+    }
 
-} /* end of pg_db_start_txn */
+    /* Verify ownership: only the statement that started the async query can retrieve it */
+    if (imp_sth && imp_dbh->async_sth && imp_sth != imp_dbh->async_sth) {
+        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "pg_result() called on wrong statement handle - this statement does not own the async query\n");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (wrong statement)\n", THEADER_slow);
+        return -2;
+    }
 
+    imp_dbh->copystate = 0; /* Assume not in copy mode until told otherwise */
 
-/* ================================================================== */
-/*
-   For lo_import and lo_export functions. Used to commit or rollback a
-   transaction, but only if AutoCommit is on.
-*/
-static int pg_db_end_txn (pTHX_ SV * dbh, imp_dbh_t * imp_dbh, int commit)
-{
-    int status;
+    TRACE_PQGETRESULT;
+    while ((result = PQgetResult(imp_dbh->conn)) != NULL) {
+        /* TODO: Better multiple result-set handling */
+        status = _sqlstate(aTHX_ imp_dbh, result);
+        switch ((int)status) {
+        case PGRES_TUPLES_OK:
+            TRACE_PQNTUPLES;
+            rows = PQntuples(result);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_end_txn with %s\n",
-                    THEADER_slow, commit ? "commit" : "rollback");
+            /* Store metadata in the appropriate statement handle */
+            if (imp_sth && imp_sth == imp_dbh->async_sth) {
+                imp_sth->cur_tuple = 0;
+                TRACE_PQNFIELDS;
+                DBIc_NUM_FIELDS(imp_sth) = PQnfields(result);
+                DBIc_ACTIVE_on(imp_sth);
+            }
+            else if (!imp_sth && imp_dbh->async_sth) {
+                /* Called via $dbh->pg_result - store in the async statement */
+                imp_dbh->async_sth->cur_tuple = 0;
+                TRACE_PQNFIELDS;
+                DBIc_NUM_FIELDS(imp_dbh->async_sth) = PQnfields(result);
+                DBIc_ACTIVE_on(imp_dbh->async_sth);
+                if (TRACE3_slow) {
+                    TRC(DBILOGFP, "%sUsing imp_dbh->async_sth for $dbh->pg_result()\n", THEADER_slow);
+                }
+            }
+            break;
+        case PGRES_COMMAND_OK:
+            /* non-select statement */
+            TRACE_PQCMDTUPLES;
+            rows = atol(PQcmdTuples(result));
+            break;
+        case PGRES_COPY_OUT:
+        case PGRES_COPY_IN:
+        case PGRES_COPY_BOTH:
+            /* Copy Out/In data transfer in progress */
+            imp_dbh->copystate = status;
+            imp_dbh->copybinary = PQbinaryTuples(result);
+            imp_dbh->copy_buffer_length = 0;
+            rows = -1;
+            break;
+        case PGRES_EMPTY_QUERY:
+        case PGRES_BAD_RESPONSE:
+        case PGRES_NONFATAL_ERROR:
+            rows = -2;
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ h, status, PQerrorMessage(imp_dbh->conn));
+            break;
+        case PGRES_FATAL_ERROR:
+            /* query cancelled? */
+            if (0 == strncmp(imp_dbh->sqlstate, "57014", 5)) {
+                rows = 0;
+                break;
+            }
+            /* fallthrough */
 
-    status = _result(aTHX_ imp_dbh, commit ? "commit" : "rollback");
-    imp_dbh->done_begin = DBDPG_FALSE;
-    if (PGRES_COMMAND_OK != status) {
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ dbh, status, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_end_txn (error: status not OK for %s)\n",
-                      THEADER_slow, commit ? "commit" : "rollback");
-        return 0;
-    }
+        default:
+            rows = -2;
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ h, status, PQerrorMessage(imp_dbh->conn));
+            break;
+        }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_end_txn\n", THEADER_slow);
+        /* Store the result in the appropriate statement handle */
+        if (imp_sth && imp_sth == imp_dbh->async_sth) {
 
-    return 1;
+            CLEAR_LAST_RESULT(imp_dbh);
 
-} /* end of pg_db_end_txn */
+            CLEAR_STH_RESULT(imp_sth);
 
-/* Large object functions */
+            imp_dbh->last_result = imp_sth->result = result;
+            imp_dbh->result_shared = DBDPG_TRUE;
+        }
+        else if (NULL == imp_sth && NULL != imp_dbh->async_sth) {
+            CLEAR_LAST_RESULT(imp_dbh);
 
-/* ================================================================== */
-unsigned int pg_db_lo_creat (SV * dbh, int mode)
-{
+            /* If the above wasn't the async handle's result, free that too */
+            if (imp_dbh->async_sth->result != imp_dbh->last_result) {
+                CLEAR_STH_RESULT(imp_dbh->async_sth);
+            }
 
-    dTHX;
-    D_imp_dbh(dbh);
+            imp_dbh->last_result = imp_dbh->async_sth->result = result;
+            imp_dbh->result_shared = DBDPG_TRUE;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_lo_creat (mode: %d)\n", THEADER_slow, mode);
+        }
+        else {
+            CLEAR_LAST_RESULT(imp_dbh);
 
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_creat when AutoCommit is on");
+            imp_dbh->last_result = result;
+            imp_dbh->result_shared = DBDPG_FALSE;
+        }
+        if (rows == -1) {
+            break;
+        }
     }
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh)) {
-        return 0; /* No other option, because lo_creat returns an Oid */
+    if (imp_sth && imp_sth == imp_dbh->async_sth) {
+        imp_sth->rows = rows;
+        imp_sth->async_status = STH_NO_ASYNC;
     }
-
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_creat\n", THEADER_slow);
+    else if (NULL == imp_sth && NULL != imp_dbh->async_sth) {
+        imp_dbh->async_sth->rows = rows;
+        imp_dbh->async_sth->async_status = STH_NO_ASYNC;
     }
+    imp_dbh->async_status = DBH_NO_ASYNC;
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (rows: %ld)\n", THEADER_slow, rows);
+    return rows;
+} /* end of pg_db_result */
 
-    return lo_creat(imp_dbh->conn, mode); /* 0 on error */
-
-}
 
 /* ================================================================== */
-int pg_db_lo_open (SV * dbh, unsigned int lobjId, int mode)
+/*
+   Indicates if an asynchronous query has finished yet
+   Accepts either a database or a statement handle
+   Returns:
+   -1 if no query is running (and raises an exception)
+   +1 if the query is finished
+   0 if the query is still running
+   -2 for other errors
+*/
+static int pg_db_ready_error(SV *h, imp_dbh_t *imp_dbh, char *pq_call)
 {
-
     dTHX;
-    D_imp_dbh(dbh);
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pg_lo_open (mode: %d objectid: %u)\n",
-                    THEADER_slow, mode, lobjId);
-
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_open when AutoCommit is on");
-    }
-
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return -2;
-
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_open\n", THEADER_slow);
-    }
 
-    return lo_open(imp_dbh->conn, lobjId, mode); /* -1 on error */
+    if (strcmp(imp_dbh->sqlstate, "00000") != 0)
+        _fatal_sqlstate(aTHX_ imp_dbh);
 
+    TRACE_PQERRORMESSAGE;
+    pg_error(aTHX_ h, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: %s failed)\n", THEADER_slow,
+                       pq_call);
+    return -2;
 }
 
-/* ================================================================== */
-int pg_db_lo_close (SV * dbh, int fd)
+int pg_db_ready(SV *h, imp_dbh_t *imp_dbh)
 {
-
+    struct imp_sth_st *imp_sth;
+    PGresult *result;
+    int ret, status;
     dTHX;
-    D_imp_dbh(dbh);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_close (fd: %d)\n", THEADER_slow, fd);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_ready (async status: %d)\n",
+                         THEADER_slow, imp_dbh->async_status);
 
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_close when AutoCommit is on");
-    }
+    switch (imp_dbh->async_status) {
+    case DBH_NO_ASYNC:
+        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "No asynchronous query is running\n");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: no async)\n", THEADER_slow);
+        return -1;
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+    case DBH_ASYNC_CONNECT:
+    case DBH_ASYNC_CONNECT_POLL:
+        if (TRACE5_slow) TRC(DBILOGFP, "%snot yet connected\n", THEADER_slow);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: not connected)\n", THEADER_slow);
         return -1;
 
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_close\n", THEADER_slow);
+    default:
+        /* Future fix: handle gracefully or throw a warning */
+        break;
+
     }
 
-    return lo_close(imp_dbh->conn, fd); /* <0 on error, 0 if ok */
+    TRACE_PQCONSUMEINPUT;
+    if (!PQconsumeInput(imp_dbh->conn)) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ h, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: consume failed)\n", THEADER_slow);
+        return -2;
+    }
 
-}
+    strcpy(imp_dbh->sqlstate, "00000");
 
-/* ================================================================== */
-int pg_db_lo_read (SV * dbh, int fd, char * buf, size_t len)
-{
+    ret = 0;
+    TRACE_PQISBUSY;
+    if (!PQisBusy(imp_dbh->conn)) {
+        ret = 1;
 
-    dTHX;
-    D_imp_dbh(dbh);
+        /*
+          If async prepare has been used, deal with the result of the
+          prepare call and send the actual query afterwards if the
+          prepare was successful.
+        */
+        imp_sth = imp_dbh->async_sth;
+        if (imp_sth && STH_ASYNC_PREPARE == imp_sth->async_status) {
+            status = PGRES_COMMAND_OK;
+            TRACE_PQGETRESULT;
+            while ((result = PQgetResult(imp_dbh->conn))) {
+                ret = _sqlstate(aTHX_ imp_dbh, result);
+                if (ret != PGRES_COMMAND_OK) status = ret;
+                TRACE_PQCLEAR;
+                PQclear(result);
+            }
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_read (fd: %d length: %" UVuf ")\n",
-                    THEADER_slow, fd, (UV)len);
+            if (PGRES_COMMAND_OK != status) {
+                Safefree(imp_sth->prepare_name);
+                imp_sth->prepare_name = NULL;
+                imp_sth->async_status = STH_NO_ASYNC;
 
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_read when AutoCommit is on");
-    }
+                imp_dbh->async_status = 0;
+                imp_dbh->async_sth = NULL;
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return -1;
+                return pg_db_ready_error(h, imp_dbh, "PQsendPrepare");
+            }
 
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_read\n", THEADER_slow);
+            imp_sth->prepared_by_us = DBDPG_TRUE;
+            ++imp_dbh->prepare_number;
+
+            ret = pq_send_prepared_query(aTHX_ imp_dbh, imp_sth);
+            if (!ret) return pg_db_ready_error(h, imp_dbh, "PQsendQueryPrepared");
+            imp_sth->async_status = STH_ASYNC;
+
+            ret = 0;
+       }
     }
 
-    return lo_read(imp_dbh->conn, fd, buf, len); /* bytes read, <0 on error */
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready\n", THEADER_slow);
+    return ret;
+} /* end of pg_db_ready */
 
-}
 
 /* ================================================================== */
-int pg_db_lo_write (SV * dbh, int fd, char * buf, size_t len)
+/*
+  Wait for the asynchronous queries running on a list of database handles,
+  for at most timeout seconds (forever if negative, and just a quick check
+  if 0), using a single poll() over all of their sockets.
+  Returns a reference to an array of the indexes of the handles whose query
+  has finished, so that pg_result will not block, or has failed, in which
+  case the error is set on that handle. Handles with no asynchronous query
+  running are included, as there is nothing to wait for. The array is empty
+  if the time ran out.
+*/
+SV * pg_db_multi_ready (AV * handles, double timeout)
 {
-
     dTHX;
-    D_imp_dbh(dbh);
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_write (fd: %d length: %" UVuf ")\n",
-                    THEADER_slow, fd, (UV)len);
-
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_write when AutoCommit is on");
+    double deadline = timeout > 0 ? pg_now(aTHX) + timeout : 0;
+    double remaining = timeout;
+    AV *   ready = newAV();
+    int    count = (int)av_len(handles) + 1;
+    int *  socks;
+    int    i;
+
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_multi_ready (handles: %d, timeout: %g)\n",
+                         THEADER_slow, count, timeout);
+
+    /* Database handles are blessed into DBI::db, but their implementor must be us */
+    for (i=0; i < count; i++) {
+        SV ** svp = av_fetch(handles, i, 0);
+        HV *  stash;
+
+        if (NULL == svp || !SvOK(*svp))
+            continue;
+        if (!SvROK(*svp) || !sv_derived_from(*svp, "DBI::db"))
+            croak("Element %d is not a database handle", i);
+        stash = DBIc_IMP_STASH((imp_dbh_t *)DBIh_COM(*svp));
+        if (NULL == stash || strNE(HvNAME(stash), "DBD::Pg::db"))
+            croak("Element %d is not a DBD::Pg database handle", i);
     }
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return -1;
+    New(0, socks, count > 0 ? count : 1, int);
 
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_write\n", THEADER_slow);
-    }
+    for (;;) {
+        int waiting = 0;
+        int status;
 
-    return lo_write(imp_dbh->conn, fd, buf, len); /* bytes written, <0 on error */
+        for (i=0; i < count; i++) {
+            SV **       svp = av_fetch(handles, i, 0);
+            imp_dbh_t * imp_dbh;
 
-}
+            if (NULL == svp || !SvOK(*svp))
+                continue;
+            imp_dbh = (imp_dbh_t *)DBIh_COM(*svp);
+            if (DBH_ASYNC != imp_dbh->async_status || NULL == imp_dbh->conn
+                || 0 != pg_db_ready(*svp, imp_dbh)) {
+                av_push(ready, newSViv(i));
+                continue;
+            }
 
-/* ================================================================== */
-IV pg_db_lo_lseek (SV * dbh, int fd, IV offset, int whence)
-{
+            TRACE_PQSOCKET;
+            socks[waiting++] = PQsocket(imp_dbh->conn);
+        }
 
-    dTHX;
-    D_imp_dbh(dbh);
+        if (AvFILLp(ready) >= 0 || 0 == waiting)
+            break;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_lseek (fd: %d offset: %" IVdf " whence: %d)\n",
-                    THEADER_slow, fd, offset, whence);
+        if (timeout > 0) {
+            remaining = deadline - pg_now(aTHX);
+            if (remaining <= 0)
+                break;
+        }
+        else if (0 == timeout) {
+            break;
+        }
 
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_lseek when AutoCommit is on");
+        /* A readable socket may only hold part of a message, so go around again either way */
+        status = pg_wait_readable(socks, waiting, remaining);
+        if (status < 0) {
+            if (EINTR == errno) {
+                PERL_ASYNC_CHECK(); /* Let any Perl signal handlers run */
+                continue;
+            }
+            Safefree(socks);
+            SvREFCNT_dec((SV *)ready);
+            croak("Could not wait for the database handles: %s", Strerror(errno));
+        }
     }
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return -1;
+    Safefree(socks);
 
-#ifdef HAS64BITLO
-    if (imp_dbh->pg_server_version >= 90300) {
-        if (TLIBPQ_slow)
-            TRC(DBILOGFP, "%slo_lseek64\n", THEADER_slow);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_multi_ready (ready: %d)\n", THEADER_slow, (int)AvFILLp(ready) + 1);
+    return sv_2mortal(newRV_noinc((SV *)ready));
 
-        return lo_lseek64(imp_dbh->conn, fd, offset, whence); /* new position, -1 on error */
-    }
+} /* end of pg_db_multi_ready */
 
-    if (offset < INT_MIN || offset > INT_MAX)
-        croak("lo_lseek offset out of range of integer");
-#endif
+/* ================================================================== */
+/*
+  Send a cancel request for a running asynchronous query to the server.
+  The result of the query - which may be "query was cancelled" (SQLSTATE 57014) -
+  still needs to be determined in the ordinary way.
+*/
+int pg_db_send_cancel(SV *h, imp_dbh_t *imp_dbh)
+{
+    dTHX;
 
-    if (TLIBPQ_slow)
-        TRC(DBILOGFP, "%slo_lseek\n", THEADER_slow);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_send_cancel (async status: %d)\n",
+                    THEADER_slow, imp_dbh->async_status);
 
-    return lo_lseek(imp_dbh->conn, fd, offset, whence); /* new position, -1 on error */
+    if (0 == imp_dbh->async_status) {
+        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "No asynchronous query is running");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_send_cancel (error: no async)\n", THEADER_slow);
+        return DBDPG_FALSE;
+    }
 
-}
+    if (!do_send_cancel(h, imp_dbh, "pg_db_send_cancel"))
+        return DBDPG_FALSE;
 
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_send_cancel\n", THEADER_slow);
+    return DBDPG_TRUE;
+} /* end of pg_db_send_cancel */
 
 /* ================================================================== */
-IV pg_db_lo_tell (SV * dbh, int fd)
+/*
+  Attempt to cancel a running asynchronous query
+  Returns true if the cancel succeeded, and false if it did not
+  In this case, pg_cancel will return false.
+  NOTE: We only return true if we cancelled
+*/
+int pg_db_cancel(SV *h, imp_dbh_t *imp_dbh)
 {
-
     dTHX;
-    D_imp_dbh(dbh);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_tell (fd: %d)\n", THEADER_slow, fd);
-
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_tell when AutoCommit is on");
-    }
-
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return -1;
-
-#ifdef HAS64BITLO
-    if (TLIBPQ_slow)
-        TRC(DBILOGFP, "%slo_tell64\n", THEADER_slow);
-
-    if (imp_dbh->pg_server_version >= 90300)
-        return lo_tell64(imp_dbh->conn, fd); /* current position, <0 on error */
-#endif
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_cancel (async status: %d)\n",
+                    THEADER_slow, imp_dbh->async_status);
 
-    if (TLIBPQ_slow)
-        TRC(DBILOGFP, "%slo_tell\n", THEADER_slow);
+    if (!pg_db_send_cancel(h, imp_dbh))
+        return DBDPG_FALSE;
 
-    return lo_tell(imp_dbh->conn, fd); /* current position, <0 on error */
+    pg_db_result(h, imp_dbh);
 
-}
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_cancel\n", THEADER_slow);
+    return 0 == strncmp(imp_dbh->sqlstate, "57014", 5);
+} /* end of pg_db_cancel */
 
 /* ================================================================== */
-int pg_db_lo_truncate (SV * dbh, int fd, IV len)
+int pg_db_cancel_sth(SV *sth, imp_sth_t *imp_sth)
 {
-
     dTHX;
-    D_imp_dbh(dbh);
+    D_imp_dbh_from_sth;
+    bool cancel_result;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_truncate (fd: %d length: %" IVdf ")\n",
-                         THEADER_slow, fd, len);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_cancel_sth (async status: %d)\n",
+                    THEADER_slow, imp_dbh->async_status);
 
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_truncate when AutoCommit is on");
-    }
+    cancel_result = pg_db_cancel(sth, imp_dbh);
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return -1;
+    dbd_st_finish(sth, imp_sth);
 
-#ifdef HAS64BITLO
-    if (TLIBPQ_slow)
-        TRC(DBILOGFP, "%slo_truncate64\n", THEADER_slow);
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_cancel_sth\n", THEADER_slow);
+    return cancel_result;
 
-    if (imp_dbh->pg_server_version >= 90300)
-        return lo_truncate64(imp_dbh->conn, fd, len); /* 0 success, <0 on error */
+} /* end of pg_db_cancel_sth */
 
-    if (len < INT_MIN || len > INT_MAX)
-        croak("lo_truncate len out of range of integer");
-#endif
 
-    if (TLIBPQ_slow)
-        TRC(DBILOGFP, "%slo_truncate\n", THEADER_slow);
-    return lo_truncate(imp_dbh->conn, fd, len); /* 0 success, <0 on error */
+/* Stands in for a statement handle in pipeline_sths where pg_pipeline_flush sent a sync point */
+static char pipeline_sync_mark;
+#define PIPELINE_SYNC_MARK ((imp_sth_t *)&pipeline_sync_mark)
 
-}
 
 /* ================================================================== */
-int pg_db_lo_unlink (SV * dbh, unsigned int lobjId)
+/*
+  Remember which statement handle (if any) the next pipeline result belongs to
+*/
+static void pg_db_pipeline_append(imp_dbh_t *imp_dbh, imp_sth_t *imp_sth)
 {
-
-    dTHX;
-    D_imp_dbh(dbh);
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_unlink (objectid: %u)\n", THEADER_slow, lobjId);
-
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        croak("Cannot call pg_lo_unlink when AutoCommit is on");
-    }
-
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return -1;
-
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_unlink\n", THEADER_slow);
+    if (imp_dbh->pipeline_length == imp_dbh->pipeline_count) {
+        /* The array is full, realloc the array to make it bigger */
+        size_t new_length = imp_dbh->pipeline_length ? imp_dbh->pipeline_length : 8;
+        if (new_length > SIZE_MAX / 2)
+            croak("pg_db_pipeline_append: array too large");
+        new_length *= 2;
+        Renew(imp_dbh->pipeline_sths, new_length, imp_sth_t *); /* freed in dbd_db_destroy */
+        imp_dbh->pipeline_length = (int)new_length;
     }
 
-    return lo_unlink(imp_dbh->conn, lobjId); /* 1 on success, -1 on failure */
-
+    imp_dbh->pipeline_sths[imp_dbh->pipeline_count++] = imp_sth;
 }
 
+
 /* ================================================================== */
-unsigned int pg_db_lo_import (SV * dbh, char * filename)
+/*
+  Forget every command in the pipeline queue
+*/
+static void pg_db_pipeline_reset(pTHX_ imp_dbh_t *imp_dbh)
 {
+    imp_dbh->pipeline_count = 0;
+    imp_dbh->pipeline_head = 0;
+    imp_dbh->pipeline_flushed = 0;
+    imp_dbh->pipeline_status = -1;
+    imp_dbh->pipeline_rows = 0;
+    if (NULL != imp_dbh->pipeline_error) {
+        SvREFCNT_dec(imp_dbh->pipeline_error);
+        imp_dbh->pipeline_error = NULL;
+    }
+}
 
-    Oid loid;
-    dTHX;
-    D_imp_dbh(dbh);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_import (filename: %s)\n", THEADER_slow, filename);
+/* ================================================================== */
+/*
+  Store a pipeline result in the statement handle that sent it,
+  so it can be fetched from as usual
+*/
+static void pg_db_pipeline_store(pTHX_ imp_dbh_t *imp_dbh, imp_sth_t *imp_sth, PGresult *result, ExecStatusType status)
+{
+    CLEAR_LAST_RESULT(imp_dbh);
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return 0; /* No other option, because lo_import returns an Oid */
+    CLEAR_STH_RESULT(imp_sth);
 
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_import\n", THEADER_slow);
-    }
-    loid = lo_import(imp_dbh->conn, filename); /* 0 on error */
+    imp_dbh->last_result = imp_sth->result = result;
+    imp_dbh->result_shared = DBDPG_TRUE;
 
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        if (!pg_db_end_txn(aTHX_ dbh, imp_dbh, 0==loid ? 0 : 1))
-            return 0;
+    if (PGRES_TUPLES_OK == status) {
+        imp_sth->cur_tuple = 0;
+        TRACE_PQNFIELDS;
+        DBIc_NUM_FIELDS(imp_sth) = PQnfields(result);
+        DBIc_ACTIVE_on(imp_sth);
     }
-
-    return loid;
-
 }
 
+
 /* ================================================================== */
-unsigned int pg_db_lo_import_with_oid (SV * dbh, char * filename, unsigned int lobjId)
+/*
+  Queue a command that has no statement handle of its own (e.g. "begin")
+  Returns 0 on success, -2 on error
+*/
+static int pg_db_pipeline_command(pTHX_ SV *h, imp_dbh_t *imp_dbh, const char *sql)
 {
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pipeline_command (sql: %s)\n", THEADER_slow, sql);
 
-    Oid loid;
-    dTHX;
-    D_imp_dbh(dbh);
-
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_import_with_oid (filename: %s, oid: %u)\n",
-                    THEADER_slow, filename, lobjId);
-
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
-        return 0; /* No other option, because lo_import* returns an Oid */
+    if (TSQL) TRC(DBILOGFP, "%s;\n\n", sql);
 
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_import_with_oid\n", THEADER_slow);
+    TRACE_PQSENDQUERYPARAMS;
+    if (!PQsendQueryParams(imp_dbh->conn, sql, 0, NULL, NULL, NULL, NULL, 0)) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ h, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_command (error: PQsendQueryParams failed)\n", THEADER_slow);
+        return -2;
     }
-    loid = lo_import_with_oid(imp_dbh->conn, filename, lobjId); /* 0 on error */
 
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        if (!pg_db_end_txn(aTHX_ dbh, imp_dbh, 0==loid ? 0 : 1))
-            return 0;
-    }
+    pg_db_pipeline_append(imp_dbh, NULL);
 
-    return loid;
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_command\n", THEADER_slow);
+    return 0;
+
+} /* end of pg_db_pipeline_command */
 
-}
 
 /* ================================================================== */
-int pg_db_lo_export (SV * dbh, unsigned int lobjId, char * filename)
+/*
+  If not autocommit, queue the commands needed to start a new transaction
+  Returns 0 on success, -2 on error
+*/
+static int pg_db_pipeline_start_txn(pTHX_ SV *h, imp_dbh_t *imp_dbh)
 {
+    if (imp_dbh->done_begin || DBIc_has(imp_dbh, DBIcf_AutoCommit))
+        return 0;
 
-    int result;
-    dTHX;
-    D_imp_dbh(dbh);
+    if (0 != pg_db_pipeline_command(aTHX_ h, imp_dbh, "begin"))
+        return -2;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_lo_export (objectid: %u filename: %s)\n",
-                    THEADER_slow, lobjId, filename);
+    imp_dbh->done_begin = DBDPG_TRUE;
 
-    if (!pg_db_start_txn(aTHX_ dbh,imp_dbh))
+    /* If read-only mode, make it so */
+    if (imp_dbh->txn_read_only
+        && 0 != pg_db_pipeline_command(aTHX_ h, imp_dbh, "set transaction read only"))
         return -2;
 
-    if (TLIBPQ_slow) {
-        TRC(DBILOGFP, "%slo_export\n", THEADER_slow);
-    }
-    result = lo_export(imp_dbh->conn, lobjId, filename); /* 1 on success, -1 on failure */
-    if (DBIc_has(imp_dbh, DBIcf_AutoCommit)) {
-        if (!pg_db_end_txn(aTHX_ dbh, imp_dbh, result==-1 ? 0 : 1))
-            return -1;
-    }
+    return 0;
 
-    return result;
-}
+} /* end of pg_db_pipeline_start_txn */
 
 
 /* ================================================================== */
-int dbd_st_blob_read (SV * sth, imp_sth_t * imp_sth, int lobjId, long offset, long len, SV * destrv, long destoffset)
+/*
+  Put the connection into pipeline mode. From now on, execute() and do()
+  send their commands to the server without waiting for a result.
+  Returns true on success
+*/
+int pg_db_enter_pipeline (SV * dbh, imp_dbh_t * imp_dbh)
 {
     dTHX;
-    D_imp_dbh_from_sth;
 
-    int    ret, lobj_fd, nbytes;
-    STRLEN nread;
-    SV *   bufsv;
-    char * tmp;
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_enter_pipeline\n", THEADER_slow);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin dbd_st_blob_read (objectid: %d offset: %ld length: %ld)\n",
-                    THEADER_slow, lobjId, offset, len);
+#if PGLIBVERSION < 140000
+    pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Pipeline mode requires libpq version 14 or higher");
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_enter_pipeline (error: libpq too old)\n", THEADER_slow);
+    return DBDPG_FALSE;
+#else
 
-    /* safety checks */
-    if (lobjId <= 0) {
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: lobjId <= 0");
-        return 0;
-    }
-    if (offset < 0) {
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: offset < 0");
-        return 0;
-    }
-    if (len < 0) {
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: len < 0");
-        return 0;
-    }
-    if (! SvROK(destrv)) {
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: destrv not a reference");
-        return 0;
-    }
-    if (destoffset < 0) {
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, "dbd_st_blob_read: destoffset < 0");
-        return 0;
+    if (NULL == imp_dbh->conn) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Database handle has been disconnected");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_enter_pipeline (error: no connection)\n", THEADER_slow);
+        return DBDPG_FALSE;
     }
 
-    /* dereference destination and ensure it's writable string */
-    bufsv = SvRV(destrv);
-    if (0==destoffset) {
-        sv_setpvn(bufsv, "", 0);
+    if (imp_dbh->in_pipeline) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_enter_pipeline (already in pipeline mode)\n", THEADER_slow);
+        return DBDPG_TRUE;
     }
 
-    /* open large object */
-    lobj_fd = lo_open(imp_dbh->conn, (unsigned)lobjId, INV_READ);
-    if (lobj_fd < 0) {
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (error: open failed)\n", THEADER_slow);
-        return 0;
-    }
+    /* Abort if we are in the middle of a copy */
+    if (imp_dbh->copystate!=0)
+        croak("Must call pg_endcopy before issuing more commands");
 
-    /* seek on large object */
-    if (offset > 0) {
-        ret = lo_lseek(imp_dbh->conn, lobj_fd, (int)offset, SEEK_SET);
-        if (ret < 0) {
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-            if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (error: bad seek)\n", THEADER_slow);
-            return 0;
-        }
-    }
+    /* Any rows still streaming in are thrown away */
+    pg_st_stream_discard(aTHX_ imp_dbh);
 
-    /* read from large object */
-    nread = 0;
-    SvGROW(bufsv, (STRLEN)(destoffset + nread + BUFSIZ + 1));
-    tmp = (SvPVX(bufsv)) + destoffset + nread;
-    while ((nbytes = lo_read(imp_dbh->conn, lobj_fd, tmp, BUFSIZ)) > 0) {
-        nread += nbytes;
-        /* break if user wants only a specified chunk */
-        if (len > 0 && nread > (STRLEN)len) {
-            nread = (STRLEN)len;
-            break;
-        }
-        SvGROW(bufsv, (STRLEN)(destoffset + nread + BUFSIZ + 1));
-        tmp = (SvPVX(bufsv)) + destoffset + nread;
+    if (DBH_NO_ASYNC != imp_dbh->async_status) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Cannot enter pipeline mode until previous async query has finished");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_enter_pipeline (error: async)\n", THEADER_slow);
+        return DBDPG_FALSE;
     }
 
-    /* terminate string */
-    SvCUR_set(bufsv, (STRLEN)(destoffset + nread));
-    *SvEND(bufsv) = '\0';
-
-    /* close large object */
-    ret = lo_close(imp_dbh->conn, lobj_fd);
-    if (ret < 0) {
+    TRACE_PQENTERPIPELINEMODE;
+    if (!PQenterPipelineMode(imp_dbh->conn)) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
         TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ sth, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (error: close failed)\n", THEADER_slow);
-        return 0;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_enter_pipeline (error: PQenterPipelineMode failed)\n", THEADER_slow);
+        return DBDPG_FALSE;
     }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd dbd_st_blob_read (bytes: %d)\n", THEADER_slow, (int)nread);
-    return (int)nread;
+    imp_dbh->in_pipeline = DBDPG_TRUE;
+    pg_db_pipeline_reset(aTHX_ imp_dbh);
 
-} /* end of dbd_st_blob_read */
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_enter_pipeline\n", THEADER_slow);
+    return DBDPG_TRUE;
+#endif
+
+} /* end of pg_db_enter_pipeline */
 
 
 /* ================================================================== */
 /*
-   Return the result of an asynchronous query, waiting if needed
+  Send a sync point, then gather the results of every command sent since
+  the previous one, in the order they were sent. Each result is stored in
+  the statement handle that sent it, so it can be fetched from as usual.
+  If a command fails, the server skips every following command up to the
+  sync point: those are reported as aborted.
+  If tuple_status is not NULL, one entry per executed statement is pushed
+  onto it: the number of rows, or [err, errstr, state] if it failed.
+  Returns the total number of rows, or -2 if any command failed, in which
+  case the error of the first failing command is set on the database handle.
 */
-long pg_db_result (SV *h, imp_dbh_t *imp_dbh)
+long pg_db_pipeline_sync (SV * dbh, imp_dbh_t * imp_dbh, AV * tuple_status)
 {
     dTHX;
-    PGresult *result;
-    ExecStatusType status;
-    long rows = 0;
-    /* Determine if we were called from a statement handle or database handle */
-    /* The Pg.xs passes sth/dbh as h, but imp_dbh is always the database handle */
-    D_imp_xxh(h);
-    imp_sth_t *imp_sth = NULL;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_result\n", THEADER_slow);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pipeline_sync (commands: %d)\n",
+                         THEADER_slow, imp_dbh->pipeline_count);
 
-    if (DBIt_ST == DBIc_TYPE(imp_xxh)) {
-        imp_sth = (imp_sth_t*)imp_xxh;
+    if (!imp_dbh->in_pipeline) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Not in pipeline mode");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_sync (error: not in pipeline mode)\n", THEADER_slow);
+        return -2;
     }
 
-    /* Handle auto-retrieved results from PG_OLDQUERY_WAIT */
-    if (imp_sth && STH_ASYNC_AUTORETRIEVED == imp_sth->async_status) {
-        if (NULL == imp_sth->result) {
-            pg_error(aTHX_ h, PGRES_FATAL_ERROR, "Auto-retrieved results already consumed");
-            return -2;
-        }
-
-        status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
-
-        if (PGRES_TUPLES_OK == status || PGRES_COMMAND_OK == status) {
-            rows = imp_sth->rows;
-        }
-        else {
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ h, status, PQerrorMessage(imp_dbh->conn));
-            rows = -2;
-        }
-        imp_sth->async_status = STH_NO_ASYNC;
-
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (auto-retrieved, %ld rows)\n", THEADER_slow, rows);
-        return rows;
+    /* The results of flushed commands must be gathered in order */
+    if (imp_dbh->pipeline_flushed > 0) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Cannot sync the pipeline until pg_pipeline_completed has gathered all flushed commands");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_sync (error: flushed commands outstanding)\n", THEADER_slow);
+        return -2;
     }
 
-    /* Handle auto-retrieved error results from PG_OLDQUERY_WAIT */
-    if (imp_sth && STH_ASYNC_AUTOERROR == imp_sth->async_status) {
-        if (NULL == imp_sth->result) {
+#if PGLIBVERSION >= 140000
+    {
+        PGresult       *result;
+        ExecStatusType  status = PGRES_FATAL_ERROR;
+        imp_sth_t      *imp_sth;
+        SV             *errmsg;
+        char            errstate[6];
+        long            rows;
+        long            totalrows = 0;
+        int             i;
+
+        TRACE_PQPIPELINESYNC;
+        if (!PQpipelineSync(imp_dbh->conn)) {
+            _fatal_sqlstate(aTHX_ imp_dbh);
             TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ h, PGRES_FATAL_ERROR, "Auto-retrieved error already reported");
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_sync (error: PQpipelineSync failed)\n", THEADER_slow);
             return -2;
         }
 
-        status = _sqlstate(aTHX_ imp_dbh, imp_sth->result);
+        errstate[0] = '\0';
 
-        TRACE_PQRESULTERRORMESSAGE;
-        pg_error(aTHX_ h, status, PQresultErrorMessage(imp_sth->result));
-        imp_sth->async_status = STH_NO_ASYNC;
+        for (i=0; i < imp_dbh->pipeline_count; i++) {
 
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (auto-retrieved error)\n", THEADER_slow);
-        return -2;
-    }
+            imp_sth = imp_dbh->pipeline_sths[i];
+            rows = -2;
+            errmsg = NULL;
+            status = PGRES_FATAL_ERROR;
 
-    /* No auto-retrieved results: check that an async query is actually running */
-    if (DBH_ASYNC != imp_dbh->async_status) {
-        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "No asynchronous query is running\n");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (error: no async)\n", THEADER_slow);
-        return -2;
-    }
+            /* The results of each command are followed by a NULL */
+            TRACE_PQGETRESULT;
+            while ((result = PQgetResult(imp_dbh->conn)) != NULL) {
+                status = _sqlstate(aTHX_ imp_dbh, result);
+                switch ((int)status) {
+                case PGRES_TUPLES_OK:
+                    TRACE_PQNTUPLES;
+                    rows = PQntuples(result);
+                    break;
+                case PGRES_COMMAND_OK:
+                    TRACE_PQCMDTUPLES;
+                    rows = atol(PQcmdTuples(result));
+                    break;
+                case PGRES_PIPELINE_ABORTED:
+                    /* An earlier command failed, so this one was never run */
+                    rows = -2;
+                    if (NULL == errmsg)
+                        errmsg = newSVpvs("Command skipped: an earlier command in the pipeline failed");
+                    break;
+                default:
+                    rows = -2;
+                    TRACE_PQRESULTERRORMESSAGE;
+                    if (NULL == errmsg)
+                        errmsg = newSVpv(PQresultErrorMessage(result), 0);
+                    if ('\0' == errstate[0]) {
+                        TRACE_PQRESULTERRORMESSAGE;
+                        pg_error(aTHX_ dbh, status, PQresultErrorMessage(result));
+                        strncpy(errstate, imp_dbh->sqlstate, 6);
+                    }
+                    break;
+                }
 
-    /* Verify ownership: only the statement that started the async query can retrieve it */
-    if (imp_sth && imp_dbh->async_sth && imp_sth != imp_dbh->async_sth) {
-        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "pg_result() called on wrong statement handle - this statement does not own the async query\n");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (wrong statement)\n", THEADER_slow);
-        return -2;
-    }
+                if (NULL == imp_sth) {
+                    TRACE_PQCLEAR;
+                    PQclear(result);
+                    continue;
+                }
 
-    imp_dbh->copystate = 0; /* Assume not in copy mode until told otherwise */
+                pg_db_pipeline_store(aTHX_ imp_dbh, imp_sth, result, status);
+            }
 
-    TRACE_PQGETRESULT;
-    while ((result = PQgetResult(imp_dbh->conn)) != NULL) {
-        /* TODO: Better multiple result-set handling */
-        status = _sqlstate(aTHX_ imp_dbh, result);
-        switch ((int)status) {
-        case PGRES_TUPLES_OK:
-            TRACE_PQNTUPLES;
-            rows = PQntuples(result);
+            /* No result at all means we have lost the connection */
+            if (-2 == rows && NULL == errmsg) {
+                _fatal_sqlstate(aTHX_ imp_dbh);
+                TRACE_PQERRORMESSAGE;
+                errmsg = newSVpv(PQerrorMessage(imp_dbh->conn), 0);
+                if ('\0' == errstate[0]) {
+                    pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+                    strncpy(errstate, imp_dbh->sqlstate, 6);
+                }
+            }
 
-            /* Store metadata in the appropriate statement handle */
-            if (imp_sth && imp_sth == imp_dbh->async_sth) {
-                imp_sth->cur_tuple = 0;
-                TRACE_PQNFIELDS;
-                DBIc_NUM_FIELDS(imp_sth) = PQnfields(result);
-                DBIc_ACTIVE_on(imp_sth);
+            if (NULL == imp_sth) {
+                if (errmsg)
+                    SvREFCNT_dec(errmsg);
+                continue;
             }
-            else if (!imp_sth && imp_dbh->async_sth) {
-                /* Called via $dbh->pg_result - store in the async statement */
-                imp_dbh->async_sth->cur_tuple = 0;
-                TRACE_PQNFIELDS;
-                DBIc_NUM_FIELDS(imp_dbh->async_sth) = PQnfields(result);
-                DBIc_ACTIVE_on(imp_dbh->async_sth);
-                if (TRACE3_slow) {
-                    TRC(DBILOGFP, "%sUsing imp_dbh->async_sth for $dbh->pg_result()\n", THEADER_slow);
+
+            imp_sth->rows = rows;
+            if (rows > 0)
+                totalrows += rows;
+
+            if (NULL != tuple_status) {
+                if (-2 == rows) {
+                    AV * const errav = newAV();
+                    av_push(errav, newSViv((IV)status));
+                    av_push(errav, errmsg);
+                    av_push(errav, newSVpv(imp_dbh->sqlstate, 5));
+                    av_push(tuple_status, newRV_noinc((SV *)errav));
+                    errmsg = NULL;
+                }
+                else {
+                    av_push(tuple_status, newSViv((IV)rows));
                 }
             }
-            break;
-        case PGRES_COMMAND_OK:
-            /* non-select statement */
-            TRACE_PQCMDTUPLES;
-            rows = atol(PQcmdTuples(result));
-            break;
-        case PGRES_COPY_OUT:
-        case PGRES_COPY_IN:
-        case PGRES_COPY_BOTH:
-            /* Copy Out/In data transfer in progress */
-            imp_dbh->copystate = status;
-            imp_dbh->copybinary = PQbinaryTuples(result);
-            rows = -1;
-            break;
-        case PGRES_EMPTY_QUERY:
-        case PGRES_BAD_RESPONSE:
-        case PGRES_NONFATAL_ERROR:
-            rows = -2;
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ h, status, PQerrorMessage(imp_dbh->conn));
-            break;
-        case PGRES_FATAL_ERROR:
-            /* query cancelled? */
-            if (0 == strncmp(imp_dbh->sqlstate, "57014", 5)) {
-                rows = 0;
-                break;
+            if (errmsg)
+                SvREFCNT_dec(errmsg);
+        }
+
+        imp_dbh->pipeline_count = 0;
+
+        /* Last of all comes the sync point itself */
+        TRACE_PQGETRESULT;
+        result = PQgetResult(imp_dbh->conn);
+        status = PGRES_FATAL_ERROR;
+        if (NULL != result) {
+            TRACE_PQRESULTSTATUS;
+            status = PQresultStatus(result);
+            TRACE_PQCLEAR;
+            PQclear(result);
+        }
+        if (PGRES_PIPELINE_SYNC != status) {
+            if ('\0' == errstate[0]) {
+                _fatal_sqlstate(aTHX_ imp_dbh);
+                TRACE_PQERRORMESSAGE;
+                pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
             }
-            /* fallthrough */
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_sync (error: no sync result)\n", THEADER_slow);
+            return -2;
+        }
 
-        default:
-            rows = -2;
-            TRACE_PQERRORMESSAGE;
-            pg_error(aTHX_ h, status, PQerrorMessage(imp_dbh->conn));
-            break;
+        /* A COMMIT or ROLLBACK may have been part of the pipeline */
+        TRACE_PQTRANSACTIONSTATUS;
+        if (PQTRANS_IDLE == PQtransactionStatus(imp_dbh->conn))
+            imp_dbh->done_begin = DBDPG_FALSE;
+
+        if ('\0' != errstate[0]) {
+            /* Report the state of the first error, not of the last skipped command */
+            strncpy(imp_dbh->sqlstate, errstate, 6);
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_sync (error)\n", THEADER_slow);
+            return -2;
         }
 
-        /* Store the result in the appropriate statement handle */
-        if (imp_sth && imp_sth == imp_dbh->async_sth) {
+        strcpy(imp_dbh->sqlstate, "00000");
 
-            CLEAR_LAST_RESULT(imp_dbh);
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_sync (rows: %ld)\n", THEADER_slow, totalrows);
+        return totalrows;
+    }
+#else
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_sync\n", THEADER_slow);
+    return -2;
+#endif
 
-            CLEAR_STH_RESULT(imp_sth);
+} /* end of pg_db_pipeline_sync */
 
-            imp_dbh->last_result = imp_sth->result = result;
-            imp_dbh->result_shared = DBDPG_TRUE;
-        }
-        else if (NULL == imp_sth && NULL != imp_dbh->async_sth) {
-            CLEAR_LAST_RESULT(imp_dbh);
 
-            /* If the above wasn't the async handle's result, free that too */
-            if (imp_dbh->async_sth->result != imp_dbh->last_result) {
-                CLEAR_STH_RESULT(imp_dbh->async_sth);
-            }
+/* ================================================================== */
+/*
+  Send a sync point, but do not wait for any results: those are gathered
+  later by pg_db_pipeline_completed, as the server finishes each command.
+  Returns the number of statements awaiting completion, or -2 on error
+*/
+int pg_db_pipeline_flush (SV * dbh, imp_dbh_t * imp_dbh)
+{
+    dTHX;
+    int pending = 0;
 
-            imp_dbh->last_result = imp_dbh->async_sth->result = result;
-            imp_dbh->result_shared = DBDPG_TRUE;
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pipeline_flush (commands: %d)\n",
+                         THEADER_slow, imp_dbh->pipeline_count - imp_dbh->pipeline_flushed);
 
-        }
-        else {
-            CLEAR_LAST_RESULT(imp_dbh);
+    if (!imp_dbh->in_pipeline) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Not in pipeline mode");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_flush (error: not in pipeline mode)\n", THEADER_slow);
+        return -2;
+    }
 
-            imp_dbh->last_result = result;
-            imp_dbh->result_shared = DBDPG_FALSE;
+#if PGLIBVERSION >= 140000
+    {
+        int i;
+
+        TRACE_PQPIPELINESYNC;
+        if (!PQpipelineSync(imp_dbh->conn)) {
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_flush (error: PQpipelineSync failed)\n", THEADER_slow);
+            return -2;
         }
-        if (rows == -1) {
-            break;
+
+        pg_db_pipeline_append(imp_dbh, PIPELINE_SYNC_MARK);
+        imp_dbh->pipeline_flushed = imp_dbh->pipeline_count;
+
+        for (i=imp_dbh->pipeline_head; i < imp_dbh->pipeline_flushed; i++) {
+            if (NULL != imp_dbh->pipeline_sths[i] && PIPELINE_SYNC_MARK != imp_dbh->pipeline_sths[i])
+                pending++;
         }
     }
+#endif
 
-    if (imp_sth && imp_sth == imp_dbh->async_sth) {
-        imp_sth->rows = rows;
-        imp_sth->async_status = STH_NO_ASYNC;
-    }
-    else if (NULL == imp_sth && NULL != imp_dbh->async_sth) {
-        imp_dbh->async_sth->rows = rows;
-        imp_dbh->async_sth->async_status = STH_NO_ASYNC;
-    }
-    imp_dbh->async_status = DBH_NO_ASYNC;
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_result (rows: %ld)\n", THEADER_slow, rows);
-    return rows;
-} /* end of pg_db_result */
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_flush (pending: %d)\n", THEADER_slow, pending);
+    return pending;
+
+} /* end of pg_db_pipeline_flush */
 
 
 /* ================================================================== */
 /*
-   Indicates if an asynchronous query has finished yet
-   Accepts either a database or a statement handle
-   Returns:
-   -1 if no query is running (and raises an exception)
-   +1 if the query is finished
-   0 if the query is still running
-   -2 for other errors
+  Gather the results of flushed commands that the server has finished,
+  without blocking unless wait is true and nothing has finished yet.
+  Each result is stored in the statement handle that sent it. Because a
+  statement handle only holds one result, gathering stops before a second
+  result for the same statement handle.
+  Returns an arrayref with one [sth, rows] entry per finished statement,
+  where rows is [err, errstr, state] if it failed, or undef if the
+  connection has failed.
 */
-static int pg_db_ready_error(SV *h, imp_dbh_t *imp_dbh, char *pq_call)
+SV * pg_db_pipeline_completed (SV * dbh, imp_dbh_t * imp_dbh, int wait)
 {
     dTHX;
+    AV * done;
 
-    if (strcmp(imp_dbh->sqlstate, "00000") != 0)
-        _fatal_sqlstate(aTHX_ imp_dbh);
-
-    TRACE_PQERRORMESSAGE;
-    pg_error(aTHX_ h, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: %s failed)\n", THEADER_slow,
-                       pq_call);
-    return -2;
-}
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_pipeline_completed (wait: %d)\n", THEADER_slow, wait);
 
-int pg_db_ready(SV *h, imp_dbh_t *imp_dbh)
-{
-    struct imp_sth_st *imp_sth;
-    PGresult *result;
-    int ret, status;
-    dTHX;
+    if (!imp_dbh->in_pipeline) {
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, "Not in pipeline mode");
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_completed (error: not in pipeline mode)\n", THEADER_slow);
+        return &PL_sv_undef;
+    }
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_ready (async status: %d)\n",
-                         THEADER_slow, imp_dbh->async_status);
+    done = newAV();
 
-    switch (imp_dbh->async_status) {
-    case DBH_NO_ASYNC:
-        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "No asynchronous query is running\n");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: no async)\n", THEADER_slow);
-        return -1;
+#if PGLIBVERSION >= 140000
+    {
+        PGresult       *result;
+        ExecStatusType  status;
+        imp_sth_t      *imp_sth;
+        imp_sth_t     **seen;
+        int             seen_count = 0;
+        int             i;
 
-    case DBH_ASYNC_CONNECT:
-    case DBH_ASYNC_CONNECT_POLL:
-        if (TRACE5_slow) TRC(DBILOGFP, "%snot yet connected\n", THEADER_slow);
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: not connected)\n", THEADER_slow);
-        return -1;
+        TRACE_PQCONSUMEINPUT;
+        if (!PQconsumeInput(imp_dbh->conn)) {
+            _fatal_sqlstate(aTHX_ imp_dbh);
+            TRACE_PQERRORMESSAGE;
+            pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+            SvREFCNT_dec((SV *)done);
+            if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_completed (error: PQconsumeInput failed)\n", THEADER_slow);
+            return &PL_sv_undef;
+        }
 
-    default:
-        /* Future fix: handle gracefully or throw a warning */
-        break;
+        New(0, seen, imp_dbh->pipeline_flushed - imp_dbh->pipeline_head + 1, imp_sth_t *);
 
-    }
+        while (imp_dbh->pipeline_head < imp_dbh->pipeline_flushed) {
 
-    TRACE_PQCONSUMEINPUT;
-    if (!PQconsumeInput(imp_dbh->conn)) {
-        _fatal_sqlstate(aTHX_ imp_dbh);
-        TRACE_PQERRORMESSAGE;
-        pg_error(aTHX_ h, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready (error: consume failed)\n", THEADER_slow);
-        return -2;
-    }
+            imp_sth = imp_dbh->pipeline_sths[imp_dbh->pipeline_head];
 
-    strcpy(imp_dbh->sqlstate, "00000");
+            /* Leave a second result for the same statement until this one has been looked at */
+            if (-1 == imp_dbh->pipeline_status && NULL != imp_sth && PIPELINE_SYNC_MARK != imp_sth) {
+                for (i=0; i < seen_count && seen[i] != imp_sth; i++)
+                    ;
+                if (i < seen_count)
+                    break;
+            }
 
-    ret = 0;
-    TRACE_PQISBUSY;
-    if (!PQisBusy(imp_dbh->conn)) {
-        ret = 1;
+            /* Only block if asked to, and only until something has finished */
+            if (!wait || seen_count > 0) {
+                TRACE_PQISBUSY;
+                if (PQisBusy(imp_dbh->conn))
+                    break;
+            }
 
-        /*
-          If async prepare has been used, deal with the result of the
-          prepare call and send the actual query afterwards if the
-          prepare was successful.
-        */
-        imp_sth = imp_dbh->async_sth;
-        if (imp_sth && STH_ASYNC_PREPARE == imp_sth->async_status) {
-            status = PGRES_COMMAND_OK;
             TRACE_PQGETRESULT;
-            while ((result = PQgetResult(imp_dbh->conn))) {
-                ret = _sqlstate(aTHX_ imp_dbh, result);
-                if (ret != PGRES_COMMAND_OK) status = ret;
-                TRACE_PQCLEAR;
-                PQclear(result);
-            }
+            result = PQgetResult(imp_dbh->conn);
 
-            if (PGRES_COMMAND_OK != status) {
-                Safefree(imp_sth->prepare_name);
-                imp_sth->prepare_name = NULL;
-                imp_sth->async_status = STH_NO_ASYNC;
+            if (PIPELINE_SYNC_MARK == imp_sth) {
+                status = PGRES_FATAL_ERROR;
+                if (NULL != result) {
+                    TRACE_PQRESULTSTATUS;
+                    status = PQresultStatus(result);
+                    TRACE_PQCLEAR;
+                    PQclear(result);
+                }
+                if (PGRES_PIPELINE_SYNC != status)
+                    goto failed;
 
-                imp_dbh->async_status = 0;
-                imp_dbh->async_sth = NULL;
+                imp_dbh->pipeline_head++;
 
-                return pg_db_ready_error(h, imp_dbh, "PQsendPrepare");
+                /* A COMMIT or ROLLBACK may have been part of the pipeline */
+                TRACE_PQTRANSACTIONSTATUS;
+                if (PQTRANS_IDLE == PQtransactionStatus(imp_dbh->conn))
+                    imp_dbh->done_begin = DBDPG_FALSE;
+                continue;
             }
 
-            imp_sth->prepared_by_us = DBDPG_TRUE;
-            ++imp_dbh->prepare_number;
+            if (NULL != result) {
+                status = _sqlstate(aTHX_ imp_dbh, result);
+                imp_dbh->pipeline_status = (int)status;
+                switch ((int)status) {
+                case PGRES_TUPLES_OK:
+                    TRACE_PQNTUPLES;
+                    imp_dbh->pipeline_rows = PQntuples(result);
+                    break;
+                case PGRES_COMMAND_OK:
+                    TRACE_PQCMDTUPLES;
+                    imp_dbh->pipeline_rows = atol(PQcmdTuples(result));
+                    break;
+                default:
+                    imp_dbh->pipeline_rows = -2;
+                    if (NULL == imp_dbh->pipeline_error) {
+                        AV * const errav = newAV();
+                        av_push(errav, newSViv((IV)status));
+                        if (PGRES_PIPELINE_ABORTED == status) {
+                            /* An earlier command failed, so this one was never run */
+                            av_push(errav, newSVpvs("Command skipped: an earlier command in the pipeline failed"));
+                        }
+                        else {
+                            TRACE_PQRESULTERRORMESSAGE;
+                            av_push(errav, newSVpv(PQresultErrorMessage(result), 0));
+                        }
+                        av_push(errav, newSVpv(imp_dbh->sqlstate, 5));
+                        imp_dbh->pipeline_error = newRV_noinc((SV *)errav);
+                    }
+                    break;
+                }
 
-            ret = pq_send_prepared_query(aTHX_ imp_dbh, imp_sth);
-            if (!ret) return pg_db_ready_error(h, imp_dbh, "PQsendQueryPrepared");
-            imp_sth->async_status = STH_ASYNC;
+                if (NULL == imp_sth) {
+                    TRACE_PQCLEAR;
+                    PQclear(result);
+                }
+                else {
+                    pg_db_pipeline_store(aTHX_ imp_dbh, imp_sth, result, status);
+                }
+                continue;
+            }
 
-            ret = 0;
-       }
-    }
+            /* No result at all means we have lost the connection */
+            if (-1 == imp_dbh->pipeline_status)
+                goto failed;
+
+            /* The command has finished */
+            if (NULL != imp_sth) {
+                AV * const entry = newAV();
+                imp_sth->rows = imp_dbh->pipeline_rows;
+                av_push(entry, newRV_inc((SV *)DBIc_MY_H(imp_sth)));
+                if (NULL != imp_dbh->pipeline_error) {
+                    av_push(entry, imp_dbh->pipeline_error);
+                    imp_dbh->pipeline_error = NULL;
+                }
+                else {
+                    av_push(entry, newSViv((IV)imp_dbh->pipeline_rows));
+                }
+                av_push(done, newRV_noinc((SV *)entry));
+                seen[seen_count++] = imp_sth;
+            }
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_ready\n", THEADER_slow);
-    return ret;
-} /* end of pg_db_ready */
+            if (NULL != imp_dbh->pipeline_error) {
+                SvREFCNT_dec(imp_dbh->pipeline_error);
+                imp_dbh->pipeline_error = NULL;
+            }
+            imp_dbh->pipeline_status = -1;
+            imp_dbh->pipeline_rows = 0;
+            imp_dbh->pipeline_head++;
+        }
 
-/* ================================================================== */
-/*
-  Send a cancel request for a running asynchronous query to the server.
-  The result of the query - which may be "query was cancelled" (SQLSTATE 57014) -
-  still needs to be determined in the ordinary way.
-*/
-int pg_db_send_cancel(SV *h, imp_dbh_t *imp_dbh)
-{
-    dTHX;
+        Safefree(seen);
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_send_cancel (async status: %d)\n",
-                    THEADER_slow, imp_dbh->async_status);
+        /* Once everything flushed has been gathered, the queue starts over */
+        if (imp_dbh->pipeline_head == imp_dbh->pipeline_flushed && imp_dbh->pipeline_head > 0) {
+            imp_dbh->pipeline_count -= imp_dbh->pipeline_head;
+            Move(imp_dbh->pipeline_sths + imp_dbh->pipeline_head, imp_dbh->pipeline_sths,
+                 imp_dbh->pipeline_count, imp_sth_t *);
+            imp_dbh->pipeline_head = 0;
+            imp_dbh->pipeline_flushed = 0;
+        }
 
-    if (0 == imp_dbh->async_status) {
-        pg_error(aTHX_ h, PGRES_FATAL_ERROR, "No asynchronous query is running");
-        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_send_cancel (error: no async)\n", THEADER_slow);
-        return DBDPG_FALSE;
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_completed (finished: %d)\n", THEADER_slow, seen_count);
+        return sv_2mortal(newRV_noinc((SV *)done));
+
+      failed:
+        Safefree(seen);
+        SvREFCNT_dec((SV *)done);
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_completed (error: connection lost)\n", THEADER_slow);
+        return &PL_sv_undef;
     }
+#else
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_pipeline_completed\n", THEADER_slow);
+    return sv_2mortal(newRV_noinc((SV *)done));
+#endif
 
-    if (!do_send_cancel(h, imp_dbh, "pg_db_send_cancel"))
-        return DBDPG_FALSE;
+} /* end of pg_db_pipeline_completed */
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_send_cancel\n", THEADER_slow);
-    return DBDPG_TRUE;
-} /* end of pg_db_send_cancel */
 
 /* ================================================================== */
 /*
-  Attempt to cancel a running asynchronous query
-  Returns true if the cancel succeeded, and false if it did not
-  In this case, pg_cancel will return false.
-  NOTE: We only return true if we cancelled
+  Leave pipeline mode, first gathering any results still outstanding
+  Returns true if all went well
 */
-int pg_db_cancel(SV *h, imp_dbh_t *imp_dbh)
+int pg_db_exit_pipeline (SV * dbh, imp_dbh_t * imp_dbh)
 {
     dTHX;
+    int ret = DBDPG_TRUE;
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_cancel (async status: %d)\n",
-                    THEADER_slow, imp_dbh->async_status);
-
-    if (!pg_db_send_cancel(h, imp_dbh))
-        return DBDPG_FALSE;
-
-    pg_db_result(h, imp_dbh);
+    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_exit_pipeline\n", THEADER_slow);
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_cancel\n", THEADER_slow);
-    return 0 == strncmp(imp_dbh->sqlstate, "57014", 5);
-} /* end of pg_db_cancel */
+    if (!imp_dbh->in_pipeline) {
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_exit_pipeline (not in pipeline mode)\n", THEADER_slow);
+        return DBDPG_TRUE;
+    }
 
-/* ================================================================== */
-int pg_db_cancel_sth(SV *sth, imp_sth_t *imp_sth)
-{
-    dTHX;
-    D_imp_dbh_from_sth;
-    bool cancel_result;
+#if PGLIBVERSION >= 140000
+    /* Commands already flushed are gathered first, then the rest are synced */
+    while (imp_dbh->pipeline_flushed > 0) {
+        if (!SvOK(pg_db_pipeline_completed(dbh, imp_dbh, DBDPG_TRUE))) {
+            ret = DBDPG_FALSE;
+            break;
+        }
+    }
 
-    if (TSTART_slow) TRC(DBILOGFP, "%sBegin pg_db_cancel_sth (async status: %d)\n",
-                    THEADER_slow, imp_dbh->async_status);
+    if (DBDPG_TRUE == ret && imp_dbh->pipeline_count > 0 && pg_db_pipeline_sync(dbh, imp_dbh, NULL) < -1)
+        ret = DBDPG_FALSE;
 
-    cancel_result = pg_db_cancel(sth, imp_dbh);
+    TRACE_PQEXITPIPELINEMODE;
+    if (!PQexitPipelineMode(imp_dbh->conn)) {
+        _fatal_sqlstate(aTHX_ imp_dbh);
+        TRACE_PQERRORMESSAGE;
+        pg_error(aTHX_ dbh, PGRES_FATAL_ERROR, PQerrorMessage(imp_dbh->conn));
+        if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_exit_pipeline (error: PQexitPipelineMode failed)\n", THEADER_slow);
+        return DBDPG_FALSE;
+    }
+#endif
 
-    dbd_st_finish(sth, imp_sth);
+    imp_dbh->in_pipeline = DBDPG_FALSE;
 
-    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_cancel_sth\n", THEADER_slow);
-    return cancel_result;
+    if (TEND_slow) TRC(DBILOGFP, "%sEnd pg_db_exit_pipeline\n", THEADER_slow);
+    return ret;
 
-} /* end of pg_db_cancel_sth */
+} /* end of pg_db_exit_pipeline */
 
 
 /* ================================================================== */
@@ -6252,6 +10139,171 @@ int dbd_st_cancel(SV *sth, imp_sth_t *imp_sth)
 } /* end of dbd_st_cancel */
 
 
+/* ================================================================== */
+/*
+  Find the catalog details of every result column that comes straight from a
+  table: its nullability and its schema.table.column name. Columns not cached
+  yet are all looked up with a single query, rather than one per column.
+  Returns an array of fields entries (to be freed by the caller), each holding
+  the cached [nullable, name] array, or NULL if the column is not from a table.
+*/
+static AV ** pg_st_column_info (pTHX_ imp_dbh_t * imp_dbh, imp_sth_t * imp_sth, int fields)
+{
+    AV **       info;
+    SV *        sql = NULL;
+    char        key[32];
+    int         keylen;
+    int         x;
+
+    Newz(0, info, fields > 0 ? fields : 1, AV *); /* freed by the caller */
+
+    if (NULL == imp_dbh->column_cache)
+        imp_dbh->column_cache = newHV(); /* freed in dbd_db_destroy */
+
+    for (x = 0; x < fields; x++) {
+        Oid   oid;
+        int   pos;
+        SV ** svp;
+        AV *  entry;
+
+        TRACE_PQFTABLE;
+        oid = PQftable(imp_sth->result, x);
+        TRACE_PQFTABLECOL;
+        pos = PQftablecol(imp_sth->result, x);
+        if (InvalidOid == oid || pos <= 0)
+            continue;
+
+        keylen = sprintf(key, "%u.%d", oid, pos);
+        svp = hv_fetch(imp_dbh->column_cache, key, keylen, 0);
+        if (NULL != svp) {
+            info[x] = (AV*)SvRV(*svp);
+            continue;
+        }
+
+        /* Unknown until the lookup below says otherwise */
+        entry = newAV();
+        av_extend(entry, 1);
+        (void)av_store(entry, 0, newSViv(2));
+        (void)av_store(entry, 1, newSV(0));
+        (void)hv_store(imp_dbh->column_cache, key, keylen, newRV_noinc((SV*)entry), 0);
+        info[x] = entry;
+
+        if (NULL == sql)
+            sql = sv_2mortal(newSVpvs("SELECT v.relid, v.num, a.attnotnull, n.nspname, c.relname, a.attname FROM (VALUES "));
+        else
+            sv_catpvs(sql, ",");
+        sv_catpvf(sql, "(%u::pg_catalog.oid,%d::pg_catalog.int2)", oid, pos);
+    }
+
+    if (NULL != sql) {
+        PGresult * result;
+        sv_catpvs(sql, ") AS v(relid, num)"
+                  " JOIN pg_catalog.pg_attribute a ON a.attrelid = v.relid AND a.attnum = v.num"
+                  " JOIN pg_catalog.pg_class c ON c.oid = a.attrelid"
+                  " LEFT JOIN pg_catalog.pg_namespace n ON n.oid = c.relnamespace");
+
+        TRACE_PQEXEC;
+        result = PQexec(imp_dbh->conn, SvPV_nolen(sql));
+        TRACE_PQRESULTSTATUS;
+        if (PGRES_TUPLES_OK == PQresultStatus(result)) {
+            int rows;
+            TRACE_PQNTUPLES;
+            rows = PQntuples(result);
+            for (x = 0; x < rows; x++) {
+                SV ** svp;
+                AV *  entry;
+                SV *  name;
+                TRACE_PQGETVALUE;
+                keylen = sprintf(key, "%s.%s", PQgetvalue(result, x, 0), PQgetvalue(result, x, 1));
+                svp = hv_fetch(imp_dbh->column_cache, key, keylen, 0);
+                if (NULL == svp)
+                    continue;
+                entry = (AV*)SvRV(*svp);
+                (void)av_store(entry, 0, newSViv('t' == *PQgetvalue(result, x, 2) ? 0 : 1));
+                name = newSVpvf("%s.%s.%s", PQgetvalue(result, x, 3), PQgetvalue(result, x, 4), PQgetvalue(result, x, 5));
+                (void)av_store(entry, 1, name);
+            }
+            TRACE_PQCLEAR;
+            PQclear(result);
+        }
+        else {
+            /* Leave the columns unknown this time, but do not remember that */
+            TRACE_PQCLEAR;
+            PQclear(result);
+            for (x = 0; x < fields; x++) {
+                AV * entry = info[x];
+                Oid  oid;
+                int  pos;
+                int  y;
+                if (NULL == entry || 2 != SvIV(*av_fetch(entry, 0, 0)))
+                    continue;
+                /* Other result columns may be the same table column, sharing the entry freed below */
+                for (y = x; y < fields; y++) {
+                    if (info[y] == entry)
+                        info[y] = NULL;
+                }
+                TRACE_PQFTABLE;
+                oid = PQftable(imp_sth->result, x);
+                TRACE_PQFTABLECOL;
+                pos = PQftablecol(imp_sth->result, x);
+                keylen = sprintf(key, "%u.%d", oid, pos);
+                (void)hv_delete(imp_dbh->column_cache, key, keylen, G_DISCARD);
+            }
+        }
+    }
+
+    return info;
+
+} /* end of pg_st_column_info */
+
+
+/* ================================================================== */
+/* Forget the key remembered from the last INSERT prepared with pg_returning_id */
+static void pg_db_returning_clear (pTHX_ imp_dbh_t * imp_dbh)
+{
+    if (NULL != imp_dbh->returning_sql) {
+        SvREFCNT_dec(imp_dbh->returning_sql);
+        SvREFCNT_dec(imp_dbh->returning_value);
+        imp_dbh->returning_sql = NULL;
+        imp_dbh->returning_value = NULL;
+    }
+
+} /* end of pg_db_returning_clear */
+
+
+/* ================================================================== */
+/*
+  Return [statement, key] for the last statement run, if it was an INSERT
+  prepared with pg_returning_id that returned at least one row, else undef
+*/
+SV * pg_db_returning_id (imp_dbh_t * imp_dbh)
+{
+    dTHX;
+    AV * av;
+
+    if (NULL == imp_dbh->returning_sql)
+        return &PL_sv_undef;
+
+    av = newAV();
+    av_push(av, newSVsv(imp_dbh->returning_sql));
+    av_push(av, newSVsv(imp_dbh->returning_value));
+    return sv_2mortal(newRV_noinc((SV*)av));
+
+} /* end of pg_db_returning_id */
+
+
+/* ================================================================== */
+/* Forget the column details remembered for NULLABLE and pg_canonical_names */
+void pg_db_clear_metadata_cache (imp_dbh_t * imp_dbh)
+{
+    dTHX;
+
+    if (NULL != imp_dbh->column_cache)
+        hv_clear(imp_dbh->column_cache);
+
+} /* end of pg_db_clear_metadata_cache */
+
+
 /* ================================================================== */
 /*
    Retrieves table oid and column position (in that table) for every column in resultset
@@ -6302,8 +10354,7 @@ SV* dbd_st_canonical_names(SV *sth, imp_sth_t *imp_sth)
 {
     dTHX;
     D_imp_dbh_from_sth;
-    ExecStatusType status;
-    PGresult * result;
+    AV ** info;
 
     PERL_UNUSED_VAR(sth);
 
@@ -6312,47 +10363,23 @@ SV* dbd_st_canonical_names(SV *sth, imp_sth_t *imp_sth)
     AV* result_av = newAV();
     av_extend(result_av, fields);
 
-    while(fields--){
-        TRACE_PQFTABLE;
-        Oid oid = PQftable(imp_sth->result, fields);
-        int stored = 0;
+    /* We need the connection, so any rows still streaming in are thrown away */
+    pg_st_stream_discard(aTHX_ imp_dbh);
 
-        if(oid != InvalidOid) {
-            TRACE_PQFTABLECOL;
-            int pos = PQftablecol(imp_sth->result, fields);
-            if(pos > 0){
-                char statement[204];
-                sprintf(statement,
-                    "SELECT n.nspname, c.relname, a.attname FROM pg_class c LEFT JOIN pg_namespace n ON c.relnamespace = n.oid LEFT JOIN pg_attribute a ON a.attrelid = c.oid WHERE c.oid = %u AND a.attnum = %d", oid, pos);
-                TRACE_PQEXEC;
-                result = PQexec(imp_dbh->conn, statement);
-                TRACE_PQRESULTSTATUS;
-                status = PQresultStatus(result);
-                if (PGRES_TUPLES_OK == status) {
-                    TRACE_PQNTUPLES;
-                    if (PQntuples(result)!=0) {
-                        int len = PQgetlength(result, 0, 0) + 1;
-                        len += PQgetlength(result, 0, 1) + 1;
-                        len += PQgetlength(result, 0, 2);
-                        SV* table_name = newSV(len);
-                        char *nsp = PQgetvalue(result, 0, 0);
-                        char *tbl = PQgetvalue(result, 0, 1);
-                        char *col = PQgetvalue(result, 0, 2);
-                        sv_setpvf(table_name, "%s.%s.%s", nsp, tbl, col);
-                        if (imp_dbh->pg_utf8_flag)
-                            SvUTF8_on(table_name);
-                        av_store(result_av, fields, table_name);
-                        stored = 1;
-                    }
-                }
-                TRACE_PQCLEAR;
-                PQclear(result);
-            }
+    info = pg_st_column_info(aTHX_ imp_dbh, imp_sth, fields);
+    while(fields--){
+        SV ** svp = info[fields] ? av_fetch(info[fields], 1, 0) : NULL;
+        if (svp && SvOK(*svp)) {
+            SV* table_name = newSVsv(*svp);
+            if (imp_dbh->pg_utf8_flag)
+                SvUTF8_on(table_name);
+            av_store(result_av, fields, table_name);
         }
-        if(!stored){
+        else {
             av_store(result_av, fields, newSV(0));
         }
     }
+    Safefree(info);
     SV* sv = newRV_noinc((SV*) result_av);
     return sv;
 
@@ -36,6 +36,7 @@ struct imp_dbh_st {
 
     bool    pg_bool_tf;        /* do bools return 't'/'f'? Set by user, default is 0 */
     bool    pg_int8_as_string; /* Return bigint values as string values always, default is 0 */
+    bool    binary_results;    /* ask for results in binary format when possible? Set by user, default is 0 */
     bool    skip_deallocate;   /* Do not deallocate our named prepare statements; default is 0 */
     bool    prepare_now;       /* force immediate prepares, even with placeholders. Set by user, default is 0 */
     bool    done_begin;        /* have we done a begin? (e.g. are we in a transaction?) */
@@ -52,6 +53,40 @@ struct imp_dbh_st {
     PGresult  *last_result;     /* PGresult structure from the last executed query (can be from imp_dbh or imp_sth) */
     bool      result_shared;    /* Is more than one thing pointing to this PGresult? */
     imp_sth_t *do_tmp_sth;      /* temporary sth to refer inside a do() call */
+
+    bool       in_pipeline;     /* has PQenterPipelineMode been called? */
+    int        pipeline_count;  /* number of entries in pipeline_sths */
+    int        pipeline_length; /* allocated size of pipeline_sths */
+    imp_sth_t **pipeline_sths;  /* statement handle for each sent command, NULL for internal ones */
+    int        pipeline_head;   /* first entry of pipeline_sths not yet gathered by pg_pipeline_completed */
+    int        pipeline_flushed;/* number of entries of pipeline_sths covered by a pg_pipeline_flush */
+    int        pipeline_status; /* status of the results gathered so far for the head entry, -1 if none */
+    long       pipeline_rows;   /* rows affected or returned by the head entry so far */
+    SV        *pipeline_error;  /* [err, errstr, state] if the head entry failed */
+
+    imp_sth_t *stream_sth;      /* statement handle whose rows are still arriving (pg_stream_rows) */
+
+    int        stmt_cache_size;  /* maximum number of statements in the statement cache; 0=disabled */
+    int        stmt_cache_count; /* number of statements in the statement cache */
+    HV        *stmt_cache;       /* statement cache entries, keyed by placeholder options and statement */
+    struct stmt_cache_st *stmt_cache_head; /* most recently used statement cache entry */
+    struct stmt_cache_st *stmt_cache_tail; /* least recently used statement cache entry */
+
+    HV        *registered_types; /* types added by pg_register_types, keyed by oid */
+
+    int        zero_copy;        /* fetched values at least this long point into the result; 0=always copy */
+
+    int        copy_buffer_size;   /* pg_putcopydata rows are sent in chunks of up to this many bytes; 0=send each row */
+    char      *copy_buffer;        /* COPY IN rows not yet given to PQputCopyData */
+    int        copy_buffer_length; /* bytes waiting in copy_buffer */
+    int        copy_buffer_alloc;  /* allocated size of copy_buffer */
+
+    HV        *column_cache;     /* [nullable, schema.table.column] of table columns, keyed by "tableoid.attnum" */
+    int        metadata_cache_size; /* maximum number of catalog method results Pg.pm keeps; 0=disabled */
+    int        metadata_generation; /* bumped by every command that may change the schema */
+
+    SV        *returning_sql;    /* statement of the last INSERT that gave us a key via pg_returning_id; NULL if none */
+    SV        *returning_value;  /* the key that INSERT returned */
 };
 
 /* The placeholder structure. Used as array elements in the ph_array_t structure */
@@ -68,6 +103,9 @@ struct ph_st {
     bool   isinout;             /* is this a bind_param_inout value? */
     SV     *inout;              /* what variable we are updating via inout magic (do not Safefree!) */
     sql_type_info_t* bind_type; /* type information for this placeholder */
+    char   binvalue[17];        /* value in binary format, for PQexecParams/PQexecPrepared only */
+    char  *binarray;            /* numeric array in binary format, for PQexecParams/PQexecPrepared only */
+    int    binarraylen;         /* length of the binary array */
 };
 typedef struct ph_st ph_t;
 
@@ -104,6 +142,38 @@ typedef enum
     } PGPlaceholderType;
 #define PLACEHOLDER_TYPE_COUNT (PLACEHOLDER_COLON + 1)
 
+/* A parsed statement kept in the per-connection statement cache (pg_statement_cache) */
+struct stmt_cache_st {
+    char   *key;                /* placeholder options followed by the statement */
+    STRLEN  keylen;             /* length of the key */
+    PGPlaceholderType placeholder_type; /* which style is being used 1=? 2=$1 3=:foo */
+    int     numsegs;            /* how many segments the statement has */
+    int     numphs;             /* how many placeholders the statement has */
+    STRLEN  totalsize;          /* total string length of the statement (with no placeholders) */
+    int     segcount;           /* number of entries in segs */
+    seg_t  *segs;               /* copy of the segments */
+    int     phcount;            /* number of entries in foonames */
+    char  **foonames;           /* copy of the placeholder names, if using :foo style */
+    char   *prepare_name;       /* server-side statement not in use by any statement handle; NULL if none */
+    Oid    *oids;               /* the parameter types prepare_name was prepared with */
+    struct stmt_cache_st *prev; /* more recently used entry */
+    struct stmt_cache_st *next; /* less recently used entry */
+};
+typedef struct stmt_cache_st stmt_cache_t;
+
+/*
+  A PGresult that fetched values point into (see pg_zero_copy). It is cleared
+  once neither the statement handle nor any of those values need it.
+*/
+struct pg_result_hold_st {
+    PGresult *result;
+    int       refcount;          /* one for the statement handle, plus one per value */
+};
+typedef struct pg_result_hold_st pg_result_hold_t;
+
+/* Converts one non-NULL result value into an SV; returns false if it cannot be decoded */
+typedef bool (*pg_decoder_t)(pTHX_ imp_dbh_t *imp_dbh, sql_type_info_t *type_info, SV *sv, char *value, int length);
+
 /* Define sth implementor data structure */
 struct imp_sth_st {
     dbih_stc_t com;          /* MUST be first element in structure */
@@ -119,6 +189,9 @@ struct imp_sth_st {
     long   rows;              /* number of affected rows */
     int    async_flag;        /* async? 0=no 1=async 2=cancel 4=wait */
     int    async_status;      /* 0=no async 1=async started -1=async has been cancelled */
+    int    stream_rows;       /* fetch rows from the server in batches of this size; 0=all at once */
+    long   stream_total;      /* number of rows received so far when streaming */
+    bool   streamed;          /* were the rows of the last execute fetched in batches? */
 
     STRLEN totalsize;        /* total string length of the statement (with no placeholders)*/
 
@@ -139,13 +212,26 @@ struct imp_sth_st {
     bool   prepared_by_us;   /* false if {prepare_name} set directly */
     bool   direct;           /* allow bypassing of the statement parsing */
     bool   is_dml;           /* is this SELECT/INSERT/UPDATE/DELETE/MERGE/VALUES/TABLE/WITH? */
-    bool   has_binary;       /* does it have one or more binary placeholders? */
+    bool   has_binary;       /* does it have one or more placeholders that may be sent as binary? */
     bool   has_default;      /* does it have one or more 'DEFAULT' values? */
     bool   has_current;      /* does it have one or more 'DEFAULT' values? */
     bool   dollaronly;       /* Only use $1 as placeholders, allow all else */
     bool   nocolons;         /* do not consider :1, :2 ... as valid placeholders */
     bool   use_inout;        /* Any placeholders using inout? */
     bool   all_bound;        /* Have all placeholders been bound? */
+    bool   binary_results;   /* inherited from dbh */
+    bool   binary_ready;     /* can every result column be decoded from binary format? */
+    bool   binary_arrays;    /* are any of those columns arrays? */
+    pg_decoder_t *decoders;  /* how to decode each result column, see pg_st_decoder_setup */
+    int    decoder_flags;    /* the handle settings the decoders were chosen for; 0=not chosen yet */
+    pg_result_hold_t *result_hold; /* set once fetched values point into result; NULL otherwise */
+
+    char   *cache_key;       /* key of this statement in the statement cache; NULL if not cached */
+    STRLEN  cache_keylen;    /* length of cache_key */
+    Oid    *cache_oids;      /* the parameter types prepare_name was prepared with, for the statement cache */
+
+    int     returning_id;    /* remember the first RETURNING column for last_insert_id? 1=yes, 2=yes and the RETURNING was added by Pg.pm */
+    SV     *returning_sql;   /* the statement, when returning_id is set */
 };
 
 
@@ -237,18 +323,36 @@ int pg_db_getfd (imp_dbh_t * imp_dbh);
 
 SV * pg_db_pg_notifies (SV *dbh, imp_dbh_t *imp_dbh);
 
+SV * pg_db_pg_notifies_all (SV *dbh, imp_dbh_t *imp_dbh, int max, bool group, bool unique);
+
+SV * pg_db_pg_wait_for_notify (SV *dbh, imp_dbh_t *imp_dbh, double timeout, int max);
+
+void pg_db_clear_metadata_cache (imp_dbh_t *imp_dbh);
+
+SV * pg_db_returning_id (imp_dbh_t *imp_dbh);
+
+sql_type_info_t * pg_db_type_data (imp_dbh_t *imp_dbh, int type_id);
+
+int pg_db_register_types (SV *dbh, imp_dbh_t *imp_dbh);
+
 SV * pg_rightgraded_sv(pTHX_ SV *input, bool utf8);
 
 SV * pg_stringify_array(SV * input, const char * array_delim, int server_version, bool utf8);
 
 long pg_quickexec (SV *dbh, const char *sql, const int asyncflag);
 
+SV * pg_st_fetch_columns (SV * sth, imp_sth_t * imp_sth, long max_rows);
+
+int pg_st_server_prepare (SV * sth, imp_sth_t * imp_sth);
+
 int pg_db_putline (SV *dbh, SV *svbuf);
 
 int pg_db_getline (SV *dbh, SV * svbuf);
 
 int pg_db_getcopydata (SV *dbh, SV * dataline, int async);
 
+IV pg_db_getcopydata_bulk (SV *dbh, SV * buffer, STRLEN min_bytes);
+
 int pg_db_putcopydata (SV *dbh, SV * dataline, int async);
 
 int pg_db_putcopyend (SV * dbh);
@@ -299,12 +403,24 @@ long pg_db_result (SV *h, imp_dbh_t *imp_dbh);
 
 int pg_db_ready(SV *h, imp_dbh_t *imp_dbh);
 
+SV * pg_db_multi_ready (AV *handles, double timeout);
+
 int pg_db_send_cancel (SV *h, imp_dbh_t *imp_dbh);
 
 int pg_db_cancel (SV *h, imp_dbh_t *imp_dbh);
 
 int pg_db_cancel_sth (SV *sth, imp_sth_t *imp_sth);
 
+int pg_db_enter_pipeline (SV *dbh, imp_dbh_t *imp_dbh);
+
+long pg_db_pipeline_sync (SV *dbh, imp_dbh_t *imp_dbh, AV *tuple_status);
+
+int pg_db_pipeline_flush (SV *dbh, imp_dbh_t *imp_dbh);
+
+SV * pg_db_pipeline_completed (SV *dbh, imp_dbh_t *imp_dbh, int wait);
+
+int pg_db_exit_pipeline (SV *dbh, imp_dbh_t *imp_dbh);
+
 SV * pg_upgraded_sv(pTHX_ SV *input);
 
 SV * pg_downgraded_sv(pTHX_ SV *input);
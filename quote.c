@@ -27,6 +27,203 @@ strncasecmp(const char *s1, const char *s2, size_t n)
 }
 #endif
 
+/*
+  Scanners for the quote functions below. Each returns the offset of the first
+  byte that needs special handling, or the length if there is none, so that the
+  clean runs in between can be sized and copied in bulk. Where SSE2 is available
+  (which is always the case on x86_64) sixteen bytes are checked at a time;
+  elsewhere _find_string_special checks eight at a time using plain arithmetic.
+*/
+#if defined(__SSE2__) && defined(__GNUC__)
+#define DBDPG_QUOTE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* Single quotes, backslashes, and NULs need attention from quote_string */
+static STRLEN _find_string_special(const char *string, STRLEN length)
+{
+    STRLEN pos = 0;
+
+#ifdef DBDPG_QUOTE_SSE2
+    const __m128i quote = _mm_set1_epi8('\'');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; pos + 16 <= length; pos += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(string + pos));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(
+            _mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), _mm_cmpeq_epi8(chunk, zero)));
+        if (mask)
+            return pos + (STRLEN)__builtin_ctz((unsigned int)mask);
+    }
+#elif defined(HAS_QUAD)
+    /* A word has a zero byte if (x - 0x01..) & ~x & 0x80.. is nonzero */
+    const U64 ones = UINT64_C(0x0101010101010101);
+    const U64 highs = UINT64_C(0x8080808080808080);
+
+    for (; pos + 8 <= length; pos += 8) {
+        U64 word, q, b;
+        Copy(string + pos, &word, 1, U64);
+        q = word ^ (ones * '\'');
+        b = word ^ (ones * '\\');
+        if (((word - ones) & ~word & highs)
+            | ((q - ones) & ~q & highs)
+            | ((b - ones) & ~b & highs))
+            break;
+    }
+#endif
+
+    for (; pos < length; pos++) {
+        if ('\'' == string[pos] || '\\' == string[pos] || '\0' == string[pos])
+            return pos;
+    }
+    return length;
+}
+
+/* Single quotes, backslashes, and anything outside of printable ASCII need attention from quote_bytea */
+static STRLEN _find_bytea_special(const char *string, STRLEN length)
+{
+    STRLEN pos = 0;
+
+#ifdef DBDPG_QUOTE_SSE2
+    const __m128i quote = _mm_set1_epi8('\'');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7f);
+
+    for (; pos + 16 <= length; pos += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(string + pos));
+        /* As a signed comparison, bytes of 0x80 and up are also less than a space */
+        const int mask = _mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del))));
+        if (mask)
+            return pos + (STRLEN)__builtin_ctz((unsigned int)mask);
+    }
+#endif
+
+    for (; pos < length; pos++) {
+        const unsigned char c = (unsigned char)string[pos];
+        if ('\'' == c || '\\' == c || c < 0x20 || c > 0x7e)
+            return pos;
+    }
+    return length;
+}
+
+/*
+  Bytea hex format ('\\x' followed by two digits per byte) in both directions.
+  Scalar code uses lookup tables; with SSE2, sixteen bytes are handled at a time.
+*/
+static const signed char _hex_digit_value[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+     0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
+
+static const char _hex_digits[] = "0123456789abcdef";
+
+/*
+  Decode pairs of hex digits into bytes, returning the number of bytes written.
+  Pairs that are not valid hex are skipped. As the result is written at half the
+  speed the string is read, it may be the same buffer as the string.
+*/
+STRLEN decode_bytea_hex(const char *string, STRLEN length, char *result)
+{
+    const unsigned char * const src = (const unsigned char *)string;
+    const char * const result_start = result;
+    STRLEN pos = 0;
+
+#ifdef DBDPG_QUOTE_SSE2
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i below_0 = _mm_set1_epi8('0' - 1);
+    const __m128i above_9 = _mm_set1_epi8('9' + 1);
+    const __m128i below_a = _mm_set1_epi8('a' - 1);
+    const __m128i above_f = _mm_set1_epi8('f' + 1);
+    const __m128i offset_0 = _mm_set1_epi8('0');
+    const __m128i offset_a = _mm_set1_epi8('a' - 10);
+    const __m128i low_byte = _mm_set1_epi16(0x00ff);
+
+    for (; pos + 32 <= length; pos += 32) {
+        __m128i nibbles[2];
+        int half;
+        for (half = 0; half < 2; half++) {
+            const __m128i chunk = _mm_loadu_si128((const __m128i *)(src + pos + 16 * half));
+            const __m128i lower = _mm_or_si128(chunk, case_bit);
+            /* As signed comparisons, bytes of 0x80 and up fail both tests */
+            const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, below_0), _mm_cmplt_epi8(chunk, above_9));
+            const __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, below_a), _mm_cmplt_epi8(lower, above_f));
+            if (0xffff != _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)))
+                break;
+            nibbles[half] = _mm_or_si128(_mm_and_si128(is_digit, _mm_sub_epi8(chunk, offset_0)),
+                                         _mm_and_si128(is_alpha, _mm_sub_epi8(lower, offset_a)));
+            /* Each 16-bit lane holds a pair, with the high nibble in its low byte */
+            nibbles[half] = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles[half], low_byte), 4),
+                                         _mm_srli_epi16(nibbles[half], 8));
+        }
+        if (half < 2) /* Leave anything invalid to the loop below */
+            break;
+        _mm_storeu_si128((__m128i *)result, _mm_packus_epi16(nibbles[0], nibbles[1]));
+        result += 16;
+    }
+#endif
+
+    for (; pos + 1 < length; pos += 2) {
+        const int high = _hex_digit_value[src[pos]];
+        const int low = _hex_digit_value[src[pos+1]];
+        if ((high | low) >= 0)
+            *result++ = (char)((high << 4) | low);
+    }
+    return (STRLEN)(result - result_start);
+}
+
+/* Write two hex digits for each byte of the string */
+static void _encode_bytea_hex(const char *string, STRLEN length, char *result)
+{
+    const unsigned char * const src = (const unsigned char *)string;
+    STRLEN pos = 0;
+
+#ifdef DBDPG_QUOTE_SSE2
+    const __m128i low_nibble = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i offset_0 = _mm_set1_epi8('0');
+    const __m128i letter_gap = _mm_set1_epi8('a' - '0' - 10);
+
+    for (; pos + 16 <= length; pos += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(src + pos));
+        const __m128i high = _mm_and_si128(_mm_srli_epi16(chunk, 4), low_nibble);
+        const __m128i low = _mm_and_si128(chunk, low_nibble);
+        __m128i pairs[2];
+        int half;
+        /* Interleave so that the high nibble of each byte comes first */
+        pairs[0] = _mm_unpacklo_epi8(high, low);
+        pairs[1] = _mm_unpackhi_epi8(high, low);
+        for (half = 0; half < 2; half++) {
+            const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(pairs[half], nine), letter_gap);
+            _mm_storeu_si128((__m128i *)(result + 2 * pos + 16 * half),
+                             _mm_add_epi8(_mm_add_epi8(pairs[half], offset_0), letters));
+        }
+    }
+#endif
+
+    for (; pos < length; pos++) {
+        result[2 * pos] = _hex_digits[src[pos] >> 4];
+        result[2 * pos + 1] = _hex_digits[src[pos] & 0x0f];
+    }
+}
+
 /*
   Quote a text string.
   Most data types use this function to quote: see types.c for the assignments.
@@ -53,23 +250,21 @@ char * quote_string(pTHX_ const char *string, STRLEN length, STRLEN *new_length,
         croak("quote_string: string is too large to quote safely");
 
     /* First pass we determine needed size, verify no embedded NULs, and determine E'' usage */
-    new_string_length = 2; /* Outer single quotes */
+    new_string_length = 2 + length; /* Outer single quotes */
     while (length > 0) {
+        const STRLEN clean = _find_string_special(string, length);
+        if (clean == length)
+            break;
+        string += clean;
+        length -= clean;
         if (*string == '\0')
             croak("quote_string: string has embedded NUL within declared length");
-        if (*string == '\'') {
-            needs_escaping = DBDPG_TRUE;
-            new_string_length++;
-        }
-        else if (*string == '\\') {
-            needs_escaping = DBDPG_TRUE;
-            new_string_length++;
-            if (supports_estring && !use_estring) {
-                use_estring = DBDPG_TRUE;
-                new_string_length++; /* For the leading E */
-            }
-        }
+        needs_escaping = DBDPG_TRUE;
         new_string_length++;
+        if (*string == '\\' && supports_estring && !use_estring) {
+            use_estring = DBDPG_TRUE;
+            new_string_length++; /* For the leading E */
+        }
         string++;
         length--;
     }
@@ -86,13 +281,18 @@ char * quote_string(pTHX_ const char *string, STRLEN length, STRLEN *new_length,
         new_string += original_length;
     }
     else {
-        /* Keep doubling logic same as above */
+        /* Keep doubling logic same as above, copying the clean runs in between */
         length = original_length;
         string = string_start;
         while (length > 0) {
-            if (*string == '\'' || *string == '\\') {
-                *new_string++ = *string;
-            }
+            const STRLEN clean = _find_string_special(string, length);
+            memcpy(new_string, string, clean);
+            new_string += clean;
+            if (clean == length)
+                break;
+            string += clean;
+            length -= clean;
+            *new_string++ = *string;
             *new_string++ = *string++;
             length--;
         }
@@ -165,6 +365,8 @@ char * quote_geometric(pTHX_ const char *string, STRLEN length, STRLEN *new_leng
   This one may have embedded NULs.
   The entire string is encased in single quotes.
   If the server supports it, use the E'' format.
+  If the server also accepts the hex format, that is used whenever it is shorter,
+  which is the case for most binary data.
   Reference: https://www.postgresql.org/docs/current/datatype-binary.html
 */
 char * quote_bytea(pTHX_ const char *string, STRLEN length, STRLEN *new_length, const int supports_estring)
@@ -174,7 +376,9 @@ char * quote_bytea(pTHX_ const char *string, STRLEN length, STRLEN *new_length,
     char * new_string;
     char * new_string_start;
     STRLEN new_string_length;
+    STRLEN hex_length;
     bool needs_escaping = DBDPG_FALSE;
+    bool use_hex = DBDPG_FALSE;
 
     if (length > (MEM_SIZE_MAX - 4) / 5)
         croak("quote_bytea: string is too large to quote safely");
@@ -182,24 +386,28 @@ char * quote_bytea(pTHX_ const char *string, STRLEN length, STRLEN *new_length,
     new_string_length = 2; /* Outer single quotes */
     if (supports_estring)
         new_string_length++;
+    hex_length = new_string_length + 3 + 2 * original_length; /* \\x and two digits per byte */
 
+    new_string_length += original_length;
     for (length = original_length; length > 0; length--) {
-        if (*string == '\'') { /* Single quote gets doubled */
-            needs_escaping = DBDPG_TRUE;
-            new_string_length += 2;
-        }
-        else if (*string == '\\') { /* Backslash gets quadrupled */
-            needs_escaping = DBDPG_TRUE;
-            new_string_length += 4;
-        }
-        else if ((unsigned char)*string < 0x20 || (unsigned char)*string > 0x7e) { /* Special chars get escaped */
-            needs_escaping = DBDPG_TRUE;
-            new_string_length += 5;
-        }
-        else {
+        const STRLEN clean = _find_bytea_special(string, length);
+        if (clean == length)
+            break;
+        string += clean;
+        length -= clean;
+        needs_escaping = DBDPG_TRUE;
+        if (*string == '\'') /* Single quote gets doubled */
             new_string_length += 1;
-        }
+        else if (*string == '\\') /* Backslash gets quadrupled */
+            new_string_length += 3;
+        else /* Special chars get escaped */
+            new_string_length += 4;
         string++;
+        if (supports_estring >= PG_QUOTE_BYTEA_HEX && new_string_length > hex_length) {
+            use_hex = DBDPG_TRUE;
+            new_string_length = hex_length;
+            break;
+        }
     }
 
     New(0, new_string, new_string_length + 1, char);
@@ -208,7 +416,14 @@ char * quote_bytea(pTHX_ const char *string, STRLEN length, STRLEN *new_length,
         *new_string++ = 'E';
     *new_string++ = '\'';
 
-    if (!needs_escaping) {
+    if (use_hex) {
+        *new_string++ = '\\';
+        *new_string++ = '\\';
+        *new_string++ = 'x';
+        _encode_bytea_hex(string_start, original_length, new_string);
+        new_string += 2 * original_length;
+    }
+    else if (!needs_escaping) {
         memcpy(new_string, string_start, original_length);
         new_string += original_length;
     }
@@ -216,6 +431,13 @@ char * quote_bytea(pTHX_ const char *string, STRLEN length, STRLEN *new_length,
         string = string_start;
         /* Keep this in sync with the previous for loop's conditions */
         for (length = original_length; length > 0; length--) {
+            const STRLEN clean = _find_bytea_special(string, length);
+            memcpy(new_string, string, clean);
+            new_string += clean;
+            if (clean == length)
+                break;
+            string += clean;
+            length -= clean;
             if (*string == '\'') { /* Single quote gets doubled */
                 *new_string++ = *string;
                 *new_string++ = *string++;
@@ -226,13 +448,13 @@ char * quote_bytea(pTHX_ const char *string, STRLEN length, STRLEN *new_length,
                 *new_string++ = *string;
                 *new_string++ = *string++;
             }
-            else if ((unsigned char)*string < 0x20 || (unsigned char)*string > 0x7e) {
-                /* Special chars get escaped */
-                (void) sprintf(new_string, "\\\\%03o", (unsigned char)*string++);
-                new_string += 5;
-            }
-            else {
-                *new_string++ = *string++;
+            else { /* Special chars get escaped as \\ooo */
+                const unsigned char c = (unsigned char)*string++;
+                *new_string++ = '\\';
+                *new_string++ = '\\';
+                *new_string++ = (char)('0' + (c >> 6));
+                *new_string++ = (char)('0' + ((c >> 3) & 7));
+                *new_string++ = (char)('0' + (c & 7));
             }
         }
     }
@@ -540,38 +762,14 @@ static void _dequote_bytea_escape(char *string, STRLEN *new_length)
     }
 }
 
-static int _decode_hex_digit(char digit)
-{
-    if (digit >= '0' && digit <= '9')
-        return digit - '0';
-    if (digit >= 'a' && digit <= 'f')
-        return 10 + digit - 'a';
-    if (digit >= 'A' && digit <= 'F')
-        return 10 + digit - 'A';
-
-    return -1;
-}
-
 static void _dequote_bytea_hex(char *string, STRLEN *new_length)
 {
-    char *result;
-
     (*new_length) = 0;
 
     if (NULL != string) {
-        result = string;
-
-        while (*string != '\0') {
-            int digit1, digit2;
-            digit1 = _decode_hex_digit(*string);
-            digit2 = _decode_hex_digit(*(string+1));
-            if (digit1 >= 0 && digit2 >= 0) {
-                *result++ = 16 * digit1 + digit2;
-                (*new_length)++;
-            }
-            string += 2;
-        }
-        *result = '\0';
+        /* Skip the leading \x */
+        (*new_length) = decode_bytea_hex(string + 2, strlen(string + 2), string);
+        string[*new_length] = '\0';
     }
 }
 
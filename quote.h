@@ -13,3 +13,7 @@ void dequote_sql_binary(pTHX_ char *string, STRLEN *new_length);
 void dequote_bool(pTHX_ char *string, STRLEN *new_length);
 void null_dequote(pTHX_ char *string, STRLEN *new_length);
 bool is_keyword(const char *string);
+STRLEN decode_bytea_hex(const char *string, STRLEN length, char *result);
+
+/* The supports_estring value for servers that also accept bytea in hex format */
+#define PG_QUOTE_BYTEA_HEX 2
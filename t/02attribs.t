@@ -18,7 +18,7 @@ my (undef,undef,$dbh) = connect_database();
 if (! $dbh) {
     plan skip_all => 'Connection to database failed, cannot continue testing';
 }
-plan tests => 273;
+plan tests => 292;
 
 isnt ($dbh, undef, 'Connect to database for handle attributes testing');
 
@@ -50,6 +50,9 @@ d pg_protocol
 d pg_errorlevel
 d pg_bool_tf
 d pg_skip_deallocate
+d pg_statement_cache
+d pg_zero_copy
+d pg_copy_buffer
 d pg_db
 d pg_user
 d pg_pass
@@ -333,6 +336,14 @@ $sth->execute(0);
 $result = $sth->fetchall_arrayref()->[0][0];
 is ($result, 'f', $t);
 
+$t=q{Database handle method "pg_bool_tf" takes effect in the middle of fetching rows};
+$sth = $dbh->prepare(q{SELECT * FROM (VALUES (true),(true)) AS x(y)});
+$sth->execute();
+$result = $sth->fetchrow_arrayref()->[0];
+$dbh->{pg_bool_tf}=0;
+is_deeply ([$result, $sth->fetchrow_arrayref()->[0]], ['t', 1], $t);
+$dbh->{pg_bool_tf}=1;
+
 #
 # Test of the database handle attribute "pg_skip_deallocate"
 #
@@ -363,6 +374,121 @@ $new_count = $dbh->selectall_arrayref($SQL)->[0][0];
 is ($new_count, $initial_count, $t);
 $dbh->{pg_skip_deallocate} = 0;
 
+#
+# Test of the database handle attribute "pg_statement_cache"
+#
+
+$t='Database handle attribute "pg_statement_cache" starts as 0';
+$result = $dbh->{pg_statement_cache};
+is ($result, 0, $t);
+
+$t='Database handle attribute "pg_statement_cache" treats negative numbers as 0';
+$dbh->{pg_statement_cache} = -5;
+$result = $dbh->{pg_statement_cache};
+is ($result, 0, $t);
+
+$t='Database handle attribute "pg_statement_cache" can be set to a positive number';
+$dbh->{pg_statement_cache} = 10;
+$result = $dbh->{pg_statement_cache};
+is ($result, 10, $t);
+
+$t='Database handle attribute "pg_statement_cache" reuses the server-side statement of a destroyed handle';
+$SQL = 'SELECT ?::int + 1 AS cached';
+$tempsth = $dbh->prepare($SQL, {pg_prepare_now => 1});
+my $cached_name = $tempsth->{pg_prepare_name};
+$initial_count = $dbh->selectall_arrayref('SELECT count(*) from pg_prepared_statements')->[0][0];
+undef $tempsth;
+$tempsth = $dbh->prepare($SQL, {pg_prepare_now => 1});
+is ($tempsth->{pg_prepare_name}, $cached_name, $t);
+
+$t='Database handle attribute "pg_statement_cache" executes a reused statement correctly';
+$tempsth->execute(41);
+$result = $tempsth->fetchall_arrayref()->[0][0];
+is ($result, 42, $t);
+
+$t='Database handle attribute "pg_statement_cache" deallocates cached statements when set to 0';
+undef $tempsth;
+$dbh->{pg_statement_cache} = 0;
+$new_count = $dbh->selectall_arrayref('SELECT count(*) from pg_prepared_statements')->[0][0];
+is ($new_count, $initial_count-1, $t);
+
+#
+# Test of the database handle attribute "pg_zero_copy"
+#
+
+$t='Database handle attribute "pg_zero_copy" starts as 0';
+$result = $dbh->{pg_zero_copy};
+is ($result, 0, $t);
+
+$t='Database handle attribute "pg_zero_copy" returns a large text value correctly';
+$dbh->{pg_zero_copy} = 100;
+my $bigtext = 'abc' x 1000;
+$sth = $dbh->prepare('SELECT ?::text, ?::bytea');
+$sth->execute($bigtext, undef);
+my $zrow = $sth->fetchrow_arrayref();
+is ($zrow->[0], $bigtext, $t);
+
+$t='Database handle attribute "pg_zero_copy" returns values as read-only';
+eval { $zrow->[0] .= 'x'; };
+like ($@, qr/read-only/, $t);
+
+$t='Database handle attribute "pg_zero_copy" returns values which can be copied and modified';
+my $zcopy = $zrow->[0];
+$zcopy .= 'x';
+is ($zcopy, "${bigtext}x", $t);
+
+$t='Database handle attribute "pg_zero_copy" keeps values valid after the statement is executed again';
+$sth->finish();
+$sth->execute('short', undef);
+$dbh->do('SELECT repeat(?, 1000)', undef, 'xyz');
+is ($zrow->[0], $bigtext, $t);
+
+$t='Database handle attribute "pg_zero_copy" returns a large bytea value correctly';
+my $bigbytea = join '' => map { chr } (0..255) x 4;
+$sth->bind_param(2, $bigbytea, { pg_type => PG_BYTEA });
+$sth->execute('short', $bigbytea);
+$zrow = $sth->fetchrow_arrayref();
+is ($zrow->[1], $bigbytea, $t);
+
+$t='Database handle attribute "pg_zero_copy" keeps values valid after the statement handle is destroyed';
+undef $sth;
+$dbh->do('SELECT repeat(?, 1000)', undef, 'xyz');
+is ($zrow->[1], $bigbytea, $t);
+
+$t='Database handle attribute "pg_zero_copy" leaves columns bound with bind_col() writable';
+$sth = $dbh->prepare('SELECT ?::text');
+$sth->execute($bigtext);
+my $zbound;
+$sth->bind_col(1, \$zbound);
+$sth->fetch();
+eval { $zbound .= 'x'; };
+is ($zbound, "${bigtext}x", $t);
+$sth->finish();
+
+$t='Database handle attribute "pg_zero_copy" can be set back to 0';
+$dbh->{pg_zero_copy} = 0;
+$result = $dbh->{pg_zero_copy};
+is ($result, 0, $t);
+
+#
+# Test of the database handle attribute "pg_copy_buffer"
+#
+
+$t='Database handle attribute "pg_copy_buffer" starts as 0';
+$result = $dbh->{pg_copy_buffer};
+is ($result, 0, $t);
+
+$t='Database handle attribute "pg_copy_buffer" treats negative numbers as 0';
+$dbh->{pg_copy_buffer} = -5;
+$result = $dbh->{pg_copy_buffer};
+is ($result, 0, $t);
+
+$t='Database handle attribute "pg_copy_buffer" can be set to a positive number';
+$dbh->{pg_copy_buffer} = 262144;
+$result = $dbh->{pg_copy_buffer};
+is ($result, 262144, $t);
+$dbh->{pg_copy_buffer} = 0;
+
 ## Test of all the informational pg_* database handle attributes
 
 $t='Database handle attribute "pg_protocol" returns at least one character';
@@ -6,7 +6,7 @@
 ## "data_sources" (see 04misc.t)
 ## "disconnect" (see 01connect.t)
 ## "pg_savepoint"  "pg_release"  "pg_rollback_to" (see 20savepoints.t)
-## "pg_getline"  "pg_endcopy"  "pg_getcopydata"  "pg_getcopydata_async" (see 07copy.t)
+## "pg_getline"  "pg_endcopy"  "pg_getcopydata"  "pg_getcopydata_async"  "pg_getcopydata_bulk" (see 07copy.t)
 ## "pg_putline"  "pg_putcopydata"  "pg_putcopydata_async (see 07copy.t)
 ## "pg_cancel"  "pg_ready"  "pg_result" (see 08async.t)
 
@@ -331,6 +331,40 @@ is ($@, q{}, $t);
 $dbh->do(q{DROP TABLE "dbd_pg_test_'table'"});
 $dbh->do(q{DROP SEQUENCE "dbd_pg_test_'seq'"});
 
+$t='Database handle method prepare() with pg_returning_id adds a RETURNING clause for the key column';
+$sth = $dbh->prepare("INSERT INTO $table2 DEFAULT VALUES", {pg_returning_id => 1});
+like ($sth->{Statement}, qr{RETURNING "a"$}, $t);
+
+$t='Statement handle with pg_returning_id is not left active after execute';
+$sth->execute();
+ok (!$sth->{Active}, $t);
+
+$t='Database handle method last_insert_id() returns the value from an added RETURNING clause';
+$result = $dbh->last_insert_id(undef,undef,$table2,undef);
+is ($result, $dbh->selectrow_array("SELECT currval('$schema.$sequence4')"), $t);
+
+$t='Database handle method prepare() with pg_returning_id adds a RETURNING clause before a trailing comment';
+$sth = $dbh->prepare("INSERT INTO $table2 DEFAULT VALUES; -- no RETURNING yet", {pg_returning_id => 1});
+like ($sth->{Statement}, qr{DEFAULT VALUES RETURNING "a"$}, $t);
+
+$t='Database handle method last_insert_id() works with an INSERT ending in a comment';
+$sth->execute();
+$result = $dbh->last_insert_id(undef,undef,$table2,undef);
+is ($result, $dbh->selectrow_array("SELECT currval('$schema.$sequence4')"), $t);
+
+$t='Database handle method last_insert_id() needs no table after an INSERT with pg_returning_id';
+$sth = $dbh->prepare("INSERT INTO $table2 DEFAULT VALUES RETURNING a, 123", {pg_returning_id => 1});
+$sth->execute();
+$result = $dbh->last_insert_id(undef,undef,undef,undef);
+is_deeply ([$result, 123], $sth->fetchrow_arrayref(), $t);
+
+$t='Database handle method last_insert_id() forgets the RETURNING value once another statement runs';
+$dbh->do('SELECT 1');
+eval {
+    $dbh->last_insert_id(undef,undef,undef,undef);
+};
+like ($@, qr{last_insert_id.*least}, $t);
+
 $dbh->do("DROP SCHEMA $schema2");
 $dbh->do("DROP TABLE $table2");
 $dbh->do("DROP SEQUENCE $sequence4");
@@ -1175,6 +1209,132 @@ $t=q{Database handle method column_info() works when FetchHashKeyName set to NAM
     is ($result->{TABLE_NAME}, $test_table, $t);
 }
 
+## Check the pg_metadata_cache attribute
+$dbh->do('CREATE TEMP TABLE dbd_pg_metadata_test (id INT PRIMARY KEY, a TEXT)');
+$expected = $dbh->column_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref();
+
+$t=q{Database handle attribute "pg_metadata_cache" can be set};
+$dbh->{pg_metadata_cache} = 10;
+is ($dbh->{pg_metadata_cache}, 10, $t);
+
+$t=q{Database handle method column_info() returns the same rows when pg_metadata_cache is set};
+$result = $dbh->column_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref();
+is_deeply ($result, $expected, $t);
+
+$t=q{Database handle method column_info() returns the same rows from the metadata cache};
+$result = $dbh->column_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref();
+is_deeply ($result, $expected, $t);
+
+$t=q{Database handle method column_info() notices a new column despite the metadata cache};
+$dbh->do('ALTER TABLE dbd_pg_metadata_test ADD COLUMN b INT');
+$result = $dbh->column_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref({});
+is_deeply ([map { $_->{COLUMN_NAME} } @$result], [qw/id a b/], $t);
+
+$t=q{Database handle method column_info() notices a new default despite the metadata cache};
+$dbh->do(q{ALTER TABLE dbd_pg_metadata_test ALTER COLUMN a SET DEFAULT 'x'});
+$result = $dbh->column_info('', '', 'dbd_pg_metadata_test', 'a')->fetchall_arrayref({})->[0];
+like ($result->{COLUMN_DEF}, qr/'x'/, $t);
+
+$t=q{Database handle method primary_key_info() returns the same rows from the metadata cache};
+$expected = $dbh->primary_key_info('', '', 'dbd_pg_metadata_test')->fetchall_arrayref();
+$result = $dbh->primary_key_info('', '', 'dbd_pg_metadata_test')->fetchall_arrayref();
+is_deeply ($result, $expected, $t);
+
+$t=q{Database handle method column_info() notices a new column comment despite the metadata cache};
+$dbh->do(q{COMMENT ON COLUMN dbd_pg_metadata_test.a IS 'tangelo'});
+$result = $dbh->column_info('', '', 'dbd_pg_metadata_test', 'a')->fetchall_arrayref({})->[0];
+is ($result->{REMARKS}, 'tangelo', $t);
+
+$t=q{Database handle method column_info() notices a second change in the same transaction despite the metadata cache};
+$dbh->do(q{ALTER TABLE dbd_pg_metadata_test ALTER COLUMN a SET DEFAULT 'y'});
+$result = $dbh->column_info('', '', 'dbd_pg_metadata_test', 'a')->fetchall_arrayref({})->[0];
+like ($result->{COLUMN_DEF}, qr/'y'/, $t);
+
+SKIP: {
+
+    skip ('Cannot rename enum values unless on Postgres 10 or later', 1) if $pgversion < 100000;
+
+    $t=q{Database handle method column_info() notices a renamed enum value despite the metadata cache};
+    $dbh->do(q{CREATE TYPE dbd_pg_metadata_enum AS ENUM ('red', 'green')});
+    $dbh->do('ALTER TABLE dbd_pg_metadata_test ADD COLUMN e dbd_pg_metadata_enum');
+    $dbh->column_info('', '', 'dbd_pg_metadata_test', 'e')->fetchall_arrayref({});
+    $dbh->do(q{ALTER TYPE dbd_pg_metadata_enum RENAME VALUE 'green' TO 'blue'});
+    $result = $dbh->column_info('', '', 'dbd_pg_metadata_test', 'e')->fetchall_arrayref({})->[0];
+    is_deeply ($result->{pg_enum_values}, [qw/red blue/], $t);
+
+    $dbh->do('ALTER TABLE dbd_pg_metadata_test DROP COLUMN e');
+    $dbh->do('DROP TYPE dbd_pg_metadata_enum');
+}
+
+## A DO block does not tell us that it changed the schema, and renaming a column
+## twice in one transaction leaves the xmin of its catalog row unchanged
+SKIP: {
+
+    skip ('Cannot use DO blocks unless on Postgres 9.0 or later', 2) if $pgversion < 90000;
+
+    $t=q{Database handle attribute "pg_metadata_cache" limits the number of cached results};
+    $dbh->{pg_metadata_cache} = 1;
+    $dbh->column_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref();
+    $dbh->table_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref();
+    $dbh->do('DO $$BEGIN ALTER TABLE dbd_pg_metadata_test RENAME COLUMN b TO c; END$$');
+    $result = $dbh->column_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref({});
+    is_deeply ([map { $_->{COLUMN_NAME} } @$result], [qw/id a c/], $t);
+
+    $t=q{Database handle method pg_clear_metadata_cache() empties the metadata cache};
+    $dbh->do('DO $$BEGIN ALTER TABLE dbd_pg_metadata_test RENAME COLUMN c TO d; END$$');
+    $dbh->pg_clear_metadata_cache();
+    $result = $dbh->column_info('', '', 'dbd_pg_metadata_test', '')->fetchall_arrayref({});
+    is_deeply ([map { $_->{COLUMN_NAME} } @$result], [qw/id a d/], $t);
+}
+
+## A cached result is returned without running the column_info() query itself,
+## which the SQL trace shows
+SKIP: {
+
+    eval { require File::Temp; };
+    $@ and skip ('Must have File::Temp to test the metadata cache with trace flags', 4);
+
+    $dbh->do('CREATE TEMP TABLE dbd_pg_metadata_test2 (id INT)');
+    $dbh->do('CREATE TEMP TABLE dbd_pg_metadata_test3 (id INT)');
+    $dbh->{pg_metadata_cache} = 2;
+    $dbh->pg_clear_metadata_cache();
+
+    my ($tracefh, $tracefile) = File::Temp::tempfile('dbdpg_test_XXXXXX', SUFFIX => '.tst', UNLINK => 0);
+    my $column_info_ran = sub {
+        my $table = shift;
+        my $start = -s $tracefile || 0;
+        $dbh->trace($dbh->parse_trace_flags('SQL'), $tracefile);
+        $dbh->column_info('', '', $table, '')->fetchall_arrayref();
+        $dbh->trace(0);
+        seek $tracefh, $start, SEEK_SET;
+        my $info = do { local $/; <$tracefh> };
+        return $info =~ /pg_enum_values/ ? 1 : 0;
+    };
+
+    $t=q{Database handle attribute "pg_metadata_cache" returns a cached result without running the query};
+    $column_info_ran->('dbd_pg_metadata_test');
+    $column_info_ran->('dbd_pg_metadata_test2');
+    is ($column_info_ran->('dbd_pg_metadata_test'), 0, $t);
+
+    $t=q{Database handle attribute "pg_metadata_cache" keeps the most recently used results when full};
+    $column_info_ran->('dbd_pg_metadata_test3');
+    is ($column_info_ran->('dbd_pg_metadata_test'), 0, $t);
+
+    $t=q{Database handle attribute "pg_metadata_cache" forgets the least recently used result when full};
+    is ($column_info_ran->('dbd_pg_metadata_test2'), 1, $t);
+
+    $t=q{Database handle method pg_clear_metadata_cache() empties the metadata cache};
+    $dbh->pg_clear_metadata_cache();
+    is ($column_info_ran->('dbd_pg_metadata_test'), 1, $t);
+
+    close $tracefh or warn 'Failed to close temporary file';
+    unlink $tracefile;
+    $dbh->do('DROP TABLE dbd_pg_metadata_test2, dbd_pg_metadata_test3');
+}
+
+$dbh->{pg_metadata_cache} = 0;
+$dbh->do('DROP TABLE dbd_pg_metadata_test');
+
 #
 # Test of the "primary_key_info" database handle method
 #
@@ -2544,6 +2704,47 @@ SKIP: {
     $dbh->{AutoCommit} = 0;
 }
 
+#
+# Test of the "pg_register_types" database handle method
+#
+
+$dbh->do( q{CREATE TYPE dbd_pg_mood AS ENUM ('sad', 'ok', 'happy')} );
+
+$t='Database handle method "pg_register_types" does not know about a new type before it is called';
+$sth = $dbh->prepare(q{SELECT '{sad,happy}'::dbd_pg_mood[]});
+$sth->execute();
+is ($sth->{pg_type}[0], 'unknown', $t);
+$result = $sth->fetchall_arrayref()->[0][0];
+
+$t='Database handle method "pg_register_types" returns arrays of unregistered types as strings';
+is ($result, '{sad,happy}', $t);
+
+$t='Database handle method "pg_register_types" registers a new type and its array type';
+$result = $dbh->pg_register_types();
+cmp_ok ($result, '>=', 2, $t);
+
+$t='Database handle method "pg_register_types" returns 0 when nothing new is found';
+$result = $dbh->pg_register_types();
+is ($result, 0, $t);
+
+$t='Database handle method "pg_register_types" makes the type name available via pg_type';
+$sth->execute();
+is ($sth->{pg_type}[0], '_dbd_pg_mood', $t);
+
+$t='Database handle method "pg_register_types" returns arrays of registered types as arrays';
+$result = $sth->fetchall_arrayref()->[0][0];
+is_deeply ($result, ['sad','happy'], $t);
+
+$t='Database handle method "pg_register_types" allows binding with the new type';
+my $mood_oid = $dbh->selectrow_array(q{SELECT 'dbd_pg_mood'::regtype::oid});
+$sth = $dbh->prepare(q{SELECT ?::text});
+$sth->bind_param(1, 'ok', { pg_type => $mood_oid });
+$sth->execute();
+is ($sth->fetchall_arrayref()->[0][0], 'ok', $t);
+
+undef $sth;
+$dbh->do('DROP TYPE dbd_pg_mood');
+
 #
 # Test of the "pg_notifies" database handle method
 #
@@ -2600,6 +2801,94 @@ SKIP: {
     is (length($name), 17, $t);
 }
 
+#
+# Test of the "pg_notifies_all" database handle method
+#
+
+$t='Database handle method pg_notifies_all() returns an empty array when nothing is pending';
+$info = $dbh->pg_notifies_all;
+is_deeply ($info, [], $t);
+
+$t='Database handle method pg_notifies_all() returns all pending notifications';
+for (1..3) {
+    $dbh->do("NOTIFY $notify_name");
+    $dbh->commit();
+}
+$info = $dbh->pg_notifies_all;
+is_deeply ($info, [[$notify_name, $pid, ''], [$notify_name, $pid, ''], [$notify_name, $pid, '']], $t);
+
+$t='Database handle method pg_notifies_all() returns no more than the maximum requested';
+for (1..3) {
+    $dbh->do("NOTIFY $notify_name");
+    $dbh->commit();
+}
+$info = $dbh->pg_notifies_all(2);
+is (scalar @$info, 2, $t);
+
+$t='Database handle method pg_notifies_all() leaves the rest for the next call';
+$info = $dbh->pg_notifies_all(2);
+is (scalar @$info, 1, $t);
+
+SKIP: {
+    if ($pgversion < 90000) {
+        skip ('Cannot test notification payloads on pre-9.0 servers', 2);
+    }
+
+    for my $payload (qw/ one one two /) {
+        $dbh->do(qq{NOTIFY $notify_name, '$payload'});
+        $dbh->commit();
+    }
+    $dbh->do(qq{NOTIFY abc$notify_name, 'one'});
+    $dbh->commit();
+
+    $t='Database handle method pg_notifies_all() drops repeated payloads when asked';
+    $info = $dbh->pg_notifies_all(0, { unique => 1 });
+    is_deeply ($info, [[$notify_name, $pid, 'one'], [$notify_name, $pid, 'two'], ["abc$notify_name", $pid, 'one']], $t);
+
+    for my $payload (qw/ one one two /) {
+        $dbh->do(qq{NOTIFY $notify_name, '$payload'});
+        $dbh->commit();
+    }
+    $dbh->do(qq{NOTIFY abc$notify_name, 'one'});
+    $dbh->commit();
+
+    $t='Database handle method pg_notifies_all() groups notifications by name when asked';
+    $info = $dbh->pg_notifies_all(undef, { group => 1 });
+    is_deeply ($info, {
+        $notify_name      => [[$pid, 'one'], [$pid, 'one'], [$pid, 'two']],
+        "abc$notify_name" => [[$pid, 'one']],
+    }, $t);
+}
+
+#
+# Test of the "pg_wait_for_notify" database handle method
+#
+
+$t='Database handle method pg_wait_for_notify() returns an empty array when checking with no timeout';
+$info = $dbh->pg_wait_for_notify(0);
+is_deeply ($info, [], $t);
+
+$t='Database handle method pg_wait_for_notify() returns an empty array when the time runs out';
+$info = $dbh->pg_wait_for_notify(0.2);
+is_deeply ($info, [], $t);
+
+$t='Database handle method pg_wait_for_notify() returns pending notifications';
+for (1..2) {
+    $dbh->do("NOTIFY $notify_name");
+    $dbh->commit();
+}
+$info = $dbh->pg_wait_for_notify(10);
+is_deeply ($info, [[$notify_name, $pid, ''], [$notify_name, $pid, '']], $t);
+
+$t='Database handle method pg_wait_for_notify() returns no more than the maximum requested';
+for (1..2) {
+    $dbh->do("NOTIFY $notify_name");
+    $dbh->commit();
+}
+$info = $dbh->pg_wait_for_notify(10, 1);
+is (scalar @$info, 1, $t);
+$dbh->pg_notifies_all;
+
 
 #
 # Test of the "getfd" database handle method
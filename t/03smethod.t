@@ -23,7 +23,7 @@ my $dbh = connect_database();
 if (! $dbh) {
     plan skip_all => 'Connection to database failed, cannot continue testing';
 }
-plan tests => 163;
+plan tests => 205;
 
 isnt ($dbh, undef, 'Connect to database for statement handle testing');
 
@@ -361,6 +361,48 @@ is_deeply (\@tuple_status, [map{1}(1..$goodrows)], $t);
 $t='Statement handle method execute_for_fetch() returns correct number of rows';
 is ($rows, $goodrows, $t);
 
+SKIP: {
+
+    if ($pglibversion < 140000) {
+        skip ('Pipeline mode requires libpq 14 or better', 1);
+    }
+
+    $t='Statement handle method execute_for_fetch() prepares the statement on the server once';
+    $result = $dbh->selectrow_array('SELECT count(*) FROM pg_prepared_statements WHERE name = ?',
+                                    undef, $sth2->{pg_prepare_name});
+    is ($result, 1, $t);
+}
+
+$t='Statement handle method execute_array() reports the status of each tuple when one fails';
+$dbh->pg_savepoint('efetch');
+undef @tuple_status;
+eval {
+    $sth2->execute_array({ ArrayTupleStatus => \@tuple_status }, [600,600,601], ['a','b','c']);
+};
+like ($@, qr{executing 3 generated 2 errors}, $t);
+
+$t='Statement handle method execute_array() returns rows and errors in the status array';
+is_deeply ([map { ref $_ ? 'error' : $_ } @tuple_status], [1,'error','error'], $t);
+
+$t='Statement handle method execute_array() returns the SQLSTATE of a failed tuple';
+is ($tuple_status[1][2], '23505', $t);
+$dbh->pg_rollback_to('efetch');
+
+SKIP: {
+
+    if ($pglibversion < 140000) {
+        skip ('Pipeline mode requires libpq 14 or better', 1);
+    }
+
+    $t='Statement handle method execute_for_fetch() raises an error when pipeline mode cannot be entered';
+    no warnings 'redefine';
+    local *DBD::Pg::db::pg_enter_pipeline = sub { $_[0]->set_err(1, 'Pipeline mode is not available'); return 0; };
+    eval {
+        $sth2->execute_for_fetch(sub { [602, 'd'] });
+    };
+    like ($@, qr{Pipeline mode is not available}, $t);
+}
+
 #
 # Test of the "fetchrow_arrayref" statement handle method
 #
@@ -803,6 +845,161 @@ $sth->execute();
 $sth->fetchall_arrayref();
 is ($sth->{pg_current_row}, 0, $t);
 
+#
+# Test of the statement handle attribute pg_stream_rows
+#
+
+SKIP: {
+
+    if ($pglibversion < 90200) {
+        skip ('Streaming rows requires libpq 9.2 or better', 14);
+    }
+
+    $t=q{Statement handle attribute pg_stream_rows can be set via prepare};
+    $sth = $dbh->prepare('SELECT x FROM generate_series(1,5) AS x', {pg_stream_rows => 2});
+    is ($sth->{pg_stream_rows}, 2, $t);
+
+    $t=q{Statement handle method execute() returns -1 when streaming rows};
+    is ($sth->execute(), -1, $t);
+
+    $t=q{Statement handle method fetchall_arrayref() returns all rows when streaming};
+    is_deeply ($sth->fetchall_arrayref(), [[1],[2],[3],[4],[5]], $t);
+
+    $t=q{Statement handle method rows() returns total rows after streaming};
+    is ($sth->rows(), 5, $t);
+
+    $t=q{Statement handle attribute pg_current_row counts across batches when streaming};
+    $sth->execute();
+    $sth->fetch() for 1..3;
+    is ($sth->{pg_current_row}, 3, $t);
+
+    $t=q{Statement handle method finish() frees the connection when streaming};
+    $sth->finish();
+    is ($dbh->selectrow_array('SELECT 42'), 42, $t);
+
+    $t=q{Running another statement throws away the rest of a streamed result};
+    $sth->execute();
+    $sth->fetch();
+    $dbh->do('SELECT 1');
+    ok (!$sth->{Active}, $t);
+
+    $t=q{Preparing a statement right away throws away the rest of a streamed result};
+    $sth->execute();
+    $sth->fetch();
+    $sth2 = $dbh->prepare('SELECT ?::int', {pg_prepare_now => 1});
+    ok (!$sth->{Active}, $t);
+
+    $t=q{Statement handle prepared during a stream can be executed};
+    is ($dbh->selectrow_array($sth2, undef, 7), 7, $t);
+
+    $t=q{Creating a large object throws away the rest of a streamed result};
+    $sth->execute();
+    $sth->fetch();
+    my $lobject = $dbh->pg_lo_creat($dbh->{pg_INV_WRITE});
+    ok ($lobject && !$sth->{Active}, $t);
+    $dbh->pg_lo_unlink($lobject);
+
+    $t=q{Statement handle method execute() works when streaming a query with no rows};
+    $sth2 = $dbh->prepare('SELECT 1 WHERE 1=0', {pg_stream_rows => 10});
+    is ($sth2->execute(), '0E0', $t);
+
+    $t=q{Statement handle method fetch() returns undef when streaming a query with no rows};
+    is ($sth2->fetch(), undef, $t);
+
+    $t=q{Statement handle method fetch() reports an error raised partway through a stream};
+    $sth2 = $dbh->prepare('SELECT 1/(3-x) FROM generate_series(1,5) AS x', {pg_stream_rows => 1});
+    eval {
+        $sth2->execute();
+        1 while $sth2->fetch();
+    };
+    like ($@, qr{division by zero}, $t);
+    $dbh->rollback();
+
+    $t=q{Statement handle attribute pg_stream_rows can be turned off};
+    $sth->{pg_stream_rows} = 0;
+    is ($sth->execute(), 5, $t);
+    $sth->finish();
+}
+
+#
+# Test of the statement handle attribute pg_binary_results
+#
+
+SKIP: {
+
+    if ($pgversion < 80300) {
+        skip ('Cannot test binary results on pre-8.3 servers', 10);
+    }
+
+    $t=q{Statement handle attribute pg_binary_results is inherited from the database handle};
+    $dbh->{pg_binary_results} = 1;
+    $sth = $dbh->prepare('SELECT 1');
+    is ($sth->{pg_binary_results}, 1, $t);
+    $dbh->{pg_binary_results} = 0;
+
+    $t=q{Statement handle attribute pg_binary_results can be set via prepare};
+    $dbh->do(q{SET DateStyle = 'ISO'});
+    $SQL = q{SELECT 1::int2, -2::int4, 1234567890123::int8, 26::oid, 1.5::float4, -2.25::float8,
+ true, false, 'abc'::bytea, 'xyz'::text, 'ab '::char(4), 'q'::varchar, 'nm'::name,
+ '2024-01-02 03:04:05.5'::timestamp, '1999-12-31 23:59:59'::timestamp, 'infinity'::timestamp,
+ '0044-03-15 12:00:00 BC'::timestamp, 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'::uuid, NULL::int4};
+    $sth = $dbh->prepare($SQL, {pg_binary_results => 1});
+    is ($sth->{pg_binary_results}, 1, $t);
+
+    $t=q{Statement handle attribute pg_binary_results returns the same values as text format};
+    $sth->execute();
+    $expected = $sth->fetchall_arrayref();
+    $sth->execute();
+    is_deeply ($sth->fetchall_arrayref(), $expected, $t);
+
+    $t=q{Statement handle attribute pg_binary_results works with ChopBlanks};
+    $sth->{ChopBlanks} = 1;
+    $sth->execute();
+    is ($sth->fetchall_arrayref()->[0][10], 'ab', $t);
+
+    $t=q{Statement handle attribute pg_binary_results works with placeholders};
+    $sth = $dbh->prepare('SELECT ?::int4 + 1, ?::text', {pg_binary_results => 1});
+    $sth->execute(41, 'abc');
+    $sth->fetchall_arrayref();
+    $sth->execute(42, 'def');
+    is_deeply ($sth->fetchall_arrayref(), [[43, 'def']], $t);
+
+    $t=q{Statement handle attribute pg_binary_results falls back to text for other types};
+    $sth = $dbh->prepare('SELECT 1.5::numeric, 2::int4', {pg_binary_results => 1});
+    $sth->execute();
+    $sth->fetchall_arrayref();
+    $sth->execute();
+    is_deeply ($sth->fetchall_arrayref(), [['1.5', 2]], $t);
+
+    $t=q{Statement handle attribute pg_binary_results returns the same arrays as text format};
+    $SQL = q{SELECT '{1,-2,NULL,4}'::int4[], '{{1,2},{3,4}}'::int8[], '{1.5,-2.25}'::float8[],
+ '{t,f,NULL}'::bool[], ARRAY['a,b', 'c"d', 'NULL', '', NULL]::text[], '{}'::int4[],
+ '[0:1]={5,6}'::int4[], '{{{a},{b}},{{c},{d}}}'::text[]};
+    $sth = $dbh->prepare($SQL, {pg_binary_results => 1});
+    $sth->execute();
+    $expected = $sth->fetchall_arrayref();
+    $sth->execute();
+    is_deeply ($sth->fetchall_arrayref(), $expected, $t);
+
+    $t=q{Statement handle attribute pg_binary_results returns arrays as strings when pg_expand_array is off};
+    $dbh->{pg_expand_array} = 0;
+    $sth->execute();
+    is ($sth->fetchall_arrayref()->[0][0], '{1,-2,NULL,4}', $t);
+    $dbh->{pg_expand_array} = 1;
+
+    $t=q{Statement handle attribute pg_binary_results returns enums and records as text on the first execute};
+    $dbh->do(q{CREATE TYPE dbd_pg_test_binenum AS ENUM ('red', 'green')});
+    $sth = $dbh->prepare(q{SELECT 'green'::dbd_pg_test_binenum, ROW(1, 'a b'), 3::int4}, {pg_binary_results => 1});
+    $sth->execute();
+    is_deeply ($sth->fetchall_arrayref(), [['green', '(1,"a b")', 3]], $t);
+
+    $t=q{Statement handle attribute pg_binary_results returns enums and records as text on the second execute};
+    $sth->execute();
+    is_deeply ($sth->fetchall_arrayref(), [['green', '(1,"a b")', 3]], $t);
+
+    $dbh->rollback();
+}
+
 #
 # Test of the statement handle method cancel()
 #
@@ -858,6 +1055,55 @@ is_deeply ($sth->pg_canonical_names, [
     undef
 ], $t);
 
+$t=q{Statement handle method pg_canonical_names() returns the same values when cached};
+$sth->execute;
+is_deeply ($sth->pg_canonical_names, [
+    'dbd_pg_testschema.dbd_pg_test.id',
+    'dbd_pg_testschema.dbd_pg_test.id',
+    undef
+], $t);
+
+$t=q{Statement handle attribute NULLABLE agrees with pg_canonical_names() on the same columns};
+is_deeply ($sth->{NULLABLE}, [0,0,2], $t);
+
+$dbh->do('CREATE TEMP TABLE dbd_pg_test_nullable (a INT, b INT)');
+$t=q{Statement handle attribute NULLABLE is correct for a new table};
+$sth = $dbh->prepare('SELECT a, b FROM dbd_pg_test_nullable');
+$sth->execute;
+is_deeply ($sth->{NULLABLE}, [1,1], $t);
+
+$t=q{Statement handle attribute NULLABLE is refreshed after an ALTER TABLE};
+$dbh->do('ALTER TABLE dbd_pg_test_nullable ALTER COLUMN a SET NOT NULL');
+$sth->execute;
+is_deeply ($sth->{NULLABLE}, [0,1], $t);
+
+SKIP: {
+
+    if ($pgversion < 90000) {
+        skip ('DO blocks require Postgres 9.0 or better', 1);
+    }
+
+    $t=q{Database handle method pg_clear_metadata_cache() forgets cached column details};
+    $dbh->do(q{DO $$BEGIN EXECUTE 'ALTER TABLE dbd_pg_test_nullable ALTER COLUMN b SET NOT NULL'; END$$});
+    $dbh->pg_clear_metadata_cache();
+    $sth->execute;
+    is_deeply ($sth->{NULLABLE}, [0,0], $t);
+}
+$sth->finish;
+$dbh->do('DROP TABLE dbd_pg_test_nullable');
+
+$t=q{Statement handle attribute NULLABLE works for a repeated column in a failed transaction};
+$dbh->pg_clear_metadata_cache();
+$sth = $dbh->prepare('SELECT id, id AS again FROM dbd_pg_test LIMIT 1');
+$sth->execute;
+eval { $dbh->do('SELECT 1/0'); };
+is_deeply ($sth->{NULLABLE}, [2,2], $t);
+$sth->finish;
+$dbh->rollback();
+
+$sth = $dbh->prepare('SELECT id, id AS not_id, id + 1 AS not_a_simple FROM dbd_pg_test LIMIT 1');
+$sth->execute;
+
 #
 # Test of the statement handle method pg_canonical_ids()
 #
@@ -874,6 +1120,52 @@ is_deeply ($data->[0], $data->[1], $t);
 
 $sth->finish;
 
+#
+# Test of the statement handle method pg_fetch_columns()
+#
+
+$t=q{Statement handle method pg_fetch_columns() returns one array per column};
+$SQL = q{SELECT x, 'abc'||x, CASE WHEN x = 2 THEN NULL ELSE x > 1 END FROM generate_series(1,3) AS x};
+$sth = $dbh->prepare($SQL);
+$sth->execute();
+is_deeply ($sth->pg_fetch_columns(), [[1,2,3],['abc1','abc2','abc3'],[0,undef,1]], $t);
+
+$t=q{Statement handle method pg_fetch_columns() finishes the statement handle};
+ok (!$sth->{Active}, $t);
+
+$t=q{Statement handle method pg_fetch_columns() returns undef when there are no more rows};
+is ($sth->pg_fetch_columns(), undef, $t);
+
+$t=q{Statement handle method pg_fetch_columns() respects the max_rows argument};
+$sth->execute();
+is_deeply ($sth->pg_fetch_columns(2), [[1,2],['abc1','abc2'],[0,undef]], $t);
+
+$t=q{Statement handle method pg_fetch_columns() continues after a fetch() call};
+$sth->execute();
+$sth->fetch();
+is_deeply ($sth->pg_fetch_columns(5), [[2,3],['abc2','abc3'],[undef,1]], $t);
+
+$t=q{Statement handle method pg_fetch_columns() returns empty arrays for an empty result};
+$sth = $dbh->prepare('SELECT 1, 2 WHERE false');
+$sth->execute();
+is_deeply ($sth->pg_fetch_columns(), [[],[]], $t);
+
+SKIP: {
+
+    if ($pglibversion < 90200) {
+        skip ('Streaming rows requires libpq 9.2 or better', 1);
+    }
+
+    $t=q{Statement handle method pg_fetch_columns() fetches across batches when streaming};
+    $sth = $dbh->prepare('SELECT x FROM generate_series(1,5) AS x', {pg_stream_rows => 2});
+    $sth->execute();
+    my @batches;
+    while (my $columns = $sth->pg_fetch_columns(3)) {
+        push @batches, $columns->[0];
+    }
+    is_deeply (\@batches, [[1,2,3],[4,5]], $t);
+}
+
 
 #
 # Test for regression reported in GitHub issue #72:
@@ -17,7 +17,7 @@ my $dbh = connect_database();
 if (! $dbh) {
     plan skip_all => 'Connection to database failed, cannot continue testing';
 }
-plan tests => 36;
+plan tests => 40;
 
 isnt ($dbh, undef, 'Connect to database for bytea testing');
 
@@ -79,8 +79,27 @@ if ($pgversion < 90000) {
 }
 else {
     test_outputs($_) for qw(hex escape);
+    $dbh->do(q{SET bytea_output = 'hex'});
 }
 
+$t='quote uses the hex format for binary data when the server accepts it';
+my $long_binary = $binary_out x 16;
+my $quoted = $dbh->quote($long_binary, { pg_type => PG_BYTEA });
+like ($quoted, ($pgversion >= 90000 ? qr{^E'\\\\x000102} : qr{^E?'\\\\000\\\\001}), $t);
+
+$t='quoted binary data is returned unchanged by the server';
+is ($dbh->selectrow_array("SELECT $quoted::bytea"), $long_binary, $t);
+
+$t='binary data bound to a statement that is not server-prepared is returned unchanged';
+$sth = $dbh->prepare('SELECT ?::bytea', { pg_server_prepare => 0 });
+$sth->bind_param(1, undef, { pg_type => PG_BYTEA });
+$sth->execute($long_binary);
+is ($sth->fetchall_arrayref()->[0][0], $long_binary, $t);
+
+$t='bytea arrays are returned as arrays of binary strings';
+my $array = $dbh->selectrow_arrayref(q{SELECT ARRAY[decode('6869','hex'), decode('0a00','hex'), decode('616263','hex')]});
+is_deeply ($array->[0], ['hi', "\n\0", 'abc'], $t);
+
 $sth->finish();
 
 cleanup_database($dbh,'test');
@@ -15,7 +15,7 @@ select(($|=1,select(STDERR),$|=1)[1]);
 my $dbh = connect_database();
 
 if ($dbh) {
-    plan tests => 87;
+    plan tests => 96;
 }
 else {
     plan skip_all => 'Connection to database failed, cannot continue testing';
@@ -274,6 +274,34 @@ $result = $dbh->selectall_arrayref("SELECT id2,val2 FROM $table ORDER BY id2");
 $expected = [['12','Mulberry'],['13','Strawberry'],[14,'Blueberry'],[17,'MoreBlueberries']];
 is_deeply ($result, $expected, $t);
 
+$t='pg_putcopydata accepts an array of rows';
+$dbh->do("COPY $table FROM STDIN");
+eval {
+    $result = $dbh->pg_putcopydata(["20\tApple\n", undef, "21\tBanana\n", "22\tCherry\n"]);
+};
+is ($@, q{}, $t);
+is ($result, 1, $t);
+$dbh->pg_putcopyend();
+
+$t='Data from an array of rows given to pg_putcopydata was entered correctly';
+$result = $dbh->selectall_arrayref("SELECT id2,val2 FROM $table WHERE id2 >= 20 ORDER BY id2");
+is_deeply ($result, [[20,'Apple'],[21,'Banana'],[22,'Cherry']], $t);
+$dbh->do("DELETE FROM $table WHERE id2 >= 20");
+
+$t='Rows buffered by pg_copy_buffer are all entered by pg_putcopyend';
+$dbh->{pg_copy_buffer} = 100;
+$dbh->do("COPY $table FROM STDIN");
+for my $id (100..199) {
+    $dbh->pg_putcopydata("$id\tBuffered row number $id\n");
+}
+$dbh->pg_putcopydata([map { "$_\tBuffered row number $_\n" } 200..249]);
+$dbh->pg_putcopyend();
+$result = $dbh->selectall_arrayref("SELECT count(*), min(id2), max(id2) FROM $table WHERE id2 >= 100");
+is_deeply ($result, [[150, 100, 249]], $t);
+$dbh->do("DELETE FROM $table WHERE id2 >= 100");
+$dbh->{pg_copy_buffer} = 0;
+$dbh->commit();
+
 $t='pg_getcopydata fails when argument is not a variable';
 $dbh->do("COPY $table TO STDOUT");
 eval {
@@ -324,6 +352,35 @@ eval {
 };
 is ($@, q{}, $t);
 
+$t='pg_getcopydata_bulk fails if not after a COPY TO statement';
+eval {
+    $dbh->pg_getcopydata_bulk($buffer);
+};
+like ($@, qr{COPY TO}, $t);
+
+$t='pg_getcopydata_bulk returns a number of bytes or -1 from each call';
+$dbh->do("COPY $table TO STDOUT");
+$buffer = 'start:';
+my @bulk;
+while (1) {
+    $result = $dbh->pg_getcopydata_bulk($buffer, 10);
+    push @bulk => $result;
+    last if $result < 0;
+}
+is ((grep { $_ < 10 and $_ != -1 } @bulk), 0, $t);
+
+$t='pg_getcopydata_bulk appends every row to the buffer';
+is ($buffer, "start:12\tMulberry\n13\tStrawberry\n14\tBlueberry\n17\tMoreBlueberries\n", $t);
+
+$t='pg_getcopydata_bulk returns -1 when the COPY has finished';
+is ($bulk[-1], -1, $t);
+
+$t='Normal queries work after pg_getcopydata_bulk runs out';
+eval {
+    $dbh->do('SELECT 234');
+};
+is ($@, q{}, $t);
+
 $t='Async queries work after COPY OUT';
 $dbh->do('CREATE TEMP TABLE foobar AS SELECT 123::INTEGER AS x');
 $dbh->do('COPY foobar TO STDOUT');
@@ -26,7 +26,7 @@ if (! $dbh_noerr) {
 $dbh_noerr->{RaiseError} = 0;
 $dbh_noerr->{PrintError} = 0;
 
-plan tests => 127;
+plan tests => 160;
 
 isnt ($dbh, undef, 'Connect to database for async testing');
 
@@ -716,6 +716,173 @@ like ($@, qr{No async|async query}, 'pg_ready fails after COPY TO STDOUT complet
 eval { $dbh->do('SELECT 1'); };
 is ($@, q{}, 'Normal synchronous query works after async COPY TO STDOUT finished');
 
+## Pipeline mode
+
+SKIP: {
+
+    if ($dbh->{pg_lib_version} < 140000) {
+        skip ('Pipeline mode requires libpq version 14 or higher', 25);
+    }
+
+    $dbh->do('CREATE TABLE dbd_pg_test_pipeline(id INT PRIMARY KEY, t TEXT)');
+
+    $t=q{Database attribute "pg_pipeline_status" returns 0 by default};
+    is ($dbh->{pg_pipeline_status}, 0, $t);
+
+    $t=q{Method pg_enter_pipeline() returns true};
+    ok ($dbh->pg_enter_pipeline(), $t);
+
+    $t=q{Database attribute "pg_pipeline_status" returns 1 after pg_enter_pipeline};
+    is ($dbh->{pg_pipeline_status}, 1, $t);
+
+    $t=q{Method execute() returns 0E0 in pipeline mode};
+    $sth = $dbh->prepare('INSERT INTO dbd_pg_test_pipeline(id,t) VALUES (?,?)');
+    $res = $sth->execute(1, 'one');
+    is ($res, '0E0', $t);
+    $sth->execute($_, "row $_") for 2..5;
+
+    $t=q{Method do() returns 0E0 in pipeline mode};
+    $res = $dbh->do(q{UPDATE dbd_pg_test_pipeline SET t = 'uno' WHERE id = 1});
+    is ($res, '0E0', $t);
+
+    $t=q{Method pg_pipeline_sync() returns the total number of rows};
+    my @status;
+    $res = $dbh->pg_pipeline_sync(\@status);
+    is ($res, 5, $t);
+
+    $t=q{Method pg_pipeline_sync() fills in a status for each execute};
+    is_deeply (\@status, [1,1,1,1,1], $t);
+
+    $t=q{Method fetch works on a statement handle executed in pipeline mode};
+    my $sth2 = $dbh->prepare('SELECT t FROM dbd_pg_test_pipeline WHERE id = ?');
+    $sth2->execute(1);
+    $dbh->pg_pipeline_sync();
+    is_deeply ($sth2->fetchall_arrayref(), [['uno']], $t);
+
+    $t=q{Method pg_pipeline_sync() returns undef when a command fails};
+    $dbh->{RaiseError} = 0;
+    $dbh->{PrintError} = 0;
+    $sth->execute(6, 'six');
+    $sth->execute(1, 'duplicate');
+    $sth->execute(7, 'seven');
+    @status = ();
+    $res = $dbh->pg_pipeline_sync(\@status);
+    is ($res, undef, $t);
+
+    $t=q{Method pg_pipeline_sync() sets the state of the first failing command};
+    is ($dbh->state, '23505', $t);
+
+    $t=q{Method pg_pipeline_sync() reports the failing and skipped commands};
+    is_deeply ([map { ref $_ ? $_->[2] : $_ } @status], [1, '23505', '22000'], $t);
+    $dbh->{RaiseError} = 1;
+
+    $t=q{Failed commands roll back the whole pipeline segment};
+    $dbh->pg_exit_pipeline();
+    $res = $dbh->selectall_arrayref('SELECT count(*) FROM dbd_pg_test_pipeline');
+    is ($res->[0][0], 5, $t);
+
+    $t=q{Database attribute "pg_pipeline_status" returns 0 after pg_exit_pipeline};
+    is ($dbh->{pg_pipeline_status}, 0, $t);
+
+    $t=q{Method pg_exit_pipeline() gathers outstanding results};
+    $dbh->pg_enter_pipeline();
+    $sth->execute(8, 'eight');
+    ok ($dbh->pg_exit_pipeline(), $t);
+
+    $t=q{Method pg_pipeline_submit() returns the number of statements pending};
+    my $sth3 = $dbh->prepare('SELECT count(*) FROM dbd_pg_test_pipeline WHERE id <= ?');
+    $res = $dbh->pg_pipeline_submit([[$sth2, 2], [$sth3, 3]]);
+    is ($res, 2, $t);
+
+    $t=q{Method pg_pipeline_sync() fails while flushed commands are outstanding};
+    eval {
+        $dbh->pg_pipeline_sync();
+    };
+    like ($@, qr{pg_pipeline_completed}, $t);
+
+    $t=q{Method pg_pipeline_completed() returns the rows of each finished statement};
+    my @done;
+    push @done, @{ $dbh->pg_pipeline_completed(1) } while @done < 2;
+    is_deeply ([map { $_->[1] } @done], [1, 1], $t);
+
+    $t=q{Method pg_pipeline_completed() returns the statement handles in order};
+    is_deeply ([map { $_->[0] } @done], [$sth2, $sth3], $t);
+
+    $t=q{Method fetch works on a statement handle returned by pg_pipeline_completed};
+    is_deeply ($sth3->fetchall_arrayref(), [[3]], $t);
+
+    $t=q{Method pg_pipeline_completed() returns one result per statement handle per call};
+    $dbh->pg_pipeline_submit([[$sth2, 4], [$sth2, 5]]);
+    my $done = $dbh->pg_pipeline_completed(1);
+    is (scalar @$done, 1, $t);
+
+    $t=q{Method pg_pipeline_completed() leaves the first result in the statement handle};
+    is_deeply ($sth2->fetchall_arrayref(), [['row 4']], $t);
+
+    $t=q{Method pg_pipeline_completed() gathers the second result on the next call};
+    $dbh->pg_pipeline_completed(1);
+    is_deeply ($sth2->fetchall_arrayref(), [['row 5']], $t);
+
+    $t=q{Method pg_pipeline_completed() reports the failing and skipped commands};
+    $dbh->pg_pipeline_submit([[$sth, 1, 'duplicate'], [$sth2, 1]]);
+    @done = ();
+    push @done, @{ $dbh->pg_pipeline_completed(1) } while @done < 2;
+    is_deeply ([map { ref $_->[1] ? $_->[1][2] : $_->[1] } @done], ['23505', '22000'], $t);
+
+    $t=q{Method pg_exit_pipeline() gathers flushed results first};
+    $dbh->pg_pipeline_submit([[$sth, 9, 'nine']]);
+    ok ($dbh->pg_exit_pipeline(), $t);
+
+    $t=q{Method execute() cannot be used asynchronously in pipeline mode};
+    $dbh->pg_enter_pipeline();
+    eval {
+        $dbh->do('SELECT 1', {pg_async => PG_ASYNC});
+    };
+    like ($@, qr{pipeline mode}, $t);
+    $dbh->pg_exit_pipeline();
+
+    $dbh->do('DROP TABLE dbd_pg_test_pipeline');
+}
+
+## DBD::Pg::Multi
+
+$t=q{Method DBD::Pg::Multi->execute() returns the number of queries sent};
+my $multi = DBD::Pg::Multi->new($dbh, $dbh_noerr);
+$res = $multi->execute('SELECT ?::int + 1', 41);
+is ($res, 2, $t);
+
+$t=q{Method DBD::Pg::Multi->all() returns one result per database handle};
+my @multi = $multi->all();
+is_deeply ([map { $_->{rows} } @multi], [1, 1], $t);
+
+$t=q{Method DBD::Pg::Multi->all() returns statement handles that can be fetched from};
+is_deeply ([map { $_->{sth}->fetchall_arrayref() } @multi], [[[42]], [[42]]], $t);
+
+$t=q{Method DBD::Pg::Multi->pending() returns 0 once all results are in};
+is ($multi->pending(), 0, $t);
+
+$t=q{Method DBD::Pg::Multi->results() reports errors for each database handle};
+$dbh->do('CREATE TEMP TABLE dbd_pg_test_multi(id INT)');
+$multi->execute('SELECT count(*) FROM dbd_pg_test_multi');
+@multi = ();
+push @multi, $multi->results(5) while $multi->pending();
+@multi = sort { $a->{index} <=> $b->{index} } @multi;
+is_deeply ([map { $_->{state} } @multi], [undef, '42P01'], $t);
+
+$t=q{Method DBD::Pg::Multi->results() returns nothing once all results are in};
+is_deeply ([$multi->results(0)], [], $t);
+$dbh->do('DROP TABLE dbd_pg_test_multi');
+
+$t=q{Method DBD::Pg::Multi->new() fails when given a handle from another driver};
+my $dbh_sponge = DBI->connect('dbi:Sponge:', '', '', {RaiseError => 1, PrintError => 0});
+eval { DBD::Pg::Multi->new($dbh, $dbh_sponge) };
+like ($@, qr{needs DBD::Pg database handles}, $t);
+
+$t=q{Waiting on a handle from another driver fails};
+eval { DBD::Pg::db::_pg_multi_ready([$dbh, $dbh_sponge], 0) };
+like ($@, qr{not a DBD::Pg database handle}, $t);
+$dbh_sponge->disconnect;
+
 cleanup_database($dbh,'test');
 $dbh_noerr->disconnect;
 $dbh->disconnect;
@@ -18,7 +18,7 @@ my $dbh = connect_database();
 if (! $dbh) {
     plan skip_all => 'Connection to database failed, cannot continue testing';
 }
-plan tests => 206;
+plan tests => 218;
 
 isnt ($dbh, undef, 'Connect to database for array testing');
 
@@ -628,6 +628,66 @@ for my $col (@{$result->[0][0]}) {
     is (length($col), length(shift @numbers), "$t (col $col)");
 }
 
+$t=q{Large integer arrays are returned properly};
+$result = $dbh->selectall_arrayref(q{SELECT array(SELECT g FROM generate_series(-500,1500) AS g)});
+is_deeply ($result->[0][0], [-500..1500], $t);
+
+$t=q{Multi-dimensional integer arrays are returned properly};
+$result = $dbh->selectall_arrayref(q{SELECT '{{1,2,3},{4,5,6},{7,8,9}}'::int[]});
+is_deeply ($result->[0][0], [[1,2,3],[4,5,6],[7,8,9]], $t);
+
+$t=q{Multi-dimensional text arrays are returned properly};
+$result = $dbh->selectall_arrayref(q{SELECT '{{{a,b},{c,d}},{{e,f},{g,h}}}'::text[]});
+is_deeply ($result->[0][0], [[['a','b'],['c','d']],[['e','f'],['g','h']]], $t);
+
+$t=q{Float arrays are returned properly};
+$result = $dbh->selectall_arrayref(q{SELECT '{1.5,-2.25,1e10,0}'::float8[]});
+is_deeply ($result->[0][0], [1.5,-2.25,1e10,0], $t);
+
+$t=q{Quoted array items with delimiters, quotes, and backslashes are returned properly};
+$result = $dbh->selectall_arrayref(q{SELECT ARRAY['a,b', 'c"d', 'e' || chr(92) || 'f', 'NULL', '', NULL]::text[]});
+is_deeply ($result->[0][0], ['a,b', 'c"d', "e\\f", 'NULL', '', undef], $t);
+
+$t=q{Integer arrays bound with an array pg_type are returned properly};
+$cleararray->execute();
+$sth = $dbh->prepare(q{INSERT INTO dbd_pg_test(id,pname,testarray2) VALUES (99,'Array Testing',?)});
+$sth->bind_param(1, [1..1000, undef, -5], {pg_type => PG_INT4ARRAY});
+$sth->execute();
+$getarray_int->execute();
+is_deeply ($getarray_int->fetchall_arrayref()->[0][0], [1..1000, undef, -5], $t);
+
+$t=q{Float arrays bound with an array pg_type are returned properly};
+$sth = $dbh->prepare(q{SELECT ?::float8[]});
+$sth->bind_param(1, [1.5, '-2.25', 3, undef], {pg_type => PG_FLOAT8ARRAY});
+$sth->execute();
+is_deeply ($sth->fetchall_arrayref()->[0][0], [1.5, -2.25, 3, undef], $t);
+
+$t=q{Bigint arrays of strings bound with an array pg_type are returned properly};
+$sth = $dbh->prepare(q{SELECT ?::int8[]});
+$sth->bind_param(1, ['1', 2, '-3'], {pg_type => PG_INT8ARRAY});
+$sth->execute();
+is_deeply ($sth->fetchall_arrayref()->[0][0], [1, 2, -3], $t);
+
+$t=q{Integer arrays bound with an array pg_type work without server-side prepares};
+$sth = $dbh->prepare(q{SELECT ?::int4[]}, {pg_server_prepare => 0});
+$sth->bind_param(1, [7, 8, 9], {pg_type => PG_INT4ARRAY});
+$sth->execute();
+is_deeply ($sth->fetchall_arrayref()->[0][0], [7, 8, 9], $t);
+
+$t=q{Statement handle attribute ParamValues shows arrays bound with an array pg_type as text};
+is ($sth->{ParamValues}{1}, '{7,8,9}', $t);
+
+$t=q{Float arrays bound with an array pg_type keep their exact values without server-side prepares};
+$sth = $dbh->prepare(q{SELECT ?::float8[] = ARRAY[0.1, 1e300, -2.5]::float8[]}, {pg_server_prepare => 0});
+$sth->bind_param(1, [0.1, 1e300, '-2.5'], {pg_type => PG_FLOAT8ARRAY});
+$sth->execute();
+is ($sth->fetchall_arrayref()->[0][0], 1, $t);
+
+$t=q{Arrays of long items full of quotes and backslashes are returned properly};
+$sth = $dbh->prepare(q{SELECT ?::text[]});
+$sth->execute(['"' x 1000, '\\' x 1000, 'plain' x 200]);
+is_deeply ($sth->fetchall_arrayref()->[0][0], ['"' x 1000, '\\' x 1000, 'plain' x 200], $t);
+
 SKIP: {
 
     my $fancytime;
@@ -17,7 +17,7 @@ my $dbh = connect_database();
 if (! $dbh) {
     plan skip_all => 'Connection to database failed, cannot continue testing';
 }
-plan tests => 225;
+plan tests => 231;
 
 my $t='Connect to database for placeholder testing';
 isnt ($dbh, undef, $t);
@@ -960,6 +960,59 @@ is ($@, '', $t);
 $sth->finish();
 
 
+## Placeholders bound with some types are sent to the server in binary format
+$SQL = q{SELECT ?::int4, ?::int8, ?::int2, ?::float8, ?::float4, ?::bool, ?::uuid};
+$sth = $dbh->prepare($SQL);
+$sth->bind_param(1, undef, SQL_INTEGER);
+$sth->bind_param(2, undef, SQL_BIGINT);
+$sth->bind_param(3, undef, SQL_SMALLINT);
+$sth->bind_param(4, undef, SQL_DOUBLE);
+$sth->bind_param(5, undef, SQL_REAL);
+$sth->bind_param(6, undef, SQL_BOOLEAN);
+$sth->bind_param(7, undef, { pg_type => PG_UUID });
+
+$t = q{Integer, float, boolean, and uuid placeholders are sent correctly in binary};
+$sth->execute(-123456, '9007199254740993', 32767, '1.5', '-0.25', 't',
+    'A0EEBC99-9C0B-4EF8-BB6D-6BB9BD380A11');
+is_deeply ($sth->fetchrow_arrayref(), [-123456, '9007199254740993', 32767, '1.5', '-0.25', 1,
+    'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'], $t);
+
+$t = q{Placeholder values that cannot be sent in binary are sent as text instead};
+$sth->execute('42 ', '9007199254740993 ', '-5', '1e3', 'NaN', 'yes',
+    '{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}');
+is_deeply ($sth->fetchrow_arrayref(), [42, '9007199254740993', -5, 1000, 'NaN', 1,
+    'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'], $t);
+
+$t = q{Invalid values sent as text are still rejected by the server};
+eval {
+    $sth->execute('abc', 1, 1, 1, 1, 't', 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11');
+};
+like ($@, qr{integer}, $t);
+$dbh->rollback();
+
+$t = q{Integers too large for binary are sent as text and rejected by the server};
+eval {
+    $sth->execute(1, '-9223372036854775809', 1, 1, 1, 't', 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11');
+};
+like ($@, qr{out of range}, $t);
+$dbh->rollback();
+
+$SQL = q{SELECT ?::timestamp::text, ?::timestamptz = '2024-02-29 12:34:56.789+00'::timestamptz};
+$sth = $dbh->prepare($SQL);
+$sth->bind_param(1, undef, { pg_type => PG_TIMESTAMP });
+$sth->bind_param(2, undef, { pg_type => PG_TIMESTAMPTZ });
+
+$t = q{Timestamp and timestamptz placeholders are sent correctly in binary};
+$sth->execute('1999-12-31 23:59:59.5', '2024-02-29 17:04:56.789+04:30');
+is_deeply ($sth->fetchrow_arrayref(), ['1999-12-31 23:59:59.5', 1], $t);
+
+$t = q{Timestamptz placeholders without an offset are sent as text};
+$dbh->do(q{SET LOCAL timezone = 'UTC'});
+$sth->execute('infinity', '2024-02-29 12:34:56.789');
+is_deeply ($sth->fetchrow_arrayref(), ['infinity', 1], $t);
+$dbh->rollback();
+
+
 ## Begin custom type testing
 
 $dbh->rollback();
@@ -282,6 +282,7 @@ checksums
 Checksums
 ChildHandles
 chopblanks
+chunked
 ChopBlanks
 chr
 cid
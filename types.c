@@ -214,209 +214,214 @@ static sql_type_info_t pg_types[] = {
  {PG_XML                           ,"xml"                          ,1,',',"xml_out"             ,quote_string,dequote_string,{0},0},
 };
 
+#define PG_TYPE_MAX_OID 6491
+
+/* Position in pg_types plus one, indexed by type oid; 0 for unknown types */
+static const unsigned short pg_type_index[PG_TYPE_MAX_OID+1] = {
+    [PG_ACLITEMARRAY]                   = 1,
+    [PG_BITARRAY]                       = 2,
+    [PG_BOOLARRAY]                      = 3,
+    [PG_BOXARRAY]                       = 4,
+    [PG_BPCHARARRAY]                    = 5,
+    [PG_BYTEAARRAY]                     = 6,
+    [PG_CHARARRAY]                      = 7,
+    [PG_CIDARRAY]                       = 8,
+    [PG_CIDRARRAY]                      = 9,
+    [PG_CIRCLEARRAY]                    = 10,
+    [PG_CSTRINGARRAY]                   = 11,
+    [PG_DATEARRAY]                      = 12,
+    [PG_DATEMULTIRANGEARRAY]            = 13,
+    [PG_DATERANGEARRAY]                 = 14,
+    [PG_FLOAT4ARRAY]                    = 15,
+    [PG_FLOAT8ARRAY]                    = 16,
+    [PG_GTSVECTORARRAY]                 = 17,
+    [PG_INETARRAY]                      = 18,
+    [PG_INT2ARRAY]                      = 19,
+    [PG_INT2VECTORARRAY]                = 20,
+    [PG_INT4ARRAY]                      = 21,
+    [PG_INT4MULTIRANGEARRAY]            = 22,
+    [PG_INT4RANGEARRAY]                 = 23,
+    [PG_INT8ARRAY]                      = 24,
+    [PG_INT8MULTIRANGEARRAY]            = 25,
+    [PG_INT8RANGEARRAY]                 = 26,
+    [PG_INTERVALARRAY]                  = 27,
+    [PG_JSONARRAY]                      = 28,
+    [PG_JSONBARRAY]                     = 29,
+    [PG_JSONPATHARRAY]                  = 30,
+    [PG_LINEARRAY]                      = 31,
+    [PG_LSEGARRAY]                      = 32,
+    [PG_MACADDRARRAY]                   = 33,
+    [PG_MACADDR8ARRAY]                  = 34,
+    [PG_MONEYARRAY]                     = 35,
+    [PG_NAMEARRAY]                      = 36,
+    [PG_NUMERICARRAY]                   = 37,
+    [PG_NUMMULTIRANGEARRAY]             = 38,
+    [PG_NUMRANGEARRAY]                  = 39,
+    [PG_OIDARRAY]                       = 40,
+    [PG_OID8ARRAY]                      = 41,
+    [PG_OIDVECTORARRAY]                 = 42,
+    [PG_PATHARRAY]                      = 43,
+    [PG_PG_ATTRIBUTEARRAY]              = 44,
+    [PG_PG_CLASSARRAY]                  = 45,
+    [PG_PG_LSNARRAY]                    = 46,
+    [PG_PG_PROCARRAY]                   = 47,
+    [PG_PG_SNAPSHOTARRAY]               = 48,
+    [PG_PG_TYPEARRAY]                   = 49,
+    [PG_POINTARRAY]                     = 50,
+    [PG_POLYGONARRAY]                   = 51,
+    [PG_RECORDARRAY]                    = 52,
+    [PG_REFCURSORARRAY]                 = 53,
+    [PG_REGCLASSARRAY]                  = 54,
+    [PG_REGCOLLATIONARRAY]              = 55,
+    [PG_REGCONFIGARRAY]                 = 56,
+    [PG_REGDATABASEARRAY]               = 57,
+    [PG_REGDICTIONARYARRAY]             = 58,
+    [PG_REGNAMESPACEARRAY]              = 59,
+    [PG_REGOPERARRAY]                   = 60,
+    [PG_REGOPERATORARRAY]               = 61,
+    [PG_REGPROCARRAY]                   = 62,
+    [PG_REGPROCEDUREARRAY]              = 63,
+    [PG_REGROLEARRAY]                   = 64,
+    [PG_REGTYPEARRAY]                   = 65,
+    [PG_TEXTARRAY]                      = 66,
+    [PG_TIDARRAY]                       = 67,
+    [PG_TIMEARRAY]                      = 68,
+    [PG_TIMESTAMPARRAY]                 = 69,
+    [PG_TIMESTAMPTZARRAY]               = 70,
+    [PG_TIMETZARRAY]                    = 71,
+    [PG_TSMULTIRANGEARRAY]              = 72,
+    [PG_TSQUERYARRAY]                   = 73,
+    [PG_TSRANGEARRAY]                   = 74,
+    [PG_TSTZMULTIRANGEARRAY]            = 75,
+    [PG_TSTZRANGEARRAY]                 = 76,
+    [PG_TSVECTORARRAY]                  = 77,
+    [PG_TXID_SNAPSHOTARRAY]             = 78,
+    [PG_UUIDARRAY]                      = 79,
+    [PG_VARBITARRAY]                    = 80,
+    [PG_VARCHARARRAY]                   = 81,
+    [PG_XIDARRAY]                       = 82,
+    [PG_XID8ARRAY]                      = 83,
+    [PG_XMLARRAY]                       = 84,
+    [PG_ACLITEM]                        = 85,
+    [PG_ANY]                            = 86,
+    [PG_ANYARRAY]                       = 87,
+    [PG_ANYCOMPATIBLE]                  = 88,
+    [PG_ANYCOMPATIBLEARRAY]             = 89,
+    [PG_ANYCOMPATIBLEMULTIRANGE]        = 90,
+    [PG_ANYCOMPATIBLENONARRAY]          = 91,
+    [PG_ANYCOMPATIBLERANGE]             = 92,
+    [PG_ANYELEMENT]                     = 93,
+    [PG_ANYENUM]                        = 94,
+    [PG_ANYMULTIRANGE]                  = 95,
+    [PG_ANYNONARRAY]                    = 96,
+    [PG_ANYRANGE]                       = 97,
+    [PG_BIT]                            = 98,
+    [PG_BOOL]                           = 99,
+    [PG_BOX]                            = 100,
+    [PG_BPCHAR]                         = 101,
+    [PG_BYTEA]                          = 102,
+    [PG_CHAR]                           = 103,
+    [PG_CID]                            = 104,
+    [PG_CIDR]                           = 105,
+    [PG_CIRCLE]                         = 106,
+    [PG_CSTRING]                        = 107,
+    [PG_DATE]                           = 108,
+    [PG_DATEMULTIRANGE]                 = 109,
+    [PG_DATERANGE]                      = 110,
+    [PG_EVENT_TRIGGER]                  = 111,
+    [PG_FDW_HANDLER]                    = 112,
+    [PG_FLOAT4]                         = 113,
+    [PG_FLOAT8]                         = 114,
+    [PG_GTSVECTOR]                      = 115,
+    [PG_INDEX_AM_HANDLER]               = 116,
+    [PG_INET]                           = 117,
+    [PG_INT2]                           = 118,
+    [PG_INT2VECTOR]                     = 119,
+    [PG_INT4]                           = 120,
+    [PG_INT4MULTIRANGE]                 = 121,
+    [PG_INT4RANGE]                      = 122,
+    [PG_INT8]                           = 123,
+    [PG_INT8MULTIRANGE]                 = 124,
+    [PG_INT8RANGE]                      = 125,
+    [PG_INTERNAL]                       = 126,
+    [PG_INTERVAL]                       = 127,
+    [PG_JSON]                           = 128,
+    [PG_JSONB]                          = 129,
+    [PG_JSONPATH]                       = 130,
+    [PG_LANGUAGE_HANDLER]               = 131,
+    [PG_LINE]                           = 132,
+    [PG_LSEG]                           = 133,
+    [PG_MACADDR]                        = 134,
+    [PG_MACADDR8]                       = 135,
+    [PG_MONEY]                          = 136,
+    [PG_NAME]                           = 137,
+    [PG_NUMERIC]                        = 138,
+    [PG_NUMMULTIRANGE]                  = 139,
+    [PG_NUMRANGE]                       = 140,
+    [PG_OID]                            = 141,
+    [PG_OID8]                           = 142,
+    [PG_OIDVECTOR]                      = 143,
+    [PG_PATH]                           = 144,
+    [PG_PG_ATTRIBUTE]                   = 145,
+    [PG_PG_BRIN_BLOOM_SUMMARY]          = 146,
+    [PG_PG_BRIN_MINMAX_MULTI_SUMMARY]   = 147,
+    [PG_PG_CLASS]                       = 148,
+    [PG_PG_DDL_COMMAND]                 = 149,
+    [PG_PG_DEPENDENCIES]                = 150,
+    [PG_PG_LSN]                         = 151,
+    [PG_PG_MCV_LIST]                    = 152,
+    [PG_PG_NDISTINCT]                   = 153,
+    [PG_PG_NODE_TREE]                   = 154,
+    [PG_PG_PROC]                        = 155,
+    [PG_PG_SNAPSHOT]                    = 156,
+    [PG_PG_TYPE]                        = 157,
+    [PG_POINT]                          = 158,
+    [PG_POLYGON]                        = 159,
+    [PG_RECORD]                         = 160,
+    [PG_REFCURSOR]                      = 161,
+    [PG_REGCLASS]                       = 162,
+    [PG_REGCOLLATION]                   = 163,
+    [PG_REGCONFIG]                      = 164,
+    [PG_REGDATABASE]                    = 165,
+    [PG_REGDICTIONARY]                  = 166,
+    [PG_REGNAMESPACE]                   = 167,
+    [PG_REGOPER]                        = 168,
+    [PG_REGOPERATOR]                    = 169,
+    [PG_REGPROC]                        = 170,
+    [PG_REGPROCEDURE]                   = 171,
+    [PG_REGROLE]                        = 172,
+    [PG_REGTYPE]                        = 173,
+    [PG_TABLE_AM_HANDLER]               = 174,
+    [PG_TEXT]                           = 175,
+    [PG_TID]                            = 176,
+    [PG_TIME]                           = 177,
+    [PG_TIMESTAMP]                      = 178,
+    [PG_TIMESTAMPTZ]                    = 179,
+    [PG_TIMETZ]                         = 180,
+    [PG_TRIGGER]                        = 181,
+    [PG_TSM_HANDLER]                    = 182,
+    [PG_TSMULTIRANGE]                   = 183,
+    [PG_TSQUERY]                        = 184,
+    [PG_TSRANGE]                        = 185,
+    [PG_TSTZMULTIRANGE]                 = 186,
+    [PG_TSTZRANGE]                      = 187,
+    [PG_TSVECTOR]                       = 188,
+    [PG_TXID_SNAPSHOT]                  = 189,
+    [PG_UNKNOWN]                        = 190,
+    [PG_UUID]                           = 191,
+    [PG_VARBIT]                         = 192,
+    [PG_VARCHAR]                        = 193,
+    [PG_VOID]                           = 194,
+    [PG_XID]                            = 195,
+    [PG_XID8]                           = 196,
+    [PG_XML]                            = 197,
+};
+
 sql_type_info_t* pg_type_data(int sql_type)
 {
-    switch(sql_type) {
-
-        case PG_ACLITEMARRAY:                   return &pg_types[0];
-        case PG_BITARRAY:                       return &pg_types[1];
-        case PG_BOOLARRAY:                      return &pg_types[2];
-        case PG_BOXARRAY:                       return &pg_types[3];
-        case PG_BPCHARARRAY:                    return &pg_types[4];
-        case PG_BYTEAARRAY:                     return &pg_types[5];
-        case PG_CHARARRAY:                      return &pg_types[6];
-        case PG_CIDARRAY:                       return &pg_types[7];
-        case PG_CIDRARRAY:                      return &pg_types[8];
-        case PG_CIRCLEARRAY:                    return &pg_types[9];
-        case PG_CSTRINGARRAY:                   return &pg_types[10];
-        case PG_DATEARRAY:                      return &pg_types[11];
-        case PG_DATEMULTIRANGEARRAY:            return &pg_types[12];
-        case PG_DATERANGEARRAY:                 return &pg_types[13];
-        case PG_FLOAT4ARRAY:                    return &pg_types[14];
-        case PG_FLOAT8ARRAY:                    return &pg_types[15];
-        case PG_GTSVECTORARRAY:                 return &pg_types[16];
-        case PG_INETARRAY:                      return &pg_types[17];
-        case PG_INT2ARRAY:                      return &pg_types[18];
-        case PG_INT2VECTORARRAY:                return &pg_types[19];
-        case PG_INT4ARRAY:                      return &pg_types[20];
-        case PG_INT4MULTIRANGEARRAY:            return &pg_types[21];
-        case PG_INT4RANGEARRAY:                 return &pg_types[22];
-        case PG_INT8ARRAY:                      return &pg_types[23];
-        case PG_INT8MULTIRANGEARRAY:            return &pg_types[24];
-        case PG_INT8RANGEARRAY:                 return &pg_types[25];
-        case PG_INTERVALARRAY:                  return &pg_types[26];
-        case PG_JSONARRAY:                      return &pg_types[27];
-        case PG_JSONBARRAY:                     return &pg_types[28];
-        case PG_JSONPATHARRAY:                  return &pg_types[29];
-        case PG_LINEARRAY:                      return &pg_types[30];
-        case PG_LSEGARRAY:                      return &pg_types[31];
-        case PG_MACADDRARRAY:                   return &pg_types[32];
-        case PG_MACADDR8ARRAY:                  return &pg_types[33];
-        case PG_MONEYARRAY:                     return &pg_types[34];
-        case PG_NAMEARRAY:                      return &pg_types[35];
-        case PG_NUMERICARRAY:                   return &pg_types[36];
-        case PG_NUMMULTIRANGEARRAY:             return &pg_types[37];
-        case PG_NUMRANGEARRAY:                  return &pg_types[38];
-        case PG_OIDARRAY:                       return &pg_types[39];
-        case PG_OID8ARRAY:                      return &pg_types[40];
-        case PG_OIDVECTORARRAY:                 return &pg_types[41];
-        case PG_PATHARRAY:                      return &pg_types[42];
-        case PG_PG_ATTRIBUTEARRAY:              return &pg_types[43];
-        case PG_PG_CLASSARRAY:                  return &pg_types[44];
-        case PG_PG_LSNARRAY:                    return &pg_types[45];
-        case PG_PG_PROCARRAY:                   return &pg_types[46];
-        case PG_PG_SNAPSHOTARRAY:               return &pg_types[47];
-        case PG_PG_TYPEARRAY:                   return &pg_types[48];
-        case PG_POINTARRAY:                     return &pg_types[49];
-        case PG_POLYGONARRAY:                   return &pg_types[50];
-        case PG_RECORDARRAY:                    return &pg_types[51];
-        case PG_REFCURSORARRAY:                 return &pg_types[52];
-        case PG_REGCLASSARRAY:                  return &pg_types[53];
-        case PG_REGCOLLATIONARRAY:              return &pg_types[54];
-        case PG_REGCONFIGARRAY:                 return &pg_types[55];
-        case PG_REGDATABASEARRAY:               return &pg_types[56];
-        case PG_REGDICTIONARYARRAY:             return &pg_types[57];
-        case PG_REGNAMESPACEARRAY:              return &pg_types[58];
-        case PG_REGOPERARRAY:                   return &pg_types[59];
-        case PG_REGOPERATORARRAY:               return &pg_types[60];
-        case PG_REGPROCARRAY:                   return &pg_types[61];
-        case PG_REGPROCEDUREARRAY:              return &pg_types[62];
-        case PG_REGROLEARRAY:                   return &pg_types[63];
-        case PG_REGTYPEARRAY:                   return &pg_types[64];
-        case PG_TEXTARRAY:                      return &pg_types[65];
-        case PG_TIDARRAY:                       return &pg_types[66];
-        case PG_TIMEARRAY:                      return &pg_types[67];
-        case PG_TIMESTAMPARRAY:                 return &pg_types[68];
-        case PG_TIMESTAMPTZARRAY:               return &pg_types[69];
-        case PG_TIMETZARRAY:                    return &pg_types[70];
-        case PG_TSMULTIRANGEARRAY:              return &pg_types[71];
-        case PG_TSQUERYARRAY:                   return &pg_types[72];
-        case PG_TSRANGEARRAY:                   return &pg_types[73];
-        case PG_TSTZMULTIRANGEARRAY:            return &pg_types[74];
-        case PG_TSTZRANGEARRAY:                 return &pg_types[75];
-        case PG_TSVECTORARRAY:                  return &pg_types[76];
-        case PG_TXID_SNAPSHOTARRAY:             return &pg_types[77];
-        case PG_UUIDARRAY:                      return &pg_types[78];
-        case PG_VARBITARRAY:                    return &pg_types[79];
-        case PG_VARCHARARRAY:                   return &pg_types[80];
-        case PG_XIDARRAY:                       return &pg_types[81];
-        case PG_XID8ARRAY:                      return &pg_types[82];
-        case PG_XMLARRAY:                       return &pg_types[83];
-        case PG_ACLITEM:                        return &pg_types[84];
-        case PG_ANY:                            return &pg_types[85];
-        case PG_ANYARRAY:                       return &pg_types[86];
-        case PG_ANYCOMPATIBLE:                  return &pg_types[87];
-        case PG_ANYCOMPATIBLEARRAY:             return &pg_types[88];
-        case PG_ANYCOMPATIBLEMULTIRANGE:        return &pg_types[89];
-        case PG_ANYCOMPATIBLENONARRAY:          return &pg_types[90];
-        case PG_ANYCOMPATIBLERANGE:             return &pg_types[91];
-        case PG_ANYELEMENT:                     return &pg_types[92];
-        case PG_ANYENUM:                        return &pg_types[93];
-        case PG_ANYMULTIRANGE:                  return &pg_types[94];
-        case PG_ANYNONARRAY:                    return &pg_types[95];
-        case PG_ANYRANGE:                       return &pg_types[96];
-        case PG_BIT:                            return &pg_types[97];
-        case PG_BOOL:                           return &pg_types[98];
-        case PG_BOX:                            return &pg_types[99];
-        case PG_BPCHAR:                         return &pg_types[100];
-        case PG_BYTEA:                          return &pg_types[101];
-        case PG_CHAR:                           return &pg_types[102];
-        case PG_CID:                            return &pg_types[103];
-        case PG_CIDR:                           return &pg_types[104];
-        case PG_CIRCLE:                         return &pg_types[105];
-        case PG_CSTRING:                        return &pg_types[106];
-        case PG_DATE:                           return &pg_types[107];
-        case PG_DATEMULTIRANGE:                 return &pg_types[108];
-        case PG_DATERANGE:                      return &pg_types[109];
-        case PG_EVENT_TRIGGER:                  return &pg_types[110];
-        case PG_FDW_HANDLER:                    return &pg_types[111];
-        case PG_FLOAT4:                         return &pg_types[112];
-        case PG_FLOAT8:                         return &pg_types[113];
-        case PG_GTSVECTOR:                      return &pg_types[114];
-        case PG_INDEX_AM_HANDLER:               return &pg_types[115];
-        case PG_INET:                           return &pg_types[116];
-        case PG_INT2:                           return &pg_types[117];
-        case PG_INT2VECTOR:                     return &pg_types[118];
-        case PG_INT4:                           return &pg_types[119];
-        case PG_INT4MULTIRANGE:                 return &pg_types[120];
-        case PG_INT4RANGE:                      return &pg_types[121];
-        case PG_INT8:                           return &pg_types[122];
-        case PG_INT8MULTIRANGE:                 return &pg_types[123];
-        case PG_INT8RANGE:                      return &pg_types[124];
-        case PG_INTERNAL:                       return &pg_types[125];
-        case PG_INTERVAL:                       return &pg_types[126];
-        case PG_JSON:                           return &pg_types[127];
-        case PG_JSONB:                          return &pg_types[128];
-        case PG_JSONPATH:                       return &pg_types[129];
-        case PG_LANGUAGE_HANDLER:               return &pg_types[130];
-        case PG_LINE:                           return &pg_types[131];
-        case PG_LSEG:                           return &pg_types[132];
-        case PG_MACADDR:                        return &pg_types[133];
-        case PG_MACADDR8:                       return &pg_types[134];
-        case PG_MONEY:                          return &pg_types[135];
-        case PG_NAME:                           return &pg_types[136];
-        case PG_NUMERIC:                        return &pg_types[137];
-        case PG_NUMMULTIRANGE:                  return &pg_types[138];
-        case PG_NUMRANGE:                       return &pg_types[139];
-        case PG_OID:                            return &pg_types[140];
-        case PG_OID8:                           return &pg_types[141];
-        case PG_OIDVECTOR:                      return &pg_types[142];
-        case PG_PATH:                           return &pg_types[143];
-        case PG_PG_ATTRIBUTE:                   return &pg_types[144];
-        case PG_PG_BRIN_BLOOM_SUMMARY:          return &pg_types[145];
-        case PG_PG_BRIN_MINMAX_MULTI_SUMMARY:   return &pg_types[146];
-        case PG_PG_CLASS:                       return &pg_types[147];
-        case PG_PG_DDL_COMMAND:                 return &pg_types[148];
-        case PG_PG_DEPENDENCIES:                return &pg_types[149];
-        case PG_PG_LSN:                         return &pg_types[150];
-        case PG_PG_MCV_LIST:                    return &pg_types[151];
-        case PG_PG_NDISTINCT:                   return &pg_types[152];
-        case PG_PG_NODE_TREE:                   return &pg_types[153];
-        case PG_PG_PROC:                        return &pg_types[154];
-        case PG_PG_SNAPSHOT:                    return &pg_types[155];
-        case PG_PG_TYPE:                        return &pg_types[156];
-        case PG_POINT:                          return &pg_types[157];
-        case PG_POLYGON:                        return &pg_types[158];
-        case PG_RECORD:                         return &pg_types[159];
-        case PG_REFCURSOR:                      return &pg_types[160];
-        case PG_REGCLASS:                       return &pg_types[161];
-        case PG_REGCOLLATION:                   return &pg_types[162];
-        case PG_REGCONFIG:                      return &pg_types[163];
-        case PG_REGDATABASE:                    return &pg_types[164];
-        case PG_REGDICTIONARY:                  return &pg_types[165];
-        case PG_REGNAMESPACE:                   return &pg_types[166];
-        case PG_REGOPER:                        return &pg_types[167];
-        case PG_REGOPERATOR:                    return &pg_types[168];
-        case PG_REGPROC:                        return &pg_types[169];
-        case PG_REGPROCEDURE:                   return &pg_types[170];
-        case PG_REGROLE:                        return &pg_types[171];
-        case PG_REGTYPE:                        return &pg_types[172];
-        case PG_TABLE_AM_HANDLER:               return &pg_types[173];
-        case PG_TEXT:                           return &pg_types[174];
-        case PG_TID:                            return &pg_types[175];
-        case PG_TIME:                           return &pg_types[176];
-        case PG_TIMESTAMP:                      return &pg_types[177];
-        case PG_TIMESTAMPTZ:                    return &pg_types[178];
-        case PG_TIMETZ:                         return &pg_types[179];
-        case PG_TRIGGER:                        return &pg_types[180];
-        case PG_TSM_HANDLER:                    return &pg_types[181];
-        case PG_TSMULTIRANGE:                   return &pg_types[182];
-        case PG_TSQUERY:                        return &pg_types[183];
-        case PG_TSRANGE:                        return &pg_types[184];
-        case PG_TSTZMULTIRANGE:                 return &pg_types[185];
-        case PG_TSTZRANGE:                      return &pg_types[186];
-        case PG_TSVECTOR:                       return &pg_types[187];
-        case PG_TXID_SNAPSHOT:                  return &pg_types[188];
-        case PG_UNKNOWN:                        return &pg_types[189];
-        case PG_UUID:                           return &pg_types[190];
-        case PG_VARBIT:                         return &pg_types[191];
-        case PG_VARCHAR:                        return &pg_types[192];
-        case PG_VOID:                           return &pg_types[193];
-        case PG_XID:                            return &pg_types[194];
-        case PG_XID8:                           return &pg_types[195];
-        case PG_XML:                            return &pg_types[196];
-        default: return NULL;
-    }
+    if (sql_type < 0 || sql_type > PG_TYPE_MAX_OID || 0 == pg_type_index[sql_type])
+        return NULL;
+    return &pg_types[pg_type_index[sql_type]-1];
 }
 
 static sql_type_info_t sql_types[] = {
@@ -839,17 +844,30 @@ for my $name (sort {$a cmp $b } keys %pgtype) {
 
 print $newfh "\};\n\n";
 
-print $newfh
-"sql_type_info_t* pg_type_data(int sql_type)
-{
-    switch(sql_type) {
-\n";
+my $maxoid = 0;
+for my $name (keys %pgtype) {
+    $maxoid = $pgtype{$name}{oid} if $pgtype{$name}{oid} > $maxoid;
+}
+
+print $newfh "#define PG_TYPE_MAX_OID $maxoid\n\n";
+print $newfh "$slashstar Position in pg_types plus one, indexed by type oid; 0 for unknown types $starslash\n";
+print $newfh "static const unsigned short pg_type_index[PG_TYPE_MAX_OID+1] = \{\n";
 
 for my $name (sort { $a cmp $b } keys %pgtype) {
-    printf $newfh qq{        case %-*s return \&pg_types\[%d\];\n}, 1+$maxlen, "$pgtype{$name}{define}:", $pos{$name};
+    printf $newfh qq{    [%-*s = %d,\n}, 1+$maxlen, "$pgtype{$name}{define}]", 1+$pos{$name};
+}
+
+print $newfh
+"\};
+
+sql_type_info_t* pg_type_data(int sql_type)
+{
+    if (sql_type < 0 || sql_type > PG_TYPE_MAX_OID || 0 == pg_type_index[sql_type])
+        return NULL;
+    return &pg_types[pg_type_index[sql_type]-1];
 }
 
-print $newfh "        default: return NULL;\n    \}\n\}\n\n";
+";
 
 print $newfh "static sql_type_info_t sql_types[] = \{\n";
 